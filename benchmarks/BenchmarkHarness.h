@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * Shared code of the native benchmarks
+ *
+ * Loads the documents of benchmarks/corpus/, times a run as the best of a
+ * few, counts the nodes of a tree, and has no-op md4c callbacks for timing
+ * the parser alone. Each benchmark source includes it and builds as its own
+ * executable.
+ */
+
+#include "MarkdownParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef HYPERMARKDOWN_CORPUS_DIR
+#define HYPERMARKDOWN_CORPUS_DIR "benchmarks/corpus"
+#endif
+
+namespace hypermarkdown_bench {
+
+using margelo::nitro::hypermarkdown::MarkdownNode;
+
+struct Document {
+    std::string name;
+    std::string content;
+};
+
+// The .md documents of `dir` but its README, sorted by name; with a
+// `filter`, only those whose name contains it
+inline std::vector<Document> loadCorpus(const std::string& dir, const std::string& filter = "") {
+    std::vector<Document> documents;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        auto path = entry.path();
+        if (path.extension() != ".md" || path.filename() == "README.md") {
+            continue;
+        }
+        std::string name = path.stem().string();
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream oss;
+        oss << in.rdbuf();
+        documents.push_back({name, oss.str()});
+    }
+    std::sort(documents.begin(), documents.end(),
+              [](const Document& a, const Document& b) { return a.name < b.name; });
+    return documents;
+}
+
+// The best of `iterations` samples in ms; a sample runs `fn` `repeat`
+// times and counts the time of one run
+inline double bestOf(int iterations, const std::function<void()>& fn, size_t repeat = 1) {
+    double best = 0;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeat; r++) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count() / repeat;
+        if (i == 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+// Nodes of the tree under `root`, the root included
+inline size_t countNodes(const MarkdownNode* root) {
+    size_t count = 0;
+    margelo::nitro::hypermarkdown::walkTree(
+        root, [&](const MarkdownNode*, size_t) { count++; return true; }, [](const MarkdownNode*) {});
+    return count;
+}
+
+// md4c callbacks for timing the parser alone
+inline int noopBlock(MD_BLOCKTYPE, void*, void*) { return 0; }
+inline int noopSpan(MD_SPANTYPE, void*, void*) { return 0; }
+inline int noopText(MD_TEXTTYPE, const MD_CHAR*, MD_SIZE, void*) { return 0; }
+
+} // namespace hypermarkdown_bench
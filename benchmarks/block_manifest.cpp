@@ -0,0 +1,62 @@
+/**
+ * Block manifest benchmark
+ *
+ * Compares, for every document of benchmarks/corpus/:
+ *
+ *   parse ms      MarkdownParser::parse() of the whole document
+ *   manifest ms   BlockManifest::build(), md4c's block analysis alone, plus
+ *                 MarkdownSerializer::blockManifestToJson()
+ *   range ms      parse() of 20 top-level blocks from the middle, as a
+ *                 virtualized list fetches them (getBlocks)
+ *
+ * Usage: block_manifest [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "BlockManifest.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    constexpr size_t kRangeBlocks = 20;
+    std::printf("%-18s %9s %8s %9s %11s %9s\n", "document", "KB", "blocks", "parse ms", "manifest ms", "range ms");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+        size_t blocks = 0;
+        bool ok = true;
+        double parseMs = bestOf(iterations, [&] { ok &= MarkdownParser::parse(document.content, options).success; });
+        double manifestMs = bestOf(iterations, [&] {
+            auto manifest = BlockManifest::build(document.content, InternalLayoutMetrics(), options);
+            ok &= manifest.success && !MarkdownSerializer::blockManifestToJson(manifest).empty();
+            blocks = manifest.blocks.size();
+        });
+        options.firstBlock = blocks > kRangeBlocks ? (blocks - kRangeBlocks) / 2 : 0;
+        options.endBlock = options.firstBlock + kRangeBlocks;
+        double rangeMs = bestOf(iterations, [&] { ok &= MarkdownParser::parse(document.content, options).success; });
+        if (!ok) {
+            std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+            return 1;
+        }
+        std::printf("%-18s %9.1f %8zu %9.3f %11.3f %9.3f\n", document.name.c_str(), document.content.size() / 1024.0,
+                    blocks, parseMs, manifestMs, rangeMs);
+    }
+    return 0;
+}
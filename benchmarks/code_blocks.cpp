@@ -0,0 +1,151 @@
+/**
+ * Code block benchmark
+ *
+ * Parses documents made of multi-megabyte code blocks (pasted logs, source
+ * dumps) and reports how many text callbacks md4c makes for them, the md4c
+ * time with a callback that only counts, and the full MarkdownParser::parse
+ * time. Verbatim blocks are emitted as runs of the input spanning many
+ * lines, so a top-level fenced block should need a handful of callbacks
+ * rather than a few per line. Indented blocks and blocks inside list items
+ * have a prefix in front of every line that is not part of the code, so
+ * they still take one callback per line.
+ *
+ * Usage: code_blocks [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kLines = 50000;
+
+struct Corpus {
+    const char* name;
+    std::string content;
+    std::string code;
+};
+
+std::string codeLine(size_t i) {
+    std::string indent(4 * (i % 4), ' ');
+    return indent + "let value" + std::to_string(i) + " = compute(\"" + std::to_string(i * 31) + "\", options);";
+}
+
+std::string code() {
+    std::string s;
+    for (size_t i = 0; i < kLines; i++) {
+        s += codeLine(i) + "\n";
+    }
+    return s;
+}
+
+// Puts `prefix` in front of every line of the code
+std::string prefixed(const std::string& prefix, const std::string& text) {
+    std::string s;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos) + 1;
+        s += prefix;
+        s.append(text, pos, end - pos);
+        pos = end;
+    }
+    return s;
+}
+
+std::string findCode(const std::shared_ptr<MarkdownNode>& root) {
+    std::vector<const MarkdownNode*> stack = {root.get()};
+    while (!stack.empty()) {
+        const MarkdownNode* node = stack.back();
+        stack.pop_back();
+        if (node->type == "code_block") {
+            std::string text;
+            for (const auto& child : node->children) {
+                text += child->content.value_or("");
+            }
+            return text;
+        }
+        for (const auto& child : node->children) {
+            stack.push_back(child.get());
+        }
+    }
+    return "";
+}
+
+struct Counts {
+    size_t textCallbacks = 0;
+    size_t bytes = 0;
+};
+
+int countText(MD_TEXTTYPE, const MD_CHAR*, MD_SIZE size, void* userdata) {
+    auto* counts = static_cast<Counts*>(userdata);
+    counts->textCallbacks++;
+    counts->bytes += size;
+    return 0;
+}
+
+Counts md4cOnly(const std::string& content) {
+    Counts counts;
+    MD_PARSER parser = {
+        0,
+        MD_FLAG_TABLES | MD_FLAG_STRIKETHROUGH | MD_FLAG_TASKLISTS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_COLLAPSEWHITESPACE,
+        noopBlock,
+        noopBlock,
+        noopSpan,
+        noopSpan,
+        countText,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr
+    };
+    md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, &counts);
+    return counts;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::string text = code();
+    std::vector<Corpus> corpora = {
+        {"fenced", "```ts\n" + text + "```\n", text},
+        {"indented", prefixed("    ", text), text},
+        {"in_list", "- item\n\n  ```ts\n" + prefixed("  ", text) + "  ```\n", text},
+    };
+
+    std::printf("%-10s %10s %10s %10s %10s %10s\n", "corpus", "bytes", "callbacks", "md4c ms", "parse ms", "MB/s");
+
+    for (const auto& corpus : corpora) {
+        InternalParserOptions options;
+        options.maxInputSize = corpus.content.size();
+
+        // The code block must hold exactly the code, without any prefixes
+        auto result = MarkdownParser::parse(corpus.content, options);
+        if (!result.success || findCode(result.nodes[0]) != corpus.code) {
+            std::fprintf(stderr, "%s: code block text differs from the source\n", corpus.name);
+            return 1;
+        }
+
+        Counts counts = md4cOnly(corpus.content);
+        double md4cMs = bestOf(iterations, [&] { md4cOnly(corpus.content); });
+        double parseMs = bestOf(iterations, [&] { MarkdownParser::parse(corpus.content, options); });
+        double mbPerSec = (corpus.content.size() / (1024.0 * 1024.0)) / (parseMs / 1000.0);
+        std::printf("%-10s %10zu %10zu %10.2f %10.2f %10.1f\n", corpus.name, corpus.content.size(),
+                    counts.textCallbacks, md4cMs, parseMs, mbPerSec);
+    }
+
+    return 0;
+}
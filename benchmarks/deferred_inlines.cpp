@@ -0,0 +1,92 @@
+/**
+ * Two-phase parsing benchmark
+ *
+ * Compares, for every document of benchmarks/corpus/, the native time to
+ * first render:
+ *
+ *   full ms       parse() and toJson() of the whole document
+ *   skeleton ms   parse() and toJson() with deferInlines, the block
+ *                 structure only
+ *   inlines ms    parse() and toJson() with inlinesOnly of 20 deferred
+ *                 leaves from the middle, a screenful
+ *
+ * and the size of the skeleton's JSON against the full JSON.
+ *
+ * Usage: deferred_inlines [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+size_t countDeferred(const std::shared_ptr<MarkdownNode>& root) {
+    size_t count = 0;
+    walkTree(
+        root.get(),
+        [&](const MarkdownNode* node, size_t) {
+            count += node->type == "deferred";
+            return true;
+        },
+        [](const MarkdownNode*) {});
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    constexpr size_t kVisibleLeaves = 20;
+    std::printf("%-18s %9s %8s %9s %11s %10s %9s %9s\n", "document", "KB", "leaves", "full ms", "skeleton ms",
+                "inlines ms", "full KB", "skel. KB");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+        bool ok = true;
+        size_t fullBytes = 0;
+        size_t skeletonBytes = 0;
+        size_t leaves = 0;
+        auto run = [&](const InternalParserOptions& runOptions, size_t& bytes) {
+            auto result = MarkdownParser::parse(document.content, runOptions);
+            ok &= result.success;
+            bytes = result.success ? MarkdownSerializer::toJson(result.nodes).size() : 0;
+            if (runOptions.deferInlines && result.success) {
+                leaves = countDeferred(result.nodes.front());
+            }
+        };
+        double fullMs = bestOf(iterations, [&] { run(options, fullBytes); });
+        options.deferInlines = true;
+        double skeletonMs = bestOf(iterations, [&] { run(options, skeletonBytes); });
+        options.deferInlines = false;
+        options.inlinesOnly = true;
+        options.firstInline = leaves > kVisibleLeaves ? (leaves - kVisibleLeaves) / 2 : 0;
+        options.endInline = options.firstInline + kVisibleLeaves;
+        size_t inlineBytes = 0;
+        double inlinesMs = bestOf(iterations, [&] { run(options, inlineBytes); });
+        if (!ok) {
+            std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+            return 1;
+        }
+        std::printf("%-18s %9.1f %8zu %9.3f %11.3f %10.3f %9.1f %9.1f\n", document.name.c_str(),
+                    document.content.size() / 1024.0, leaves, fullMs, skeletonMs, inlinesMs, fullBytes / 1024.0,
+                    skeletonBytes / 1024.0);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * Display list benchmark
+ *
+ * Compares the nested JSON AST with the flat display list (displayList) for
+ * every document of benchmarks/corpus/, with and without source positions:
+ *
+ *   json KB    size of the output handed to JS
+ *   write ms   MarkdownSerializer::toJson(), or DisplayList::build() plus
+ *              MarkdownSerializer::displayListToJson()
+ *
+ * JSON.parse on the JS side scales with the output; the display list
+ * replaces an object per node and repeated property names with numbers.
+ *
+ * Usage: display_list [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "DisplayList.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    std::printf("%-18s %-9s %9s %9s %9s %9s\n", "document", "positions", "tree KB", "tree ms", "list KB", "list ms");
+    for (const auto& document : documents) {
+        for (bool positions : {false, true}) {
+            InternalParserOptions options;
+            options.maxInputSize = document.content.size();
+            options.sourcePositions = positions;
+            auto result = MarkdownParser::parse(document.content, options);
+            if (!result.success) {
+                std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+                return 1;
+            }
+            // A fresh index per write, as in a real parse call
+            auto lines = [&] { return positions ? std::optional<LineIndex>(document.content) : std::nullopt; };
+            size_t treeBytes = 0;
+            size_t listBytes = 0;
+            double treeMs = bestOf(iterations, [&] {
+                auto index = lines();
+                treeBytes = MarkdownSerializer::toJson(result.nodes, nullptr, index ? &*index : nullptr).size();
+            });
+            double listMs = bestOf(iterations, [&] {
+                auto index = lines();
+                auto list = DisplayList::build(result.nodes, index ? &*index : nullptr);
+                listBytes = MarkdownSerializer::displayListToJson(list).size();
+            });
+            std::printf("%-18s %-9s %9.1f %9.3f %9.1f %9.3f\n", document.name.c_str(), positions ? "yes" : "no",
+                        treeBytes / 1024.0, treeMs, listBytes / 1024.0, listMs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * Resource extraction benchmark
+ *
+ * Times listing the images and links of every document of
+ * benchmarks/corpus/, for prefetching:
+ *
+ *   full ms       parse plus the JSON AST, which JS would walk for image and
+ *                 link nodes
+ *   extract ms    DocumentResources::extract() plus the resources JSON
+ *
+ * and the same for all of the documents as one batch.
+ *
+ * Usage: document_resources [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "DocumentResources.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    InternalParserOptions options;
+    for (const auto& document : documents) {
+        options.maxInputSize = std::max(options.maxInputSize, document.content.size());
+    }
+    bool failed = false;
+    auto parse = [&](const Document& document) {
+        auto result = MarkdownParser::parse(document.content, options);
+        failed |= !result.success;
+        MarkdownSerializer::toJson(result.nodes);
+    };
+    auto extract = [&](const Document& document) {
+        auto extracted = DocumentResources::extract(document.content, options);
+        failed |= !extracted.success;
+        return extracted;
+    };
+
+    std::printf("%-18s %9s %9s %10s\n", "document", "resources", "full ms", "extract ms");
+    double batchFullMs = 0;
+    for (const auto& document : documents) {
+        size_t resources = extract(document).resources.size();
+        double fullMs = bestOf(iterations, [&] { parse(document); });
+        double extractMs = bestOf(iterations, [&] {
+            std::vector<DocumentResources> batch;
+            batch.push_back(extract(document));
+            MarkdownSerializer::resourcesToJson(batch);
+        });
+        batchFullMs += fullMs;
+        std::printf("%-18s %9zu %9.3f %10.3f\n", document.name.c_str(), resources, fullMs, extractMs);
+    }
+    double batchMs = bestOf(iterations, [&] {
+        std::vector<DocumentResources> batch;
+        for (const auto& document : documents) {
+            batch.push_back(extract(document));
+        }
+        MarkdownSerializer::resourcesToJson(batch);
+    });
+    std::printf("%-18s %9s %9.3f %10.3f\n", "(batch)", "", batchFullMs, batchMs);
+    if (failed) {
+        std::fprintf(stderr, "parse failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * Giant paragraph memory benchmark
+ *
+ * Parses single paragraphs of 1 to 16 MB (a pasted log without blank lines)
+ * with no-op callbacks and reports the peak RSS md4c adds on top of the
+ * input. Inline analysis works in bounded windows, so the peak must grow
+ * much slower than the paragraph; only the per-line bookkeeping of the
+ * block itself is proportional to it.
+ *
+ * Every measurement runs in a forked child so that the high-water mark of
+ * one size does not hide the next one.
+ *
+ * Usage: giant_paragraph
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+
+#include <cstdio>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kBaseMegabytes = 1;
+constexpr int kDoublings = 4;
+
+// Accepted peak overhead at the largest size, in bytes per input byte.
+// Holding all marks of the paragraph at once costs 2-3 bytes per byte.
+constexpr double kMaxOverheadPerByte = 0.5;
+
+// A log line with the usual suspects: brackets, raw HTML, autolinks,
+// emphasis and code spans, all closed on the line itself.
+std::string logLine(size_t i) {
+    return "2024-05-01T12:" + std::to_string(10 + i % 50) + ":00Z [INFO] worker-" + std::to_string(i % 8) +
+           ": processed <req id=" + std::to_string(i) + "> in `" + std::to_string(i % 97) +
+           "ms` *(cache hit)* see https://example.com/r/" + std::to_string(i) + " & retry_count=0\n";
+}
+
+std::string generate(size_t bytes) {
+    std::string s;
+    s.reserve(bytes + 256);
+    for (size_t i = 0; s.size() < bytes; i++) {
+        s += logLine(i);
+    }
+    return s;
+}
+
+size_t peakRssBytes() {
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Runs in the child: returns the peak RSS increase caused by md_parse()
+size_t measure(size_t bytes) {
+    std::string content = generate(bytes);
+    MD_PARSER parser = {
+        0,
+        MD_FLAG_TABLES | MD_FLAG_STRIKETHROUGH | MD_FLAG_TASKLISTS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_COLLAPSEWHITESPACE,
+        noopBlock,
+        noopBlock,
+        noopSpan,
+        noopSpan,
+        noopText,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr
+    };
+
+    size_t before = peakRssBytes();
+    md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, nullptr);
+    size_t after = peakRssBytes();
+    return after - before;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%10s %14s %14s\n", "MB", "peak KB", "bytes/byte");
+
+    double lastOverhead = 0;
+    for (int step = 0; step <= kDoublings; step++) {
+        size_t bytes = (kBaseMegabytes << step) * 1024 * 1024;
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::perror("pipe");
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            size_t peak = measure(bytes);
+            ssize_t written = write(fds[1], &peak, sizeof(peak));
+            _exit(written == sizeof(peak) ? 0 : 1);
+        }
+
+        size_t peak = 0;
+        ssize_t got = read(fds[0], &peak, sizeof(peak));
+        close(fds[0]);
+        close(fds[1]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (got != sizeof(peak) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::fprintf(stderr, "measurement of %zu bytes failed\n", bytes);
+            return 1;
+        }
+
+        lastOverhead = static_cast<double>(peak) / bytes;
+        std::printf("%10zu %14zu %14.2f\n", bytes >> 20, peak / 1024, lastOverhead);
+    }
+
+    if (lastOverhead > kMaxOverheadPerByte) {
+        std::fprintf(stderr, "peak memory grows with the paragraph (%.2f bytes per input byte)\n", lastOverhead);
+        return 1;
+    }
+    return 0;
+}
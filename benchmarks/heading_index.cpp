@@ -0,0 +1,72 @@
+/**
+ * Heading index benchmark
+ *
+ * Times what a table of contents costs for every document of
+ * benchmarks/corpus/:
+ *
+ *   full ms       parse plus the JSON AST, which JS would walk for headings
+ *   index ms      the same with collectHeadings, plus the heading index JSON
+ *   only ms       headingsOnly plus the heading index JSON
+ *
+ * headingsOnly skips inline analysis of everything but headings and the
+ * paragraphs of tight list items, and hands over no AST.
+ *
+ * Usage: heading_index [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    std::printf("%-18s %9s %9s %9s %9s\n", "document", "headings", "full ms", "index ms", "only ms");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+        size_t headings = 0;
+        bool failed = false;
+        auto run = [&](bool collect, bool only) {
+            options.collectHeadings = collect;
+            options.headingsOnly = only;
+            auto result = MarkdownParser::parse(document.content, options);
+            if (!result.success) {
+                failed = true;
+                return;
+            }
+            if (!only) {
+                MarkdownSerializer::toJson(result.nodes);
+            }
+            if (result.headings) {
+                MarkdownSerializer::headingsToJson(*result.headings, LineIndex(document.content));
+                headings = result.headings->size();
+            }
+        };
+        double fullMs = bestOf(iterations, [&] { run(false, false); });
+        double indexMs = bestOf(iterations, [&] { run(true, false); });
+        double onlyMs = bestOf(iterations, [&] { run(true, true); });
+        if (failed) {
+            std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+            return 1;
+        }
+        std::printf("%-18s %9zu %9.3f %9.3f %9.3f\n", document.name.c_str(), headings, fullMs, indexMs, onlyMs);
+    }
+    return 0;
+}
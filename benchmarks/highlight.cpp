@@ -0,0 +1,174 @@
+/**
+ * Code tokenizer benchmark
+ *
+ * Tokenizes 1 MB of typical code per language with CodeTokenizer and
+ * reports the throughput, with and without the conversion of the offsets
+ * to UTF-16 units the parser does. The last rows parse a Markdown document
+ * of fenced code blocks with and without highlightCode, i.e. the cost of
+ * highlighting within a parse.
+ *
+ * Usage: highlight [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "CodeTokenizer.h"
+#include "MarkdownParser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kCodeBytes = 1024 * 1024;
+
+struct Sample {
+    const char* language;
+    const char* code;
+};
+
+const Sample kSamples[] = {
+    {"ts", "import { useMemo } from 'react'\n"
+           "// Sums the visible rows\n"
+           "export function total(rows: Row[], limit = 10): number {\n"
+           "  const visible = rows.filter((row) => row.visible && row.value > 0.5)\n"
+           "  return visible.slice(0, limit).reduce((sum, row) => sum + row.value, 0)\n"
+           "}\n"
+           "const label = `total: ${total(rows)}` ?? null\n"},
+    {"python", "@dataclass\n"
+               "class Row:\n"
+               "    \"\"\"A row of the table.\"\"\"\n"
+               "    value: float = 0.0\n\n"
+               "def total(rows, limit=10):\n"
+               "    # Sums the visible rows\n"
+               "    return sum(r.value for r in rows[:limit] if r.visible and r.value > 0.5)\n"},
+    {"json", "{\"id\": 1234, \"name\": \"hyper-markdown\", \"tags\": [\"parser\", \"native\"],\n"
+             " \"nested\": {\"enabled\": true, \"ratio\": 0.75, \"parent\": null}}\n"},
+    {"bash", "#!/bin/bash\n"
+             "set -euo pipefail\n"
+             "for file in \"$@\"; do\n"
+             "  if [ -f \"$file\" ]; then echo \"${file%%.md}: $(wc -l < \"$file\")\"; fi  # count lines\n"
+             "done\n"},
+    {"cpp", "#include <vector>\n"
+            "// Sums the visible rows\n"
+            "template <typename Row>\n"
+            "double total(const std::vector<Row>& rows, size_t limit = 10) {\n"
+            "    double sum = 0.0;\n"
+            "    for (size_t i = 0; i < rows.size() && i < limit; i++) { if (rows[i].visible) sum += rows[i].value; }\n"
+            "    return sum;\n"
+            "}\n"},
+    {"java", "@Override\n"
+             "public double total(List<Row> rows, int limit) {\n"
+             "    // Sums the visible rows\n"
+             "    return rows.stream().limit(limit).filter(Row::isVisible).mapToDouble(r -> r.value * 1.5).sum();\n"
+             "}\n"},
+    {"kotlin", "data class Row(val value: Double, val visible: Boolean = true)\n"
+               "fun total(rows: List<Row>, limit: Int = 10): Double =\n"
+               "    rows.take(limit).filter { it.visible }.sumOf { it.value } // visible rows\n"
+               "val label = \"total: ${total(listOf(Row(0.5)))}\"\n"},
+    {"swift", "@MainActor\n"
+              "struct Row { let value: Double; var visible = true }\n"
+              "func total(_ rows: [Row], limit: Int = 10) -> Double {\n"
+              "    // Sums the visible rows\n"
+              "    return rows.prefix(limit).filter { $0.visible }.reduce(0) { $0 + $1.value }\n"
+              "}\n"},
+    {"go", "package table\n\n"
+           "// Total sums the visible rows\n"
+           "func Total(rows []Row, limit int) (float64, error) {\n"
+           "\tsum := 0.0\n"
+           "\tfor i, r := range rows { if i < limit && r.Visible { sum += r.Value } }\n"
+           "\treturn sum, nil\n"
+           "}\n"},
+    {"rust", "#[derive(Debug, Clone)]\n"
+             "pub struct Row { value: f64, visible: bool }\n"
+             "/// Sums the visible rows\n"
+             "fn total<'a>(rows: &'a [Row], limit: usize) -> Option<f64> {\n"
+             "    let sum = rows.iter().take(limit).filter(|r| r.visible).map(|r| r.value).sum();\n"
+             "    println!(\"total: {}\", sum); Some(sum)\n"
+             "}\n"},
+    {"sql", "-- Visible rows per owner\n"
+            "SELECT o.name, COUNT(*) AS rows, SUM(r.value) AS total\n"
+            "FROM rows r JOIN owners o ON o.id = r.owner_id\n"
+            "WHERE r.visible = TRUE AND r.value > 0.5 AND o.name <> 'it''s'\n"
+            "GROUP BY o.name ORDER BY total DESC LIMIT 10;\n"},
+    {"yaml", "name: hyper-markdown # the package\n"
+             "version: 1.2.0\n"
+             "enabled: true\n"
+             "tags:\n"
+             "  - parser\n"
+             "  - \"native code\"\n"
+             "limits: {rows: 10, ratio: 0.75}\n"},
+    {"diff", "diff --git a/src/table.ts b/src/table.ts\n"
+             "@@ -1,4 +1,4 @@\n"
+             " export function total(rows: Row[]) {\n"
+             "-  return rows.reduce((sum, row) => sum + row.value, 0)\n"
+             "+  return rows.filter((row) => row.visible).reduce((sum, row) => sum + row.value, 0)\n"
+             " }\n"},
+};
+
+std::string repeat(const std::string& unit, size_t bytes) {
+    std::string s;
+    s.reserve(bytes + unit.size());
+    while (s.size() < bytes) {
+        s += unit;
+    }
+    return s;
+}
+
+double megabytesPerSecond(size_t bytes, double ms) {
+    return (bytes / (1024.0 * 1024.0)) / (ms / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::printf("%-8s %9s %9s %9s %10s %12s\n", "language", "bytes", "tokens", "ms", "MB/s", "utf16 MB/s");
+
+    std::string markdown;
+    for (const auto& sample : kSamples) {
+        const CodeLanguage* language = CodeTokenizer::findLanguage(sample.language);
+        if (!language) {
+            std::fprintf(stderr, "no lexer for %s\n", sample.language);
+            return 1;
+        }
+        std::string code = repeat(sample.code, kCodeBytes);
+        std::vector<CodeToken> tokens;
+        double ms = bestOf(iterations, [&] {
+            tokens.clear();
+            CodeTokenizer::tokenize(*language, code.data(), code.size(), tokens);
+        });
+        double utf16Ms = bestOf(iterations, [&] {
+            tokens.clear();
+            CodeTokenizer::tokenize(*language, code.data(), code.size(), tokens);
+            CodeTokenizer::toUtf16(code.data(), code.size(), tokens);
+        });
+        std::printf("%-8s %9zu %9zu %9.2f %10.1f %12.1f\n", sample.language, code.size(), tokens.size(), ms,
+                    megabytesPerSecond(code.size(), ms), megabytesPerSecond(code.size(), utf16Ms));
+
+        // A few blocks of each language for the parse rows
+        markdown += repeat("Some text before the block.\n\n```" + std::string(sample.language) + "\n" +
+                               sample.code + "```\n\n",
+                           64 * 1024);
+    }
+
+    InternalParserOptions plain;
+    plain.maxInputSize = markdown.size();
+    InternalParserOptions highlighted = plain;
+    highlighted.highlightCode = true;
+    double plainMs = bestOf(iterations, [&] { MarkdownParser::parse(markdown, plain); });
+    double highlightedMs = bestOf(iterations, [&] { MarkdownParser::parse(markdown, highlighted); });
+    std::printf("\n%-18s %9s %9s %10s\n", "parse", "bytes", "ms", "MB/s");
+    std::printf("%-18s %9zu %9.2f %10.1f\n", "plain", markdown.size(), plainMs,
+                megabytesPerSecond(markdown.size(), plainMs));
+    std::printf("%-18s %9zu %9.2f %10.1f\n", "highlightCode", markdown.size(), highlightedMs,
+                megabytesPerSecond(markdown.size(), highlightedMs));
+    return 0;
+}
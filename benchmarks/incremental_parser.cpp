@@ -0,0 +1,128 @@
+/**
+ * Incremental parsing benchmark
+ *
+ * Parses every document of benchmarks/corpus/ in steps of a time budget,
+ * as IncrementalParser does for a frame, and compares with a one-shot
+ * parse and serialization:
+ *
+ *   one-shot ms   parse() and toJson() of the whole document
+ *   steps         steps until done
+ *   step ms       median step time, the frame time usually taken
+ *   max step ms   longest step, the frame time taken at worst
+ *   first ms      time until a step returns the first blocks
+ *   total ms      time of all steps together
+ *
+ * each the best of several runs, as preemption of the process shows in
+ * single steps.
+ *
+ * Usage: incremental_parser [budget-ms] [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "IncrementalParser.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Timings of one incremental parse
+struct Run {
+    bool ok = true;
+    size_t steps = 0;
+    double stepMs = 0;
+    double maxStepMs = 0;
+    double firstMs = 0;
+    double totalMs = 0;
+};
+
+Run parseInSteps(const std::string& content, const InternalParserOptions& options, double budgetMs) {
+    Run run;
+    IncrementalParser parser(content, options);
+    std::vector<double> stepMs;
+    bool first = true;
+    auto start = std::chrono::steady_clock::now();
+    while (run.ok) {
+        auto stepStart = std::chrono::steady_clock::now();
+        auto step = parser.step(budgetMs);
+        stepMs.push_back(msSince(stepStart));
+        run.ok = step.success;
+        if (first && step.blocks != "[]") {
+            run.firstMs = msSince(start);
+            first = false;
+        }
+        if (step.done) {
+            break;
+        }
+    }
+    run.totalMs = msSince(start);
+    run.steps = stepMs.size();
+    run.maxStepMs = *std::max_element(stepMs.begin(), stepMs.end());
+    std::nth_element(stepMs.begin(), stepMs.begin() + stepMs.size() / 2, stepMs.end());
+    run.stepMs = stepMs[stepMs.size() / 2];
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double budgetMs = argc > 1 ? std::atof(argv[1]) : 2;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 3 ? argv[3] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    std::printf("budget %.1f ms, best of %d\n", budgetMs, iterations);
+    std::printf("%-18s %9s %11s %7s %9s %11s %9s %9s\n", "document", "KB", "one-shot ms", "steps", "step ms",
+                "max step ms", "first ms", "total ms");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+
+        double oneShotMs = 0;
+        Run best;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            auto result = MarkdownParser::parse(document.content, options);
+            std::string json = result.success ? MarkdownSerializer::toJson(result.nodes) : std::string();
+            double ms = msSince(start);
+            oneShotMs = i == 0 ? ms : std::min(oneShotMs, ms);
+
+            Run run = parseInSteps(document.content, options, budgetMs);
+            if (!result.success || !run.ok) {
+                std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+                return 1;
+            }
+            if (i == 0) {
+                best = run;
+                continue;
+            }
+            best.steps = std::min(best.steps, run.steps);
+            best.stepMs = std::min(best.stepMs, run.stepMs);
+            best.maxStepMs = std::min(best.maxStepMs, run.maxStepMs);
+            best.firstMs = std::min(best.firstMs, run.firstMs);
+            best.totalMs = std::min(best.totalMs, run.totalMs);
+        }
+        std::printf("%-18s %9.1f %11.3f %7zu %9.3f %11.3f %9.3f %9.3f\n", document.name.c_str(),
+                    document.content.size() / 1024.0, oneShotMs, best.steps, best.stepMs, best.maxStepMs, best.firstMs,
+                    best.totalMs);
+    }
+    return 0;
+}
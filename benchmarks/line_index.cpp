@@ -0,0 +1,107 @@
+/**
+ * Line index benchmark
+ *
+ * Converts offsets of multi-megabyte documents to lines and columns with
+ * LineIndex: building the whole index with one lookup at the end of the
+ * document, lookups in document order (the pattern of serializing node
+ * positions) and lookups at random offsets. A byte-by-byte scan for line
+ * endings is the baseline of the build. Documents range from short lines
+ * of prose to minified single-line content and non-ASCII text.
+ *
+ * Usage: line_index [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "LineIndex.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kDocumentBytes = 8 * 1024 * 1024;
+constexpr size_t kLookups = 1000000;
+
+std::string repeat(const std::string& unit) {
+    std::string s;
+    s.reserve(kDocumentBytes + unit.size());
+    while (s.size() < kDocumentBytes) {
+        s += unit;
+    }
+    return s;
+}
+
+std::vector<Document> documents() {
+    return {
+        {"prose", repeat("The quick brown fox jumps over the lazy dog, *again* and [again](url).\n\n")},
+        {"code", repeat("    if (x) {\n        return y;\n    }\n")},
+        {"crlf", repeat("| a | b | c |\r\n|---|---|---|\r\n| 1 | 2 | 3 |\r\n")},
+        {"long_lines", repeat(std::string(64 * 1024, 'x') + "\n")},
+        {"cjk", repeat("日本語の文章をマークダウンで書く。🚀\n")},
+    };
+}
+
+// Line starts found one byte at a time
+size_t bytewiseLineCount(const std::string& text) {
+    size_t lines = 1;
+    for (size_t i = 0; i < text.size(); i++) {
+        lines += text[i] == '\n' || (text[i] == '\r' && (i + 1 == text.size() || text[i + 1] != '\n'));
+    }
+    return lines;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::printf("%-11s %9s %10s %11s %11s %12s %12s\n", "document", "bytes", "lines", "bytewise ms", "build ms",
+                "ordered ns", "random ns");
+
+    volatile uint32_t sink = 0;
+    for (const auto& document : documents()) {
+        const std::string& text = document.content;
+        size_t lines = 0;
+        double bytewiseMs = bestOf(iterations, [&] { lines = bytewiseLineCount(text); });
+        double buildMs = bestOf(iterations, [&] {
+            LineIndex index(text);
+            sink = sink + index.locate(text.size()).line;
+        });
+        if (LineIndex(text).locate(text.size()).line != lines) {
+            std::fprintf(stderr, "%s: line counts differ\n", document.name.c_str());
+            return 1;
+        }
+
+        // Offsets in document order, and shuffled
+        std::vector<size_t> offsets(kLookups);
+        for (size_t i = 0; i < kLookups; i++) {
+            offsets[i] = text.size() * i / kLookups;
+        }
+        double orderedMs = bestOf(iterations, [&] {
+            LineIndex index(text);
+            for (size_t offset : offsets) {
+                sink = sink + index.locate(offset).column;
+            }
+        });
+        std::shuffle(offsets.begin(), offsets.end(), std::mt19937(39));
+        LineIndex built(text);
+        built.locate(text.size());
+        double randomMs = bestOf(iterations, [&] {
+            for (size_t offset : offsets) {
+                sink = sink + built.locate(offset).column;
+            }
+        });
+
+        std::printf("%-11s %9zu %10zu %11.2f %11.2f %12.1f %12.1f\n", document.name.c_str(), text.size(), lines,
+                    bytewiseMs, buildMs, orderedMs * 1e6 / kLookups, randomMs * 1e6 / kLookups);
+    }
+    return 0;
+}
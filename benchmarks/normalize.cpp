@@ -0,0 +1,80 @@
+/**
+ * Input normalization benchmark
+ *
+ * Runs InputNormalizer over 8 MB documents: clean ASCII and clean CJK text
+ * (the zero-copy path, which only scans), and documents with CRLF line
+ * endings, NULs or invalid UTF-8 that have to be copied. Counting the
+ * bytes that need a look one byte at a time is the baseline of the scan.
+ *
+ * Usage: normalize [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "InputNormalizer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kDocumentBytes = 8 * 1024 * 1024;
+
+std::string repeat(const std::string& unit) {
+    std::string s;
+    s.reserve(kDocumentBytes + unit.size());
+    while (s.size() < kDocumentBytes) {
+        s += unit;
+    }
+    return s;
+}
+
+std::vector<Document> documents() {
+    return {
+        {"ascii", repeat("The quick brown fox jumps over the lazy dog, *again* and [again](url).\n\n")},
+        {"cjk", repeat("日本語の文章をマークダウンで書く。中文文本 🚀\n")},
+        {"crlf", repeat("| a | b | c |\r\n|---|---|---|\r\n| 1 | 2 | 3 |\r\n")},
+        {"nul", repeat(std::string("Some text with a NUL\0 in the middle of the line.\n", 50))},
+        {"latin1", repeat("Caf\xE9 cr\xE8me br\xFBl\xE9\x65, na\xEFve fa\xE7\x61\x64\x65.\n")},
+    };
+}
+
+// Bytes needing a look, counted one byte at a time
+size_t bytewiseSpecialBytes(const std::string& text) {
+    size_t special = 0;
+    for (char c : text) {
+        auto byte = static_cast<unsigned char>(c);
+        special += byte >= 0x80 || byte == '\r' || byte == '\0';
+    }
+    return special;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::printf("%-8s %9s %8s %11s %9s %12s\n", "document", "bytes", "copied", "bytewise ms", "ms", "MB/s");
+
+    volatile size_t sink = 0;
+    for (const auto& document : documents()) {
+        const std::string& text = document.content;
+        double bytewiseMs = bestOf(iterations, [&] { sink = bytewiseSpecialBytes(text); });
+        bool copied = false;
+        double ms = bestOf(iterations, [&] {
+            std::string out;
+            copied = InputNormalizer::normalize(text, out);
+        });
+        double mb = text.size() / (1024.0 * 1024.0);
+        std::printf("%-8s %9zu %8s %11.2f %9.2f %12.1f\n", document.name.c_str(), text.size(), copied ? "yes" : "no",
+                    bytewiseMs, ms, mb / (ms / 1000.0));
+    }
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * Pathological input benchmark
+ *
+ * Runs a curated corpus of adversarial inputs through MarkdownParser::parse
+ * at doubling sizes and asserts the parse time grows near-linearly.
+ * Exits with a non-zero status if any case looks super-linear.
+ *
+ * The minimized slow inputs found by the fuzz targets, fuzz/regressions/,
+ * are cases too: each is repeated to the sizes of the others and parsed
+ * with the options its first byte selects.
+ *
+ * Usage: pathological [case-name-filter]
+ */
+#include "FuzzInput.h"
+#include "MarkdownParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifndef HYPERMARKDOWN_FUZZ_REGRESSIONS_DIR
+#define HYPERMARKDOWN_FUZZ_REGRESSIONS_DIR "fuzz/regressions"
+#endif
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+// Smallest repetition count; each case is measured at base, 2x, 4x and 8x
+constexpr size_t kBaseCount = 8000;
+constexpr int kDoublings = 3;
+constexpr int kRepetitions = 5;
+
+// Largest exponent k in time ~ bytes^k we still accept as "near-linear".
+// Linear is 1.0 and quadratic is 2.0; the slack above 1.0 absorbs n*log(n)
+// terms and cache effects once the AST outgrows the CPU caches.
+constexpr double kMaxScalingExponent = 1.5;
+
+// Largest time ratio we accept between two consecutive sizes. Linear is 2.0
+// and quadratic 4.0: a single jump the fit averages out over the other
+// doublings is caught here.
+constexpr double kMaxDoublingRatio = 3.0;
+
+// Below this, timer noise dominates and the ratio is meaningless
+constexpr double kMinMeasurableMs = 0.5;
+
+struct PathologicalCase {
+    std::string name;
+    std::function<std::string(size_t)> generate;
+    InternalParserOptions options;
+
+    // The curated cases run with the default options
+    PathologicalCase(const std::string& name, const std::function<std::string(size_t)>& generate,
+                     const InternalParserOptions& options = InternalParserOptions())
+        : name(name), generate(generate), options(options) {}
+};
+
+std::string repeat(const std::string& s, size_t n) {
+    std::string out;
+    out.reserve(s.size() * n);
+    for (size_t i = 0; i < n; i++) {
+        out += s;
+    }
+    return out;
+}
+
+// The corpus. Most cases follow the pathological tests of cmark and
+// commonmark.js, the rest target md4c's link reference handling.
+const std::vector<PathologicalCase>& corpus() {
+    static const std::vector<PathologicalCase> cases = {
+        {"nested_brackets", [](size_t n) { return repeat("[", n) + "a" + repeat("]", n); }},
+        {"nested_images", [](size_t n) { return repeat("![", n) + "a" + repeat("](b)", n); }},
+        {"unclosed_brackets", [](size_t n) { return repeat("[a", n); }},
+        {"unopened_brackets", [](size_t n) { return repeat("a]", n); }},
+        {"bracket_paren", [](size_t n) { return repeat("[ (](", n); }},
+        {"unclosed_link_dest_a", [](size_t n) { return repeat("[a](<b", n); }},
+        {"unclosed_link_dest_b", [](size_t n) { return repeat("[a](b", n); }},
+        {"unclosed_link_title", [](size_t n) { return repeat("[a](b \"", n); }},
+        {"link_emph_mix", [](size_t n) { return repeat("[ a_", n); }},
+        {"nested_emph", [](size_t n) { return repeat("*a **a ", n) + "b" + repeat(" a** a*", n); }},
+        {"emph_alternating", [](size_t n) { return repeat("*_", n); }},
+        {"emph_mismatched", [](size_t n) { return repeat("*a_ ", n); }},
+        {"emph_openers", [](size_t n) { return repeat("_a ", n); }},
+        {"emph_closers", [](size_t n) { return repeat("a_ ", n); }},
+        {"emph_rule_of_3", [](size_t n) { return "a**b" + repeat("c* ", n); }},
+        {"strikethrough", [](size_t n) { return repeat("~~a ", n); }},
+        {"backticks", [](size_t n) {
+            std::string s;
+            for (size_t i = 0; i < n; i++) {
+                s += std::string(i % 40 + 1, '`') + "a";
+            }
+            return s;
+        }},
+        {"html_comment", [](size_t n) { return "</" + repeat("<!--", n); }},
+        {"html_tags", [](size_t n) { return repeat("<a ", n); }},
+        {"entities", [](size_t n) { return repeat("&a", n); }},
+        {"autolinks", [](size_t n) { return repeat("www.a.", n); }},
+        {"nested_quotes", [](size_t n) { return repeat("> ", n) + "a\n"; }},
+        {"nested_lists", [](size_t n) { return repeat("- ", n) + "a\n"; }},
+        // Lazy continuation lines of a paragraph nested CONTAINER_MAXDEPTH deep.
+        // Kept to n/4 lines: every line costs a softbreak node and the test is
+        // about line analysis, not about allocating a huge sibling list.
+        {"lazy_quote", [](size_t n) { return repeat("> ", n) + "a\n" + repeat("b\n", n / 4); }},
+        // Emphasis crossing every line keeps each inline window open, so the
+        // window keeps doubling until it holds the whole paragraph
+        {"cross_line_emph", [](size_t n) { return repeat("a *b\nc* ", n); }},
+        {"table_columns", [](size_t n) { return repeat("|a", n) + "\n" + repeat("|-", n) + "\n" + repeat("|b", n) + "\n"; }},
+        {"ref_defs", [](size_t n) {
+            std::string s;
+            for (size_t i = 0; i < n; i++) {
+                s += "[l" + std::to_string(i) + "]: /u" + std::to_string(i) + "\n";
+            }
+            s += "\n";
+            for (size_t i = 0; i < n; i++) {
+                s += "[l" + std::to_string(i) + "] ";
+            }
+            return s;
+        }},
+        {"ref_duplicates", [](size_t n) {
+            std::string s;
+            for (size_t i = 0; i < n; i++) {
+                s += "[a]: /u" + std::to_string(i) + "\n";
+            }
+            return s + "\n" + repeat("[a] ", n);
+        }},
+        {"ref_unresolved", [](size_t n) { return repeat("[a] ", n); }},
+        {"ref_expansion", [](size_t n) { return "[a]: /" + std::string(n, 'x') + "\n\n" + repeat("[a]", n); }},
+    };
+    return cases;
+}
+
+// A fuzz regression input, repeated to about `n` times 8 bytes
+PathologicalCase fuzzRegression(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto input = hypermarkdown_fuzz::decode(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    std::string unit = input.content.empty() ? std::string("\n") : input.content;
+    input.options.collectTimings = false;
+    input.options.collectMemory = false;
+    return {"fuzz/" + path.filename().string(),
+            [unit](size_t n) { return repeat(unit, std::max<size_t>(1, n * 8 / unit.size())); }, input.options};
+}
+
+std::vector<PathologicalCase> fuzzRegressions() {
+    std::vector<PathologicalCase> cases;
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(HYPERMARKDOWN_FUZZ_REGRESSIONS_DIR, ec)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const auto& path : paths) {
+        cases.push_back(fuzzRegression(path));
+    }
+    return cases;
+}
+
+double measureMs(const std::string& input, InternalParserOptions options) {
+    options.maxInputSize = SIZE_MAX;
+
+    double best = 0;
+    for (int i = 0; i < kRepetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = MarkdownParser::parse(input, options);
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (i == 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+// Least-squares slope of log(time) over log(bytes)
+double fitExponent(const std::vector<double>& x, const std::vector<double>& y) {
+    double n = static_cast<double>(x.size());
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        sumX += x[i];
+        sumY += y[i];
+        sumXX += x[i] * x[i];
+        sumXY += x[i] * y[i];
+    }
+    return (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int failures = 0;
+
+    std::printf("%-22s %10s %10s %8s %8s\n", "case", "bytes", "ms", "exponent", "doubling");
+
+    std::vector<PathologicalCase> cases = corpus();
+    for (auto& c : fuzzRegressions()) {
+        cases.push_back(std::move(c));
+    }
+
+    for (const auto& c : cases) {
+        if (filter && c.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        std::vector<double> logBytes;
+        std::vector<double> logMs;
+        double lastMs = 0;
+        double worstRatio = 0;
+        for (int step = 0; step <= kDoublings; step++) {
+            std::string input = c.generate(kBaseCount << step);
+            double ms = measureMs(input, c.options);
+            // A jump is measured again once, and the faster run counts, so a
+            // preempted process is not taken for a performance cliff
+            if (step > 0 && lastMs >= kMinMeasurableMs && ms / lastMs > kMaxDoublingRatio) {
+                ms = std::min(ms, measureMs(input, c.options));
+            }
+            if (step > 0 && lastMs >= kMinMeasurableMs) {
+                worstRatio = std::max(worstRatio, ms / lastMs);
+            }
+            logBytes.push_back(std::log(static_cast<double>(input.size())));
+            logMs.push_back(std::log(std::max(ms, 1e-6)));
+            lastMs = ms;
+            std::printf("%-22s %10zu %10.2f\n", step == 0 ? c.name.c_str() : "", input.size(), ms);
+        }
+
+        double exponent = fitExponent(logBytes, logMs);
+        bool measurable = lastMs >= kMinMeasurableMs;
+        bool ok = !measurable || (exponent <= kMaxScalingExponent && worstRatio <= kMaxDoublingRatio);
+        std::printf("%-22s %10s %10s %8.2f %8.2f %s\n", "", "", "", exponent, worstRatio, ok ? "ok" : "SUPER-LINEAR");
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d case(s) scale super-linearly\n", failures);
+        return 1;
+    }
+    return 0;
+}
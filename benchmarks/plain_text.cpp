@@ -0,0 +1,63 @@
+/**
+ * Plain text benchmark
+ *
+ * Times getting the rendered text of every document of benchmarks/corpus/:
+ *
+ *   full ms       parse plus the JSON AST, which JS would walk for its text
+ *   text ms       PlainText::extract() of all of the text
+ *   preview ms    PlainText::extract() of the first 200 characters, which
+ *                 stops parsing there
+ *
+ * Usage: plain_text [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "PlainText.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    std::printf("%-18s %9s %9s %9s %10s\n", "document", "bytes", "full ms", "text ms", "preview ms");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+        bool failed = false;
+        size_t bytes = 0;
+        double fullMs = bestOf(iterations, [&] {
+            auto result = MarkdownParser::parse(document.content, options);
+            failed |= !result.success;
+            MarkdownSerializer::toJson(result.nodes);
+        });
+        double textMs = bestOf(iterations, [&] {
+            auto plain = PlainText::extract(document.content, SIZE_MAX, options);
+            failed |= !plain.success;
+            bytes = plain.text.size();
+        });
+        double previewMs = bestOf(iterations, [&] {
+            failed |= !PlainText::extract(document.content, 200, options).success;
+        });
+        if (failed) {
+            std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+            return 1;
+        }
+        std::printf("%-18s %9zu %9.3f %9.3f %10.3f\n", document.name.c_str(), bytes, fullMs, textMs, previewMs);
+    }
+    return 0;
+}
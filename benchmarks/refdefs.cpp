@@ -0,0 +1,136 @@
+/**
+ * Link reference definition benchmark
+ *
+ * Parses documents with 10k `[label]: url` definitions followed by 100k
+ * reference links, as found in large documentation exports. Labels in the
+ * references differ from the definitions in case and whitespace, so every
+ * lookup has to go through label normalization.
+ *
+ * Reports md4c alone (no-op callbacks, i.e. mostly reference resolution)
+ * and the full MarkdownParser::parse including the tree.
+ *
+ * Usage: refdefs [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kDefinitions = 10000;
+constexpr size_t kReferences = 100000;
+
+// Label of the i-th definition and the way references spell it
+std::string defLabel(const char* stem, size_t i) {
+    return std::string(stem) + " Label " + std::to_string(i);
+}
+
+std::string refLabel(const char* stem, size_t i) {
+    // Same label with different case and extra inner/outer whitespace
+    std::string upper;
+    for (const char* p = stem; *p; p++) {
+        upper += (*p >= 'a' && *p <= 'z') ? static_cast<char>(*p - 'a' + 'A') : *p;
+    }
+    return " " + upper + "   label\n" + std::to_string(i);
+}
+
+std::string generate(const char* stem, bool unicode) {
+    std::string s;
+    s.reserve(kDefinitions * 48 + kReferences * 48);
+
+    for (size_t i = 0; i < kDefinitions; i++) {
+        std::string label = unicode ? "Ссылка " + std::to_string(i) : defLabel(stem, i);
+        s += "[" + label + "]: https://example.com/docs/" + std::to_string(i) + " \"Title " + std::to_string(i) + "\"\n";
+    }
+    s += "\n";
+
+    // Paragraphs of 20 references each, in a scattered order
+    for (size_t i = 0; i < kReferences; i++) {
+        size_t target = (i * 7919) % kDefinitions;
+        std::string label = unicode ? "  сСЫЛКА\n" + std::to_string(target) : refLabel(stem, target);
+        s += "See [" + label + "] and ";
+        if (i % 20 == 19) {
+            s += "more.\n\n";
+        }
+    }
+    return s;
+}
+
+int md4cOnly(const std::string& content) {
+    MD_PARSER parser = {
+        0,
+        MD_FLAG_TABLES | MD_FLAG_STRIKETHROUGH | MD_FLAG_TASKLISTS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_COLLAPSEWHITESPACE,
+        noopBlock,
+        noopBlock,
+        noopSpan,
+        noopSpan,
+        noopText,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr
+    };
+    return md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, nullptr);
+}
+
+size_t countLinks(const std::shared_ptr<MarkdownNode>& root) {
+    size_t links = 0;
+    std::vector<const MarkdownNode*> stack = {root.get()};
+    while (!stack.empty()) {
+        const MarkdownNode* node = stack.back();
+        stack.pop_back();
+        if (node->type == "link") {
+            links++;
+        }
+        for (const auto& child : node->children) {
+            stack.push_back(child.get());
+        }
+    }
+    return links;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::vector<Document> corpora = {
+        {"ascii", generate("api", false)},
+        {"cyrillic", generate("", true)},
+    };
+
+    std::printf("%-10s %10s %10s %10s %10s %12s\n", "corpus", "bytes", "md4c ms", "parse ms", "MB/s", "md4c ns/ref");
+
+    for (const auto& corpus : corpora) {
+        InternalParserOptions options;
+        options.maxInputSize = corpus.content.size();
+
+        // Make sure the references really resolve
+        auto result = MarkdownParser::parse(corpus.content, options);
+        size_t links = result.success ? countLinks(result.nodes[0]) : 0;
+        if (links != kReferences) {
+            std::fprintf(stderr, "%s: expected %zu links, got %zu\n", corpus.name.c_str(), kReferences, links);
+            return 1;
+        }
+
+        double md4cMs = bestOf(iterations, [&] { md4cOnly(corpus.content); });
+        double parseMs = bestOf(iterations, [&] { MarkdownParser::parse(corpus.content, options); });
+        double mbPerSec = (corpus.content.size() / (1024.0 * 1024.0)) / (parseMs / 1000.0);
+        std::printf("%-10s %10zu %10.2f %10.2f %10.1f %12.1f\n", corpus.name.c_str(), corpus.content.size(), md4cMs,
+                    parseMs, mbPerSec, md4cMs * 1e6 / kReferences);
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * Search index benchmark
+ *
+ * Times find-in-document over every document of benchmarks/corpus/, for a
+ * single pattern and for five at once:
+ *
+ *   index ms      SearchIndex over the parsed tree (once per document)
+ *   search ms     SearchIndex::search() plus the matches as JSON (per
+ *                 keystroke)
+ *   walk ms       what the JS side did per keystroke, natively: walk the
+ *                 tree, lowercase every text node and look for each pattern
+ *
+ * The walk finds matches within single text nodes only, and lowercases
+ * ASCII only; it is a lower bound of the JS version.
+ *
+ * Usage: search_index [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+size_t walkAndFind(const MarkdownNode* root, const std::vector<std::string>& patterns) {
+    size_t matches = 0;
+    std::string lower;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t) {
+            if (node->type != "text" || !node->content) {
+                return true;
+            }
+            lower = *node->content;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+            for (const auto& pattern : patterns) {
+                for (size_t at = lower.find(pattern); at != std::string::npos; at = lower.find(pattern, at + pattern.size())) {
+                    matches++;
+                }
+            }
+            return true;
+        },
+        [](const MarkdownNode*) {});
+    return matches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    if (documents.empty()) {
+        std::fprintf(stderr, "no documents found\n");
+        return 1;
+    }
+
+    const std::vector<std::vector<std::string>> queries = {
+        {"the"},
+        {"the", "markdown", "error", "data", "value"},
+    };
+    std::printf("%-18s %9s %9s %9s %9s %9s\n", "document", "patterns", "matches", "index ms", "search ms", "walk ms");
+    for (const auto& document : documents) {
+        InternalParserOptions options;
+        options.maxInputSize = document.content.size();
+        auto result = MarkdownParser::parse(document.content, options);
+        if (!result.success) {
+            std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+            return 1;
+        }
+        const MarkdownNode* root = result.nodes.front().get();
+        double indexMs = bestOf(iterations, [&] { SearchIndex index(root); });
+        SearchIndex index(root);
+        for (const auto& patterns : queries) {
+            size_t matches = 0;
+            double searchMs = bestOf(iterations, [&] {
+                auto found = index.search(patterns);
+                matches = found.size();
+                MarkdownSerializer::searchMatchesToJson(found);
+            });
+            double walkMs = bestOf(iterations, [&] { walkAndFind(root, patterns); });
+            std::printf("%-18s %9zu %9zu %9.3f %9.3f %9.3f\n", document.name.c_str(), patterns.size(), matches, indexMs,
+                        searchMs, walkMs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+/**
+ * Corpus benchmark suite
+ *
+ * Parses every document of benchmarks/corpus/ (CommonMark spec examples,
+ * long READMEs, chat transcripts, table-, code- and CJK-heavy docs) in these
+ * modes and reports throughput for the parsing ones, only latency for the
+ * release ones:
+ *
+ *   md4c   md_parse() with no-op callbacks, i.e. the parser alone
+ *   tree   MarkdownParser::parse(), the parser plus building the node tree
+ *   json   MarkdownParser::parse() plus MarkdownSerializer::toJson()
+ *   pos    json with sourcePositions, i.e. the cost of node positions
+ *   free   release latency: destroying a parsed tree on the calling thread
+ *   defer  release latency: handing a parsed tree to the NodeReclaimer
+ *
+ * Every sample parses the document as many times as needed to process at
+ * least kMinSampleBytes, the best of the samples is reported. Allocations
+ * are counted through operator new for the tree and the JSON, and through
+ * md4c's allocator hooks for md4c itself (the timed runs go without them).
+ *
+ * --json prints one machine-readable document instead of the table, meant
+ * to be stored per commit to track regressions.
+ *
+ * Usage: suite [--json] [--iterations N] [--corpus DIR] [name-filter]
+ */
+#include "BenchmarkHarness.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "NodeReclaimer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kMinSampleBytes = 1024 * 1024;
+
+size_t gAllocations = 0;
+size_t gAllocatedBytes = 0;
+
+} // namespace
+
+// Counting allocator for the whole binary
+void* operator new(size_t size) {
+    gAllocations++;
+    gAllocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Result {
+    std::string corpus;
+    const char* mode;
+    size_t bytes;
+    size_t nodes;
+    double ms;
+    size_t allocations;
+    size_t allocatedBytes;
+    bool latencyOnly;       // free and defer: no input is processed
+};
+
+void* countingRealloc(void* ptr, size_t size, void*) {
+    gAllocations++;
+    gAllocatedBytes += size;
+    return std::realloc(ptr, size);
+}
+
+void countingFree(void* ptr, void*) { std::free(ptr); }
+
+int md4cOnly(const std::string& content, bool countAllocations = false) {
+    MD_PARSER parser = {
+        0,
+        MD_FLAG_TABLES | MD_FLAG_STRIKETHROUGH | MD_FLAG_TASKLISTS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_COLLAPSEWHITESPACE,
+        noopBlock,
+        noopBlock,
+        noopSpan,
+        noopSpan,
+        noopText,
+        nullptr,
+        nullptr,
+        countAllocations ? countingRealloc : nullptr,
+        countAllocations ? countingFree : nullptr,
+        nullptr,
+        nullptr
+    };
+    return md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, nullptr);
+}
+
+// Runs `counted` once to count its allocations, then times `fn`
+Result measure(const Document& corpus, const char* mode, size_t nodes, int iterations,
+               const std::function<void()>& counted, const std::function<void()>& fn) {
+    size_t allocationsBefore = gAllocations;
+    size_t bytesBefore = gAllocatedBytes;
+    counted();
+    Result result = {corpus.name, mode, corpus.content.size(), nodes, 0,
+                     gAllocations - allocationsBefore, gAllocatedBytes - bytesBefore, false};
+
+    size_t repeat = std::max<size_t>(1, kMinSampleBytes / std::max<size_t>(1, corpus.content.size()));
+    result.ms = bestOf(iterations, fn, repeat);
+    return result;
+}
+
+// Times dropping parsed trees only: the trees of a sample are parsed up
+// front, the reclaimer is drained between samples
+Result measureRelease(const Document& corpus, const char* mode, size_t nodes, int iterations,
+                      const InternalParserOptions& options, bool deferred) {
+    Result result = {corpus.name, mode, corpus.content.size(), nodes, 0, 0, 0, true};
+    size_t repeat = std::max<size_t>(1, kMinSampleBytes / std::max<size_t>(1, corpus.content.size()));
+    for (int i = 0; i < iterations; i++) {
+        std::vector<ParseResult> parsed;
+        for (size_t r = 0; r < repeat; r++) {
+            parsed.push_back(MarkdownParser::parse(corpus.content, options));
+        }
+        size_t allocationsBefore = gAllocations;
+        size_t bytesBefore = gAllocatedBytes;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& p : parsed) {
+            if (deferred) {
+                NodeReclaimer::shared().release(std::move(p.nodes));
+            } else {
+                p.nodes.clear();
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count() / repeat;
+        if (i == 0 || ms < result.ms) {
+            result.ms = ms;
+            result.allocations = (gAllocations - allocationsBefore) / repeat;
+            result.allocatedBytes = (gAllocatedBytes - bytesBefore) / repeat;
+        }
+        NodeReclaimer::shared().drain();
+    }
+    return result;
+}
+
+double megabytesPerSecond(const Result& r) {
+    return (r.bytes / (1024.0 * 1024.0)) / (r.ms / 1000.0);
+}
+
+double nodesPerSecond(const Result& r) {
+    return r.nodes / (r.ms / 1000.0);
+}
+
+void printTable(const std::vector<Result>& results) {
+    std::printf("%-18s %-5s %10s %9s %9s %9s %12s %10s %12s\n", "corpus", "mode", "bytes", "nodes", "ms", "MB/s",
+                "Mnodes/s", "allocs", "alloc KB");
+    for (const auto& r : results) {
+        char mbPerSec[16] = "";
+        char mnodesPerSec[16] = "";
+        if (!r.latencyOnly) {
+            std::snprintf(mbPerSec, sizeof(mbPerSec), "%.1f", megabytesPerSecond(r));
+            std::snprintf(mnodesPerSec, sizeof(mnodesPerSec), "%.2f", nodesPerSecond(r) / 1e6);
+        }
+        std::printf("%-18s %-5s %10zu %9zu %9.3f %9s %12s %10zu %12.1f\n", r.corpus.c_str(), r.mode, r.bytes,
+                    r.nodes, r.ms, mbPerSec, mnodesPerSec, r.allocations, r.allocatedBytes / 1024.0);
+    }
+}
+
+void printJson(const std::vector<Result>& results, int iterations) {
+    std::printf("{\"benchmark\":\"suite\",\"iterations\":%d,\"results\":[", iterations);
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        std::printf("%s\n{\"corpus\":\"%s\",\"mode\":\"%s\",\"bytes\":%zu,\"nodes\":%zu,\"ms\":%.4f,", i ? "," : "",
+                    MarkdownSerializer::escapeJson(r.corpus).c_str(), r.mode, r.bytes, r.nodes, r.ms);
+        if (!r.latencyOnly) {
+            std::printf("\"mbPerSec\":%.2f,\"nodesPerSec\":%.0f,", megabytesPerSecond(r), nodesPerSecond(r));
+        }
+        std::printf("\"allocations\":%zu,\"allocatedBytes\":%zu}", r.allocations, r.allocatedBytes);
+    }
+    std::printf("\n]}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool json = false;
+    int iterations = 5;
+    std::string dir = HYPERMARKDOWN_CORPUS_DIR;
+    std::string filter;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    auto corpora = loadCorpus(dir, filter);
+    if (corpora.empty()) {
+        std::fprintf(stderr, "no corpus documents found in %s\n", dir.c_str());
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (const auto& corpus : corpora) {
+        InternalParserOptions options;
+        options.maxInputSize = corpus.content.size();
+
+        auto parsed = MarkdownParser::parse(corpus.content, options);
+        if (!parsed.success) {
+            std::fprintf(stderr, "%s: parse failed: %s\n", corpus.name.c_str(),
+                         parsed.error ? parsed.error->message.c_str() : "");
+            return 1;
+        }
+        size_t nodes = countNodes(parsed.nodes[0].get());
+
+        auto md4cRun = [&] { md4cOnly(corpus.content); };
+        auto treeRun = [&] { MarkdownParser::parse(corpus.content, options); };
+        auto jsonRun = [&] {
+            auto result = MarkdownParser::parse(corpus.content, options);
+            MarkdownSerializer::toJson(result.nodes);
+        };
+        InternalParserOptions positionOptions = options;
+        positionOptions.sourcePositions = true;
+        auto positionsRun = [&] {
+            auto result = MarkdownParser::parse(corpus.content, positionOptions);
+            LineIndex lines(corpus.content);
+            MarkdownSerializer::toJson(result.nodes, nullptr, &lines);
+        };
+        results.push_back(measure(corpus, "md4c", nodes, iterations, [&] { md4cOnly(corpus.content, true); }, md4cRun));
+        results.push_back(measure(corpus, "tree", nodes, iterations, treeRun, treeRun));
+        results.push_back(measure(corpus, "json", nodes, iterations, jsonRun, jsonRun));
+        results.push_back(measure(corpus, "pos", nodes, iterations, positionsRun, positionsRun));
+        results.push_back(measureRelease(corpus, "free", nodes, iterations, options, false));
+        results.push_back(measureRelease(corpus, "defer", nodes, iterations, options, true));
+    }
+
+    if (json) {
+        printJson(results, iterations);
+    } else {
+        printTable(results);
+    }
+    return 0;
+}
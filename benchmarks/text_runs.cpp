@@ -0,0 +1,74 @@
+/**
+ * Text runs benchmark
+ *
+ * Compares the node tree with a node per span against textRuns, where the
+ * inline content of each block is one text node with styled runs. For every
+ * document of benchmarks/corpus/, plus a generated one of long paragraphs
+ * dense with emphasis, code and links, it reports per mode:
+ *
+ *   nodes      nodes in the tree, i.e. the objects the JS side gets
+ *   json KB    size of the JSON AST
+ *   parse ms   MarkdownParser::parse()
+ *   json ms    MarkdownSerializer::toJson() of the parsed tree
+ *
+ * Usage: text_runs [iterations] [corpus-dir]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+// Chat-style prose: every sentence has a few spans
+std::string inlineHeavy() {
+    const std::string sentence =
+        "The **parser** keeps *every* span as a `node`, see [the docs](https://example.com/docs) "
+        "and ~~the old notes~~ for ***why*** it matters. ";
+    std::string content;
+    for (int paragraph = 0; paragraph < 400; paragraph++) {
+        for (int i = 0; i < 8; i++) {
+            content += sentence;
+        }
+        content += "\n\n";
+    }
+    return content;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    auto documents = loadCorpus(argc > 2 ? argv[2] : HYPERMARKDOWN_CORPUS_DIR);
+    documents.push_back({"inline_heavy", inlineHeavy()});
+
+    std::printf("%-18s %-5s %9s %9s %9s %9s\n", "document", "mode", "nodes", "json KB", "parse ms", "json ms");
+    for (const auto& document : documents) {
+        for (bool textRuns : {false, true}) {
+            InternalParserOptions options;
+            options.maxInputSize = document.content.size();
+            options.textRuns = textRuns;
+            auto result = MarkdownParser::parse(document.content, options);
+            if (!result.success) {
+                std::fprintf(stderr, "%s: parse failed\n", document.name.c_str());
+                return 1;
+            }
+            size_t jsonBytes = MarkdownSerializer::toJson(result.nodes).size();
+            double parseMs = bestOf(iterations, [&] { MarkdownParser::parse(document.content, options); });
+            double jsonMs = bestOf(iterations, [&] { MarkdownSerializer::toJson(result.nodes); });
+            std::printf("%-18s %-5s %9zu %9.1f %9.3f %9.3f\n", document.name.c_str(), textRuns ? "runs" : "tree",
+                        countNodes(result.nodes[0].get()), jsonBytes / 1024.0, parseMs, jsonMs);
+        }
+    }
+    return 0;
+}
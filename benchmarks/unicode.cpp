@@ -0,0 +1,119 @@
+/**
+ * Unicode text benchmark
+ *
+ * Parses Japanese, Chinese and emoji-rich documents. Emphasis delimiters
+ * next to non-ASCII text make md4c classify the neighbouring codepoints as
+ * whitespace or punctuation, and reference labels in those scripts go
+ * through case folding, so these corpora exercise md4c's Unicode tables
+ * much harder than English prose does. An ASCII corpus of similar shape is
+ * included as the baseline.
+ *
+ * Usage: unicode [iterations]
+ */
+#include "BenchmarkHarness.h"
+#include "MarkdownParser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_bench;
+
+namespace {
+
+constexpr size_t kParagraphs = 4000;
+
+// Builds a document from a handful of phrases in one script: paragraphs
+// mixing emphasis, strikethrough, code and reference links, plus headings
+// and list items every few paragraphs.
+std::string generate(const std::vector<std::string>& phrases, const std::vector<std::string>& labels) {
+    std::string s;
+
+    for (size_t i = 0; i < labels.size(); i++) {
+        s += "[" + labels[i] + "]: https://example.com/" + std::to_string(i) + "\n";
+    }
+    s += "\n";
+
+    for (size_t i = 0; i < kParagraphs; i++) {
+        const std::string& a = phrases[i % phrases.size()];
+        const std::string& b = phrases[(i * 7 + 3) % phrases.size()];
+        const std::string& c = phrases[(i * 13 + 5) % phrases.size()];
+        const std::string& label = labels[i % labels.size()];
+
+        if (i % 10 == 0) {
+            s += "## " + a + "\n\n";
+        }
+        if (i % 5 == 4) {
+            s += "- " + a + "**" + b + "**" + c + "\n- _" + c + "_\n\n";
+            continue;
+        }
+        s += a + "*" + b + "*" + c + "、**" + a + "**。" + b + "~~" + c + "~~" + a + "[" + label + "]" + c + "\n";
+        s += b + "「_" + a + "_」" + c + "`" + b + "`" + a + "！\n\n";
+    }
+    return s;
+}
+
+std::vector<Document> corpora() {
+    return {
+        {"ascii", generate({"the quick brown fox", "jumps over", "the lazy dog", "while parsing", "markdown text"},
+                           {"Ref One", "Ref Two", "Ref Three"})},
+        {"japanese", generate({"日本語の文章", "マークダウンを解析する", "テキストの表示", "カタカナとひらがな", "漢字"},
+                              {"参照ＡＢＣ", "リンク", "ドキュメント"})},
+        {"chinese", generate({"中文文本", "解析标记语言", "显示内容", "简体中文与繁體中文", "段落"},
+                             {"参考Ａ", "链接", "文档"})},
+        {"emoji", generate({"Ship it 🚀", "🎉🎉 party", "👍🏽 looks good", "🔥 hot path 🔥", "✅ done ❌ not done"},
+                           {"Émoji ✨", "ÄÖÜ ẞ", "Ωμέγα 🙂"})},
+    };
+}
+
+int md4cOnly(const std::string& content) {
+    MD_PARSER parser = {
+        0,
+        MD_FLAG_TABLES | MD_FLAG_STRIKETHROUGH | MD_FLAG_TASKLISTS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_COLLAPSEWHITESPACE,
+        noopBlock,
+        noopBlock,
+        noopSpan,
+        noopSpan,
+        noopText,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr
+    };
+    return md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, nullptr);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::printf("%-10s %10s %10s %10s %12s %12s\n", "corpus", "bytes", "md4c ms", "parse ms", "md4c MB/s", "parse MB/s");
+
+    for (const auto& corpus : corpora()) {
+        InternalParserOptions options;
+        options.maxInputSize = corpus.content.size();
+
+        auto result = MarkdownParser::parse(corpus.content, options);
+        if (!result.success) {
+            std::fprintf(stderr, "%s: parse failed: %s\n", corpus.name.c_str(),
+                         result.error ? result.error->message.c_str() : "");
+            return 1;
+        }
+
+        double mb = corpus.content.size() / (1024.0 * 1024.0);
+        double md4cMs = bestOf(iterations, [&] { md4cOnly(corpus.content); });
+        double parseMs = bestOf(iterations, [&] { MarkdownParser::parse(corpus.content, options); });
+        std::printf("%-10s %10zu %10.2f %10.2f %12.1f %12.1f\n", corpus.name.c_str(), corpus.content.size(), md4cMs,
+                    parseMs, mb / (md4cMs / 1000.0), mb / (parseMs / 1000.0));
+    }
+
+    return 0;
+}
@@ -0,0 +1,296 @@
+#include "BlockManifest.h"
+#include "InputNormalizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// State of the manifest pass, in md4c's userdata
+class ManifestBuilder {
+public:
+    ManifestBuilder(const std::string& input, const InternalLayoutMetrics& metrics, std::vector<ManifestBlock>& blocks)
+        : input(input.data()), size(static_cast<uint32_t>(input.size())), metrics(metrics), blocks(blocks) {}
+    
+    static int enterBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
+        auto* builder = static_cast<ManifestBuilder*>(userdata);
+        if (type != MD_BLOCK_DOC) {
+            builder->enter(type, detail);
+        }
+        return 0;
+    }
+    
+    static int leaveBlock(MD_BLOCKTYPE type, void*, void* userdata) {
+        auto* builder = static_cast<ManifestBuilder*>(userdata);
+        if (type != MD_BLOCK_DOC && --builder->depth == 0) {
+            builder->finish();
+        }
+        return 0;
+    }
+    
+    // The contents of every block are skipped, so there are no span and
+    // text callbacks; md4c still wants them
+    static int enterSpan(MD_SPANTYPE, void*, void*) { return 0; }
+    static int leaveSpan(MD_SPANTYPE, void*, void*) { return 0; }
+    static int text(MD_TEXTTYPE, const MD_CHAR*, MD_SIZE, void*) { return 0; }
+    
+    static int skipContents(MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end, void* userdata) {
+        static_cast<ManifestBuilder*>(userdata)->leaf(type, beg, end);
+        return 1;
+    }
+
+private:
+    const char* input;
+    uint32_t size;
+    const InternalLayoutMetrics& metrics;
+    std::vector<ManifestBlock>& blocks;
+    uint32_t previousEnd = 0;
+    size_t depth = 0;
+    
+    // The top-level block being analyzed: the end of its last line seen,
+    // the last leaf block in it, and its height so far
+    std::string type;
+    uint32_t contentEnd = 0;
+    char lastFence = 0;     // fence character of the last leaf, if fenced code
+    bool lastSetext = false;
+    int headingLevel = 1;
+    char codeFence = 0;
+    double height = 0;
+    
+    void enter(MD_BLOCKTYPE blockType, void* detail) {
+        if (depth++ == 0) {
+            type = MarkdownParser::blockTypeToString(blockType);
+            contentEnd = 0;
+            height = 0;
+        }
+        if (blockType == MD_BLOCK_H) {
+            headingLevel = static_cast<MD_BLOCK_H_DETAIL*>(detail)->level;
+        } else if (blockType == MD_BLOCK_CODE) {
+            codeFence = static_cast<char>(static_cast<MD_BLOCK_CODE_DETAIL*>(detail)->fence_char);
+        }
+    }
+    
+    void leaf(MD_BLOCKTYPE leafType, uint32_t beg, uint32_t end) {
+        bool hasLines = beg != 0 || end != 0;
+        lastFence = leafType == MD_BLOCK_CODE ? codeFence : 0;
+        lastSetext = false;
+        if (hasLines) {
+            contentEnd = std::max(contentEnd, end);
+            // An ATX heading has its marks before the content on its line
+            lastSetext = leafType == MD_BLOCK_H && std::memchr(input + lineStart(beg), '#', beg - lineStart(beg)) == nullptr;
+        }
+        switch (leafType) {
+            case MD_BLOCK_H: {
+                int level = std::clamp(headingLevel, 1, 6) - 1;
+                height += hasLines ? textHeight(beg, end, metrics.headingFontSizes[level], metrics.headingLineHeights[level])
+                                   : metrics.headingLineHeights[level];
+                break;
+            }
+            case MD_BLOCK_CODE: {
+                // The lines of fenced code start with the opening fence,
+                // those of indented code may end with blank lines
+                while (end > beg && (isNewline(input[end - 1]) || input[end - 1] == ' ' || input[end - 1] == '\t')) {
+                    end--;
+                }
+                uint32_t lines = hasLines ? lineCount(beg, end) - (lastFence ? 1 : 0) : 0;
+                height += lines * metrics.codeLineHeight + 2 * metrics.codeBlockPadding;
+                break;
+            }
+            case MD_BLOCK_TABLE:
+                // One line per row, the delimiter row aside
+                height += (lineCount(beg, end) - 1) * metrics.lineHeight;
+                break;
+            case MD_BLOCK_HR:
+                height += 1;
+                break;
+            default:
+                if (hasLines) {
+                    height += textHeight(beg, end, metrics.fontSize, metrics.lineHeight);
+                }
+                break;
+        }
+    }
+    
+    void finish() {
+        uint32_t start = firstNonBlankLine(previousEnd);
+        uint32_t last = lineEnd(std::max(contentEnd, start));
+        // md4c's lines leave out the closing fence of a code block and the
+        // underline of a Setext heading
+        if (last < size && ((lastFence && isFence(nextLine(last))) || (lastSetext && isUnderline(nextLine(last))))) {
+            last = lineEnd(nextLine(last));
+        }
+        uint32_t end = last < size ? nextLine(last) : size;
+        
+        ManifestBlock block;
+        block.type = std::move(type);
+        block.start = start;
+        block.end = end;
+        // One pass for the length and the lines; only "\r" line ends need
+        // a closer look
+        uint32_t units = 0;
+        uint32_t newlines = 0;
+        uint32_t returns = 0;
+        for (uint32_t p = start; p < end; p++) {
+            auto byte = static_cast<unsigned char>(input[p]);
+            units += unitsOf(byte);
+            newlines += byte == '\n';
+            returns += byte == '\r';
+        }
+        block.characters = units;
+        block.lines = returns ? lineCount(start, last) : newlines + (last < size ? 0 : 1);
+        block.height = static_cast<uint32_t>(std::ceil(height + metrics.blockSpacing));
+        blocks.push_back(std::move(block));
+        previousEnd = end;
+    }
+    
+    // Lines end with "\n", "\r\n" or "\r", as for md4c
+    static bool isNewline(char c) {
+        return c == '\n' || c == '\r';
+    }
+    
+    uint32_t lineStart(uint32_t offset) const {
+        while (offset > 0 && !isNewline(input[offset - 1])) {
+            offset--;
+        }
+        return offset;
+    }
+    
+    uint32_t lineEnd(uint32_t offset) const {
+        while (offset < size && !isNewline(input[offset])) {
+            offset++;
+        }
+        return offset;
+    }
+    
+    // Start of the line after the line end at `offset`
+    uint32_t nextLine(uint32_t offset) const {
+        return offset + (input[offset] == '\r' && offset + 1 < size && input[offset + 1] == '\n' ? 2 : 1);
+    }
+    
+    // Lines of [beg, end), where `end` is in the last line
+    uint32_t lineCount(uint32_t beg, uint32_t end) const {
+        uint32_t count = 1;
+        for (uint32_t p = beg; p < end; p++) {
+            count += input[p] == '\n' || (input[p] == '\r' && (p + 1 == size || input[p + 1] != '\n'));
+        }
+        return count;
+    }
+    
+    uint32_t firstNonBlankLine(uint32_t offset) const {
+        while (offset < size) {
+            uint32_t p = offset;
+            while (p < size && (input[p] == ' ' || input[p] == '\t')) {
+                p++;
+            }
+            if (p < size && !isNewline(input[p])) {
+                return offset;
+            }
+            offset = p < size ? nextLine(p) : size;
+        }
+        return size;
+    }
+    
+    // Start of the line's text after indentation and blockquote marks
+    uint32_t lineText(uint32_t offset) const {
+        while (offset < size && (input[offset] == ' ' || input[offset] == '\t' || input[offset] == '>')) {
+            offset++;
+        }
+        return offset;
+    }
+    
+    bool isFence(uint32_t offset) const {
+        uint32_t p = lineText(offset);
+        uint32_t marks = p;
+        while (marks < size && input[marks] == lastFence) {
+            marks++;
+        }
+        return marks - p >= 3;
+    }
+    
+    bool isUnderline(uint32_t offset) const {
+        uint32_t p = lineText(offset);
+        if (p >= size || (input[p] != '=' && input[p] != '-')) {
+            return false;
+        }
+        char mark = input[p];
+        while (p < size && input[p] == mark) {
+            p++;
+        }
+        while (p < size && (input[p] == ' ' || input[p] == '\t')) {
+            p++;
+        }
+        return p == size || isNewline(input[p]);
+    }
+    
+    // UTF-16 units of a byte of valid UTF-8, without validating it: one
+    // per byte that is not a continuation byte, two for a 4-byte sequence
+    static uint32_t unitsOf(unsigned char byte) {
+        return ((byte & 0xC0) != 0x80) + (byte >= 0xF0);
+    }
+    
+    // Height of text lines wrapped at the metrics' width, plus the images,
+    // in one pass
+    double textHeight(uint32_t beg, uint32_t end, double fontSize, double lineHeight) const {
+        double perLine = std::max(1.0, std::floor(metrics.width / std::max(fontSize * metrics.charWidth, 0.01)));
+        auto wrapped = [&](size_t units) { return std::max(1.0, std::ceil(static_cast<double>(units) / perLine)); };
+        double lines = 0;
+        size_t units = 0;
+        size_t images = 0;
+        for (uint32_t p = lineText(beg); p < end; p++) {
+            auto byte = static_cast<unsigned char>(input[p]);
+            if (isNewline(static_cast<char>(byte))) {
+                lines += wrapped(units);
+                units = 0;
+                p = lineText(nextLine(p)) - 1;
+                continue;
+            }
+            units += unitsOf(byte);
+            images += byte == '!' && p + 1 < end && input[p + 1] == '[';
+        }
+        lines += wrapped(units);
+        return lines * lineHeight + static_cast<double>(images) * metrics.imageHeight;
+    }
+};
+
+} // namespace
+
+BlockManifest BlockManifest::build(const std::string& content, const InternalLayoutMetrics& metrics,
+                                   const InternalParserOptions& options) {
+    BlockManifest manifest;
+    if (content.size() > options.maxInputSize) {
+        manifest.error = ParseError("Input exceeds maximum size limit");
+        return manifest;
+    }
+    
+    std::string normalized;
+    bool isNormalized = options.normalizeInput && InputNormalizer::normalize(content, normalized);
+    const std::string& source = isNormalized ? normalized : content;
+    
+    ManifestBuilder builder(source, metrics, manifest.blocks);
+    MD_PARSER parser = {
+        0,
+        MarkdownParser::optionsToFlags(options),
+        ManifestBuilder::enterBlock,
+        ManifestBuilder::leaveBlock,
+        ManifestBuilder::enterSpan,
+        ManifestBuilder::leaveSpan,
+        ManifestBuilder::text,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        ManifestBuilder::skipContents
+    };
+    if (md_parse(source.c_str(), static_cast<MD_SIZE>(source.size()), &parser, &builder) != 0) {
+        manifest.blocks.clear();
+        manifest.error = ParseError("Failed to parse markdown");
+        return manifest;
+    }
+    manifest.success = true;
+    return manifest;
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// Theme metrics the block heights of a manifest are estimated from, in
+// points (separate from Nitro-generated LayoutMetrics)
+struct InternalLayoutMetrics {
+    double width = 360;             // width of the rendered text
+    double fontSize = 16;
+    double lineHeight = 24;
+    double headingFontSizes[6] = {32, 28, 24, 20, 18, 16};
+    double headingLineHeights[6] = {40, 36, 32, 28, 26, 24};
+    double codeLineHeight = 20;     // code lines do not wrap
+    double codeBlockPadding = 16;   // above and below the code
+    double blockSpacing = 16;       // below every top-level block
+    double imageHeight = 200;
+    double charWidth = 0.55;        // average advance of a character, in ems
+};
+
+// One top-level block of a manifest. `start` and `end` are byte offsets of
+// the input (of the normalized input with normalizeInput), `characters` the
+// length of [start, end) in UTF-16 code units, as far as the input is
+// valid UTF-8, and `lines` its line count.
+struct ManifestBlock {
+    std::string type;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    uint32_t characters = 0;
+    uint32_t lines = 0;
+    uint32_t height = 0;
+};
+
+// The top-level blocks of a document, with an estimated height for each,
+// so that a virtualized list can lay out a long document without its AST
+// and fetch the nodes of the visible blocks only (getBlocks). The blocks
+// come from md4c's block analysis alone: the contents of every block are
+// skipped, so there is no inline analysis and no node tree.
+//
+// A block's range runs from the first non-blank line after the previous
+// block to the end of its last line, including the newline. Blank lines
+// between blocks belong to no block; link reference definitions go with
+// the block after them.
+//
+// Heights are rough: text wraps at `charWidth` ems per character, code
+// does not wrap, and nested blocks take the full width.
+struct BlockManifest {
+    bool success = false;
+    std::vector<ManifestBlock> blocks;
+    std::optional<ParseError> error;
+    
+    // Runs md4c's block analysis over `content` with the md4c flags and the
+    // maxInputSize and normalizeInput settings of `options`
+    static BlockManifest build(const std::string& content, const InternalLayoutMetrics& metrics,
+                               const InternalParserOptions& options = InternalParserOptions());
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,1201 @@
+#include "CodeTokenizer.h"
+#include "InputNormalizer.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <initializer_list>
+#include <unordered_set>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+using WordList = std::vector<std::string_view>;
+
+// What the identifier after a keyword names, e.g. a function after `def`
+enum class Declares : uint8_t {
+    Nothing,
+    Function,
+    Type
+};
+
+// The words of a language with their classes, looked up once per
+// identifier. Open addressing over a hash of a few characters; most
+// identifiers are in no table and miss on the first probe.
+class WordTable {
+public:
+    struct Entry {
+        std::string_view word;
+        CodeTokenClass cls = CodeTokenClass::Keyword;
+        Declares declares = Declares::Nothing;
+    };
+    
+    // A word already in the table keeps its class, so classes are added in
+    // order of precedence
+    void add(const WordList& words, CodeTokenClass cls) {
+        for (auto word : words) {
+            if (!word.empty() && !find(word)) {
+                entries.push_back({word, cls, declaration(word, cls)});
+            }
+        }
+        rebuild();
+    }
+    
+    const Entry* find(std::string_view word) const {
+        if (word.size() > maxLength) {
+            return nullptr;
+        }
+        for (size_t slot = hash(word) & mask;; slot = (slot + 1) & mask) {
+            const Entry& entry = slots[slot];
+            if (entry.word.empty()) {
+                return nullptr;
+            }
+            if (entry.word == word) {
+                return &entry;
+            }
+        }
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> slots = std::vector<Entry>(1);
+    size_t mask = 0;
+    size_t maxLength = 0;
+    
+    static size_t hash(std::string_view word) {
+        auto byte = [&](size_t i) { return static_cast<size_t>(static_cast<unsigned char>(word[i])); };
+        return word.size() * 0x9E37 + byte(0) * 0x1F3 + byte(word.size() - 1) * 0x3B + byte(word.size() / 2) * 7;
+    }
+    
+    static Declares declaration(std::string_view word, CodeTokenClass cls) {
+        static const WordList kFunctions = {"def", "fn", "func", "fun", "function"};
+        static const WordList kTypes = {"class", "struct", "enum", "trait", "interface", "protocol", "union",
+                                        "record", "extension", "impl", "object"};
+        if (cls != CodeTokenClass::Keyword) {
+            return Declares::Nothing;
+        }
+        if (std::find(kFunctions.begin(), kFunctions.end(), word) != kFunctions.end()) {
+            return Declares::Function;
+        }
+        if (std::find(kTypes.begin(), kTypes.end(), word) != kTypes.end()) {
+            return Declares::Type;
+        }
+        return Declares::Nothing;
+    }
+    
+    // At most a quarter of the slots are used, so probe chains stay short
+    void rebuild() {
+        size_t size = 16;
+        while (size < entries.size() * 4) {
+            size *= 2;
+        }
+        slots.assign(size, Entry());
+        mask = size - 1;
+        for (const auto& entry : entries) {
+            size_t slot = hash(entry.word) & mask;
+            while (!slots[slot].word.empty()) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = entry;
+            maxLength = std::max(maxLength, entry.word.size());
+        }
+    }
+};
+
+enum class Grammar : uint8_t {
+    Code,   // C-like and scripting languages
+    Shell,
+    Sql,
+    Json,
+    Yaml,
+    Diff
+};
+
+// Roles of a byte in a language
+enum ByteFlags : uint8_t {
+    kQuote = 1,             // starts a string
+    kMultilineQuote = 2,    // starts a string that may span lines
+    kRawQuote = 4,          // starts a string without backslash escapes
+    kIdentifierQuote = 8,   // starts a quoted identifier
+    kIdentifierStart = 16,
+    kIdentifierChar = 32
+};
+
+inline bool isDigit(unsigned char c) {
+    return static_cast<unsigned>(c - '0') < 10;
+}
+
+inline bool isAlpha(unsigned char c) {
+    return static_cast<unsigned>((c | 0x20) - 'a') < 26;
+}
+
+inline bool isUpper(unsigned char c) {
+    return static_cast<unsigned>(c - 'A') < 26;
+}
+
+inline bool isHexDigit(unsigned char c) {
+    return isDigit(c) || static_cast<unsigned>((c | 0x20) - 'a') < 6;
+}
+
+inline bool isSpace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool contains(const char* set, char c) {
+    return c != '\0' && std::strchr(set, c) != nullptr;
+}
+
+} // namespace
+
+struct CodeLanguage {
+    const char* name = nullptr;
+    WordList aliases = {};
+    Grammar grammar = Grammar::Code;
+    WordList keywords = {};
+    WordList literals = {};
+    WordList types = {};
+    WordList builtIns = {};
+    const char* lineComment = nullptr;
+    bool blockComments = false;
+    const char* quotes = "\"'";          // string delimiters
+    const char* multilineQuotes = "";    // strings that may span lines
+    const char* rawQuotes = "";          // strings without backslash escapes
+    const char* identifierQuotes = "";   // quoted identifiers, skipped as plain text
+    bool tripleQuotes = false;           // """ strings (and ''' if ' is a quote)
+    bool stringPrefixes = false;         // Python r"", b"", f""
+    char annotation = 0;                 // @decorator, @Annotation
+    bool preprocessor = false;           // C #include lines
+    bool cppStrings = false;             // C++ R"d(raw)d", and u8"", L'' prefixes
+    bool hashDirectives = false;         // Swift #if, #available
+    bool rustSyntax = false;             // #[attributes], macro!, 'lifetimes, r#"raw"#
+    bool dollarIdentifiers = false;      // JS $ in identifiers
+    bool capitalizedTypes = false;       // Capitalized identifiers are types
+    bool caseInsensitive = false;        // SQL keywords
+    
+    // Derived from the above by prepare()
+    WordTable words = {};
+    uint8_t bytes[256] = {};
+    size_t lineCommentLength = 0;
+    
+    void prepare() {
+        words.add(keywords, CodeTokenClass::Keyword);
+        words.add(literals, CodeTokenClass::Literal);
+        words.add(types, CodeTokenClass::Type);
+        words.add(builtIns, CodeTokenClass::BuiltIn);
+        for (int c = 0; c < 256; c++) {
+            auto byte = static_cast<unsigned char>(c);
+            bool start = isAlpha(byte) || byte == '_' || byte >= 0x80 || (byte == '$' && dollarIdentifiers);
+            bool part = start || isDigit(byte) || (byte == '-' && grammar == Grammar::Shell);
+            bytes[c] = (contains(quotes, static_cast<char>(c)) ? kQuote : 0) |
+                       (contains(multilineQuotes, static_cast<char>(c)) ? kMultilineQuote : 0) |
+                       (contains(rawQuotes, static_cast<char>(c)) ? kRawQuote : 0) |
+                       (contains(identifierQuotes, static_cast<char>(c)) ? kIdentifierQuote : 0) |
+                       (start ? kIdentifierStart : 0) | (part ? kIdentifierChar : 0);
+        }
+        lineCommentLength = lineComment ? std::strlen(lineComment) : 0;
+    }
+};
+
+namespace {
+
+const std::vector<CodeLanguage>& languages() {
+    static const std::vector<CodeLanguage> list = [] {
+        std::vector<CodeLanguage> l;
+        l.push_back({
+            .name = "typescript",
+            .aliases = {"typescript", "ts", "tsx", "mts", "cts", "javascript", "js", "jsx", "mjs", "cjs", "node"},
+            .keywords = {"abstract", "as", "async", "await", "break", "case", "catch", "class", "const", "continue",
+                         "debugger", "declare", "default", "delete", "do", "else", "enum", "export", "extends",
+                         "finally", "for", "from", "function", "get", "if", "implements", "import", "in", "infer",
+                         "instanceof", "interface", "is", "keyof", "let", "namespace", "new", "of", "private",
+                         "protected", "public", "readonly", "return", "satisfies", "set", "static", "super", "switch",
+                         "this", "throw", "try", "type", "typeof", "var", "void", "while", "with", "yield"},
+            .literals = {"true", "false", "null", "undefined", "NaN", "Infinity"},
+            .types = {"any", "bigint", "boolean", "never", "number", "object", "string", "symbol", "unknown"},
+            .builtIns = {"Array", "Boolean", "Date", "Error", "JSON", "Map", "Math", "Number", "Object", "Promise",
+                         "Reflect", "RegExp", "Set", "String", "Symbol", "WeakMap", "WeakSet", "console", "document",
+                         "exports", "globalThis", "module", "process", "require", "window"},
+            .lineComment = "//",
+            .blockComments = true,
+            .quotes = "\"'`",
+            .multilineQuotes = "`",
+            .dollarIdentifiers = true,
+            .capitalizedTypes = true,
+        });
+        l.push_back({
+            .name = "python",
+            .aliases = {"python", "py", "python3", "py3", "gyp"},
+            .keywords = {"and", "as", "assert", "async", "await", "break", "case", "class", "continue", "def", "del",
+                         "elif", "else", "except", "finally", "for", "from", "global", "if", "import", "in", "is",
+                         "lambda", "match", "nonlocal", "not", "or", "pass", "raise", "return", "try", "while",
+                         "with", "yield"},
+            .literals = {"True", "False", "None", "Ellipsis", "NotImplemented"},
+            .builtIns = {"abs", "all", "any", "bool", "bytes", "dict", "dir", "enumerate", "filter", "float",
+                         "getattr", "hasattr", "int", "isinstance", "iter", "len", "list", "map", "max", "min",
+                         "next", "object", "open", "print", "range", "repr", "reversed", "round", "self", "set",
+                         "setattr", "sorted", "str", "sum", "super", "tuple", "type", "zip"},
+            .lineComment = "#",
+            .tripleQuotes = true,
+            .stringPrefixes = true,
+            .annotation = '@',
+        });
+        l.push_back({
+            .name = "json",
+            .aliases = {"json", "jsonc", "json5", "geojson"},
+            .grammar = Grammar::Json,
+            .literals = {"true", "false", "null"},
+        });
+        l.push_back({
+            .name = "bash",
+            .aliases = {"bash", "sh", "shell", "zsh", "console", "shellscript", "ksh"},
+            .grammar = Grammar::Shell,
+            .keywords = {"if", "then", "else", "elif", "fi", "for", "while", "until", "do", "done", "case", "esac",
+                         "in", "function", "select", "time", "return", "break", "continue"},
+            .literals = {"true", "false"},
+            .builtIns = {"alias", "cd", "declare", "echo", "eval", "exec", "exit", "export", "local", "printf",
+                         "pwd", "read", "readonly", "set", "shift", "source", "test", "trap", "unalias", "unset"},
+            .lineComment = "#",
+            .multilineQuotes = "\"'",
+            .rawQuotes = "'",
+        });
+        l.push_back({
+            .name = "cpp",
+            .aliases = {"cpp", "c++", "cc", "cxx", "hpp", "hh", "hxx", "h", "c", "objc", "objective-c", "mm"},
+            .keywords = {"alignas", "alignof", "asm", "break", "case", "catch", "class", "co_await", "co_return",
+                         "co_yield", "concept", "const", "const_cast", "consteval", "constexpr", "constinit",
+                         "continue", "decltype", "default", "delete", "do", "dynamic_cast", "else", "enum",
+                         "explicit", "export", "extern", "final", "for", "friend", "goto", "if", "inline",
+                         "mutable", "namespace", "new", "noexcept", "operator", "override", "private", "protected",
+                         "public", "register", "reinterpret_cast", "requires", "restrict", "return", "sizeof",
+                         "static", "static_assert", "static_cast", "struct", "switch", "template", "this",
+                         "thread_local", "throw", "try", "typedef", "typeid", "typename", "union", "using",
+                         "virtual", "volatile", "while"},
+            .literals = {"true", "false", "nullptr", "NULL"},
+            .types = {"auto", "bool", "char", "char8_t", "char16_t", "char32_t", "double", "float", "int",
+                      "int8_t", "int16_t", "int32_t", "int64_t", "long", "ptrdiff_t", "short", "signed",
+                      "size_t", "ssize_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "uintptr_t",
+                      "unsigned", "void", "wchar_t"},
+            .builtIns = {"std", "printf", "fprintf", "sprintf", "snprintf", "malloc", "calloc", "realloc", "free",
+                         "memcpy", "memmove", "memset", "strlen", "strcmp", "assert"},
+            .lineComment = "//",
+            .blockComments = true,
+            .preprocessor = true,
+            .cppStrings = true,
+        });
+        l.push_back({
+            .name = "java",
+            .aliases = {"java", "jsp"},
+            .keywords = {"abstract", "assert", "break", "case", "catch", "class", "const", "continue", "default",
+                         "do", "else", "enum", "extends", "final", "finally", "for", "goto", "if", "implements",
+                         "import", "instanceof", "interface", "native", "new", "non-sealed", "package", "permits",
+                         "private", "protected", "public", "record", "return", "sealed", "static", "strictfp",
+                         "super", "switch", "synchronized", "this", "throw", "throws", "transient", "try", "var",
+                         "volatile", "while", "yield"},
+            .literals = {"true", "false", "null"},
+            .types = {"boolean", "byte", "char", "double", "float", "int", "long", "short", "void"},
+            .builtIns = {"System", "String", "Object", "Math", "Integer", "Long", "Double", "Boolean", "List",
+                         "Map", "Set", "Optional"},
+            .lineComment = "//",
+            .blockComments = true,
+            .annotation = '@',
+            .capitalizedTypes = true,
+        });
+        l.push_back({
+            .name = "kotlin",
+            .aliases = {"kotlin", "kt", "kts"},
+            .keywords = {"abstract", "actual", "annotation", "as", "break", "by", "catch", "class", "companion",
+                         "const", "constructor", "continue", "crossinline", "data", "do", "else", "enum", "expect",
+                         "external", "final", "finally", "for", "fun", "get", "if", "import", "in", "infix", "init",
+                         "inline", "inner", "interface", "internal", "is", "lateinit", "noinline", "object", "open",
+                         "operator", "out", "override", "package", "private", "protected", "public", "reified",
+                         "return", "sealed", "set", "super", "suspend", "tailrec", "this", "throw", "try",
+                         "typealias", "val", "value", "var", "vararg", "when", "where", "while"},
+            .literals = {"true", "false", "null"},
+            .builtIns = {"println", "print", "listOf", "mutableListOf", "mapOf", "mutableMapOf", "setOf",
+                         "arrayOf", "require", "check", "error", "lazy", "repeat", "TODO"},
+            .lineComment = "//",
+            .blockComments = true,
+            .tripleQuotes = true,
+            .annotation = '@',
+            .capitalizedTypes = true,
+        });
+        l.push_back({
+            .name = "swift",
+            .aliases = {"swift"},
+            .keywords = {"actor", "any", "as", "associatedtype", "async", "await", "break", "case", "catch", "class",
+                         "continue", "convenience", "default", "defer", "deinit", "do", "dynamic", "else", "enum",
+                         "extension", "fallthrough", "fileprivate", "final", "for", "func", "guard", "if", "import",
+                         "in", "indirect", "init", "inout", "internal", "is", "lazy", "let", "mutating",
+                         "nonisolated", "open", "operator", "override", "private", "protocol", "public", "repeat",
+                         "required", "rethrows", "return", "self", "Self", "some", "static", "struct", "subscript",
+                         "super", "switch", "throw", "throws", "try", "typealias", "unowned", "var", "weak",
+                         "where", "while"},
+            .literals = {"true", "false", "nil"},
+            .builtIns = {"print", "debugPrint", "fatalError", "precondition", "assert", "min", "max", "abs",
+                         "zip", "stride"},
+            .lineComment = "//",
+            .blockComments = true,
+            .quotes = "\"",
+            .tripleQuotes = true,
+            .annotation = '@',
+            .hashDirectives = true,
+            .capitalizedTypes = true,
+        });
+        l.push_back({
+            .name = "go",
+            .aliases = {"go", "golang"},
+            .keywords = {"break", "case", "chan", "const", "continue", "default", "defer", "else", "fallthrough",
+                         "for", "func", "go", "goto", "if", "import", "interface", "map", "package", "range",
+                         "return", "select", "struct", "switch", "type", "var"},
+            .literals = {"true", "false", "nil", "iota"},
+            .types = {"any", "bool", "byte", "complex64", "complex128", "error", "float32", "float64", "int",
+                      "int8", "int16", "int32", "int64", "rune", "string", "uint", "uint8", "uint16", "uint32",
+                      "uint64", "uintptr"},
+            .builtIns = {"append", "cap", "clear", "close", "complex", "copy", "delete", "imag", "len", "make",
+                         "max", "min", "new", "panic", "print", "println", "real", "recover"},
+            .lineComment = "//",
+            .blockComments = true,
+            .quotes = "\"'`",
+            .multilineQuotes = "`",
+            .rawQuotes = "`",
+        });
+        l.push_back({
+            .name = "rust",
+            .aliases = {"rust", "rs"},
+            .keywords = {"as", "async", "await", "break", "const", "continue", "crate", "dyn", "else", "enum",
+                         "extern", "fn", "for", "if", "impl", "in", "let", "loop", "match", "mod", "move", "mut",
+                         "pub", "ref", "return", "self", "Self", "static", "struct", "super", "trait", "type",
+                         "union", "unsafe", "use", "where", "while"},
+            .literals = {"true", "false"},
+            .types = {"bool", "char", "f32", "f64", "i8", "i16", "i32", "i64", "i128", "isize", "str", "u8", "u16",
+                      "u32", "u64", "u128", "usize"},
+            .builtIns = {"Box", "Err", "None", "Ok", "Option", "Result", "Some", "String", "Vec"},
+            .lineComment = "//",
+            .blockComments = true,
+            .multilineQuotes = "\"",
+            .rustSyntax = true,
+            .capitalizedTypes = true,
+        });
+        l.push_back({
+            .name = "sql",
+            .aliases = {"sql", "mysql", "postgresql", "postgres", "psql", "sqlite", "plsql", "tsql"},
+            .grammar = Grammar::Sql,
+            .keywords = {"add", "all", "alter", "and", "as", "asc", "begin", "between", "by", "case", "check",
+                         "column", "commit", "constraint", "create", "cross", "database", "default", "delete",
+                         "desc", "distinct", "drop", "else", "end", "exists", "foreign", "from", "full", "group",
+                         "having", "if", "in", "index", "inner", "insert", "intersect", "into", "is", "join", "key",
+                         "left", "like", "limit", "not", "offset", "on", "or", "order", "outer", "primary",
+                         "references", "replace", "returning", "right", "rollback", "select", "set", "table",
+                         "then", "transaction", "union", "unique", "update", "using", "values", "view", "when",
+                         "where", "with"},
+            .literals = {"true", "false", "null"},
+            .types = {"bigint", "blob", "boolean", "char", "date", "decimal", "double", "float", "int", "integer",
+                      "json", "jsonb", "numeric", "real", "serial", "smallint", "text", "time", "timestamp",
+                      "uuid", "varchar"},
+            .builtIns = {"avg", "cast", "coalesce", "count", "lower", "max", "min", "now", "round", "substring",
+                         "sum", "upper"},
+            .lineComment = "--",
+            .blockComments = true,
+            .quotes = "'",
+            .identifierQuotes = "\"`",
+            .caseInsensitive = true,
+        });
+        l.push_back({
+            .name = "yaml",
+            .aliases = {"yaml", "yml"},
+            .grammar = Grammar::Yaml,
+            .literals = {"true", "false", "null", "yes", "no", "on", "off", "~"},
+            .caseInsensitive = true,
+        });
+        l.push_back({
+            .name = "diff",
+            .aliases = {"diff", "patch"},
+            .grammar = Grammar::Diff,
+        });
+        for (auto& language : l) {
+            language.prepare();
+        }
+        return l;
+    }();
+    return list;
+}
+
+// Lexer state over one code block
+class Lexer {
+public:
+    Lexer(const CodeLanguage& language, const char* code, size_t size, std::vector<CodeToken>& tokens)
+        : lang(language), s(code), n(size), out(tokens) {}
+    
+    void code();
+    void json();
+    void yaml();
+    void diff();
+
+private:
+    const CodeLanguage& lang;
+    const char* s;
+    size_t n;
+    std::vector<CodeToken>& out;
+    
+    unsigned char at(size_t i) const {
+        return i < n ? static_cast<unsigned char>(s[i]) : 0;
+    }
+    
+    bool startsWith(size_t i, const char* prefix) const {
+        size_t length = std::strlen(prefix);
+        return n - i >= length && std::memcmp(s + i, prefix, length) == 0;
+    }
+    
+    void emit(size_t start, size_t end, CodeTokenClass cls) {
+        if (end > start) {
+            out.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), cls});
+        }
+    }
+    
+    size_t lineEnd(size_t i) const {
+        const void* newline = std::memchr(s + i, '\n', n - i);
+        return newline ? static_cast<const char*>(newline) - s : n;
+    }
+    
+    bool is(unsigned char c, ByteFlags flag) const {
+        return lang.bytes[c] & flag;
+    }
+    
+    bool isIdentifierStart(unsigned char c) const {
+        return is(c, kIdentifierStart);
+    }
+    
+    bool isIdentifierChar(unsigned char c) const {
+        return is(c, kIdentifierChar);
+    }
+    
+    size_t identifierEnd(size_t i) const {
+        while (i < n && isIdentifierChar(at(i))) {
+            i++;
+        }
+        return i;
+    }
+    
+    // End of a string whose opening quote is before i: after the closing
+    // quote, or at the end of the line for an unterminated single-line string
+    size_t stringEnd(size_t i, char quote) const {
+        bool multiline = is(static_cast<unsigned char>(quote), kMultilineQuote);
+        bool raw = is(static_cast<unsigned char>(quote), kRawQuote);
+        while (i < n) {
+            char c = s[i];
+            if (c == quote) {
+                // SQL escapes a quote by doubling it
+                if (lang.grammar == Grammar::Sql && at(i + 1) == static_cast<unsigned char>(quote)) {
+                    i += 2;
+                    continue;
+                }
+                return i + 1;
+            }
+            if (c == '\\' && !raw) {
+                i += 2;
+                continue;
+            }
+            if (c == '\n' && !multiline) {
+                return i;
+            }
+            i++;
+        }
+        return n;
+    }
+    
+    // End of a """ string whose opening quotes end before i
+    size_t tripleStringEnd(size_t i, char quote) const {
+        while (i < n) {
+            if (s[i] == '\\') {
+                i += 2;
+            } else if (s[i] == quote && at(i + 1) == static_cast<unsigned char>(quote) &&
+                       at(i + 2) == static_cast<unsigned char>(quote)) {
+                return i + 3;
+            } else {
+                i++;
+            }
+        }
+        return n;
+    }
+    
+    size_t blockCommentEnd(size_t i) const {
+        for (; i + 1 < n; i++) {
+            if (s[i] == '*' && s[i + 1] == '/') {
+                return i + 2;
+            }
+        }
+        return n;
+    }
+    
+    // End of a number starting at i: decimal, hexadecimal, binary or octal,
+    // with digit separators, fraction, exponent and type suffix
+    size_t numberEnd(size_t i) const {
+        if (s[i] == '0' && (at(i + 1) | 0x20) == 'x') {
+            i += 2;
+            while (i < n && (isHexDigit(at(i)) || s[i] == '_')) {
+                i++;
+            }
+        } else {
+            while (i < n && (isDigit(at(i)) || s[i] == '_')) {
+                i++;
+            }
+            if (at(i) == '.' && isDigit(at(i + 1))) {
+                i++;
+                while (i < n && (isDigit(at(i)) || s[i] == '_')) {
+                    i++;
+                }
+            }
+            if ((at(i) | 0x20) == 'e' &&
+                (isDigit(at(i + 1)) || ((at(i + 1) == '+' || at(i + 1) == '-') && isDigit(at(i + 2))))) {
+                i += 2;
+                while (i < n && isDigit(at(i))) {
+                    i++;
+                }
+            }
+        }
+        // Suffixes like 10u, 1.5f, 100n, 8i32, and binary and octal digits
+        while (i < n && (isAlpha(at(i)) || isDigit(at(i)) || s[i] == '_')) {
+            i++;
+        }
+        return i;
+    }
+    
+    // First non-blank position on the same line from i
+    size_t skipBlanks(size_t i) const {
+        while (i < n && isSpace(at(i))) {
+            i++;
+        }
+        return i;
+    }
+    
+    const WordTable::Entry* lookup(std::string_view word) const;
+    size_t shellVariableEnd(size_t i) const;
+    size_t rustString(size_t i, size_t wordEnd) const;
+    size_t cppString(size_t i, size_t wordEnd) const;
+    size_t yamlValue(size_t i, size_t end, size_t indent);
+    void yamlScalar(size_t start, size_t end, bool key);
+};
+
+// The entry of a word in the language's table, case-insensitively for SQL
+const WordTable::Entry* Lexer::lookup(std::string_view word) const {
+    if (!lang.caseInsensitive) {
+        return lang.words.find(word);
+    }
+    char lower[32];
+    if (word.size() > sizeof(lower)) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < word.size(); i++) {
+        lower[i] = isUpper(static_cast<unsigned char>(word[i])) ? static_cast<char>(word[i] | 0x20) : word[i];
+    }
+    return lang.words.find(std::string_view(lower, word.size()));
+}
+
+// End of a shell variable reference starting with the '$' at i, or i if
+// there is none
+size_t Lexer::shellVariableEnd(size_t i) const {
+    unsigned char next = at(i + 1);
+    if (next == '{') {
+        const void* close = std::memchr(s + i, '}', lineEnd(i) - i);
+        return close ? static_cast<const char*>(close) - s + 1 : i;
+    }
+    if (isAlpha(next) || next == '_') {
+        size_t end = i + 1;
+        while (end < n && (isAlpha(at(end)) || isDigit(at(end)) || s[end] == '_')) {
+            end++;
+        }
+        return end;
+    }
+    if (isDigit(next) || contains("@#?$!*-", static_cast<char>(next))) {
+        return i + 2;
+    }
+    return i;
+}
+
+// End of a Rust raw or byte string whose prefix (r, b, br) ends at
+// wordEnd, or 0 if the prefix is an identifier
+size_t Lexer::rustString(size_t i, size_t wordEnd) const {
+    std::string_view prefix(s + i, wordEnd - i);
+    if (prefix == "b" && at(wordEnd) == '\'') {
+        return stringEnd(wordEnd + 1, '\'');
+    }
+    if ((prefix == "b" || prefix == "c") && at(wordEnd) == '"') {
+        return stringEnd(wordEnd + 1, '"');
+    }
+    if (prefix != "r" && prefix != "br" && prefix != "cr") {
+        return 0;
+    }
+    size_t hashes = 0;
+    while (at(wordEnd + hashes) == '#') {
+        hashes++;
+    }
+    if (at(wordEnd + hashes) != '"') {
+        return 0;
+    }
+    // A raw string ends at a quote followed by as many hashes
+    for (size_t j = wordEnd + hashes + 1; j < n; j++) {
+        if (s[j] != '"' || n - j - 1 < hashes) {
+            continue;
+        }
+        size_t k = 0;
+        while (k < hashes && s[j + 1 + k] == '#') {
+            k++;
+        }
+        if (k == hashes) {
+            return j + 1 + hashes;
+        }
+    }
+    return n;
+}
+
+// End of a C++ raw string or of a string or character with an encoding
+// prefix (u8, u, U, L), whose prefix ends at wordEnd, or 0 if the prefix
+// is an identifier
+size_t Lexer::cppString(size_t i, size_t wordEnd) const {
+    std::string_view prefix(s + i, wordEnd - i);
+    bool raw = !prefix.empty() && prefix.back() == 'R';
+    if (raw) {
+        prefix.remove_suffix(1);
+    }
+    if (!prefix.empty() && prefix != "u8" && prefix != "u" && prefix != "U" && prefix != "L") {
+        return 0;
+    }
+    if (!raw) {
+        return at(wordEnd) == '"' || at(wordEnd) == '\'' ? stringEnd(wordEnd + 1, s[wordEnd]) : 0;
+    }
+    if (at(wordEnd) != '"') {
+        return 0;
+    }
+    // R"delim( ... )delim": the delimiter is at most 16 characters, none of
+    // them a space, a parenthesis or a backslash
+    size_t open = wordEnd + 1;
+    while (open < n && open - wordEnd <= 17 && !isSpace(at(open)) && !contains("()\\\n", s[open])) {
+        open++;
+    }
+    if (at(open) != '(' || open - wordEnd > 17) {
+        return 0;
+    }
+    // It ends at the first )delim"
+    std::string_view delimiter(s + wordEnd + 1, open - wordEnd - 1);
+    size_t closing = delimiter.size() + 2;
+    for (size_t j = open + 1; n - j >= closing; j++) {
+        if (s[j] == ')' && s[j + closing - 1] == '"' &&
+            std::memcmp(s + j + 1, delimiter.data(), delimiter.size()) == 0) {
+            return j + closing;
+        }
+    }
+    return n;
+}
+
+void Lexer::code() {
+    bool lineStart = true;
+    // The previous token declares a function or a type named by the next
+    // identifier, e.g. `def name`, `class Name`
+    Declares declaring = Declares::Nothing;
+    size_t i = 0;
+    while (i < n) {
+        unsigned char c = at(i);
+        if (c == '\n') {
+            lineStart = true;
+            i++;
+            continue;
+        }
+        if (isSpace(c)) {
+            i++;
+            continue;
+        }
+        bool atLineStart = lineStart;
+        lineStart = false;
+        Declares declared = declaring;
+        declaring = Declares::Nothing;
+        size_t start = i;
+        
+        if (lang.lineComment && c == static_cast<unsigned char>(lang.lineComment[0]) &&
+            n - i >= lang.lineCommentLength && std::memcmp(s + i, lang.lineComment, lang.lineCommentLength) == 0) {
+            // A shell comment starts a word: `a#b` is one word
+            bool comment = lang.grammar != Grammar::Shell || i == 0 || isSpace(at(i - 1)) ||
+                           contains("\n;&|(", s[i - 1]);
+            if (comment) {
+                i = lineEnd(i);
+                emit(start, i, start == 0 && startsWith(0, "#!") ? CodeTokenClass::Meta : CodeTokenClass::Comment);
+                continue;
+            }
+        }
+        if (lang.blockComments && c == '/' && at(i + 1) == '*') {
+            i = blockCommentEnd(i + 2);
+            emit(start, i, CodeTokenClass::Comment);
+            continue;
+        }
+        if (c == '#' && lang.preprocessor && atLineStart) {
+            // Up to the end of the line, or of the last continued line
+            i = lineEnd(i);
+            while (i < n && i > 0 && (s[i - 1] == '\\' || (s[i - 1] == '\r' && i > 1 && s[i - 2] == '\\'))) {
+                i = lineEnd(i + 1);
+            }
+            emit(start, i, CodeTokenClass::Meta);
+            continue;
+        }
+        if (c == '#' && lang.hashDirectives && isAlpha(at(i + 1))) {
+            i = identifierEnd(i + 1);
+            emit(start, i, CodeTokenClass::Meta);
+            continue;
+        }
+        if (c == '#' && lang.rustSyntax && (at(i + 1) == '[' || (at(i + 1) == '!' && at(i + 2) == '['))) {
+            // An attribute, up to its closing bracket on the same line
+            size_t end = lineEnd(i);
+            int depth = 0;
+            for (i = i + 1; i < end; i++) {
+                if (s[i] == '[') {
+                    depth++;
+                } else if (s[i] == ']' && --depth == 0) {
+                    i++;
+                    break;
+                }
+            }
+            emit(start, i, CodeTokenClass::Meta);
+            continue;
+        }
+        if (is(c, kIdentifierQuote)) {
+            i = stringEnd(i + 1, static_cast<char>(c));
+            continue;
+        }
+        if (is(c, kQuote)) {
+            if (lang.rustSyntax && c == '\'') {
+                // 'a' and '\n' are characters, 'a a lifetime
+                if (at(i + 1) == '\\' || (at(i + 1) != '\'' && at(i + 2) == '\'')) {
+                    i = stringEnd(i + 1, '\'');
+                    emit(start, i, CodeTokenClass::String);
+                } else {
+                    i = identifierEnd(i + 1);
+                }
+                continue;
+            }
+            if (lang.tripleQuotes && at(i + 1) == c && at(i + 2) == c) {
+                i = tripleStringEnd(i + 3, static_cast<char>(c));
+            } else {
+                i = stringEnd(i + 1, static_cast<char>(c));
+            }
+            emit(start, i, CodeTokenClass::String);
+            continue;
+        }
+        if (isDigit(c) || (c == '.' && isDigit(at(i + 1)) && (i == 0 || !isIdentifierChar(at(i - 1))))) {
+            i = numberEnd(i);
+            emit(start, i, CodeTokenClass::Number);
+            continue;
+        }
+        if (lang.annotation && c == static_cast<unsigned char>(lang.annotation) && isIdentifierStart(at(i + 1))) {
+            // @name, @qualified.name
+            i = identifierEnd(i + 1);
+            while (at(i) == '.' && isIdentifierStart(at(i + 1))) {
+                i = identifierEnd(i + 1);
+            }
+            emit(start, i, CodeTokenClass::Meta);
+            continue;
+        }
+        if (lang.grammar == Grammar::Shell) {
+            if (c == '\\') {
+                i += 2;
+                continue;
+            }
+            if (c == '$') {
+                size_t end = shellVariableEnd(i);
+                if (end > i) {
+                    i = end;
+                    emit(start, i, CodeTokenClass::Variable);
+                    continue;
+                }
+            }
+        }
+        if (isIdentifierStart(c)) {
+            i = identifierEnd(i);
+            if (lang.stringPrefixes && i - start <= 2 && (at(i) == '"' || at(i) == '\'')) {
+                // r"...", f'...', rb"""..."""
+                bool prefix = true;
+                for (size_t j = start; j < i; j++) {
+                    prefix = prefix && contains("rRbBfFuU", s[j]);
+                }
+                if (prefix) {
+                    char quote = s[i];
+                    i = lang.tripleQuotes && at(i + 1) == static_cast<unsigned char>(quote) &&
+                                at(i + 2) == static_cast<unsigned char>(quote)
+                            ? tripleStringEnd(i + 3, quote)
+                            : stringEnd(i + 1, quote);
+                    emit(start, i, CodeTokenClass::String);
+                    continue;
+                }
+            }
+            if (lang.cppStrings && i - start <= 3 && (at(i) == '"' || at(i) == '\'')) {
+                if (size_t end = cppString(start, i)) {
+                    i = end;
+                    emit(start, i, CodeTokenClass::String);
+                    continue;
+                }
+            }
+            if (lang.rustSyntax) {
+                if (size_t end = rustString(start, i)) {
+                    i = end;
+                    emit(start, i, CodeTokenClass::String);
+                    continue;
+                }
+                if (at(i) == '!' && at(i + 1) != '=') {
+                    // println!, vec!
+                    i++;
+                    emit(start, i, CodeTokenClass::BuiltIn);
+                    continue;
+                }
+            }
+            if (declared != Declares::Nothing) {
+                emit(start, i, declared == Declares::Function ? CodeTokenClass::Function : CodeTokenClass::Type);
+                continue;
+            }
+            if (const auto* entry = lookup(std::string_view(s + start, i - start))) {
+                emit(start, i, entry->cls);
+                declaring = entry->declares;
+            } else if (lang.grammar != Grammar::Shell && at(skipBlanks(i)) == '(') {
+                emit(start, i, CodeTokenClass::Function);
+            } else if (lang.capitalizedTypes && isUpper(c)) {
+                emit(start, i, CodeTokenClass::Type);
+            }
+            continue;
+        }
+        i++;
+    }
+}
+
+void Lexer::json() {
+    size_t i = 0;
+    while (i < n) {
+        unsigned char c = at(i);
+        size_t start = i;
+        if (c == '"') {
+            i = stringEnd(i + 1, '"');
+            // A string followed by a colon is a key
+            size_t next = i;
+            while (next < n && (isSpace(at(next)) || s[next] == '\n')) {
+                next++;
+            }
+            emit(start, i, at(next) == ':' ? CodeTokenClass::Attribute : CodeTokenClass::String);
+        } else if (isDigit(c) || (c == '-' && isDigit(at(i + 1)))) {
+            i = numberEnd(c == '-' ? i + 1 : i);
+            emit(start, i, CodeTokenClass::Number);
+        } else if (isAlpha(c)) {
+            i = identifierEnd(i);
+            if (lang.words.find(std::string_view(s + start, i - start))) {
+                emit(start, i, CodeTokenClass::Literal);
+            }
+        } else if (c == '/' && at(i + 1) == '/') {
+            // JSON with comments
+            i = lineEnd(i);
+            emit(start, i, CodeTokenClass::Comment);
+        } else if (c == '/' && at(i + 1) == '*') {
+            i = blockCommentEnd(i + 2);
+            emit(start, i, CodeTokenClass::Comment);
+        } else {
+            i++;
+        }
+    }
+}
+
+// Emits a plain or flow scalar of YAML: a key, a number, a literal or a string
+void Lexer::yamlScalar(size_t start, size_t end, bool key) {
+    while (end > start && isSpace(at(end - 1))) {
+        end--;
+    }
+    if (end == start) {
+        return;
+    }
+    if (key) {
+        emit(start, end, CodeTokenClass::Attribute);
+        return;
+    }
+    std::string_view word(s + start, end - start);
+    if (lookup(word)) {
+        emit(start, end, CodeTokenClass::Literal);
+        return;
+    }
+    if (word == ".inf" || word == "-.inf" || word == ".nan") {
+        emit(start, end, CodeTokenClass::Number);
+        return;
+    }
+    size_t digits = (word[0] == '-' || word[0] == '+') ? start + 1 : start;
+    if (digits < end && (isDigit(at(digits)) || (at(digits) == '.' && isDigit(at(digits + 1)))) &&
+        numberEnd(digits) == end) {
+        emit(start, end, CodeTokenClass::Number);
+        return;
+    }
+    emit(start, end, CodeTokenClass::String);
+}
+
+// Tokenizes the value of a YAML line from i to the end of the line; returns
+// where the next line to look at starts (after a block scalar, its lines)
+size_t Lexer::yamlValue(size_t i, size_t end, size_t indent) {
+    i = skipBlanks(i);
+    // Anchors, aliases and tags
+    while (i < end && (s[i] == '&' || s[i] == '*' || s[i] == '!')) {
+        size_t start = i;
+        while (i < end && !isSpace(at(i))) {
+            i++;
+        }
+        emit(start, i, CodeTokenClass::Type);
+        i = skipBlanks(i);
+    }
+    if (i >= end) {
+        return end;
+    }
+    size_t start = i;
+    char c = s[i];
+    if (c == '#') {
+        emit(i, end, CodeTokenClass::Comment);
+        return end;
+    }
+    if (c == '"' || c == '\'') {
+        i = stringEnd(i + 1, c);
+        emit(start, i, CodeTokenClass::String);
+        // An escaped line break continues the string on the next line
+        if (i > end) {
+            end = lineEnd(i);
+        }
+        i = skipBlanks(i);
+        if (at(i) == '#') {
+            emit(i, end, CodeTokenClass::Comment);
+        }
+        return end;
+    }
+    if (c == '|' || c == '>') {
+        // Block scalar: the following lines indented deeper are its text
+        emit(start, start + 1, CodeTokenClass::Meta);
+        size_t line = end < n ? end + 1 : n;
+        while (line < n) {
+            size_t lineEndAt = lineEnd(line);
+            size_t text = skipBlanks(line);
+            if (text < lineEndAt && text - line <= indent) {
+                break;
+            }
+            emit(text, lineEndAt, CodeTokenClass::String);
+            line = lineEndAt < n ? lineEndAt + 1 : n;
+        }
+        return line;
+    }
+    if (c == '[' || c == '{') {
+        // Flow collection: scalars between , [ ] { }, keys before a colon
+        while (i < end) {
+            c = s[i];
+            if (c == '"' || c == '\'') {
+                size_t stringStart = i;
+                i = stringEnd(i + 1, c);
+                emit(stringStart, i, CodeTokenClass::String);
+                if (i > end) {
+                    end = lineEnd(i);
+                }
+            } else if (c == '#' && isSpace(at(i - 1))) {
+                emit(i, end, CodeTokenClass::Comment);
+                break;
+            } else if (contains(",[]{}", c) || isSpace(static_cast<unsigned char>(c))) {
+                i++;
+            } else {
+                size_t scalarStart = i;
+                while (i < end && !contains(",[]{}", s[i]) && !(s[i] == ':' && (i + 1 == end || isSpace(at(i + 1))))) {
+                    i++;
+                }
+                yamlScalar(scalarStart, i, at(i) == ':');
+                if (at(i) == ':') {
+                    i++;
+                }
+            }
+        }
+        return end;
+    }
+    // Plain scalar, up to a comment
+    while (i < end && !(s[i] == '#' && isSpace(at(i - 1)))) {
+        i++;
+    }
+    yamlScalar(start, i, false);
+    if (i < end) {
+        emit(i, end, CodeTokenClass::Comment);
+    }
+    return end;
+}
+
+void Lexer::yaml() {
+    size_t line = 0;
+    while (line < n) {
+        size_t end = lineEnd(line);
+        size_t next = end < n ? end + 1 : n;
+        size_t i = skipBlanks(line);
+        size_t indent = i - line;
+        if (i == end) {
+            line = next;
+            continue;
+        }
+        if (s[i] == '#') {
+            emit(i, end, CodeTokenClass::Comment);
+            line = next;
+            continue;
+        }
+        if (indent == 0 && (startsWith(i, "---") || startsWith(i, "...")) && (i + 3 == end || isSpace(at(i + 3)))) {
+            emit(i, i + 3, CodeTokenClass::Meta);
+            line = next;
+            continue;
+        }
+        if (indent == 0 && s[i] == '%') {
+            emit(i, end, CodeTokenClass::Meta);
+            line = next;
+            continue;
+        }
+        // Sequence entries, "- - item" included
+        while (at(i) == '-' && (i + 1 == end || isSpace(at(i + 1)))) {
+            i = skipBlanks(i + 1);
+            indent = i - line;
+        }
+        // A key: a quoted or plain scalar followed by ": " or a colon at the
+        // end of the line
+        size_t keyEnd = i;
+        if (at(i) == '"' || at(i) == '\'') {
+            keyEnd = stringEnd(i + 1, s[i]);
+        } else if (at(i) != '[' && at(i) != '{') {
+            while (keyEnd < end && !(s[keyEnd] == ':' && (keyEnd + 1 == end || isSpace(at(keyEnd + 1)))) &&
+                   !(s[keyEnd] == '#' && keyEnd > i && isSpace(at(keyEnd - 1)))) {
+                keyEnd++;
+            }
+        }
+        size_t colon = skipBlanks(keyEnd);
+        if (colon < end && s[colon] == ':' && keyEnd > i) {
+            yamlScalar(i, keyEnd, true);
+            line = yamlValue(colon + 1, end, indent);
+        } else {
+            line = yamlValue(i, end, indent);
+        }
+        line = std::max(line, next);
+    }
+}
+
+void Lexer::diff() {
+    size_t line = 0;
+    while (line < n) {
+        size_t end = lineEnd(line);
+        switch (s[line]) {
+            case '+':
+                emit(line, end, startsWith(line, "+++") ? CodeTokenClass::Comment : CodeTokenClass::Addition);
+                break;
+            case '-':
+                emit(line, end, startsWith(line, "---") ? CodeTokenClass::Comment : CodeTokenClass::Deletion);
+                break;
+            case '!':
+                emit(line, end, CodeTokenClass::Addition);
+                break;
+            case '@':
+                if (startsWith(line, "@@")) {
+                    emit(line, end, CodeTokenClass::Meta);
+                }
+                break;
+            default:
+                if (startsWith(line, "diff ") || startsWith(line, "index ") || startsWith(line, "Index: ") ||
+                    startsWith(line, "===") || startsWith(line, "*** ")) {
+                    emit(line, end, CodeTokenClass::Comment);
+                }
+                break;
+        }
+        line = end < n ? end + 1 : n;
+    }
+}
+
+} // namespace
+
+const CodeLanguage* CodeTokenizer::findLanguage(std::string_view name) {
+    char lower[16];
+    if (name.empty() || name.size() > sizeof(lower)) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < name.size(); i++) {
+        lower[i] = isUpper(static_cast<unsigned char>(name[i])) ? static_cast<char>(name[i] | 0x20) : name[i];
+    }
+    std::string_view key(lower, name.size());
+    for (const auto& language : languages()) {
+        for (auto alias : language.aliases) {
+            if (alias == key) {
+                return &language;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::string_view CodeTokenizer::languageName(const CodeLanguage& language) {
+    return language.name;
+}
+
+void CodeTokenizer::tokenize(const CodeLanguage& language, const char* code, size_t size,
+                             std::vector<CodeToken>& tokens) {
+    Lexer lexer(language, code, size, tokens);
+    switch (language.grammar) {
+        case Grammar::Json:
+            lexer.json();
+            break;
+        case Grammar::Yaml:
+            lexer.yaml();
+            break;
+        case Grammar::Diff:
+            lexer.diff();
+            break;
+        default:
+            lexer.code();
+            break;
+    }
+}
+
+void CodeTokenizer::toUtf16(const char* code, size_t size, std::vector<CodeToken>& tokens) {
+    auto bytes = reinterpret_cast<const unsigned char*>(code);
+    // Offsets in the ASCII prefix are the same in both units, code is often
+    // all ASCII
+    size_t ascii = 0;
+    for (uint64_t word; size - ascii >= 8; ascii += 8) {
+        std::memcpy(&word, code + ascii, 8);
+        if (word & 0x8080808080808080ull) {
+            break;
+        }
+    }
+    while (ascii < size && bytes[ascii] < 0x80) {
+        ascii++;
+    }
+    if (ascii == size) {
+        return;
+    }
+    
+    size_t offset = 0;
+    uint32_t units = 0;
+    // Characters past the BMP take two units (a surrogate pair). Invalid
+    // UTF-8 takes one per maximal subpart, the U+FFFD the JSON has in its
+    // place. Tokens are in order, so `to` never goes back.
+    auto advance = [&](size_t to) {
+        to = std::min(to, size);
+        if (to <= ascii) {
+            offset = to;
+            units = static_cast<uint32_t>(to);
+            return units;
+        }
+        if (offset < ascii) {
+            offset = ascii;
+            units = static_cast<uint32_t>(ascii);
+        }
+        while (offset < to) {
+            if (bytes[offset] < 0x80) {
+                offset++;
+                units++;
+                continue;
+            }
+            auto sequence = InputNormalizer::sequenceAt(code + offset, code + size);
+            offset += sequence.length;
+            units += sequence.valid && sequence.length == 4 ? 2 : 1;
+        }
+        return units;
+    };
+    for (auto& token : tokens) {
+        uint32_t start = advance(token.offset);
+        uint32_t end = advance(static_cast<size_t>(token.offset) + token.length);
+        token.offset = start;
+        token.length = end - start;
+    }
+}
+
+} // namespace margelo::nitro::hypermarkdown
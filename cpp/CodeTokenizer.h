@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::hypermarkdown {
+
+// Class of a code token. The values are serialized, and the JS side maps
+// them to highlight.js class names (CODE_TOKEN_CLASSES in src/types/ast.ts),
+// so existing syntax themes style them: only append to this list.
+enum class CodeTokenClass : uint8_t {
+    Keyword,    // hljs-keyword
+    String,     // hljs-string
+    Comment,    // hljs-comment
+    Number,     // hljs-number
+    Literal,    // hljs-literal: true, null, None, ...
+    BuiltIn,    // hljs-built_in: console, len, println!, ...
+    Type,       // hljs-type
+    Function,   // hljs-title: declared and called functions
+    Attribute,  // hljs-attr: JSON and YAML keys
+    Meta,       // hljs-meta: preprocessor lines, decorators, attributes
+    Variable,   // hljs-variable: shell variables
+    Addition,   // hljs-addition: added diff lines
+    Deletion    // hljs-deletion: removed diff lines
+};
+
+// A highlighted range of a code block's text. Text between tokens is plain.
+struct CodeToken {
+    uint32_t offset;
+    uint32_t length;
+    CodeTokenClass cls;
+};
+
+struct CodeLanguage;
+
+// Syntax highlighting of fenced code blocks in native code (highlightCode),
+// so the renderer only has to style ranges of the text instead of running
+// highlight.js. Each language is a hand-written lexer over keyword tables,
+// covering the constructs themes color: comments, strings, numbers,
+// keywords and literals, types, function names, annotations. It does not
+// parse, so it cannot tell apart everything a grammar can (JS regex
+// literals, for one, are plain text), but it is linear and never fails.
+class CodeTokenizer {
+public:
+    // The language of a fence info string like "ts" or "Python", or null
+    // if there is no lexer for it
+    static const CodeLanguage* findLanguage(std::string_view name);
+    
+    // Canonical name of a language, e.g. "typescript" for "ts"
+    static std::string_view languageName(const CodeLanguage& language);
+    
+    // Appends the tokens of `code` to `tokens`, in order and without
+    // overlaps. Offsets and lengths are in bytes.
+    static void tokenize(const CodeLanguage& language, const char* code, size_t size, std::vector<CodeToken>& tokens);
+    
+    // Converts byte offsets and lengths of tokens of `code` to UTF-16 code
+    // units, i.e. indices into the JS string of the code. Each invalid
+    // UTF-8 sequence counts as the U+FFFD replacing it in the JSON AST.
+    static void toUtf16(const char* code, size_t size, std::vector<CodeToken>& tokens);
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,138 @@
+#include "DisplayList.h"
+#include <utility>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Appends the records of one tree
+class Builder {
+public:
+    Builder(DisplayList& list, const LineIndex* lines) : list(list), lines(lines) {}
+    
+    void append(const MarkdownNode* root) {
+        int32_t depth = 0;
+        walkTree(
+            root,
+            [&](const MarkdownNode* node, size_t) {
+                appendRecord(node, depth++);
+                return true;
+            },
+            [&](const MarkdownNode*) { depth--; });
+    }
+
+private:
+    DisplayList& list;
+    const LineIndex* lines;
+    // A document has a few dozen node types at most, a linear search
+    // beats hashing every type name
+    std::vector<std::pair<std::string_view, int32_t>> types;
+    
+    int32_t string(std::string_view value) {
+        list.strings.push_back(value);
+        return static_cast<int32_t>(list.strings.size() - 1);
+    }
+    
+    int32_t type(std::string_view name) {
+        for (const auto& [interned, index] : types) {
+            if (interned == name) {
+                return index;
+            }
+        }
+        types.emplace_back(name, string(name));
+        return types.back().second;
+    }
+    
+    void appendRecord(const MarkdownNode* node, int32_t depth) {
+        auto& ops = list.ops;
+        list.nodeCount++;
+        ops.push_back(depth);
+        if (!node) {
+            ops.push_back(-1);
+            ops.push_back(0);
+            return;
+        }
+        ops.push_back(type(node->type));
+        size_t mask = ops.size();
+        ops.push_back(0);
+        uint32_t fields = 0;
+        auto optionalString = [&](DisplayField field, const std::optional<std::string>& value) {
+            if (value) {
+                fields |= field;
+                ops.push_back(string(*value));
+            }
+        };
+        auto optionalNumber = [&](DisplayField field, const auto& value) {
+            if (value) {
+                fields |= field;
+                ops.push_back(static_cast<int32_t>(*value));
+            }
+        };
+        
+        optionalString(kFieldContent, node->content);
+        optionalNumber(kFieldLevel, node->level);
+        optionalString(kFieldHref, node->href);
+        optionalString(kFieldSrc, node->src);
+        optionalString(kFieldAlt, node->alt);
+        optionalString(kFieldTitle, node->title);
+        optionalString(kFieldLanguage, node->language);
+        if (!node->tokens.empty()) {
+            fields |= kFieldTokens;
+            ops.push_back(static_cast<int32_t>(node->tokens.size() * 3));
+            for (const auto& token : node->tokens) {
+                ops.insert(ops.end(), {static_cast<int32_t>(token.offset), static_cast<int32_t>(token.length),
+                                       static_cast<int32_t>(token.cls)});
+            }
+        }
+        if (!node->runs.empty()) {
+            fields |= kFieldRuns;
+            ops.push_back(static_cast<int32_t>(node->runs.size() * 3));
+            for (const auto& run : node->runs) {
+                ops.insert(ops.end(), {static_cast<int32_t>(run.length), run.styles, run.link});
+            }
+        }
+        if (!node->links.empty()) {
+            fields |= kFieldLinks;
+            ops.push_back(static_cast<int32_t>(node->links.size()));
+            for (const auto& link : node->links) {
+                ops.push_back((link.href ? 1 : 0) | (link.src ? 2 : 0) | (link.title ? 4 : 0));
+                for (const auto* value : {&link.href, &link.src, &link.title}) {
+                    if (*value) {
+                        ops.push_back(string(**value));
+                    }
+                }
+            }
+        }
+        optionalNumber(kFieldOrdered, node->ordered);
+        optionalNumber(kFieldStart, node->start);
+        optionalNumber(kFieldChecked, node->checked);
+        optionalNumber(kFieldAlign, node->align);
+        optionalNumber(kFieldIsHeader, node->isHeader);
+        if (node->position) {
+            fields |= kFieldPosition;
+            ops.push_back(static_cast<int32_t>(node->position->start));
+            ops.push_back(static_cast<int32_t>(node->position->end));
+            if (lines) {
+                fields |= kFieldLocation;
+                auto start = lines->locate(node->position->start);
+                auto end = lines->locate(node->position->end);
+                ops.insert(ops.end(), {static_cast<int32_t>(start.line), static_cast<int32_t>(start.column),
+                                       static_cast<int32_t>(end.line), static_cast<int32_t>(end.column)});
+            }
+        }
+        ops[mask] = static_cast<int32_t>(fields);
+    }
+};
+
+} // namespace
+
+DisplayList DisplayList::build(const std::vector<std::shared_ptr<MarkdownNode>>& nodes, const LineIndex* lines) {
+    DisplayList list;
+    Builder builder(list, lines);
+    for (const auto& node : nodes) {
+        builder.append(node.get());
+    }
+    return list;
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// Fields of a display list record, one bit each in the record's field mask.
+// The values of the fields that are present follow the mask in this order.
+// The values are serialized (DISPLAY_LIST_FIELDS in src/types/ast.ts).
+enum DisplayField : uint32_t {
+    kFieldContent = 1 << 0,
+    kFieldLevel = 1 << 1,
+    kFieldHref = 1 << 2,
+    kFieldSrc = 1 << 3,
+    kFieldAlt = 1 << 4,
+    kFieldTitle = 1 << 5,
+    kFieldLanguage = 1 << 6,
+    kFieldTokens = 1 << 7,      // count, then the flat (offset, length, class) triples
+    kFieldRuns = 1 << 8,        // count, then the flat (length, styles, link) triples
+    kFieldLinks = 1 << 9,       // count, then per link a mask (href 1, src 2, title 4) and its strings
+    kFieldOrdered = 1 << 10,
+    kFieldStart = 1 << 11,
+    kFieldChecked = 1 << 12,
+    kFieldAlign = 1 << 13,      // TableCellAlign: default 0, left 1, center 2, right 3
+    kFieldIsHeader = 1 << 14,
+    kFieldPosition = 1 << 15,   // start and end offset
+    kFieldLocation = 1 << 16    // start line and column, end line and column
+};
+
+// A node tree flattened into one preorder sequence of records (displayList),
+// so that neither the JSON nor any other encoding of it nests: the JS side
+// rebuilds the tree in a single loop. Each node is a record of integers
+//
+//   depth, type, fields, values...
+//
+// where `depth` is 0 for the top-level nodes and the parent's plus one for
+// children, so the parent of a record is the closest preceding record with
+// a smaller depth. `type` indexes `strings`, or is -1 for a null node, and
+// `fields` is a mask of DisplayField bits. String values index `strings`,
+// booleans are 0 or 1. Node type names are interned, all other strings
+// are entries of their own.
+//
+// The records are plain int32 values and the strings views of the tree's
+// strings, so writing the list out is a linear copy. The tree has to
+// outlive its list.
+struct DisplayList {
+    std::vector<int32_t> ops;
+    std::vector<std::string_view> strings;
+    size_t nodeCount = 0;
+    
+    // Flattens the trees of `nodes`. Positions are written as offsets, plus
+    // lines and columns when `lines` indexes the parsed input.
+    static DisplayList build(const std::vector<std::shared_ptr<MarkdownNode>>& nodes, const LineIndex* lines = nullptr);
+    
+    // Memory held by the list, for memory accounting
+    size_t byteSize() const {
+        return ops.capacity() * sizeof(int32_t) + strings.capacity() * sizeof(std::string_view);
+    }
+};
+
+} // namespace margelo::nitro::hypermarkdown
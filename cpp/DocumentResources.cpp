@@ -0,0 +1,182 @@
+#include "DocumentResources.h"
+#include "InputNormalizer.h"
+#include <string_view>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+constexpr size_t kNotReported = SIZE_MAX;
+
+// State of the extraction pass, in md4c's userdata
+class ResourceCollector {
+public:
+    ResourceCollector(const std::string& input, unsigned flags, std::vector<DocumentResource>& resources)
+        : input(input.data()), resources(resources) {
+        // The characters md4c starts looking for a link at
+        triggers['['] = true;
+        triggers['<'] = true;
+        triggers[':'] = (flags & MD_FLAG_PERMISSIVEURLAUTOLINKS) != 0;
+        triggers['@'] = (flags & MD_FLAG_PERMISSIVEEMAILAUTOLINKS) != 0;
+        www = (flags & MD_FLAG_PERMISSIVEWWWAUTOLINKS) != 0;
+    }
+    
+    static int enterBlock(MD_BLOCKTYPE, void*, void*) { return 0; }
+    static int leaveBlock(MD_BLOCKTYPE, void*, void*) { return 0; }
+    
+    static int enterSpan(MD_SPANTYPE type, void* detail, void* userdata) {
+        if (type == MD_SPAN_A || type == MD_SPAN_IMG) {
+            static_cast<ResourceCollector*>(userdata)->enter(type, detail);
+        }
+        return 0;
+    }
+    
+    static int leaveSpan(MD_SPANTYPE type, void*, void* userdata) {
+        if (type == MD_SPAN_A || type == MD_SPAN_IMG) {
+            static_cast<ResourceCollector*>(userdata)->leave();
+        }
+        return 0;
+    }
+    
+    static int text(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
+        auto* collector = static_cast<ResourceCollector*>(userdata);
+        if (collector->images > 0) {
+            collector->appendAlt(type, text, size);
+        }
+        return 0;
+    }
+    
+    static void sourceOffset(MD_OFFSET offset, void* userdata) {
+        static_cast<ResourceCollector*>(userdata)->offset = offset;
+    }
+    
+    static int skipContents(MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end, void* userdata) {
+        if (type == MD_BLOCK_CODE || type == MD_BLOCK_HTML || type == MD_BLOCK_HR || (beg == 0 && end == 0)) {
+            return 1;
+        }
+        return !static_cast<ResourceCollector*>(userdata)->mayHoldLink(beg, end);
+    }
+
+private:
+    struct OpenSpan {
+        size_t resource;    // kNotReported inside the description of an image
+        bool image;
+    };
+    
+    const char* input;
+    std::vector<DocumentResource>& resources;
+    bool triggers[256] = {};
+    bool www = false;
+    uint32_t offset = 0;
+    std::vector<OpenSpan> open;
+    size_t images = 0;      // open image spans
+    size_t altOwner = 0;    // the image the description text goes to
+    
+    static std::optional<std::string> optional(const MD_ATTRIBUTE& attribute) {
+        return attribute.size > 0 ? std::optional<std::string>(std::string(attribute.text, attribute.size))
+                                  : std::nullopt;
+    }
+    
+    void enter(MD_SPANTYPE type, void* detail) {
+        bool image = type == MD_SPAN_IMG;
+        if (images > 0) {
+            open.push_back({kNotReported, image});
+        } else {
+            DocumentResource resource;
+            resource.image = image;
+            resource.start = offset;
+            if (image) {
+                auto* img = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
+                resource.url.assign(img->src.text, img->src.size);
+                resource.title = optional(img->title);
+                altOwner = resources.size();
+            } else {
+                auto* a = static_cast<MD_SPAN_A_DETAIL*>(detail);
+                resource.url.assign(a->href.text, a->href.size);
+                resource.title = optional(a->title);
+            }
+            open.push_back({resources.size(), image});
+            resources.push_back(std::move(resource));
+        }
+        images += image;
+    }
+    
+    void leave() {
+        OpenSpan span = open.back();
+        open.pop_back();
+        images -= span.image;
+        if (span.resource != kNotReported) {
+            resources[span.resource].end = offset;
+        }
+    }
+    
+    void appendAlt(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size) {
+        auto& alt = resources[altOwner].alt;
+        if (!alt) {
+            alt.emplace();
+        }
+        switch (type) {
+            case MD_TEXT_SOFTBR:
+            case MD_TEXT_BR:
+                *alt += ' ';
+                break;
+            case MD_TEXT_NULLCHAR:
+                break;
+            default:
+                alt->append(text, size);
+                break;
+        }
+    }
+    
+    // Whether the lines [beg, end) have a character a link or an autolink
+    // could start at; a paragraph of plain prose does not
+    bool mayHoldLink(uint32_t beg, uint32_t end) const {
+        for (uint32_t p = beg; p < end; p++) {
+            if (triggers[static_cast<unsigned char>(input[p])]) {
+                return true;
+            }
+        }
+        return www && std::string_view(input + beg, end - beg).find("www.") != std::string_view::npos;
+    }
+};
+
+} // namespace
+
+DocumentResources DocumentResources::extract(const std::string& content, const InternalParserOptions& options) {
+    DocumentResources extracted;
+    if (content.size() > options.maxInputSize) {
+        extracted.error = ParseError("Input exceeds maximum size limit");
+        return extracted;
+    }
+    
+    std::string normalized;
+    bool isNormalized = options.normalizeInput && InputNormalizer::normalize(content, normalized);
+    const std::string& source = isNormalized ? normalized : content;
+    
+    unsigned flags = MarkdownParser::optionsToFlags(options);
+    ResourceCollector collector(source, flags, extracted.resources);
+    MD_PARSER parser = {
+        0,
+        flags,
+        ResourceCollector::enterBlock,
+        ResourceCollector::leaveBlock,
+        ResourceCollector::enterSpan,
+        ResourceCollector::leaveSpan,
+        ResourceCollector::text,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        ResourceCollector::sourceOffset,
+        ResourceCollector::skipContents
+    };
+    if (md_parse(source.c_str(), static_cast<MD_SIZE>(source.size()), &parser, &collector) != 0) {
+        extracted.resources.clear();
+        extracted.error = ParseError("Failed to parse markdown");
+        return extracted;
+    }
+    extracted.success = true;
+    return extracted;
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// An image or a link of a document. `url` is the image's src or the
+// link's href, as in the AST; `alt` is the plain text of an image's
+// description, line breaks as spaces. `start` and `end` are the byte
+// offsets of the whole span in the input (of the normalized input with
+// normalizeInput), from the "!" or "[" to after the ")" or "]".
+struct DocumentResource {
+    bool image = false;
+    std::string url;
+    std::optional<std::string> alt;
+    std::optional<std::string> title;
+    uint32_t start = 0;
+    uint32_t end = 0;
+};
+
+// The images and links of a document in document order, for prefetching,
+// without an AST: md4c calls back for the spans and text of images and
+// links only, and leaf blocks that cannot hold one are skipped before
+// their inline analysis.
+//
+// Links are inline, reference and autolinks (with the GFM flags, the
+// permissive ones too), not wiki links. The images and links inside the
+// description of an image are not rendered, so not reported; their text
+// goes into its alt.
+struct DocumentResources {
+    bool success = false;
+    std::vector<DocumentResource> resources;
+    std::optional<ParseError> error;
+    
+    // Runs md4c over `content` with the md4c flags and the maxInputSize and
+    // normalizeInput settings of `options`
+    static DocumentResources extract(const std::string& content,
+                                     const InternalParserOptions& options = InternalParserOptions());
+};
+
+} // namespace margelo::nitro::hypermarkdown
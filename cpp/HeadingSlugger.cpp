@@ -0,0 +1,147 @@
+#include "HeadingSlugger.h"
+#include "InputNormalizer.h"
+#include <cstdint>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Whether a character is left out of slugs: punctuation, symbols and
+// controls. '-' and '_' stay, ' ' is handled before.
+bool isRemoved(uint32_t c) {
+    if (c < 0x80) {
+        bool alphanumeric = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        return !alphanumeric && c != '-' && c != '_';
+    }
+    if (c < 0x100) {
+        // Latin-1 keeps its letters and ª µ º
+        return c <= 0xA9 || (c >= 0xAB && c <= 0xB4) || (c >= 0xB6 && c <= 0xB9) || (c >= 0xBB && c <= 0xBF) ||
+               c == 0xD7 || c == 0xF7;
+    }
+    if (c >= 0x3000 && c <= 0x303F) {
+        // CJK punctuation, but for the ideographic marks and numbers
+        return !(c >= 0x3005 && c <= 0x3007) && !(c >= 0x3021 && c <= 0x3029) && !(c >= 0x3031 && c <= 0x3035) &&
+               !(c >= 0x3038 && c <= 0x303C);
+    }
+    if (c >= 0xFF01 && c <= 0xFF65) {
+        // Fullwidth punctuation, but for the fullwidth letters and digits
+        return !(c >= 0xFF10 && c <= 0xFF19) && !(c >= 0xFF21 && c <= 0xFF3A) && !(c >= 0xFF41 && c <= 0xFF5A) &&
+               c != 0xFF3F;
+    }
+    return (c >= 0x2000 && c <= 0x206F) ||   // general punctuation
+           (c >= 0x20A0 && c <= 0x20CF) ||   // currency
+           (c >= 0x2190 && c <= 0x23FF) ||   // arrows, math operators, technical
+           (c >= 0x2500 && c <= 0x27BF) ||   // box drawing, shapes, dingbats
+           (c >= 0x2900 && c <= 0x2BFF) ||   // arrows, math, misc symbols
+           (c >= 0xFE00 && c <= 0xFE0F) ||   // variation selectors
+           (c >= 0xFE10 && c <= 0xFE1F) ||   // vertical forms
+           (c >= 0xFE30 && c <= 0xFE6F) ||   // CJK compatibility and small forms
+           (c >= 0x1F000 && c <= 0x1FAFF);   // emoji and pictographs
+}
+
+uint32_t toLower(uint32_t c) {
+    if (c < 0x80) {
+        return c >= 'A' && c <= 'Z' ? c + 0x20 : c;
+    }
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7) {
+        return c + 0x20;
+    }
+    if (c >= 0x100 && c <= 0x17F) {
+        if (c == 0x178) {
+            return 0xFF;
+        }
+        // Latin Extended-A pairs capitals and small letters, the capital
+        // first; the pairs shift by one around ĸ and ŉ
+        bool capital = (c <= 0x137 || (c >= 0x14A && c <= 0x177)) ? c % 2 == 0 : c % 2 == 1;
+        return capital && c != 0x130 && c != 0x138 && c != 0x149 && c != 0x17F ? c + 1 : c;
+    }
+    if (c >= 0x391 && c <= 0x3AB && c != 0x3A2) {
+        return c + 0x20;
+    }
+    switch (c) {
+        case 0x386: return 0x3AC;
+        case 0x388: case 0x389: case 0x38A: return c + 0x25;
+        case 0x38C: return 0x3CC;
+        case 0x38E: case 0x38F: return c + 0x3F;
+        default: break;
+    }
+    if (c >= 0x400 && c <= 0x40F) {
+        return c + 0x50;
+    }
+    if (c >= 0x410 && c <= 0x42F) {
+        return c + 0x20;
+    }
+    if (c >= 0xFF21 && c <= 0xFF3A) {
+        return c + 0x20;
+    }
+    return c;
+}
+
+} // namespace
+
+std::string HeadingSlugger::slug(std::string_view text) {
+    std::string base = githubSlug(text);
+    std::string result = base;
+    while (occurrences.count(result)) {
+        result = base + "-" + std::to_string(++occurrences[base]);
+    }
+    occurrences.emplace(result, 0);
+    return result;
+}
+
+std::string HeadingSlugger::githubSlug(std::string_view text) {
+    std::string slug;
+    slug.reserve(text.size());
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        auto sequence = InputNormalizer::sequenceAt(p, end);
+        if (!sequence.valid) {
+            // Kept as it is, like the rest of the text the slug is made of
+            slug.append(p, sequence.length);
+        } else if (*p == ' ') {
+            slug += '-';
+        } else {
+            uint32_t c = InputNormalizer::decode(p, sequence.length);
+            if (!isRemoved(c)) {
+                InputNormalizer::appendUtf8(slug, toLower(c));
+            }
+        }
+        p += sequence.length;
+    }
+    return slug;
+}
+
+void HeadingSlugger::appendEntity(std::string& out, std::string_view entity) {
+    if (entity.size() > 3 && entity[1] == '#') {
+        bool hex = entity[2] == 'x' || entity[2] == 'X';
+        uint32_t c = 0;
+        for (size_t i = hex ? 3 : 2; i + 1 < entity.size(); i++) {
+            char digit = entity[i];
+            uint32_t value = digit >= '0' && digit <= '9' ? digit - '0' : (digit | 0x20) - 'a' + 10;
+            c = c * (hex ? 16 : 10) + value;
+            if (c > 0x10FFFF) {
+                break;
+            }
+        }
+        // As CommonMark has it, invalid characters and NUL are U+FFFD
+        bool valid = c != 0 && c <= 0x10FFFF && !(c >= 0xD800 && c <= 0xDFFF);
+        InputNormalizer::appendUtf8(out, valid ? c : 0xFFFD);
+        return;
+    }
+    static const struct {
+        std::string_view name;
+        const char* text;
+    } kEntities[] = {
+        {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}, {"&nbsp;", "\xC2\xA0"},
+    };
+    for (const auto& known : kEntities) {
+        if (entity == known.name) {
+            out += known.text;
+            return;
+        }
+    }
+    out.append(entity);
+}
+
+} // namespace margelo::nitro::hypermarkdown
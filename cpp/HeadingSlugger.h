@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace margelo::nitro::hypermarkdown {
+
+// Anchors for the headings of a document, as GitHub (github-slugger) makes
+// them: the text lowercased, punctuation and symbols removed, spaces turned
+// into '-'. A slug seen before gets the first free "-1", "-2"... suffix, so
+// slugs have to be asked for in document order, one slugger per document.
+//
+// Lowercasing covers ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic;
+// the removed characters are those of the punctuation, symbol and emoji
+// blocks, and not the rare ones elsewhere.
+class HeadingSlugger {
+public:
+    std::string slug(std::string_view text);
+    
+    // The slug of the text, before deduplication
+    static std::string githubSlug(std::string_view text);
+    
+    // Appends the text of an entity md4c reports raw ("&amp;", "&#x41;"):
+    // numeric references and the entities of XML and nbsp are decoded,
+    // others are kept as they are
+    static void appendEntity(std::string& out, std::string_view entity);
+    
+private:
+    std::unordered_map<std::string, size_t> occurrences;
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -1,142 +1,183 @@
 #include "HybridHyperMarkdown.hpp"
+#include "BlockManifest.h"
+#include "DisplayList.h"
+#include "DocumentResources.h"
+#include "HybridIncrementalParser.hpp"
+#include "HybridSearchIndex.hpp"
+#include "LineIndex.h"
 #include "MarkdownParser.h"
-#include <sstream>
-#include <iomanip>
+#include "MarkdownSerializer.h"
+#include "NodeReclaimer.h"
+#include "PlainText.h"
+#include <algorithm>
+#include <chrono>
 
 namespace margelo::nitro::hypermarkdown {
 
-std::string HybridHyperMarkdown::escapeJson(const std::string& str) {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if ('\x00' <= c && c <= '\x1f') {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                } else {
-                    oss << c;
-                }
-        }
-    }
-    return oss.str();
+namespace {
+
+// Documents from this size on have their node tree freed on the reclaimer
+// thread; below it, freeing inline is cheaper than the hand-over
+constexpr size_t kDeferredReleaseBytes = 32 * 1024;
+
+ParseTimings toNitroTimings(const InternalParseTimings& timings) {
+    return ParseTimings(
+        timings.blockMs,
+        timings.inlineMs,
+        timings.treeMs,
+        timings.serializeMs,
+        timings.totalMs,
+        static_cast<double>(timings.inputBytes),
+        static_cast<double>(timings.nodeCount),
+        static_cast<double>(timings.outputBytes)
+    );
 }
 
-std::string HybridHyperMarkdown::nodeToJson(const std::shared_ptr<MarkdownNode>& node) {
-    if (!node) {
-        return "null";
-    }
-    
-    std::ostringstream oss;
-    oss << "{";
-    
-    // Type
-    oss << "\"type\":\"" << escapeJson(node->type) << "\"";
-    
-    // Content (if present)
-    if (node->content) {
-        oss << ",\"content\":\"" << escapeJson(*node->content) << "\"";
-    }
-    
-    // Level (for headings)
-    if (node->level) {
-        oss << ",\"level\":" << *node->level;
-    }
-    
-    // Link/Image properties
-    if (node->href) {
-        oss << ",\"href\":\"" << escapeJson(*node->href) << "\"";
-    }
-    if (node->src) {
-        oss << ",\"src\":\"" << escapeJson(*node->src) << "\"";
-    }
-    if (node->alt) {
-        oss << ",\"alt\":\"" << escapeJson(*node->alt) << "\"";
-    }
-    if (node->title) {
-        oss << ",\"title\":\"" << escapeJson(*node->title) << "\"";
-    }
-    
-    // Code block language
-    if (node->language) {
-        oss << ",\"language\":\"" << escapeJson(*node->language) << "\"";
-    }
-    
-    // List properties
-    if (node->ordered) {
-        oss << ",\"ordered\":" << (*node->ordered ? "true" : "false");
+ParseMemoryUsage toNitroMemoryUsage(const InternalMemoryUsage& usage) {
+    return ParseMemoryUsage(
+        static_cast<double>(usage.allocations),
+        static_cast<double>(usage.bytesAllocated),
+        static_cast<double>(usage.peakBytes)
+    );
+}
+
+ParseMemory toNitroMemory(const InternalParseMemory& memory) {
+    return ParseMemory(
+        toNitroMemoryUsage(memory.md4c),
+        toNitroMemoryUsage(memory.ast),
+        toNitroMemoryUsage(memory.output),
+        static_cast<double>(memory.peakBytes)
+    );
+}
+
+InternalParserOptions toInternalOptions(const std::optional<ParserOptions>& options) {
+    InternalParserOptions internal;
+    if (options) {
+        if (options->gfm) internal.gfm = *options->gfm;
+        if (options->enableTables) internal.enableTables = *options->enableTables;
+        if (options->enableTaskLists) internal.enableTaskLists = *options->enableTaskLists;
+        if (options->enableStrikethrough) internal.enableStrikethrough = *options->enableStrikethrough;
+        if (options->enableAutolink) internal.enableAutolink = *options->enableAutolink;
+        if (options->math) internal.math = *options->math;
+        if (options->wiki) internal.wiki = *options->wiki;
+        if (options->maxInputSize) internal.maxInputSize = static_cast<size_t>(*options->maxInputSize);
+        if (options->timeout) internal.timeout = static_cast<int>(*options->timeout);
+        if (options->collectTimings) internal.collectTimings = *options->collectTimings;
+        if (options->collectMemory) internal.collectMemory = *options->collectMemory;
+        if (options->maxMemory) internal.maxMemory = static_cast<size_t>(*options->maxMemory);
+        if (options->sourcePositions) internal.sourcePositions = *options->sourcePositions;
+        if (options->normalizeInput) internal.normalizeInput = *options->normalizeInput;
+        if (options->highlightCode) internal.highlightCode = *options->highlightCode;
+        if (options->textRuns) internal.textRuns = *options->textRuns;
+        if (options->deferInlines) internal.deferInlines = *options->deferInlines;
+        if (options->collectHeadings) internal.collectHeadings = *options->collectHeadings;
+        if (options->headingsOnly) internal.headingsOnly = *options->headingsOnly;
     }
-    if (node->start) {
-        oss << ",\"start\":" << *node->start;
+    return internal;
+}
+
+InternalLayoutMetrics toInternalMetrics(const LayoutMetrics& metrics) {
+    InternalLayoutMetrics internal;
+    internal.width = metrics.width;
+    internal.fontSize = metrics.fontSize;
+    internal.lineHeight = metrics.lineHeight;
+    if (metrics.headingFontSizes) {
+        std::copy_n(metrics.headingFontSizes->begin(), std::min<size_t>(metrics.headingFontSizes->size(), 6),
+                    internal.headingFontSizes);
     }
-    
-    // Task list item
-    if (node->checked) {
-        oss << ",\"checked\":" << (*node->checked ? "true" : "false");
+    if (metrics.headingLineHeights) {
+        std::copy_n(metrics.headingLineHeights->begin(), std::min<size_t>(metrics.headingLineHeights->size(), 6),
+                    internal.headingLineHeights);
     }
-    
-    // Table cell
-    if (node->align) {
-        std::string alignStr;
-        switch (*node->align) {
-            case TableCellAlign::Left: alignStr = "left"; break;
-            case TableCellAlign::Center: alignStr = "center"; break;
-            case TableCellAlign::Right: alignStr = "right"; break;
-            default: alignStr = "default"; break;
-        }
-        oss << ",\"align\":\"" << alignStr << "\"";
+    if (metrics.codeLineHeight) internal.codeLineHeight = *metrics.codeLineHeight;
+    if (metrics.codeBlockPadding) internal.codeBlockPadding = *metrics.codeBlockPadding;
+    if (metrics.blockSpacing) internal.blockSpacing = *metrics.blockSpacing;
+    if (metrics.imageHeight) internal.imageHeight = *metrics.imageHeight;
+    if (metrics.charWidth) internal.charWidth = *metrics.charWidth;
+    return internal;
+}
+
+// An index or a count from JS: NaN and negative ones are 0, anything past
+// what there is means "all"
+size_t toCount(double value) {
+    if (!(value > 0)) {
+        return 0;
     }
-    if (node->isHeader) {
-        oss << ",\"isHeader\":" << (*node->isHeader ? "true" : "false");
+    return value >= 1e15 ? SIZE_MAX : static_cast<size_t>(value);
+}
+
+bool wantsDisplayList(const std::optional<ParserOptions>& options) {
+    return options && options->displayList && *options->displayList;
+}
+
+} // namespace
+
+ParseResultNative HybridHyperMarkdown::parse(const std::string& content, const std::optional<::margelo::nitro::hypermarkdown::ParserOptions>& options) {
+    return parseWith(content, toInternalOptions(options), wantsDisplayList(options));
+}
+
+ParseResultNative HybridHyperMarkdown::getBlocks(const std::string& content, double start, double end,
+                                                 const std::optional<ParserOptions>& options) {
+    InternalParserOptions parserOpts = toInternalOptions(options);
+    parserOpts.firstBlock = toCount(start);
+    parserOpts.endBlock = toCount(end);
+    return parseWith(content, parserOpts, wantsDisplayList(options));
+}
+
+ParseResultNative HybridHyperMarkdown::parseInlines(const std::string& content, double start, double end,
+                                                    const std::optional<ParserOptions>& options) {
+    InternalParserOptions parserOpts = toInternalOptions(options);
+    parserOpts.deferInlines = false;
+    parserOpts.inlinesOnly = true;
+    parserOpts.firstInline = toCount(start);
+    parserOpts.endInline = toCount(end);
+    return parseWith(content, parserOpts, wantsDisplayList(options));
+}
+
+std::shared_ptr<HybridIncrementalParserSpec> HybridHyperMarkdown::createIncrementalParser(
+    const std::string& content, const std::optional<ParserOptions>& options) {
+    return std::make_shared<HybridIncrementalParser>(content, toInternalOptions(options));
+}
+
+std::shared_ptr<HybridSearchIndexSpec> HybridHyperMarkdown::createSearchIndex(
+    const std::string& content, const std::optional<ParserOptions>& options) {
+    return std::make_shared<HybridSearchIndex>(content, toInternalOptions(options));
+}
+
+std::string HybridHyperMarkdown::extractResources(const std::vector<std::string>& contents,
+                                                  const std::optional<ParserOptions>& options) {
+    auto internal = toInternalOptions(options);
+    std::vector<DocumentResources> documents;
+    documents.reserve(contents.size());
+    for (const auto& content : contents) {
+        documents.push_back(DocumentResources::extract(content, internal));
     }
-    
-    // Children
-    if (!node->children.empty()) {
-        oss << ",\"children\":[";
-        bool first = true;
-        for (const auto& child : node->children) {
-            if (!first) oss << ",";
-            first = false;
-            oss << nodeToJson(child);
-        }
-        oss << "]";
+    return MarkdownSerializer::resourcesToJson(documents);
+}
+
+std::string HybridHyperMarkdown::toPlainText(const std::string& content, std::optional<double> maxChars,
+                                             const std::optional<ParserOptions>& options) {
+    return PlainText::extract(content, maxChars ? toCount(*maxChars) : SIZE_MAX, toInternalOptions(options)).text;
+}
+
+BlockManifestNative HybridHyperMarkdown::getBlockManifest(const std::string& content, const LayoutMetrics& metrics,
+                                                          const std::optional<ParserOptions>& options) {
+    auto manifest = BlockManifest::build(content, toInternalMetrics(metrics), toInternalOptions(options));
+    if (!manifest.success) {
+        return BlockManifestNative(false, "{\"types\":[],\"blocks\":[]}",
+                                   manifest.error ? std::optional<std::string>(manifest.error->message) : std::nullopt);
     }
-    
-    oss << "}";
-    return oss.str();
+    return BlockManifestNative(true, MarkdownSerializer::blockManifestToJson(manifest), std::nullopt);
 }
 
-ParseResultNative HybridHyperMarkdown::parse(const std::string& content, const std::optional<::margelo::nitro::hypermarkdown::ParserOptions>& options) {
-    // Convert Nitro ParserOptions to internal parser options
-    margelo::nitro::hypermarkdown::ParserOptions internalOptions;
-    
-    // Destructure options with defaults
-    bool gfm = true;
-    bool enableTables = true;
-    bool enableTaskLists = true;
-    bool enableStrikethrough = true;
-    bool enableAutolink = true;
-    bool math = false;
-    bool wiki = false;
-    size_t maxInputSize = 10 * 1024 * 1024; // 10MB
-    int timeout = 5000;
+ParseResultNative HybridHyperMarkdown::parseWith(const std::string& content, const InternalParserOptions& parserOpts,
+                                                 bool displayList) {
+    auto start = std::chrono::steady_clock::now();
     
-    if (options) {
-        if (options->gfm) gfm = *options->gfm;
-        if (options->enableTables) enableTables = *options->enableTables;
-        if (options->enableTaskLists) enableTaskLists = *options->enableTaskLists;
-        if (options->enableStrikethrough) enableStrikethrough = *options->enableStrikethrough;
-        if (options->enableAutolink) enableAutolink = *options->enableAutolink;
-        if (options->math) math = *options->math;
-        if (options->wiki) wiki = *options->wiki;
-        if (options->maxInputSize) maxInputSize = static_cast<size_t>(*options->maxInputSize);
-        if (options->timeout) timeout = static_cast<int>(*options->timeout);
-    }
+    size_t maxInputSize = parserOpts.maxInputSize;
+    bool collectTimings = parserOpts.collectTimings;
+    bool collectMemory = parserOpts.collectMemory;
+    bool sourcePositions = parserOpts.sourcePositions;
     
     // Check input size
     if (content.size() > maxInputSize) {
@@ -145,33 +186,50 @@ ParseResultNative HybridHyperMarkdown::parse(const std::string& content, const s
             "[]",
             std::optional<std::string>("Input exceeds maximum size limit"),
             std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
             std::nullopt
         );
     }
     
-    // Handle empty content
-    if (content.empty()) {
+    // Handle empty content; the parser has the empty heading index
+    if (content.empty() && !MarkdownParser::collectsHeadings(parserOpts)) {
+        std::string ast = sourcePositions
+            ? "[{\"type\":\"document\",\"position\":{\"start\":{\"line\":1,\"column\":1,\"offset\":0},"
+              "\"end\":{\"line\":1,\"column\":1,\"offset\":0}},\"children\":[]}]"
+            : "[{\"type\":\"document\",\"children\":[]}]";
+        if (displayList) {
+            auto document = std::make_shared<MarkdownNode>("document");
+            if (sourcePositions) {
+                document->position = SourceSpan();
+            }
+            LineIndex lines(content);
+            ast = MarkdownSerializer::displayListToJson(DisplayList::build({document}, &lines));
+        }
+        std::optional<ParseTimings> timings = std::nullopt;
+        if (collectTimings) {
+            InternalParseTimings empty;
+            empty.nodeCount = 1;
+            empty.outputBytes = ast.size();
+            timings = toNitroTimings(empty);
+        }
+        std::optional<ParseMemory> memory = std::nullopt;
+        if (collectMemory) {
+            memory = toNitroMemory(InternalParseMemory());
+        }
         return ParseResultNative(
             true,
-            "[{\"type\":\"document\",\"children\":[]}]",
+            ast,
+            std::nullopt,
             std::nullopt,
             std::nullopt,
+            timings,
+            memory,
             std::nullopt
         );
     }
     
-    // Create internal parser options struct
-    InternalParserOptions parserOpts;
-    parserOpts.gfm = gfm;
-    parserOpts.enableTables = enableTables;
-    parserOpts.enableTaskLists = enableTaskLists;
-    parserOpts.enableStrikethrough = enableStrikethrough;
-    parserOpts.enableAutolink = enableAutolink;
-    parserOpts.math = math;
-    parserOpts.wiki = wiki;
-    parserOpts.maxInputSize = maxInputSize;
-    parserOpts.timeout = timeout;
-    
     // Parse using MarkdownParser
     auto result = MarkdownParser::parse(content, parserOpts);
     
@@ -190,27 +248,70 @@ ParseResultNative HybridHyperMarkdown::parse(const std::string& content, const s
             "[]",
             std::optional<std::string>(errorMsg),
             errorLine,
-            errorColumn
+            errorColumn,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt
         );
     }
     
     // Convert AST to JSON
-    std::ostringstream jsonOss;
-    jsonOss << "[";
-    bool first = true;
-    for (const auto& node : result.nodes) {
-        if (!first) jsonOss << ",";
-        first = false;
-        jsonOss << nodeToJson(node);
+    auto serializeStart = std::chrono::steady_clock::now();
+    InternalParseMemory* accounting = result.memory ? &*result.memory : nullptr;
+    std::optional<LineIndex> lines;
+    if (sourcePositions) {
+        lines.emplace(result.normalizedInput ? *result.normalizedInput : content);
+    }
+    std::string ast = displayList
+        ? MarkdownSerializer::displayListToJson(DisplayList::build(result.nodes, lines ? &*lines : nullptr), accounting)
+        : MarkdownSerializer::toJson(result.nodes, accounting, lines ? &*lines : nullptr);
+    std::optional<std::string> headings;
+    if (result.headings) {
+        headings = lines ? MarkdownSerializer::headingsToJson(*result.headings, *lines)
+                         : MarkdownSerializer::headingsToJson(*result.headings, LineIndex(
+                               result.normalizedInput ? *result.normalizedInput : content));
+    }
+    if (content.size() >= kDeferredReleaseBytes) {
+        NodeReclaimer::shared().release(std::move(result.nodes));
+    }
+    
+    if (accounting && accounting->exceeded) {
+        return ParseResultNative(
+            false,
+            "[]",
+            std::optional<std::string>("Parse exceeds maximum memory limit"),
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt
+        );
+    }
+    
+    std::optional<ParseTimings> timings = std::nullopt;
+    if (result.timings) {
+        using Ms = std::chrono::duration<double, std::milli>;
+        auto end = std::chrono::steady_clock::now();
+        result.timings->serializeMs = Ms(end - serializeStart).count();
+        result.timings->totalMs = Ms(end - start).count();
+        result.timings->outputBytes = ast.size();
+        timings = toNitroTimings(*result.timings);
+    }
+    
+    std::optional<ParseMemory> memory = std::nullopt;
+    if (collectMemory && result.memory) {
+        memory = toNitroMemory(*result.memory);
     }
-    jsonOss << "]";
     
     return ParseResultNative(
         true,
-        jsonOss.str(),
+        std::move(ast),
+        std::nullopt,
         std::nullopt,
         std::nullopt,
-        std::nullopt
+        timings,
+        memory,
+        std::move(headings)
     );
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <optional>
@@ -15,12 +16,40 @@ public:
     // Parse markdown content and return result with JSON AST
     ParseResultNative parse(const std::string& content, const std::optional<ParserOptions>& options) override;
     
-private:
-    // Convert MarkdownNode tree to JSON string
-    std::string nodeToJson(const std::shared_ptr<MarkdownNode>& node);
+    // Top-level blocks of the content with estimated heights, without an AST
+    BlockManifestNative getBlockManifest(const std::string& content, const LayoutMetrics& metrics,
+                                         const std::optional<ParserOptions>& options) override;
+    
+    // Parse, but build the AST of the top-level blocks [start, end) only
+    ParseResultNative getBlocks(const std::string& content, double start, double end,
+                                const std::optional<ParserOptions>& options) override;
+    
+    // Parse the inline content of the deferred leaves [start, end) of a
+    // skeleton parsed with deferInlines
+    ParseResultNative parseInlines(const std::string& content, double start, double end,
+                                   const std::optional<ParserOptions>& options) override;
+    
+    // Parser that parses the content in steps, for a time budget each
+    std::shared_ptr<HybridIncrementalParserSpec> createIncrementalParser(
+        const std::string& content, const std::optional<ParserOptions>& options) override;
     
-    // Escape JSON string
-    std::string escapeJson(const std::string& str);
+    // Find-in-document index over the rendered text of the content
+    std::shared_ptr<HybridSearchIndexSpec> createSearchIndex(
+        const std::string& content, const std::optional<ParserOptions>& options) override;
+    
+    // Images and links of each of a batch of documents, without an AST, as
+    // JSON
+    std::string extractResources(const std::vector<std::string>& contents,
+                                 const std::optional<ParserOptions>& options) override;
+    
+    // Rendered text of the content, up to maxChars UTF-16 code units,
+    // without an AST; empty if it cannot be parsed
+    std::string toPlainText(const std::string& content, std::optional<double> maxChars,
+                            const std::optional<ParserOptions>& options) override;
+    
+private:
+    ParseResultNative parseWith(const std::string& content, const InternalParserOptions& parserOpts,
+                                bool displayList);
     
     // Convert internal ParserOptions to MarkdownParser options
     margelo::nitro::hypermarkdown::ParserOptions convertOptions(const std::optional<ParserOptions>& options);
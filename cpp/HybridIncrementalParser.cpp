@@ -0,0 +1,39 @@
+#include "HybridIncrementalParser.hpp"
+
+namespace margelo::nitro::hypermarkdown {
+
+ParseStepNative HybridIncrementalParser::step(double budgetMs) {
+    auto result = parser.step(budgetMs);
+    if (!result.success) {
+        std::string errorMsg = result.error ? result.error->message : "Unknown parse error";
+        std::optional<double> errorLine = std::nullopt;
+        std::optional<double> errorColumn = std::nullopt;
+        
+        if (result.error) {
+            if (result.error->line) errorLine = static_cast<double>(*result.error->line);
+            if (result.error->column) errorColumn = static_cast<double>(*result.error->column);
+        }
+        
+        return ParseStepNative(
+            false,
+            false,
+            "[]",
+            std::nullopt,
+            std::optional<std::string>(errorMsg),
+            errorLine,
+            errorColumn
+        );
+    }
+    
+    return ParseStepNative(
+        true,
+        result.done,
+        std::move(result.blocks),
+        std::move(result.document),
+        std::nullopt,
+        std::nullopt,
+        std::nullopt
+    );
+}
+
+} // namespace margelo::nitro::hypermarkdown
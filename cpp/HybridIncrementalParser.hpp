@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include "HybridIncrementalParserSpec.hpp"
+#include "IncrementalParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+class HybridIncrementalParser : public HybridIncrementalParserSpec {
+public:
+    HybridIncrementalParser(const std::string& content, const InternalParserOptions& options)
+        : HybridObject(TAG), HybridIncrementalParserSpec(), parser(content, options) {}
+    
+    // Parse for about `budgetMs` and return the top-level blocks completed
+    ParseStepNative step(double budgetMs) override;
+    
+private:
+    IncrementalParser parser;
+};
+
+} // namespace margelo::nitro::hypermarkdown
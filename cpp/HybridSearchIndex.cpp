@@ -0,0 +1,25 @@
+#include "HybridSearchIndex.hpp"
+#include "MarkdownSerializer.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+SearchIndex HybridSearchIndex::build(const std::string& content, InternalParserOptions options) {
+    // The whole tree, whatever parts of it the options ask for
+    options.deferInlines = false;
+    options.inlinesOnly = false;
+    options.headingsOnly = false;
+    options.collectHeadings = false;
+    auto result = MarkdownParser::parse(content, options);
+    if (!result.success || result.nodes.empty()) {
+        MarkdownNode empty("document");
+        return SearchIndex(&empty);
+    }
+    return SearchIndex(result.nodes.front().get());
+}
+
+std::string HybridSearchIndex::search(const std::vector<std::string>& patterns, std::optional<double> maxMatches) {
+    size_t limit = maxMatches && *maxMatches >= 0 ? static_cast<size_t>(*maxMatches) : SIZE_MAX;
+    return MarkdownSerializer::searchMatchesToJson(index.search(patterns, limit));
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "HybridSearchIndexSpec.hpp"
+#include "SearchIndex.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+class HybridSearchIndex : public HybridSearchIndexSpec {
+public:
+    HybridSearchIndex(const std::string& content, InternalParserOptions options)
+        : HybridObject(TAG), HybridSearchIndexSpec(), index(build(content, std::move(options))) {}
+    
+    // Matches of the patterns, as JSON
+    std::string search(const std::vector<std::string>& patterns, std::optional<double> maxMatches) override;
+    
+private:
+    // The index of the document as parseMarkdown() gives it with the same
+    // options; of an empty document if the parse fails
+    static SearchIndex build(const std::string& content, InternalParserOptions options);
+    
+    SearchIndex index;
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,125 @@
+#include "IncrementalParser.h"
+#include "InputNormalizer.h"
+#include "MarkdownSerializer.h"
+#include <chrono>
+
+namespace margelo::nitro::hypermarkdown {
+
+IncrementalParser::IncrementalParser(const std::string& content, const InternalParserOptions& parserOptions)
+    : options(parserOptions) {
+    options.collectTimings = false;
+    if (content.size() > options.maxInputSize) {
+        error = ParseError("Input exceeds maximum size limit");
+        return;
+    }
+    if (options.collectMemory || options.maxMemory > 0) {
+        memory.emplace();
+        memory->limit = options.maxMemory;
+    }
+    
+    // md4c and the nodes refer to the input until the last step, so the
+    // parser keeps its own copy
+    std::string normalized;
+    if (options.normalizeInput && InputNormalizer::normalize(content, normalized)) {
+        source = std::move(normalized);
+        if (memory && !memory->allocate(memory->md4c, source.capacity() + 1)) {
+            error = ParseError("Parse exceeds maximum memory limit");
+            return;
+        }
+    } else {
+        source = content;
+    }
+    if (options.sourcePositions) {
+        lines.emplace(source);
+    }
+    
+    MarkdownParser::initContext(ctx, source, options, memory ? &*memory : nullptr);
+    MD_PARSER parser = MarkdownParser::md4cParser(options, memory.has_value());
+    state = md_parse_begin(source.c_str(), static_cast<MD_SIZE>(source.size()), &parser, &ctx);
+    if (!state) {
+        error = memory && memory->exceeded ? ParseError("Parse exceeds maximum memory limit")
+                                           : ParseError("Failed to parse markdown");
+    }
+}
+
+IncrementalParser::~IncrementalParser() {
+    if (state) {
+        md_parse_end(state);
+    }
+}
+
+void IncrementalParser::fail(ParseError failure) {
+    md_parse_end(state);
+    state = nullptr;
+    error = std::move(failure);
+}
+
+void IncrementalParser::takeBlocks(std::string& json) {
+    // Top-level blocks are complete once the parse is back at the document;
+    // until then the last one is still open
+    auto& children = ctx.root->children;
+    size_t complete = children.size();
+    if (!finished && ctx.nodeStack.size() > 1 && complete > 0) {
+        complete--;
+    }
+    if (complete == 0) {
+        return;
+    }
+    std::vector<std::shared_ptr<MarkdownNode>> blocks(children.begin(), children.begin() + complete);
+    children.erase(children.begin(), children.begin() + complete);
+    std::string array = MarkdownSerializer::toJson(blocks, nullptr, lines ? &*lines : nullptr);
+    if (json.size() > 1) {
+        json += ',';
+    }
+    json.append(array, 1, array.size() - 2);
+}
+
+IncrementalParser::Step IncrementalParser::step(double budgetMs) {
+    using Clock = std::chrono::steady_clock;
+    Step result;
+    if (error) {
+        result.error = error;
+        return result;
+    }
+    
+    // Serializing the blocks is part of the step, so it counts against
+    // the budget
+    std::string json = "[";
+    auto start = Clock::now();
+    auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+    while (!finished) {
+        int done = 0;
+        int status = md_parse_step(state, kStepBytes, &done);
+        if (memory && memory->exceeded) {
+            fail(*MarkdownParser::memoryLimitFailure(source, ctx).error);
+            result.error = error;
+            return result;
+        }
+        if (status != 0) {
+            fail(ParseError("Failed to parse markdown"));
+            result.error = error;
+            return result;
+        }
+        if (done) {
+            ctx.flushText();
+            md_parse_end(state);
+            state = nullptr;
+            finished = true;
+        }
+        takeBlocks(json);
+        if (elapsedMs() >= budgetMs) {
+            break;
+        }
+    }
+    json += ']';
+    
+    result.success = true;
+    result.done = finished;
+    result.blocks = std::move(json);
+    if (finished) {
+        result.document = MarkdownSerializer::nodeToJson(ctx.root, lines ? &*lines : nullptr);
+    }
+    return result;
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// A parse done in steps, for documents that take longer to parse than a
+// frame: each step() runs md4c (md_parse_step) for about a time budget and
+// returns the top-level blocks completed since the previous step. The
+// blocks of all steps, as the children of the document of the last one,
+// are the AST of a one-shot parse with the same options.
+//
+// md4c analyzes all blocks before it enters the first one (reference
+// definitions may come after their use), so the first steps of a document
+// return no blocks; after them, blocks come in document order.
+//
+// collectTimings is ignored. maxMemory covers md4c and the node tree as in
+// a one-shot parse; the blocks returned are released and not accounted.
+class IncrementalParser {
+public:
+    struct Step {
+        bool success = false;
+        bool done = false;
+        std::string blocks = "[]";              // JSON array of top-level nodes
+        std::optional<std::string> document;    // JSON of the document node, without children, once done
+        std::optional<ParseError> error;
+    };
+    
+    IncrementalParser(const std::string& content, const InternalParserOptions& options);
+    ~IncrementalParser();
+    
+    IncrementalParser(const IncrementalParser&) = delete;
+    IncrementalParser& operator=(const IncrementalParser&) = delete;
+    
+    // Parses for about `budgetMs`, at least one chunk of the input, and
+    // returns the blocks completed meanwhile. After the last step, or after
+    // an error, further steps return the same outcome without blocks.
+    Step step(double budgetMs);
+    
+    bool done() const { return finished; }
+    
+private:
+    // Input bytes per md_parse_step() call, between two looks at the clock;
+    // a step can take longer by a line or a leaf block, e.g. a paragraph
+    static constexpr int kStepBytes = 4096;
+    
+    std::string source;                     // normalized with normalizeInput
+    InternalParserOptions options;
+    std::optional<InternalParseMemory> memory;
+    ParserContext ctx;
+    MD_PARSE_STATE* state = nullptr;
+    std::optional<LineIndex> lines;
+    std::optional<ParseError> error;
+    bool finished = false;
+    
+    void fail(ParseError failure);
+    
+    // Moves the top-level blocks completed so far into `json`, an array
+    // being built
+    void takeBlocks(std::string& json);
+};
+
+} // namespace margelo::nitro::hypermarkdown
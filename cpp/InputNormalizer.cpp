@@ -0,0 +1,206 @@
+#include "InputNormalizer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HYPERMARKDOWN_NORMALIZER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HYPERMARKDOWN_NORMALIZER_NEON 1
+#endif
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Whether the byte needs a look: non-ASCII, '\r' or NUL
+inline bool isSpecial(unsigned char byte) {
+    return byte >= 0x80 || byte == '\r' || byte == '\0';
+}
+
+// First byte in [p, end) that needs a look, or end
+const char* findSpecial(const char* p, const char* end) {
+#if HYPERMARKDOWN_NORMALIZER_SSE2
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i zero = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn), _mm_cmpeq_epi8(chunk, zero));
+        // The sign bit of a byte is set for non-ASCII
+        if (int mask = _mm_movemask_epi8(_mm_or_si128(found, chunk))) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+#elif HYPERMARKDOWN_NORMALIZER_NEON
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t found = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\r')), vceqzq_u8(chunk)),
+                                    vcgeq_u8(chunk, vdupq_n_u8(0x80)));
+        // NEON has no movemask: narrow to 4 bits per byte
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+        if (mask) {
+            return p + __builtin_ctzll(mask) / 4;
+        }
+    }
+#endif
+    for (; p < end; p++) {
+        if (isSpecial(static_cast<unsigned char>(*p))) {
+            return p;
+        }
+    }
+    return end;
+}
+
+inline bool isContinuation(unsigned char byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+// Skips the well-formed 2- and 3-byte sequences starting at p, which cover
+// most non-ASCII text; stops at anything else
+const char* skipValidRun(const char* p, const char* end) {
+    auto bytes = reinterpret_cast<const unsigned char*>(p);
+    auto last = reinterpret_cast<const unsigned char*>(end);
+    while (last - bytes >= 3) {
+        unsigned char lead = bytes[0];
+        if (lead >= 0xC2 && lead <= 0xDF && isContinuation(bytes[1])) {
+            bytes += 2;
+        } else if ((lead & 0xF0) == 0xE0 && isContinuation(bytes[1]) && isContinuation(bytes[2]) &&
+                   (lead != 0xE0 || bytes[1] >= 0xA0) && (lead != 0xED || bytes[1] <= 0x9F)) {
+            bytes += 3;
+        } else {
+            break;
+        }
+    }
+    return reinterpret_cast<const char*>(bytes);
+}
+
+} // namespace
+
+InputNormalizer::Sequence InputNormalizer::sequenceAt(const char* p, const char* end) {
+    auto byte = [&](size_t i) { return static_cast<unsigned char>(p[i]); };
+    unsigned char lead = byte(0);
+    if (lead < 0x80) {
+        return {1, true};
+    }
+    
+    // Well-formed sequences (Unicode table 3-7): the lead byte determines
+    // the length and the range of the second byte, later bytes are 80..BF
+    size_t length;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;       // no overlong forms
+        if (lead == 0xED) high = 0x9F;      // no surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;       // no overlong forms
+        if (lead == 0xF4) high = 0x8F;      // nothing past U+10FFFF
+    } else {
+        return {1, false};
+    }
+    
+    size_t available = static_cast<size_t>(end - p);
+    for (size_t i = 1; i < length; i++) {
+        if (i >= available || byte(i) < low || byte(i) > high) {
+            return {i, false};
+        }
+        low = 0x80;
+        high = 0xBF;
+    }
+    return {length, true};
+}
+
+bool InputNormalizer::normalize(const char* input, size_t size, std::string& out) {
+    const char* end = input + size;
+    const char* p = input;
+    // Input from here on is not in `out` yet
+    const char* pending = input;
+    bool changed = false;
+    
+    while ((p = findSpecial(p, end)) < end) {
+        const char* replacement;
+        size_t replaced;
+        if (*p == '\r') {
+            replacement = "\n";
+            replaced = p + 1 < end && p[1] == '\n' ? 2 : 1;
+        } else if (*p == '\0') {
+            replacement = kReplacementCharacter;
+            replaced = 1;
+        } else {
+            // Valid non-ASCII text usually comes in runs
+            p = skipValidRun(p, end);
+            if (p == end || static_cast<unsigned char>(*p) < 0x80) {
+                continue;
+            }
+            Sequence sequence = sequenceAt(p, end);
+            if (sequence.valid) {
+                p += sequence.length;
+                continue;
+            }
+            replacement = kReplacementCharacter;
+            replaced = sequence.length;
+        }
+        
+        if (!changed) {
+            changed = true;
+            out.clear();
+            out.reserve(size + size / 16);
+        }
+        out.append(pending, p - pending);
+        out += replacement;
+        p += replaced;
+        pending = p;
+    }
+    
+    if (changed) {
+        out.append(pending, end - pending);
+    }
+    return changed;
+}
+
+uint32_t InputNormalizer::decode(const char* p, size_t length) {
+    auto byte = [&](size_t i) { return static_cast<uint32_t>(static_cast<unsigned char>(p[i])); };
+    switch (length) {
+        case 1: return byte(0);
+        case 2: return (byte(0) & 0x1F) << 6 | (byte(1) & 0x3F);
+        case 3: return (byte(0) & 0x0F) << 12 | (byte(1) & 0x3F) << 6 | (byte(2) & 0x3F);
+        default: return (byte(0) & 0x07) << 18 | (byte(1) & 0x3F) << 12 | (byte(2) & 0x3F) << 6 | (byte(3) & 0x3F);
+    }
+}
+
+void InputNormalizer::appendUtf8(std::string& out, uint32_t c) {
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+        out += static_cast<char>(0xC0 | c >> 6);
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        out += static_cast<char>(0xE0 | c >> 12);
+        out += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | c >> 18);
+        out += static_cast<char>(0x80 | (c >> 12 & 0x3F));
+        out += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+size_t InputNormalizer::utf16Units(const char*& p, const char* until, const char* end) {
+    size_t units = 0;
+    while (p < until) {
+        if (static_cast<unsigned char>(*p) < 0x80) {
+            units++;
+            p++;
+            continue;
+        }
+        auto sequence = sequenceAt(p, end);
+        units += sequence.valid && sequence.length == 4 ? 2 : 1;
+        p += sequence.length;
+    }
+    return units;
+}
+
+} // namespace margelo::nitro::hypermarkdown
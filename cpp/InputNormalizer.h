@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace margelo::nitro::hypermarkdown {
+
+// Clean-up of the input before parsing (normalizeInput). Text from network
+// APIs may contain invalid UTF-8, CRLF line endings or NUL bytes; after the
+// pre-pass, each invalid UTF-8 sequence and each NUL is a U+FFFD, and
+// "\r\n" and lone "\r" line endings are "\n". All of it in one pass that
+// skips over 16 bytes of plain ASCII at a time, and without copying input
+// that is clean already.
+class InputNormalizer {
+public:
+    // Returns false if the input is clean and leaves `out` alone; otherwise
+    // returns true with the normalized input in `out`
+    static bool normalize(const char* input, size_t size, std::string& out);
+    static bool normalize(const std::string& input, std::string& out) {
+        return normalize(input.data(), input.size(), out);
+    }
+    
+    // A UTF-8 sequence at the start of some text: `length` bytes that are
+    // either a whole valid character, or the maximal invalid subpart to be
+    // replaced by one U+FFFD, as WHATWG and Unicode recommend
+    struct Sequence {
+        size_t length;
+        bool valid;
+    };
+    
+    // The sequence at p, which has to be before end
+    static Sequence sequenceAt(const char* p, const char* end);
+    
+    // The codepoint of a valid sequence of `length` bytes at p
+    static uint32_t decode(const char* p, size_t length);
+    
+    // Appends the UTF-8 encoding of a codepoint
+    static void appendUtf8(std::string& out, uint32_t codepoint);
+    
+    // Length of text in UTF-16 code units once it is in the JSON, i.e. as a
+    // JS string: characters past the BMP take two, each invalid sequence
+    // one, for its U+FFFD
+    static size_t utf16Length(const char* text, size_t size) {
+        return utf16Units(text, text + size, text + size);
+    }
+    
+    // The same for a part of some text: advances p over the sequences that
+    // start before `until` in the text ending at `end`, and returns their
+    // length in UTF-16 units. The last one may end after `until`.
+    static size_t utf16Units(const char*& p, const char* until, const char* end);
+    
+    static constexpr const char* kReplacementCharacter = "\xEF\xBF\xBD";
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,170 @@
+#include "LineIndex.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HYPERMARKDOWN_LINE_INDEX_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HYPERMARKDOWN_LINE_INDEX_NEON 1
+#endif
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Line starts are searched at least this far ahead, so that lookups in
+// document order do not scan a few bytes at a time
+constexpr size_t kScanAhead = 16 * 1024;
+
+// The vectorized scans look at 16 bytes at a time and get a bit mask of the
+// matching bytes, with 1 << kMaskShift bits per byte
+#if HYPERMARKDOWN_LINE_INDEX_SSE2
+constexpr int kMaskShift = 0;
+
+uint64_t lineEndingMask(const char* p) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(found));
+}
+
+// UTF-16 code units of the 16-byte chunks of UTF-8 in [p, p + 16 * chunks),
+// at most 255 chunks as the counts are gathered per byte lane: all bytes
+// but continuation bytes (0x80-0xBF), plus one for the lead byte of a
+// 4-byte sequence (0xF0-0xFF), a surrogate pair
+uint32_t utf16Units(const char* p, size_t chunks) {
+    __m128i continuations = _mm_setzero_si128();
+    __m128i fourByteLeads = _mm_setzero_si128();
+    for (size_t i = 0; i < chunks; i++, p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // Matches are -1, subtracting them counts
+        continuations = _mm_sub_epi8(continuations, _mm_cmplt_epi8(chunk, _mm_set1_epi8(-64)));
+        fourByteLeads = _mm_sub_epi8(fourByteLeads, _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(-16)), chunk));
+    }
+    auto sum = [](__m128i counts) {
+        __m128i halves = _mm_sad_epu8(counts, _mm_setzero_si128());
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(halves) + _mm_extract_epi16(halves, 4));
+    };
+    return static_cast<uint32_t>(chunks * 16) - sum(continuations) + sum(fourByteLeads);
+}
+#elif HYPERMARKDOWN_LINE_INDEX_NEON
+constexpr int kMaskShift = 2;
+
+uint64_t lineEndingMask(const char* p) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t found = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\n')), vceqq_u8(chunk, vdupq_n_u8('\r')));
+    // NEON has no movemask: narrow to 4 bits per byte, keep one of them
+    uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+    return nibbles & 0x8888888888888888ull;
+}
+
+uint32_t utf16Units(const char* p, size_t chunks) {
+    uint8x16_t continuations = vdupq_n_u8(0);
+    uint8x16_t fourByteLeads = vdupq_n_u8(0);
+    for (size_t i = 0; i < chunks; i++, p += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        // Matches are 0xFF, subtracting them counts
+        continuations = vsubq_u8(continuations, vceqq_u8(vandq_u8(chunk, vdupq_n_u8(0xC0)), vdupq_n_u8(0x80)));
+        fourByteLeads = vsubq_u8(fourByteLeads, vcgeq_u8(chunk, vdupq_n_u8(0xF0)));
+    }
+    return static_cast<uint32_t>(chunks * 16) - vaddlvq_u8(continuations) + vaddlvq_u8(fourByteLeads);
+}
+#endif
+
+// UTF-16 code units of the UTF-8 text in [p, end)
+uint32_t utf16Length(const char* p, const char* end) {
+    uint32_t units = 0;
+#if HYPERMARKDOWN_LINE_INDEX_SSE2 || HYPERMARKDOWN_LINE_INDEX_NEON
+    while (end - p >= 16) {
+        size_t chunks = std::min<size_t>((end - p) / 16, 255);
+        units += utf16Units(p, chunks);
+        p += chunks * 16;
+    }
+#else
+    // ASCII eight bytes at a time
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (word & 0x8080808080808080ull) {
+            break;
+        }
+        units += 8;
+        p += 8;
+    }
+#endif
+    for (; p < end; p++) {
+        auto byte = static_cast<unsigned char>(*p);
+        units += (byte & 0xC0) != 0x80;
+        units += byte >= 0xF0;
+    }
+    return units;
+}
+
+} // namespace
+
+LineIndex::LineIndex(const char* text, size_t size) : text(text), size(size) {
+    lineStarts.push_back(0);
+}
+
+void LineIndex::scanTo(size_t offset) const {
+    // A line starting at `offset` is known once the byte before it is scanned
+    if (scanned >= offset) {
+        return;
+    }
+    const char* end = text + std::min(size, std::max(offset, scanned + kScanAhead));
+    auto addLineEnding = [&](const char* p) {
+        // The '\r' of a "\r\n" does not end the line, the '\n' does
+        if (*p == '\n' || p + 1 == text + size || p[1] != '\n') {
+            lineStarts.push_back(static_cast<uint32_t>(p - text + 1));
+        }
+    };
+    const char* p = text + scanned;
+#if HYPERMARKDOWN_LINE_INDEX_SSE2 || HYPERMARKDOWN_LINE_INDEX_NEON
+    for (; end - p >= 16; p += 16) {
+        for (uint64_t mask = lineEndingMask(p); mask; mask &= mask - 1) {
+            addLineEnding(p + (__builtin_ctzll(mask) >> kMaskShift));
+        }
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == '\n' || *p == '\r') {
+            addLineEnding(p);
+        }
+    }
+    scanned = end - text;
+}
+
+size_t LineIndex::lineOf(size_t offset) const {
+    auto inLine = [&](size_t line) {
+        return lineStarts[line] <= offset && (line + 1 == lineStarts.size() || offset < lineStarts[line + 1]);
+    };
+    // Lookups mostly move forward by a few lines at most
+    if (inLine(lastLine)) {
+        return lastLine;
+    }
+    if (lastLine + 1 < lineStarts.size() && inLine(lastLine + 1)) {
+        return lastLine + 1;
+    }
+    return std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - lineStarts.begin() - 1;
+}
+
+SourceLocation LineIndex::locate(size_t offset) const {
+    offset = std::min(offset, size);
+    scanTo(offset);
+    
+    size_t line = lineOf(offset);
+    size_t lineStart = lineStarts[line];
+    uint32_t column;
+    if (line == lastLine && offset >= lastOffset && lastOffset >= lineStart) {
+        column = lastColumn + utf16Length(text + lastOffset, text + offset);
+    } else {
+        column = 1 + utf16Length(text + lineStart, text + offset);
+    }
+    lastLine = line;
+    lastOffset = offset;
+    lastColumn = column;
+    return {static_cast<uint32_t>(line + 1), column};
+}
+
+} // namespace margelo::nitro::hypermarkdown
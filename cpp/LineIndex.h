@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::hypermarkdown {
+
+// 1-based line and column of an input offset. Columns count UTF-16 code
+// units, like JS string indices and editors do.
+struct SourceLocation {
+    uint32_t line = 1;
+    uint32_t column = 1;
+};
+
+// Converts byte offsets of a document to lines and columns. Line starts are
+// found lazily, with a vectorized scan for line endings, only as far into
+// the document as the offsets asked for; lookups are binary searches over
+// them. The previous lookup is cached, so walking a tree in document order
+// scans the input once and does no searches, and columns on a long line are
+// counted from the previous column on. `\n`, `\r\n` and `\r` end a line,
+// as in CommonMark.
+//
+// The index refers to the text, which has to outlive it. Lookups update the
+// cache, so an index must not be shared between threads.
+class LineIndex {
+public:
+    LineIndex(const char* text, size_t size);
+    explicit LineIndex(const std::string& text) : LineIndex(text.data(), text.size()) {}
+    
+    // Offsets past the end are located at the end
+    SourceLocation locate(size_t offset) const;
+    
+    // Number of line starts found so far
+    size_t scannedLines() const { return lineStarts.size(); }
+    
+    // Number of bytes scanned for line endings so far
+    size_t scannedBytes() const { return scanned; }
+    
+private:
+    // Finds the line starts up to and including `offset`
+    void scanTo(size_t offset) const;
+    size_t lineOf(size_t offset) const;
+    
+    const char* text;
+    size_t size;
+    mutable std::vector<uint32_t> lineStarts;
+    mutable size_t scanned = 0;
+    
+    // The previous lookup
+    mutable size_t lastLine = 0;
+    mutable size_t lastOffset = 0;
+    mutable uint32_t lastColumn = 1;
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -1,8 +1,30 @@
 #include "MarkdownParser.h"
+#include "HeadingSlugger.h"
+#include "InputNormalizer.h"
+#include "LineIndex.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <cstring>
 
 namespace margelo::nitro::hypermarkdown {
 
+MarkdownNode::~MarkdownNode() {
+    // Detach the children of every node we hold the last reference to before
+    // it is destroyed, so each destructor call finds no children left.
+    std::vector<std::shared_ptr<MarkdownNode>> pending = std::move(children);
+    while (!pending.empty()) {
+        std::shared_ptr<MarkdownNode> node = std::move(pending.back());
+        pending.pop_back();
+        if (node && node.use_count() == 1) {
+            for (auto& child : node->children) {
+                pending.push_back(std::move(child));
+            }
+            node->children.clear();
+        }
+    }
+}
+
 unsigned int MarkdownParser::optionsToFlags(const InternalParserOptions& options) {
     unsigned int flags = 0;
     
@@ -91,7 +113,23 @@ int MarkdownParser::enterBlockCallback(MD_BLOCKTYPE type, void* detail, void* us
     
     // Skip document block as we already have root
     if (type == MD_BLOCK_DOC) {
-        return 0;
+        if (ctx->positions) {
+            ctx->enterPosition(*ctx->root);
+        }
+        return ctx->status();
+    }
+    
+    if (ctx->deferred && ctx->deferredTight) {
+        ctx->closeDeferred();
+    }
+    ctx->enteredType = type;
+    if (ctx->blockDepth++ == 0) {
+        ctx->skipping = ctx->blockIndex < ctx->firstBlock || ctx->blockIndex >= ctx->endBlock;
+        ctx->blockIndex++;
+    }
+    if (ctx->skipping) {
+        ctx->skipOffset();
+        return ctx->status();
     }
     
     auto node = std::make_shared<MarkdownNode>(blockTypeToString(type));
@@ -148,44 +186,78 @@ int MarkdownParser::enterBlockCallback(MD_BLOCKTYPE type, void* detail, void* us
             break;
     }
     
+    if (ctx->headings) {
+        auto index = static_cast<uint32_t>(ctx->currentNode()->children.size());
+        ctx->blockPath.push_back(index);
+        if (type == MD_BLOCK_H) {
+            enterHeading(*ctx, node->level.value_or(1));
+        }
+        if (!ctx->positions) {
+            // Only the offset reported right before a block is its start
+            ctx->hasOffset = false;
+        }
+    }
     ctx->pushNode(node);
-    return 0;
+    return ctx->status();
 }
 
-int MarkdownParser::leaveBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata) {
+int MarkdownParser::leaveBlockCallback(MD_BLOCKTYPE type, void*, void* userdata) {
     auto* ctx = static_cast<ParserContext*>(userdata);
     ctx->flushText();
     
     // Skip document block
     if (type == MD_BLOCK_DOC) {
-        return 0;
+        if (ctx->positions) {
+            ctx->leavePosition(*ctx->root);
+        }
+        return ctx->status();
+    }
+    
+    if (ctx->deferred && (ctx->deferredTight || ctx->blockDepth == ctx->deferredDepth)) {
+        ctx->closeDeferred();
+    }
+    ctx->enteredType = -1;
+    ctx->blockDepth--;
+    if (ctx->skipping) {
+        ctx->skipOffset();
+        return ctx->status();
     }
     
     if (type == MD_BLOCK_CODE) {
         // For code blocks, set the accumulated text as content
         auto node = ctx->currentNode();
         if (!ctx->currentText.empty()) {
-            node->content = ctx->currentText;
+            node->content = std::move(ctx->currentText);
             ctx->currentText.clear();
         }
+        if (ctx->highlightCode && node->language) {
+            tokenizeCode(*ctx, *node);
+        }
         ctx->inCodeBlock = false;
     }
     
     if (type == MD_BLOCK_HTML) {
         auto node = ctx->currentNode();
         if (!ctx->currentText.empty()) {
-            node->content = ctx->currentText;
+            node->content = std::move(ctx->currentText);
             ctx->currentText.clear();
         }
         ctx->inHtmlBlock = false;
     }
     
+    if (ctx->headings) {
+        ctx->blockPath.pop_back();
+        ctx->inHeading = false;
+    }
     ctx->popNode();
-    return 0;
+    return ctx->status();
 }
 
 int MarkdownParser::enterSpanCallback(MD_SPANTYPE type, void* detail, void* userdata) {
     auto* ctx = static_cast<ParserContext*>(userdata);
+    if (ctx->textRuns) {
+        return enterRunSpan(*ctx, type, detail);
+    }
     ctx->flushText();
     
     auto node = std::make_shared<MarkdownNode>(spanTypeToString(type));
@@ -223,11 +295,17 @@ int MarkdownParser::enterSpanCallback(MD_SPANTYPE type, void* detail, void* user
     }
     
     ctx->pushNode(node);
-    return 0;
+    return ctx->status();
 }
 
-int MarkdownParser::leaveSpanCallback(MD_SPANTYPE type, void* detail, void* userdata) {
+int MarkdownParser::leaveSpanCallback(MD_SPANTYPE type, void*, void* userdata) {
     auto* ctx = static_cast<ParserContext*>(userdata);
+    if (ctx->textRuns) {
+        // No node takes the offset md4c reported for the span's end
+        ctx->hasOffset = false;
+        ctx->leaveRun();
+        return ctx->status();
+    }
     ctx->flushText();
     
     // For code_inline, set content from accumulated text
@@ -249,15 +327,33 @@ int MarkdownParser::leaveSpanCallback(MD_SPANTYPE type, void* detail, void* user
         if (!altText.empty()) {
             node->alt = altText;
             node->children.clear(); // Images don't have children in our AST
+            ctx->accountString(*node->alt);
         }
     }
     
     ctx->popNode();
-    return 0;
+    return ctx->status();
 }
 
 int MarkdownParser::textCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
     auto* ctx = static_cast<ParserContext*>(userdata);
+    if (ctx->positions && type != MD_TEXT_NULLCHAR) {
+        ctx->noteText(text, size);
+    }
+    if (ctx->inHeading) {
+        appendHeadingText(*ctx, type, text, size);
+    }
+    
+    if (ctx->inCodeBlock || ctx->inHtmlBlock) {
+        if (type == MD_TEXT_CODE || type == MD_TEXT_HTML) {
+            ctx->appendVerbatim(text, size);
+            return 0;
+        }
+    }
+    
+    if (ctx->textRuns) {
+        return textRunCallback(*ctx, type, text, size);
+    }
     
     switch (type) {
         case MD_TEXT_NORMAL:
@@ -270,13 +366,19 @@ int MarkdownParser::textCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE
         case MD_TEXT_SOFTBR: {
             ctx->flushText();
             auto softbreak = std::make_shared<MarkdownNode>("softbreak");
-            ctx->currentNode()->children.push_back(softbreak);
+            if (ctx->positions) {
+                ctx->placeLeaf(*softbreak);
+            }
+            ctx->appendChild(softbreak);
             break;
         }
         case MD_TEXT_BR: {
             ctx->flushText();
             auto hardbreak = std::make_shared<MarkdownNode>("hardbreak");
-            ctx->currentNode()->children.push_back(hardbreak);
+            if (ctx->positions) {
+                ctx->placeLeaf(*hardbreak);
+            }
+            ctx->appendChild(hardbreak);
             break;
         }
         case MD_TEXT_NULLCHAR:
@@ -284,7 +386,332 @@ int MarkdownParser::textCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE
             break;
     }
     
-    return 0;
+    return ctx->status();
+}
+
+void MarkdownParser::sourceOffsetCallback(MD_OFFSET offset, void* userdata) {
+    auto* ctx = static_cast<ParserContext*>(userdata);
+    ctx->offset = offset;
+    ctx->hasOffset = true;
+    if (!ctx->positions) {
+        // Installed for the heading index alone: nothing places nodes
+        ctx->lastOffset = std::max(ctx->lastOffset, static_cast<uint32_t>(offset));
+    }
+}
+
+int MarkdownParser::skipContentsCallback(MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end, void* userdata) {
+    auto* ctx = static_cast<ParserContext*>(userdata);
+    // headingsOnly needs the contents of headings, and those of the
+    // paragraphs of tight list items, which are siblings of blocks
+    if (ctx->headingsOnly && !ctx->skipping && type != MD_BLOCK_H &&
+        (type != MD_BLOCK_P || ctx->enteredType == MD_BLOCK_P)) {
+        return 1;
+    }
+    bool hasInlines = type == MD_BLOCK_P || type == MD_BLOCK_H || type == MD_BLOCK_TABLE;
+    if (hasInlines && (ctx->deferInlines || ctx->inlinesOnly)) {
+        size_t index = ctx->inlineIndex++;
+        if (ctx->inlinesOnly && index >= ctx->firstInline && index < ctx->endInline) {
+            openDeferred(*ctx, type, beg, end);
+            return 0;
+        }
+        if (ctx->deferInlines && !ctx->skipping) {
+            if (ctx->inHeading) {
+                // The heading's text is its source, markup included
+                ctx->headings->back().text.assign(ctx->input + beg, end - beg);
+            }
+            auto node = std::make_shared<MarkdownNode>("deferred");
+            if (ctx->positions) {
+                placeDeferred(*ctx, *node, beg, end);
+            }
+            ctx->appendChild(node);
+            return 1;
+        }
+    }
+    if (!ctx->skipping) {
+        return 0;
+    }
+    // Where the block's contents would have ended: paragraphs of tight list
+    // items report no offsets of their own, and the text of code and HTML
+    // blocks takes the newline of their last line
+    if ((type == MD_BLOCK_CODE || type == MD_BLOCK_HTML) && end < ctx->inputSize && ctx->input[end] == '\n') {
+        end++;
+    }
+    ctx->lastOffset = std::max(ctx->lastOffset, static_cast<uint32_t>(end));
+    return 1;
+}
+
+// Places the "deferred" node of a skeleton at the lines of its leaf; a leaf
+// without lines (an empty heading) is placed like other nodes md4c reports
+// no offsets for
+void MarkdownParser::placeDeferred(ParserContext& ctx, MarkdownNode& node, MD_OFFSET beg, MD_OFFSET end) {
+    if (beg == 0 && end == 0) {
+        ctx.placeLeaf(node);
+        return;
+    }
+    node.position = SourceSpan{beg, end};
+    ctx.lastOffset = std::max(ctx.lastOffset, static_cast<uint32_t>(end));
+}
+
+// Starts the heading index entry of a heading about to be pushed, whose
+// position blockPath already ends with; an empty heading has no offset
+// reported
+void MarkdownParser::enterHeading(ParserContext& ctx, int level) {
+    HeadingEntry entry;
+    entry.level = level;
+    entry.offset = ctx.hasOffset ? ctx.offset : ctx.lastOffset;
+    entry.path = ctx.blockPath;
+    ctx.headings->push_back(std::move(entry));
+    ctx.inHeading = true;
+}
+
+// The plain text of a heading: breaks are spaces, inline HTML is left out
+// and entities are decoded
+void MarkdownParser::appendHeadingText(ParserContext& ctx, MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size) {
+    auto& heading = ctx.headings->back().text;
+    switch (type) {
+        case MD_TEXT_SOFTBR:
+        case MD_TEXT_BR:
+            heading += ' ';
+            break;
+        case MD_TEXT_ENTITY:
+            HeadingSlugger::appendEntity(heading, std::string_view(text, size));
+            break;
+        case MD_TEXT_HTML:
+        case MD_TEXT_NULLCHAR:
+            break;
+        default:
+            heading.append(text, size);
+            break;
+    }
+}
+
+// Opens the "deferred" node of an inlinesOnly leaf in range: its contents
+// are analyzed into it. The leaf was entered right before, unless it is a
+// paragraph of a tight list item.
+void MarkdownParser::openDeferred(ParserContext& ctx, MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end) {
+    if (ctx.deferred) {
+        ctx.closeDeferred();
+    }
+    auto node = std::make_shared<MarkdownNode>("deferred");
+    if (ctx.positions) {
+        // Not moving `lastOffset` past the contents, which place themselves
+        node->position = beg == 0 && end == 0 ? SourceSpan{ctx.lastOffset, ctx.lastOffset} : SourceSpan{beg, end};
+    }
+    ctx.appendChild(node);
+    ctx.nodeStack.push(node);
+    ctx.deferred = node.get();
+    ctx.deferredDepth = ctx.blockDepth;
+    ctx.deferredTight = ctx.enteredType != static_cast<int>(type);
+    ctx.skipping = false;
+}
+
+template <typename Callback>
+int MarkdownParser::timed(void* userdata, Callback&& callback) {
+    auto* ctx = static_cast<ParserContext*>(userdata);
+    auto start = ParserContext::Clock::now();
+    if (ctx->inBlockPhase) {
+        ctx->blockPhaseEnd = start;
+        ctx->inBlockPhase = false;
+    }
+    int ret = callback();
+    ctx->callbackTime += ParserContext::Clock::now() - start;
+    return ret;
+}
+
+int MarkdownParser::timedEnterBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata) {
+    int ret = timed(userdata, [&] { return enterBlockCallback(type, detail, userdata); });
+    if (type == MD_BLOCK_DOC) {
+        static_cast<ParserContext*>(userdata)->inBlockPhase = true;
+    }
+    return ret;
+}
+
+int MarkdownParser::timedLeaveBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata) {
+    return timed(userdata, [&] { return leaveBlockCallback(type, detail, userdata); });
+}
+
+int MarkdownParser::timedEnterSpanCallback(MD_SPANTYPE type, void* detail, void* userdata) {
+    return timed(userdata, [&] { return enterSpanCallback(type, detail, userdata); });
+}
+
+int MarkdownParser::timedLeaveSpanCallback(MD_SPANTYPE type, void* detail, void* userdata) {
+    return timed(userdata, [&] { return leaveSpanCallback(type, detail, userdata); });
+}
+
+int MarkdownParser::timedTextCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
+    return timed(userdata, [&] { return textCallback(type, text, size, userdata); });
+}
+
+// md4c blocks carry their size in a header, so that reallocations and frees
+// can be accounted; the header keeps the block aligned like malloc() does
+static constexpr size_t kMd4cHeaderSize = alignof(std::max_align_t);
+
+void* MarkdownParser::md4cRealloc(void* ptr, size_t size, void* userdata) {
+    auto* memory = static_cast<ParserContext*>(userdata)->memory;
+    char* block = ptr ? static_cast<char*>(ptr) - kMd4cHeaderSize : nullptr;
+    size_t oldSize = 0;
+    if (block) {
+        std::memcpy(&oldSize, block, sizeof(oldSize));
+    }
+    if (!memory->withinLimit(size, oldSize)) {
+        memory->exceeded = true;
+        return nullptr;
+    }
+    auto* resized = static_cast<char*>(std::realloc(block, size + kMd4cHeaderSize));
+    if (!resized) {
+        return nullptr;
+    }
+    memory->allocate(memory->md4c, size, oldSize);
+    std::memcpy(resized, &size, sizeof(size));
+    return resized + kMd4cHeaderSize;
+}
+
+void MarkdownParser::md4cFree(void* ptr, void* userdata) {
+    auto* memory = static_cast<ParserContext*>(userdata)->memory;
+    char* block = static_cast<char*>(ptr) - kMd4cHeaderSize;
+    size_t size = 0;
+    std::memcpy(&size, block, sizeof(size));
+    memory->release(memory->md4c, size);
+    std::free(block);
+}
+
+// The heading index is not collected for the leaves of an inlinesOnly parse
+bool MarkdownParser::collectsHeadings(const InternalParserOptions& options) {
+    return (options.collectHeadings || options.headingsOnly) && !options.inlinesOnly;
+}
+
+size_t MarkdownParser::countNodes(const std::shared_ptr<MarkdownNode>& root) {
+    size_t count = 0;
+    walkTree(root.get(), [&](const MarkdownNode*, size_t) { count++; return true; }, [](const MarkdownNode*) {});
+    return count;
+}
+
+ParseResult MarkdownParser::memoryLimitFailure(const std::string& content, const ParserContext& ctx) {
+    static const char* kMessage = "Parse exceeds maximum memory limit";
+    if (!ctx.positions) {
+        return ParseResult::Failure(kMessage);
+    }
+    // With positions we know how far the parse got
+    auto location = LineIndex(content).locate(ctx.lastOffset);
+    return ParseResult::Failure(kMessage, static_cast<int>(location.line), static_cast<int>(location.column));
+}
+
+// Highlights a code block whose language has a lexer. The text was flushed
+// into one text child when the block was left.
+void MarkdownParser::tokenizeCode(ParserContext& ctx, MarkdownNode& node) {
+    const CodeLanguage* language = CodeTokenizer::findLanguage(*node.language);
+    if (!language || node.children.size() != 1 || !node.children.front()->content) {
+        return;
+    }
+    const std::string& code = *node.children.front()->content;
+    CodeTokenizer::tokenize(*language, code.data(), code.size(), node.tokens);
+    CodeTokenizer::toUtf16(code.data(), code.size(), node.tokens);
+    if (ctx.memory) {
+        ctx.memory->allocate(ctx.memory->ast, node.tokens.capacity() * sizeof(CodeToken));
+    }
+}
+
+// Span callback with textRuns: a span only changes the styles of the runs
+int MarkdownParser::enterRunSpan(ParserContext& ctx, MD_SPANTYPE type, void* detail) {
+    // No node takes the offset md4c reported for the span's start
+    ctx.hasOffset = false;
+    auto optional = [](const MD_ATTRIBUTE& attribute) {
+        return attribute.size > 0 ? std::optional<std::string>(std::in_place, attribute.text, attribute.size)
+                                  : std::nullopt;
+    };
+    switch (type) {
+        case MD_SPAN_EM: ctx.enterRun(kStyleEmphasis); break;
+        case MD_SPAN_STRONG: ctx.enterRun(kStyleStrong); break;
+        case MD_SPAN_DEL: ctx.enterRun(kStyleStrikethrough); break;
+        case MD_SPAN_CODE: ctx.enterRun(kStyleCode); break;
+        case MD_SPAN_U: ctx.enterRun(kStyleUnderline); break;
+        case MD_SPAN_LATEXMATH: ctx.enterRun(kStyleMath); break;
+        case MD_SPAN_LATEXMATH_DISPLAY: ctx.enterRun(kStyleDisplayMath); break;
+        case MD_SPAN_A: {
+            auto* a = static_cast<MD_SPAN_A_DETAIL*>(detail);
+            ctx.enterRun(kStyleLink, TextRunLink{optional(a->href), std::nullopt, optional(a->title)});
+            break;
+        }
+        case MD_SPAN_WIKILINK: {
+            auto* wiki = static_cast<MD_SPAN_WIKILINK_DETAIL*>(detail);
+            ctx.enterRun(kStyleWikiLink, TextRunLink{optional(wiki->target), std::nullopt, std::nullopt});
+            break;
+        }
+        case MD_SPAN_IMG: {
+            auto* img = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
+            const auto* href = ctx.runHref();
+            ctx.enterRun(kStyleImage, TextRunLink{href ? *href : std::nullopt, optional(img->src), optional(img->title)});
+            break;
+        }
+        default:
+            ctx.enterRun(0);
+            break;
+    }
+    return ctx.status();
+}
+
+// Text callback with textRuns: breaks are text too, a space for a soft
+// break as the renderer shows it, a newline for a hard one
+int MarkdownParser::textRunCallback(ParserContext& ctx, MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size) {
+    switch (type) {
+        case MD_TEXT_SOFTBR:
+            ctx.appendRun(" ", 1);
+            break;
+        case MD_TEXT_BR:
+            ctx.appendRun("\n", 1);
+            break;
+        case MD_TEXT_NULLCHAR:
+            break;
+        default:
+            ctx.appendRun(text, size);
+            break;
+    }
+    return ctx.status();
+}
+
+void MarkdownParser::initContext(ParserContext& ctx, const std::string& source, const InternalParserOptions& options,
+                                 InternalParseMemory* memory) {
+    ctx.input = source.data();
+    ctx.inputSize = source.size();
+    ctx.positions = options.sourcePositions;
+    ctx.highlightCode = options.highlightCode;
+    ctx.textRuns = options.textRuns;
+    ctx.firstBlock = options.firstBlock;
+    ctx.endBlock = options.endBlock;
+    ctx.deferInlines = options.deferInlines;
+    ctx.inlinesOnly = options.inlinesOnly;
+    ctx.firstInline = options.firstInline;
+    ctx.endInline = options.endInline;
+    if (options.inlinesOnly) {
+        // No blocks of their own, only the contents of the leaves in range
+        ctx.firstBlock = 0;
+        ctx.endBlock = 0;
+    }
+    if (memory) {
+        ctx.memory = memory;
+        ctx.accountNode(*ctx.root);
+    }
+}
+
+MD_PARSER MarkdownParser::md4cParser(const InternalParserOptions& options, bool accountMemory) {
+    return {
+        0,  // abi_version - use 0 for compatibility
+        optionsToFlags(options),
+        options.collectTimings ? timedEnterBlockCallback : enterBlockCallback,
+        options.collectTimings ? timedLeaveBlockCallback : leaveBlockCallback,
+        options.collectTimings ? timedEnterSpanCallback : enterSpanCallback,
+        options.collectTimings ? timedLeaveSpanCallback : leaveSpanCallback,
+        options.collectTimings ? timedTextCallback : textCallback,
+        nullptr,  // debug_log
+        nullptr,  // syntax
+        accountMemory ? md4cRealloc : nullptr,
+        accountMemory ? md4cFree : nullptr,
+        options.sourcePositions || collectsHeadings(options) ? sourceOffsetCallback : nullptr,
+        options.firstBlock > 0 || options.endBlock != SIZE_MAX || options.deferInlines || options.inlinesOnly ||
+                options.headingsOnly
+            ? skipContentsCallback
+            : nullptr
+    };
 }
 
 ParseResult MarkdownParser::parse(const std::string& content, const InternalParserOptions& options) {
@@ -296,24 +723,59 @@ ParseResult MarkdownParser::parse(const std::string& content, const InternalPars
     // Handle empty content
     if (content.empty()) {
         auto emptyDoc = std::make_shared<MarkdownNode>("document");
-        return ParseResult::Success({emptyDoc});
+        if (options.sourcePositions) {
+            emptyDoc->position = SourceSpan();
+        }
+        auto success = ParseResult::Success({emptyDoc});
+        if (collectsHeadings(options)) {
+            success.headings.emplace();
+            if (options.headingsOnly) {
+                success.nodes.clear();
+            }
+        }
+        if (options.collectTimings) {
+            success.timings = InternalParseTimings();
+            success.timings->nodeCount = 1;
+        }
+        if (options.collectMemory || options.maxMemory > 0) {
+            success.memory = InternalParseMemory();
+            success.memory->limit = options.maxMemory;
+        }
+        return success;
+    }
+    
+    auto start = ParserContext::Clock::now();
+    
+    std::optional<InternalParseMemory> memory;
+    if (options.collectMemory || options.maxMemory > 0) {
+        memory.emplace();
+        memory->limit = options.maxMemory;
+    }
+    
+    // Parse the normalized copy of the input if the pre-pass had to change
+    // anything; the copy counts as parser memory
+    std::string normalized;
+    bool isNormalized = options.normalizeInput && InputNormalizer::normalize(content, normalized);
+    const std::string& source = isNormalized ? normalized : content;
+    if (isNormalized && memory && !memory->allocate(memory->md4c, normalized.capacity() + 1)) {
+        return ParseResult::Failure("Parse exceeds maximum memory limit");
     }
     
     ParserContext ctx;
+    initContext(ctx, source, options, memory ? &*memory : nullptr);
+    MD_PARSER parser = md4cParser(options, memory.has_value());
+    std::vector<HeadingEntry> headings;
+    if (collectsHeadings(options)) {
+        ctx.headings = &headings;
+        ctx.headingsOnly = options.headingsOnly;
+    }
     
-    MD_PARSER parser = {
-        0,  // abi_version - use 0 for compatibility
-        optionsToFlags(options),
-        enterBlockCallback,
-        leaveBlockCallback,
-        enterSpanCallback,
-        leaveSpanCallback,
-        textCallback,
-        nullptr,  // debug_log
-        nullptr   // syntax
-    };
+    int result = md_parse(source.c_str(), static_cast<MD_SIZE>(source.size()), &parser, &ctx);
+    auto parsed = ParserContext::Clock::now();
     
-    int result = md_parse(content.c_str(), static_cast<MD_SIZE>(content.size()), &parser, &ctx);
+    if (memory && memory->exceeded) {
+        return memoryLimitFailure(source, ctx);
+    }
     
     if (result != 0) {
         return ParseResult::Failure("Failed to parse markdown");
@@ -321,8 +783,42 @@ ParseResult MarkdownParser::parse(const std::string& content, const InternalPars
     
     // Flush any remaining text
     ctx.flushText();
+    if (memory && memory->exceeded) {
+        return memoryLimitFailure(source, ctx);
+    }
     
-    return ParseResult::Success({ctx.root});
+    auto success = ParseResult::Success({ctx.root});
+    if (ctx.headings) {
+        HeadingSlugger slugger;
+        for (auto& heading : headings) {
+            heading.slug = slugger.slug(heading.text);
+        }
+        success.headings = std::move(headings);
+        if (options.headingsOnly) {
+            // The tree was only built far enough to find the headings
+            success.nodes.clear();
+        }
+    }
+    success.memory = memory;
+    if (isNormalized) {
+        success.normalizedInput = std::move(normalized);
+    }
+    if (options.collectTimings) {
+        using Ms = std::chrono::duration<double, std::milli>;
+        auto end = ParserContext::Clock::now();
+        if (ctx.inBlockPhase) {
+            ctx.blockPhaseEnd = parsed;
+        }
+        InternalParseTimings timings;
+        timings.blockMs = Ms(ctx.blockPhaseEnd - start).count();
+        timings.inlineMs = std::max(0.0, Ms(parsed - ctx.blockPhaseEnd).count() - Ms(ctx.callbackTime).count());
+        timings.treeMs = Ms(ctx.callbackTime + (end - parsed)).count();
+        timings.totalMs = Ms(end - start).count();
+        timings.inputBytes = content.size();
+        timings.nodeCount = countNodes(ctx.root);
+        success.timings = timings;
+    }
+    return success;
 }
 
 } // namespace margelo::nitro::hypermarkdown
@@ -5,6 +5,13 @@
 #include <memory>
 #include <optional>
 #include <stack>
+#include <tuple>
+#include <utility>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include "CodeTokenizer.h"
+#include "InputNormalizer.h"
 
 extern "C" {
 #include "md4c.h"
@@ -20,6 +27,43 @@ enum class TableCellAlign {
     Right
 };
 
+// Byte range [start, end) of a node in the parsed input
+struct SourceSpan {
+    uint32_t start = 0;
+    uint32_t end = 0;
+};
+
+// Styles of a text run, a bitmask with one bit per kind of span the run is
+// in. The values are serialized (TEXT_RUN_STYLES in src/types/ast.ts).
+enum TextStyle : uint16_t {
+    kStyleEmphasis = 1,
+    kStyleStrong = 2,
+    kStyleStrikethrough = 4,
+    kStyleCode = 8,
+    kStyleLink = 16,
+    kStyleImage = 32,      // the run is the alt text of an image
+    kStyleMath = 64,
+    kStyleDisplayMath = 128,
+    kStyleUnderline = 256,
+    kStyleWikiLink = 512
+};
+
+// A range of a text node's content with the same styles (textRuns). `link`
+// indexes the node's links for runs in a link or image, and is -1 otherwise.
+struct TextRun {
+    uint32_t length = 0;
+    uint16_t styles = 0;
+    int32_t link = -1;
+};
+
+// Target of a link, wiki link or image of a text node's runs. An image in
+// a link has both `src` and the link's `href`.
+struct TextRunLink {
+    std::optional<std::string> href;
+    std::optional<std::string> src;
+    std::optional<std::string> title;
+};
+
 // Markdown node structure matching TypeScript types
 struct MarkdownNode {
     std::string type;
@@ -38,6 +82,16 @@ struct MarkdownNode {
     // Code block language
     std::optional<std::string> language;
     
+    // Syntax tokens of a code block's text, only set with highlightCode.
+    // Offsets and lengths are in UTF-16 code units.
+    std::vector<CodeToken> tokens;
+    
+    // Styled runs of a text node's content, only set with textRuns, and
+    // only if some of the text is styled. They cover the content in order,
+    // lengths are in UTF-16 code units.
+    std::vector<TextRun> runs;
+    std::vector<TextRunLink> links;
+    
     // List properties
     std::optional<bool> ordered;
     std::optional<int> start;
@@ -49,9 +103,50 @@ struct MarkdownNode {
     std::optional<TableCellAlign> align;
     std::optional<bool> isHeader;
     
+    // Source range, only set when parsing with sourcePositions
+    std::optional<SourceSpan> position;
+    
     MarkdownNode(const std::string& nodeType) : type(nodeType) {}
+    
+    // Releases the subtree with an explicit stack: the default destructor
+    // would recurse once per nesting level through `children`
+    ~MarkdownNode();
 };
 
+// Depth-first walk over a node tree driven by an explicit stack, so the
+// tree depth is bounded by the heap rather than the thread's stack. Use it
+// for every tree walk. `enter(node, index)` runs before the children of a
+// node, `index` being its position among its siblings; returning false
+// stops the walk, and walkTree returns false. `leave(node)` runs after the
+// children. Null children are entered and left like leaves.
+template <typename Enter, typename Leave>
+bool walkTree(const MarkdownNode* root, Enter&& enter, Leave&& leave) {
+    struct Frame {
+        const MarkdownNode* node;
+        size_t next;
+    };
+    
+    if (!enter(root, 0)) {
+        return false;
+    }
+    std::vector<Frame> stack = {{root, 0}};
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.node && frame.next < frame.node->children.size()) {
+            size_t index = frame.next++;
+            const MarkdownNode* child = frame.node->children[index].get();
+            if (!enter(child, index)) {
+                return false;
+            }
+            stack.push_back({child, 0});
+        } else {
+            leave(frame.node);
+            stack.pop_back();
+        }
+    }
+    return true;
+}
+
 // Parse error structure
 struct ParseError {
     std::string message;
@@ -62,11 +157,89 @@ struct ParseError {
     ParseError(const std::string& msg, int l, int c) : message(msg), line(l), column(c) {}
 };
 
+// Per-phase timing breakdown of one parse (separate from Nitro-generated ParseTimings)
+struct InternalParseTimings {
+    double blockMs = 0;      // md4c block analysis, including reference definitions
+    double inlineMs = 0;     // md4c inline analysis and callback dispatch
+    double treeMs = 0;       // building the MarkdownNode tree in the callbacks
+    double serializeMs = 0;  // JSON serialization, filled in by the caller
+    double totalMs = 0;
+    size_t inputBytes = 0;
+    size_t nodeCount = 0;
+    size_t outputBytes = 0;  // filled in by the caller
+};
+
+// Allocation counters of one kind of memory used by a parse
+struct InternalMemoryUsage {
+    size_t allocations = 0;
+    size_t bytesAllocated = 0;
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+};
+
+// Memory accounting of one parse (separate from Nitro-generated ParseMemory).
+// md4c's scratch memory is counted exactly through its allocator hooks, the
+// normalized copy of the input (normalizeInput) goes with it; the AST and
+// the JSON output are accounted from node sizes and string and vector
+// capacities, as the standard library does not let us hook those.
+struct InternalParseMemory {
+    InternalMemoryUsage md4c;
+    InternalMemoryUsage ast;
+    InternalMemoryUsage output;
+    size_t limit = 0;  // 0 = unlimited
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    bool exceeded = false;
+    
+    // Whether replacing `replaced` live bytes by `size` bytes stays in the limit
+    bool withinLimit(size_t size, size_t replaced = 0) const {
+        return limit == 0 || liveBytes - replaced + size <= limit;
+    }
+    
+    // Records an allocation of `size` bytes that replaces `replaced` bytes
+    // (for reallocations). Returns false, and records nothing, if the live
+    // total would go over the limit.
+    bool allocate(InternalMemoryUsage& usage, size_t size, size_t replaced = 0) {
+        if (!withinLimit(size, replaced)) {
+            exceeded = true;
+            return false;
+        }
+        usage.allocations++;
+        usage.bytesAllocated += size;
+        usage.liveBytes = usage.liveBytes - replaced + size;
+        usage.peakBytes = std::max(usage.peakBytes, usage.liveBytes);
+        liveBytes = liveBytes - replaced + size;
+        peakBytes = std::max(peakBytes, liveBytes);
+        return true;
+    }
+    
+    void release(InternalMemoryUsage& usage, size_t size) {
+        usage.liveBytes -= size;
+        liveBytes -= size;
+    }
+};
+
+// A heading of the heading index (collectHeadings, headingsOnly)
+struct HeadingEntry {
+    int level = 1;
+    std::string text;               // plain text of its content
+    std::string slug;               // GitHub-style anchor, unique in the document
+    uint32_t offset = 0;            // input offset of its content, as in its position
+    std::vector<uint32_t> path;     // child indices from the document node down to it
+};
+
 // Parse result
 struct ParseResult {
     bool success;
     std::vector<std::shared_ptr<MarkdownNode>> nodes;
     std::optional<ParseError> error;
+    std::optional<InternalParseTimings> timings;
+    std::optional<InternalParseMemory> memory;
+    // The input as it was parsed, if normalizeInput had to change it. Node
+    // positions are offsets into this text then.
+    std::optional<std::string> normalizedInput;
+    // The headings in document order, with collectHeadings or headingsOnly
+    std::optional<std::vector<HeadingEntry>> headings;
     
     static ParseResult Success(std::vector<std::shared_ptr<MarkdownNode>> nodes) {
         ParseResult result;
@@ -81,6 +254,13 @@ struct ParseResult {
         result.error = ParseError(message);
         return result;
     }
+    
+    static ParseResult Failure(const std::string& message, int line, int column) {
+        ParseResult result;
+        result.success = false;
+        result.error = ParseError(message, line, column);
+        return result;
+    }
 };
 
 // Internal parser options (separate from Nitro-generated ParserOptions)
@@ -94,6 +274,33 @@ struct InternalParserOptions {
     bool wiki = false;
     size_t maxInputSize = 10 * 1024 * 1024; // 10MB
     int timeout = 5000; // 5 seconds
+    bool collectTimings = false;
+    bool collectMemory = false;
+    size_t maxMemory = 0; // bytes, 0 = unlimited
+    bool sourcePositions = false;
+    bool normalizeInput = false;
+    bool highlightCode = false;
+    bool textRuns = false;
+    // Top-level blocks to build nodes for, by index (getBlocks): the
+    // document gets only the blocks in [firstBlock, endBlock) as children,
+    // the contents of the others are not even analyzed
+    size_t firstBlock = 0;
+    size_t endBlock = SIZE_MAX;
+    // Two-phase parsing. With deferInlines, the inline content of
+    // paragraphs, headings and tables is not analyzed: a "deferred" node
+    // stands in its place, the leaves being numbered in document order.
+    // With inlinesOnly (parseInlines), the document instead gets one
+    // "deferred" node for each leaf in [firstInline, endInline), holding the
+    // nodes of its content, and no other nodes.
+    bool deferInlines = false;
+    bool inlinesOnly = false;
+    size_t firstInline = 0;
+    size_t endInline = SIZE_MAX;
+    // Heading index. With collectHeadings, the result also lists the
+    // headings; with headingsOnly, it lists them instead of returning nodes,
+    // and the inline content of other blocks is not analyzed.
+    bool collectHeadings = false;
+    bool headingsOnly = false;
 };
 
 // Parser context for md4c callbacks
@@ -103,6 +310,87 @@ struct ParserContext {
     std::string currentText;
     bool inCodeBlock = false;
     bool inHtmlBlock = false;
+    bool highlightCode = false;
+    
+    // Text runs (textRuns): the inline content between two block callbacks
+    // goes into one text node, `runText`, as styled runs instead of a node
+    // per span. New text gets `runStyles` and `runLink`; `runScopes` holds
+    // the values to restore when the current span is left.
+    bool textRuns = false;
+    MarkdownNode* runText = nullptr;
+    uint16_t runStyles = 0;
+    int32_t runLink = -1;
+    std::vector<std::pair<uint16_t, int32_t>> runScopes;
+    
+    // Top-level block range (firstBlock, endBlock): blocks outside of it
+    // are entered and left without building nodes, and their contents are
+    // skipped. `blockDepth` is the nesting below the document.
+    size_t firstBlock = 0;
+    size_t endBlock = SIZE_MAX;
+    size_t blockIndex = 0;
+    size_t blockDepth = 0;
+    bool skipping = false;
+    
+    // Deferred inline content (deferInlines, inlinesOnly). `inlineIndex`
+    // numbers the leaves with inline content. With inlinesOnly, `deferred`
+    // is the open "deferred" node of a leaf in range, closed when the leaf
+    // is left; a paragraph of a tight list item is not entered or left, so
+    // that one is closed by the next block callback. `enteredType` is the
+    // block entered last, if no block was left since.
+    bool deferInlines = false;
+    bool inlinesOnly = false;
+    size_t firstInline = 0;
+    size_t endInline = SIZE_MAX;
+    size_t inlineIndex = 0;
+    MarkdownNode* deferred = nullptr;
+    size_t deferredDepth = 0;
+    bool deferredTight = false;
+    int enteredType = -1;
+    
+    // Heading index (collectHeadings, headingsOnly): `blockPath` holds the
+    // child index of every open block, the text of an open heading goes to
+    // the last entry
+    std::vector<HeadingEntry>* headings = nullptr;
+    std::vector<uint32_t> blockPath;
+    bool inHeading = false;
+    bool headingsOnly = false;
+    
+    // The input being parsed
+    const char* input = nullptr;
+    size_t inputSize = 0;
+    
+    // Text of the current code or HTML block while it is still a single
+    // range of the input; it is copied only once, when the block is flushed
+    const char* verbatimBegin = nullptr;
+    size_t verbatimSize = 0;
+    
+    // Phase timing, only maintained by the timed callbacks. md4c analyzes
+    // all blocks between entering the document and the next callback, so
+    // that callback marks the end of the block phase.
+    using Clock = std::chrono::steady_clock;
+    bool inBlockPhase = false;
+    Clock::time_point blockPhaseEnd;
+    Clock::duration callbackTime = Clock::duration::zero();
+    
+    // Memory accounting, only set when collectMemory or maxMemory is used
+    InternalParseMemory* memory = nullptr;
+    
+    // Source positions, only maintained with sourcePositions. md4c reports
+    // the offset where a block or span begins right before entering it, and
+    // where it ends right before leaving it. Nodes it reports no offsets for
+    // take the range of their children, or an empty range at `lastOffset`,
+    // the end of the latest range seen.
+    bool positions = false;
+    bool hasOffset = false;
+    uint32_t offset = 0;
+    uint32_t lastOffset = 0;
+    
+    // Input range of the pending text, as far as it is taken from the input
+    // (md4c passes some text, like the space of a collapsed line break, from
+    // string literals)
+    bool hasTextRange = false;
+    uint32_t textStart = 0;
+    uint32_t textEnd = 0;
     
     ParserContext() {
         root = std::make_shared<MarkdownNode>("document");
@@ -114,21 +402,276 @@ struct ParserContext {
     }
     
     void pushNode(std::shared_ptr<MarkdownNode> node) {
-        currentNode()->children.push_back(node);
+        if (positions) {
+            enterPosition(*node);
+        }
+        appendChild(node);
         nodeStack.push(node);
     }
     
+    void enterPosition(MarkdownNode& node) {
+        if (hasOffset) {
+            node.position = SourceSpan{offset, offset};
+            lastOffset = offset;
+            hasOffset = false;
+        }
+    }
+    
+    void leavePosition(MarkdownNode& node) {
+        const auto& children = node.children;
+        bool placedChildren = !children.empty() && children.front()->position && children.back()->position;
+        if (hasOffset) {
+            node.position = SourceSpan{node.position ? node.position->start : offset, offset};
+            hasOffset = false;
+        } else if (!node.position) {
+            node.position = placedChildren ? *children.front()->position : SourceSpan{lastOffset, lastOffset};
+        }
+        // A node covers its children, e.g. a code block also covers the
+        // newline ending its last line
+        if (placedChildren) {
+            node.position->start = std::min(node.position->start, children.front()->position->start);
+            node.position->end = std::max(node.position->end, children.back()->position->end);
+        }
+        lastOffset = std::max(lastOffset, node.position->end);
+    }
+    
+    // Takes the offset of a skipped block, so that nodes placed at
+    // `lastOffset` after it are placed as in a full parse
+    void skipOffset() {
+        if (hasOffset) {
+            lastOffset = std::max(lastOffset, offset);
+            hasOffset = false;
+        }
+    }
+    
+    // Closes the "deferred" node of an inlinesOnly leaf, whose contents
+    // are complete; the blocks after it are skipped again
+    void closeDeferred() {
+        flushText();
+        nodeStack.pop();
+        deferred = nullptr;
+        skipping = true;
+    }
+    
+    // Places a node md4c reports no offsets for, like a line break
+    void placeLeaf(MarkdownNode& node) {
+        node.position = SourceSpan{lastOffset, lastOffset};
+    }
+    
+    void placeText(MarkdownNode& node) {
+        if (!hasTextRange) {
+            placeLeaf(node);
+            return;
+        }
+        node.position = SourceSpan{textStart, textEnd};
+        lastOffset = std::max(lastOffset, textEnd);
+        hasTextRange = false;
+    }
+    
+    void noteText(const char* text, size_t size) {
+        if (text < input || text + size > input + inputSize) {
+            return;
+        }
+        auto start = static_cast<uint32_t>(text - input);
+        if (!hasTextRange) {
+            hasTextRange = true;
+            textStart = start;
+        }
+        textEnd = start + static_cast<uint32_t>(size);
+    }
+    
+    void appendChild(std::shared_ptr<MarkdownNode> node) {
+        auto& children = currentNode()->children;
+        if (!memory) {
+            children.push_back(std::move(node));
+            return;
+        }
+        accountNode(*node);
+        size_t capacity = children.capacity();
+        children.push_back(std::move(node));
+        if (children.capacity() != capacity) {
+            constexpr size_t kPointerSize = sizeof(std::shared_ptr<MarkdownNode>);
+            memory->allocate(memory->ast, children.capacity() * kPointerSize, capacity * kPointerSize);
+        }
+    }
+    
+    // Accounts a node and the heap memory of its strings. make_shared puts
+    // the node and its reference counts in one allocation.
+    void accountNode(const MarkdownNode& node) {
+        constexpr size_t kControlBlockSize = 16;
+        memory->allocate(memory->ast, sizeof(MarkdownNode) + kControlBlockSize);
+        accountString(node.type);
+        for (const auto* str : {&node.content, &node.href, &node.src, &node.alt, &node.title, &node.language}) {
+            if (*str) {
+                accountString(**str);
+            }
+        }
+    }
+    
+    void accountString(const std::string& str) {
+        static const size_t kInlineCapacity = std::string().capacity();
+        if (memory && str.capacity() > kInlineCapacity) {
+            memory->allocate(memory->ast, str.capacity() + 1);
+        }
+    }
+    
+    // Non-zero once the parse has to be aborted, returned by the callbacks
+    int status() const {
+        return memory && memory->exceeded ? -1 : 0;
+    }
+    
+    // md4c can leave a span it did not enter (e.g. "[](~~)~~"), so this
+    // never pops the root, nor an open "deferred" node
     void popNode() {
-        if (nodeStack.size() > 1) {
+        if (nodeStack.size() > 1 && nodeStack.top().get() != deferred) {
+            if (positions) {
+                leavePosition(*nodeStack.top());
+            }
             nodeStack.pop();
         }
     }
     
+    // Appends text of a code or HTML block. md4c emits such blocks as runs
+    // of the input, so consecutive runs usually just extend the range.
+    void appendVerbatim(const char* text, size_t size) {
+        if (currentText.empty()) {
+            bool inInput = text >= input && text + size <= input + inputSize;
+            if (inInput && verbatimSize == 0) {
+                verbatimBegin = text;
+                verbatimSize = size;
+                return;
+            }
+            if (inInput && verbatimBegin + verbatimSize == text) {
+                verbatimSize += size;
+                return;
+            }
+            // Not contiguous (e.g. indentation inside a list), fall back to copying
+            if (verbatimSize > 0) {
+                currentText.assign(verbatimBegin, verbatimSize);
+                verbatimSize = 0;
+            }
+        }
+        currentText.append(text, size);
+    }
+    
+    // The text node taking the runs, created with the first run
+    MarkdownNode& runNode() {
+        if (!runText) {
+            auto node = std::make_shared<MarkdownNode>("text");
+            node->content.emplace();
+            runText = node.get();
+            appendChild(node);
+        }
+        return *runText;
+    }
+    
+    // Appends text with the current styles, to the last run if it has them
+    void appendRun(const char* text, size_t size) {
+        MarkdownNode& node = runNode();
+        node.content->append(text, size);
+        auto& runs = node.runs;
+        if (runs.empty() || runs.back().styles != runStyles || runs.back().link != runLink) {
+            runs.push_back({0, runStyles, runLink});
+        }
+        runs.back().length += static_cast<uint32_t>(size);
+    }
+    
+    // Applies the styles of a span, and its link target, to the text up to
+    // leaveRun()
+    void enterRun(uint16_t style, std::optional<TextRunLink> link = std::nullopt) {
+        runScopes.emplace_back(runStyles, runLink);
+        runStyles |= style;
+        if (link) {
+            auto& links = runNode().links;
+            runLink = static_cast<int32_t>(links.size());
+            links.push_back(std::move(*link));
+        }
+    }
+    
+    // A link or image without text gets an empty run, so its target is
+    // not lost. Runs after it in it have its link or a later one.
+    void leaveRun() {
+        if (runScopes.empty()) {
+            return;
+        }
+        if (runLink != runScopes.back().second) {
+            auto& runs = runNode().runs;
+            if (runs.empty() || runs.back().link < runLink) {
+                runs.push_back({0, runStyles, runLink});
+            }
+        }
+        std::tie(runStyles, runLink) = runScopes.back();
+        runScopes.pop_back();
+    }
+    
+    // The href of the innermost link the runs are in, if any
+    const std::optional<std::string>* runHref() const {
+        if (!runText || runLink < 0 || !(runStyles & (kStyleLink | kStyleWikiLink))) {
+            return nullptr;
+        }
+        return &runText->links[static_cast<size_t>(runLink)].href;
+    }
+    
+    // Completes the text node of the runs: run lengths go from bytes to
+    // UTF-16 code units, as the renderer slices the JS string. Plain text
+    // needs no runs.
+    void finishRuns() {
+        MarkdownNode& node = *runText;
+        runText = nullptr;
+        if (node.runs.size() == 1 && node.runs.front().styles == 0 && node.runs.front().link < 0) {
+            node.runs.clear();
+        }
+        // The JSON has the content as a whole, so a UTF-8 sequence can span
+        // runs (invalid bytes of adjacent runs become one U+FFFD). It counts
+        // toward the run it starts in.
+        const char* text = node.content->data();
+        const char* end = text + node.content->size();
+        const char* runEnd = text;
+        for (auto& run : node.runs) {
+            runEnd += run.length;
+            run.length = static_cast<uint32_t>(InputNormalizer::utf16Units(text, runEnd, end));
+        }
+        if (positions) {
+            placeText(node);
+        }
+        if (memory) {
+            accountString(*node.content);
+            memory->allocate(memory->ast, node.runs.capacity() * sizeof(TextRun) +
+                                              node.links.capacity() * sizeof(TextRunLink));
+            for (const auto& link : node.links) {
+                for (const auto* str : {&link.href, &link.src, &link.title}) {
+                    if (*str) {
+                        accountString(**str);
+                    }
+                }
+            }
+        }
+    }
+    
     void flushText() {
+        if (runText) {
+            finishRuns();
+        }
+        if (verbatimSize > 0) {
+            auto textNode = std::make_shared<MarkdownNode>("text");
+            textNode->content.emplace(verbatimBegin, verbatimSize);
+            if (positions) {
+                placeText(*textNode);
+            }
+            appendChild(textNode);
+            verbatimBegin = nullptr;
+            verbatimSize = 0;
+            return;
+        }
         if (!currentText.empty()) {
             auto textNode = std::make_shared<MarkdownNode>("text");
-            textNode->content = currentText;
-            currentNode()->children.push_back(textNode);
+            // Move rather than copy, so a long run of text is held once and
+            // its buffer is not kept around for the rest of the document
+            textNode->content = std::move(currentText);
+            if (positions) {
+                placeText(*textNode);
+            }
+            appendChild(textNode);
             currentText.clear();
         }
     }
@@ -139,8 +682,24 @@ class MarkdownParser {
 public:
     static ParseResult parse(const std::string& content, const InternalParserOptions& options = InternalParserOptions());
     
-private:
+    // md4c flags and node type names, shared with passes that run md4c
+    // with callbacks of their own
     static unsigned int optionsToFlags(const InternalParserOptions& options);
+    static std::string blockTypeToString(MD_BLOCKTYPE type);
+    
+    // Setup of a parse into `ctx`, shared with parses done in steps
+    // (IncrementalParser). `source` is the input as given to md4c, `memory`
+    // is set for collectMemory or maxMemory; the md4c allocator hooks then
+    // expect `ctx` as userdata.
+    static void initContext(ParserContext& ctx, const std::string& source, const InternalParserOptions& options,
+                            InternalParseMemory* memory);
+    static MD_PARSER md4cParser(const InternalParserOptions& options, bool accountMemory);
+    static ParseResult memoryLimitFailure(const std::string& content, const ParserContext& ctx);
+    
+    // Whether a parse with these options has a heading index
+    static bool collectsHeadings(const InternalParserOptions& options);
+    
+private:
     
     // md4c callbacks
     static int enterBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata);
@@ -148,11 +707,33 @@ private:
     static int enterSpanCallback(MD_SPANTYPE type, void* detail, void* userdata);
     static int leaveSpanCallback(MD_SPANTYPE type, void* detail, void* userdata);
     static int textCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata);
+    static void sourceOffsetCallback(MD_OFFSET offset, void* userdata);
+    static int skipContentsCallback(MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end, void* userdata);
+    
+    // Same callbacks, also accounting the time spent in them (collectTimings)
+    template <typename Callback>
+    static int timed(void* userdata, Callback&& callback);
+    static int timedEnterBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata);
+    static int timedLeaveBlockCallback(MD_BLOCKTYPE type, void* detail, void* userdata);
+    static int timedEnterSpanCallback(MD_SPANTYPE type, void* detail, void* userdata);
+    static int timedLeaveSpanCallback(MD_SPANTYPE type, void* detail, void* userdata);
+    static int timedTextCallback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata);
+    
+    // md4c allocator hooks used with memory accounting
+    static void* md4cRealloc(void* ptr, size_t size, void* userdata);
+    static void md4cFree(void* ptr, void* userdata);
     
     // Helper methods
-    static std::string blockTypeToString(MD_BLOCKTYPE type);
     static std::string spanTypeToString(MD_SPANTYPE type);
     static TableCellAlign alignFromMd4c(MD_ALIGN align);
+    static size_t countNodes(const std::shared_ptr<MarkdownNode>& root);
+    static void tokenizeCode(ParserContext& ctx, MarkdownNode& node);
+    static int enterRunSpan(ParserContext& ctx, MD_SPANTYPE type, void* detail);
+    static int textRunCallback(ParserContext& ctx, MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size);
+    static void placeDeferred(ParserContext& ctx, MarkdownNode& node, MD_OFFSET beg, MD_OFFSET end);
+    static void enterHeading(ParserContext& ctx, int level);
+    static void appendHeadingText(ParserContext& ctx, MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size);
+    static void openDeferred(ParserContext& ctx, MD_BLOCKTYPE type, MD_OFFSET beg, MD_OFFSET end);
 };
 
 } // namespace margelo::nitro::hypermarkdown
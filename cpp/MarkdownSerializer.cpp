@@ -0,0 +1,480 @@
+#include "MarkdownSerializer.h"
+#include "InputNormalizer.h"
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Display list values written per resize of the output
+constexpr size_t kOpsChunk = 4096;
+
+const char* alignToString(TableCellAlign align) {
+    switch (align) {
+        case TableCellAlign::Left: return "left";
+        case TableCellAlign::Center: return "center";
+        case TableCellAlign::Right: return "right";
+        default: return "default";
+    }
+}
+
+void appendNumber(std::string& out, uint32_t value) {
+    char digits[10];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+} // namespace
+
+void MarkdownSerializer::appendEscaped(std::string& out, std::string_view str) {
+    const char* end = str.data() + str.size();
+    for (const char* p = str.data(); p < end; p++) {
+        char c = *p;
+        // Non-ASCII: valid UTF-8 is copied, invalid sequences become U+FFFD,
+        // the JSON has to be valid UTF-8
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            auto sequence = InputNormalizer::sequenceAt(p, end);
+            if (sequence.valid) {
+                out.append(p, sequence.length);
+            } else {
+                out += InputNormalizer::kReplacementCharacter;
+            }
+            p += sequence.length - 1;
+            continue;
+        }
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ('\x00' <= c && c <= '\x1f') {
+                    out += "\\u00";
+                    out += kHexDigits[(c >> 4) & 0xf];
+                    out += kHexDigits[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+void MarkdownSerializer::appendString(std::string& out, const char* key, const std::string& value) {
+    out += ",\"";
+    out += key;
+    out += "\":\"";
+    appendEscaped(out, value);
+    out += '"';
+}
+
+void MarkdownSerializer::appendFields(std::string& out, const MarkdownNode& node) {
+    // Type
+    out += "{\"type\":\"";
+    appendEscaped(out, node.type);
+    out += '"';
+    
+    // Content (if present)
+    if (node.content) {
+        appendString(out, "content", *node.content);
+    }
+    
+    // Level (for headings)
+    if (node.level) {
+        out += ",\"level\":";
+        out += std::to_string(*node.level);
+    }
+    
+    // Link/Image properties
+    if (node.href) {
+        appendString(out, "href", *node.href);
+    }
+    if (node.src) {
+        appendString(out, "src", *node.src);
+    }
+    if (node.alt) {
+        appendString(out, "alt", *node.alt);
+    }
+    if (node.title) {
+        appendString(out, "title", *node.title);
+    }
+    
+    // Code block language
+    if (node.language) {
+        appendString(out, "language", *node.language);
+    }
+    
+    // Code block syntax tokens, as flat (offset, length, class) triples
+    if (!node.tokens.empty()) {
+        out += ",\"tokens\":[";
+        for (size_t i = 0; i < node.tokens.size(); i++) {
+            const auto& token = node.tokens[i];
+            if (i > 0) {
+                out += ',';
+            }
+            appendNumber(out, token.offset);
+            out += ',';
+            appendNumber(out, token.length);
+            out += ',';
+            appendNumber(out, static_cast<uint32_t>(token.cls));
+        }
+        out += ']';
+    }
+    
+    // Text runs, as flat (length, styles, link) triples, and their links
+    if (!node.runs.empty()) {
+        out += ",\"runs\":[";
+        for (size_t i = 0; i < node.runs.size(); i++) {
+            const auto& run = node.runs[i];
+            if (i > 0) {
+                out += ',';
+            }
+            appendNumber(out, run.length);
+            out += ',';
+            appendNumber(out, run.styles);
+            out += ',';
+            if (run.link < 0) {
+                out += "-1";
+            } else {
+                appendNumber(out, static_cast<uint32_t>(run.link));
+            }
+        }
+        out += ']';
+    }
+    if (!node.links.empty()) {
+        out += ",\"links\":[";
+        for (size_t i = 0; i < node.links.size(); i++) {
+            const auto& link = node.links[i];
+            if (i > 0) {
+                out += ',';
+            }
+            char separator = '{';
+            for (const auto& [key, value] : {std::pair{"href", &link.href}, {"src", &link.src}, {"title", &link.title}}) {
+                if (*value) {
+                    out += separator;
+                    out += '"';
+                    out += key;
+                    out += "\":\"";
+                    appendEscaped(out, **value);
+                    out += '"';
+                    separator = ',';
+                }
+            }
+            if (separator == '{') {
+                out += '{';
+            }
+            out += '}';
+        }
+        out += ']';
+    }
+    
+    // List properties
+    if (node.ordered) {
+        out += *node.ordered ? ",\"ordered\":true" : ",\"ordered\":false";
+    }
+    if (node.start) {
+        out += ",\"start\":";
+        out += std::to_string(*node.start);
+    }
+    
+    // Task list item
+    if (node.checked) {
+        out += *node.checked ? ",\"checked\":true" : ",\"checked\":false";
+    }
+    
+    // Table cell
+    if (node.align) {
+        out += ",\"align\":\"";
+        out += alignToString(*node.align);
+        out += '"';
+    }
+    if (node.isHeader) {
+        out += *node.isHeader ? ",\"isHeader\":true" : ",\"isHeader\":false";
+    }
+}
+
+void MarkdownSerializer::appendPoint(std::string& out, uint32_t offset, const LineIndex* lines) {
+    out += '{';
+    if (lines) {
+        auto location = lines->locate(offset);
+        out += "\"line\":";
+        appendNumber(out, location.line);
+        out += ",\"column\":";
+        appendNumber(out, location.column);
+        out += ',';
+    }
+    out += "\"offset\":";
+    appendNumber(out, offset);
+    out += '}';
+}
+
+void MarkdownSerializer::appendPosition(std::string& out, const SourceSpan& span, const LineIndex* lines) {
+    out += ",\"position\":{\"start\":";
+    appendPoint(out, span.start, lines);
+    out += ",\"end\":";
+    appendPoint(out, span.end, lines);
+    out += '}';
+}
+
+bool MarkdownSerializer::appendNode(Output& output, const MarkdownNode* node) {
+    std::string& out = output.json;
+    return walkTree(
+        node,
+        [&](const MarkdownNode* current, size_t index) {
+            if (index > 0) {
+                out += ',';
+            }
+            if (!current) {
+                out += "null";
+                return true;
+            }
+            appendFields(out, *current);
+            if (current->position) {
+                appendPosition(out, *current->position, output.lines);
+            }
+            if (!output.account()) {
+                return false;
+            }
+            if (!current->children.empty()) {
+                out += ",\"children\":[";
+            }
+            return true;
+        },
+        [&](const MarkdownNode* current) {
+            if (!current) {
+                return;
+            }
+            if (!current->children.empty()) {
+                out += ']';
+            }
+            out += '}';
+        });
+}
+
+bool MarkdownSerializer::Output::account() {
+    if (!memory || json.capacity() == capacity) {
+        return true;
+    }
+    // std::string grows by reallocating: the new buffer replaces the old one
+    if (!memory->allocate(memory->output, json.capacity() + 1, capacity > 0 ? capacity + 1 : 0)) {
+        failed = true;
+        return false;
+    }
+    capacity = json.capacity();
+    return true;
+}
+
+std::string MarkdownSerializer::displayListToJson(const DisplayList& list, InternalParseMemory* memory) {
+    if (memory && !memory->allocate(memory->output, list.byteSize())) {
+        return std::string();
+    }
+    Output output;
+    output.memory = memory;
+    std::string& out = output.json;
+    // Most values are short numbers, most strings need no escaping
+    size_t stringBytes = 0;
+    for (auto value : list.strings) {
+        stringBytes += value.size() + 3;
+    }
+    out.reserve(list.ops.size() * 4 + stringBytes + 32);
+    // Numbers are written straight into the buffer, a chunk at a time with
+    // room for the longest ones
+    out += "{\"ops\":[";
+    for (size_t i = 0; i < list.ops.size(); i += kOpsChunk) {
+        size_t count = std::min(kOpsChunk, list.ops.size() - i);
+        size_t used = out.size();
+        out.resize(used + count * 12);
+        char* p = out.data() + used;
+        for (size_t j = i; j < i + count; j++) {
+            int32_t op = list.ops[j];
+            if (static_cast<uint32_t>(op) < 10) {
+                *p++ = static_cast<char>('0' + op);
+            } else {
+                p = std::to_chars(p, p + 11, op).ptr;
+            }
+            *p++ = ',';
+        }
+        out.resize(p - out.data());
+    }
+    if (!list.ops.empty()) {
+        out.pop_back();
+    }
+    out += "],\"strings\":[";
+    for (size_t i = 0; i < list.strings.size(); i++) {
+        out += i > 0 ? ",\"" : "\"";
+        appendEscaped(out, list.strings[i]);
+        out += '"';
+        if (!output.account()) {
+            return std::string();
+        }
+    }
+    out += "]}";
+    if (!output.account()) {
+        return std::string();
+    }
+    return std::move(output.json);
+}
+
+std::string MarkdownSerializer::blockManifestToJson(const BlockManifest& manifest) {
+    std::vector<std::string_view> types;
+    std::string blocks;
+    blocks.reserve(manifest.blocks.size() * 32);
+    char number[16];
+    for (const auto& block : manifest.blocks) {
+        size_t type = std::find(types.begin(), types.end(), block.type) - types.begin();
+        if (type == types.size()) {
+            types.push_back(block.type);
+        }
+        for (size_t value : {type, size_t{block.start}, size_t{block.end}, size_t{block.characters},
+                             size_t{block.lines}, size_t{block.height}}) {
+            blocks.append(number, std::to_chars(number, number + sizeof(number), value).ptr);
+            blocks += ',';
+        }
+    }
+    if (!blocks.empty()) {
+        blocks.pop_back();
+    }
+    std::string out = "{\"types\":[";
+    for (size_t i = 0; i < types.size(); i++) {
+        out += i > 0 ? ",\"" : "\"";
+        appendEscaped(out, types[i]);
+        out += '"';
+    }
+    out += "],\"blocks\":[";
+    out += blocks;
+    out += "]}";
+    return out;
+}
+
+std::string MarkdownSerializer::headingsToJson(const std::vector<HeadingEntry>& headings, const LineIndex& lines) {
+    std::string out = "[";
+    for (const auto& heading : headings) {
+        out += out.size() > 1 ? ",{\"level\":" : "{\"level\":";
+        appendNumber(out, heading.level);
+        out += ",\"text\":\"";
+        appendEscaped(out, heading.text);
+        out += "\",\"slug\":\"";
+        appendEscaped(out, heading.slug);
+        out += "\",\"offset\":";
+        appendNumber(out, heading.offset);
+        out += ",\"line\":";
+        appendNumber(out, lines.locate(heading.offset).line);
+        out += ",\"path\":[";
+        for (size_t i = 0; i < heading.path.size(); i++) {
+            if (i > 0) {
+                out += ',';
+            }
+            appendNumber(out, heading.path[i]);
+        }
+        out += "]}";
+    }
+    out += ']';
+    return out;
+}
+
+std::string MarkdownSerializer::searchMatchesToJson(const std::vector<SearchMatch>& matches) {
+    std::string out = "[";
+    for (const auto& match : matches) {
+        out += out.size() > 1 ? ",{\"pattern\":" : "{\"pattern\":";
+        appendNumber(out, match.pattern);
+        out += ",\"segments\":[";
+        for (size_t i = 0; i < match.segments.size(); i++) {
+            const auto& segment = match.segments[i];
+            out += i > 0 ? ",{\"path\":[" : "{\"path\":[";
+            for (size_t j = 0; j < segment.path.size(); j++) {
+                if (j > 0) {
+                    out += ',';
+                }
+                appendNumber(out, segment.path[j]);
+            }
+            out += "],\"start\":";
+            appendNumber(out, segment.start);
+            out += ",\"end\":";
+            appendNumber(out, segment.end);
+            out += '}';
+        }
+        out += "]}";
+    }
+    out += ']';
+    return out;
+}
+
+std::string MarkdownSerializer::resourcesToJson(const std::vector<DocumentResources>& documents) {
+    std::string out = "[";
+    for (const auto& document : documents) {
+        out += out.size() > 1 ? ",{\"success\":" : "{\"success\":";
+        out += document.success ? "true" : "false";
+        out += ",\"resources\":[";
+        for (size_t i = 0; i < document.resources.size(); i++) {
+            const auto& resource = document.resources[i];
+            out += i > 0 ? ",{\"type\":" : "{\"type\":";
+            out += resource.image ? "\"image\",\"src\":\"" : "\"link\",\"href\":\"";
+            appendEscaped(out, resource.url);
+            if (resource.alt) {
+                out += "\",\"alt\":\"";
+                appendEscaped(out, *resource.alt);
+            }
+            if (resource.title) {
+                out += "\",\"title\":\"";
+                appendEscaped(out, *resource.title);
+            }
+            out += "\",\"start\":";
+            appendNumber(out, resource.start);
+            out += ",\"end\":";
+            appendNumber(out, resource.end);
+            out += '}';
+        }
+        out += ']';
+        if (document.error) {
+            out += ",\"error\":\"";
+            appendEscaped(out, document.error->message);
+            out += '"';
+        }
+        out += '}';
+    }
+    out += ']';
+    return out;
+}
+
+std::string MarkdownSerializer::escapeJson(const std::string& str) {
+    std::string out;
+    out.reserve(str.size());
+    appendEscaped(out, str);
+    return out;
+}
+
+std::string MarkdownSerializer::nodeToJson(const std::shared_ptr<MarkdownNode>& node, const LineIndex* lines) {
+    Output output;
+    output.lines = lines;
+    appendNode(output, node.get());
+    return std::move(output.json);
+}
+
+std::string MarkdownSerializer::toJson(const std::vector<std::shared_ptr<MarkdownNode>>& nodes, InternalParseMemory* memory,
+                                      const LineIndex* lines) {
+    Output output;
+    output.memory = memory;
+    output.lines = lines;
+    output.json += '[';
+    bool first = true;
+    for (const auto& node : nodes) {
+        if (!first) output.json += ',';
+        first = false;
+        if (!appendNode(output, node.get())) {
+            return std::string();
+        }
+    }
+    output.json += ']';
+    if (!output.account()) {
+        return std::string();
+    }
+    return std::move(output.json);
+}
+
+} // namespace margelo::nitro::hypermarkdown
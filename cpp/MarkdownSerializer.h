@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BlockManifest.h"
+#include "DisplayList.h"
+#include "DocumentResources.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "SearchIndex.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// Serializes the MarkdownNode tree to the JSON AST consumed by the JS side.
+// Has no JSI or Nitro dependencies, so it builds as part of the host-native
+// core library as well.
+class MarkdownSerializer {
+public:
+    // Convert a list of top-level nodes to a JSON array. With `memory`, the
+    // output buffer is accounted there; if it would go over the memory limit
+    // serialization stops and an empty string is returned. Node positions
+    // are written as offsets, plus lines and columns when `lines` indexes
+    // the parsed input.
+    static std::string toJson(const std::vector<std::shared_ptr<MarkdownNode>>& nodes, InternalParseMemory* memory = nullptr,
+                              const LineIndex* lines = nullptr);
+    
+    // Convert a display list to {"ops":[...],"strings":[...]}. Memory is
+    // accounted as with toJson(), the list included.
+    static std::string displayListToJson(const DisplayList& list, InternalParseMemory* memory = nullptr);
+    
+    // Convert a block manifest to {"types":[...],"blocks":[...]}: the
+    // distinct block types, and per block its type's index, start, end,
+    // characters, lines and height
+    static std::string blockManifestToJson(const BlockManifest& manifest);
+    
+    // Convert a heading index to [{"level","text","slug","offset","line",
+    // "path"},...]; `lines` indexes the parsed input
+    static std::string headingsToJson(const std::vector<HeadingEntry>& headings, const LineIndex& lines);
+    
+    // Convert search matches to [{"pattern","segments":[{"path","start",
+    // "end"},...]},...]
+    static std::string searchMatchesToJson(const std::vector<SearchMatch>& matches);
+    
+    // Convert the resources of a batch of documents to [{"success",
+    // "resources":[{"type","src" or "href","alt","title","start","end"},
+    // ...],"error"},...], one entry per document
+    static std::string resourcesToJson(const std::vector<DocumentResources>& documents);
+    
+    // Convert MarkdownNode tree to JSON string
+    static std::string nodeToJson(const std::shared_ptr<MarkdownNode>& node, const LineIndex* lines = nullptr);
+    
+    // Escape JSON string
+    static std::string escapeJson(const std::string& str);
+    
+private:
+    // The JSON being built, all nodes append to the same buffer
+    struct Output {
+        std::string json;
+        InternalParseMemory* memory = nullptr;
+        const LineIndex* lines = nullptr;
+        size_t capacity = 0;
+        bool failed = false;
+        
+        // Accounts growth of the buffer since the last call
+        bool account();
+    };
+    
+    // Appends a node and its subtree, iteratively. Returns false if the
+    // output went over the memory limit.
+    static bool appendNode(Output& output, const MarkdownNode* node);
+    static void appendFields(std::string& out, const MarkdownNode& node);
+    static void appendPosition(std::string& out, const SourceSpan& span, const LineIndex* lines);
+    static void appendPoint(std::string& out, uint32_t offset, const LineIndex* lines);
+    static void appendString(std::string& out, const char* key, const std::string& value);
+    static void appendEscaped(std::string& out, std::string_view str);
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,88 @@
+#include "NodeReclaimer.h"
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Lowers the priority of the calling thread, freeing memory is never urgent
+void lowerThreadPriority() {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#elif defined(__linux__)
+    // Linux (and Android) nice values are per thread
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+}
+
+} // namespace
+
+NodeReclaimer& NodeReclaimer::shared() {
+    static NodeReclaimer reclaimer;
+    return reclaimer;
+}
+
+NodeReclaimer::~NodeReclaimer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void NodeReclaimer::release(std::vector<std::shared_ptr<MarkdownNode>>&& nodes) {
+    if (nodes.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(nodes));
+        if (!thread.joinable()) {
+            thread = std::thread([this] { run(); });
+        }
+    }
+    nodes.clear();
+    wakeUp.notify_one();
+}
+
+void NodeReclaimer::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+void NodeReclaimer::run() {
+    lowerThreadPriority();
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeUp.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        auto batch = std::move(queue);
+        queue.clear();
+        busy = true;
+        
+        // Free outside the lock, so releasing never waits for a free
+        lock.unlock();
+        batch.clear();
+        lock.lock();
+        
+        busy = false;
+        if (queue.empty()) {
+            drained.notify_all();
+        }
+    }
+}
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// Frees discarded node trees on a low-priority background thread. Dropping
+// a large document otherwise costs one free() per node on the thread that
+// drops it, which for the JS thread shows up as a frame hitch; handing the
+// tree over here costs a queue push.
+class NodeReclaimer {
+public:
+    // The process-wide reclaimer, its thread starts on the first release
+    static NodeReclaimer& shared();
+    
+    ~NodeReclaimer();
+    
+    // Takes the nodes over and frees them later on the reclaimer thread.
+    // Nodes still referenced elsewhere live on until their last owner lets go.
+    void release(std::vector<std::shared_ptr<MarkdownNode>>&& nodes);
+    
+    // Blocks until everything released so far has been freed
+    void drain();
+    
+private:
+    void run();
+    
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable drained;
+    std::vector<std::vector<std::shared_ptr<MarkdownNode>>> queue;
+    bool busy = false;
+    bool stopping = false;
+    std::thread thread;
+};
+
+} // namespace margelo::nitro::hypermarkdown
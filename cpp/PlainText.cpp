@@ -0,0 +1,166 @@
+#include "PlainText.h"
+#include "HeadingSlugger.h"
+#include "InputNormalizer.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// State of the plain text pass, in md4c's userdata. Every callback returns
+// non-zero once the text is full, which makes md4c stop.
+class TextCollector {
+public:
+    TextCollector(std::string& out, size_t maxChars) : out(out), maxChars(maxChars) {}
+    
+    bool full = false;      // stopped at maxChars, with text left over
+    
+    static int enterBlock(MD_BLOCKTYPE type, void*, void* userdata) {
+        auto* collector = static_cast<TextCollector*>(userdata);
+        collector->separate(type == MD_BLOCK_TH || type == MD_BLOCK_TD ? ' ' : '\n');
+        return collector->full;
+    }
+    
+    static int leaveBlock(MD_BLOCKTYPE type, void*, void* userdata) {
+        auto* collector = static_cast<TextCollector*>(userdata);
+        if (type != MD_BLOCK_TH && type != MD_BLOCK_TD) {
+            collector->separate('\n');
+        }
+        return collector->full;
+    }
+    
+    static int span(MD_SPANTYPE, void*, void* userdata) {
+        return static_cast<TextCollector*>(userdata)->full;
+    }
+    
+    static int text(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
+        auto* collector = static_cast<TextCollector*>(userdata);
+        switch (type) {
+            case MD_TEXT_SOFTBR:
+                collector->append(" ", 1);
+                break;
+            case MD_TEXT_BR:
+                collector->append("\n", 1);
+                break;
+            case MD_TEXT_NULLCHAR:
+                collector->append(InputNormalizer::kReplacementCharacter, 3);
+                break;
+            case MD_TEXT_HTML:
+                break;
+            case MD_TEXT_ENTITY:
+                collector->entity.clear();
+                HeadingSlugger::appendEntity(collector->entity, std::string_view(text, size));
+                collector->append(collector->entity.data(), collector->entity.size());
+                break;
+            default:
+                collector->append(text, size);
+                break;
+        }
+        return collector->full;
+    }
+    
+    // Raw HTML blocks are left out
+    static int skipContents(MD_BLOCKTYPE type, MD_OFFSET, MD_OFFSET, void*) {
+        return type == MD_BLOCK_HTML;
+    }
+
+private:
+    std::string& out;
+    size_t maxChars;
+    size_t units = 0;
+    char pending = 0;       // separator to put before the next text
+    std::string entity;
+    
+    void separate(char separator) {
+        // A newline wins over a space; none before the first text
+        if (!out.empty() && pending != '\n') {
+            pending = separator;
+        }
+    }
+    
+    void append(const char* text, size_t size) {
+        if (pending) {
+            char separator = pending;
+            pending = 0;
+            // Code blocks end their lines with a newline of their own
+            if ((separator != '\n' || out.back() != '\n') && !put(&separator, 1)) {
+                return;
+            }
+        }
+        put(text, size);
+    }
+    
+    // Appends whole characters of the text as long as they fit, each
+    // invalid sequence as a U+FFFD; returns false once the text is full
+    bool put(const char* p, size_t size) {
+        const char* end = p + size;
+        while (p < end) {
+            if (static_cast<unsigned char>(*p) < 0x80) {
+                if (units == maxChars) {
+                    full = true;
+                    return false;
+                }
+                out += *p++;
+                units++;
+                continue;
+            }
+            auto sequence = InputNormalizer::sequenceAt(p, end);
+            size_t length = sequence.valid && sequence.length == 4 ? 2 : 1;
+            if (units + length > maxChars) {
+                full = true;
+                return false;
+            }
+            if (sequence.valid) {
+                out.append(p, sequence.length);
+            } else {
+                out += InputNormalizer::kReplacementCharacter;
+            }
+            units += length;
+            p += sequence.length;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+PlainText PlainText::extract(const std::string& content, size_t maxChars, const InternalParserOptions& options) {
+    PlainText plain;
+    if (content.size() > options.maxInputSize) {
+        plain.error = ParseError("Input exceeds maximum size limit");
+        return plain;
+    }
+    
+    std::string normalized;
+    bool isNormalized = options.normalizeInput && InputNormalizer::normalize(content, normalized);
+    const std::string& source = isNormalized ? normalized : content;
+    
+    TextCollector collector(plain.text, maxChars);
+    MD_PARSER parser = {
+        0,
+        MarkdownParser::optionsToFlags(options),
+        TextCollector::enterBlock,
+        TextCollector::leaveBlock,
+        TextCollector::span,
+        TextCollector::span,
+        TextCollector::text,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        TextCollector::skipContents
+    };
+    if (md_parse(source.c_str(), static_cast<MD_SIZE>(source.size()), &parser, &collector) != 0 && !collector.full) {
+        plain.text.clear();
+        plain.error = ParseError("Failed to parse markdown");
+        return plain;
+    }
+    while (!plain.text.empty() && plain.text.back() == '\n') {
+        plain.text.pop_back();
+    }
+    plain.truncated = collector.full;
+    plain.success = true;
+    return plain;
+}
+
+} // namespace margelo::nitro::hypermarkdown
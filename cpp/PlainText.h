@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// The rendered text of a document, for previews and accessibility labels,
+// without an AST: md4c's callbacks append the text straight to `text`, and
+// parsing stops once it holds `maxChars` UTF-16 code units.
+//
+// Soft breaks are spaces, hard breaks newlines; blocks are separated by a
+// newline and table cells by a space. Images come out as their alt text,
+// links as their text, entities decoded as in heading text (numeric ones,
+// those of XML and nbsp). Raw HTML is left out, and each invalid UTF-8
+// sequence or NUL is a U+FFFD. The text is cut at a character boundary and
+// has no trailing newlines.
+struct PlainText {
+    bool success = false;
+    std::string text;
+    bool truncated = false;     // stopped at maxChars, with text left over
+    std::optional<ParseError> error;
+    
+    // Runs md4c over `content` with the md4c flags and the maxInputSize and
+    // normalizeInput settings of `options`
+    static PlainText extract(const std::string& content, size_t maxChars = SIZE_MAX,
+                             const InternalParserOptions& options = InternalParserOptions());
+};
+
+} // namespace margelo::nitro::hypermarkdown
@@ -0,0 +1,268 @@
+#include "SearchIndex.h"
+#include "InputNormalizer.h"
+#include "md4c.h"
+#include <algorithm>
+#include <array>
+
+namespace margelo::nitro::hypermarkdown {
+
+namespace {
+
+// Ends a block in the folded text; no pattern contains it
+constexpr char kBlockSeparator = '\0';
+
+// Nodes whose text runs on with that of their siblings
+bool isInline(const std::string& type) {
+    static constexpr std::array<std::string_view, 13> kInlineTypes = {
+        "text", "softbreak", "hardbreak", "emphasis", "strong", "link", "image",
+        "code_inline", "strikethrough", "math_inline", "math_block", "wiki_link", "underline",
+    };
+    return std::find(kInlineTypes.begin(), kInlineTypes.end(), type) != kInlineTypes.end();
+}
+
+// Appends the folding of the character of `length` bytes at p, and returns
+// the number of characters it folds into; invalid sequences are kept as
+// they are
+unsigned appendFoldedCharacter(std::string& out, const char* p, size_t length, bool valid) {
+    if (length == 1) {
+        char c = *p;
+        out += c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+        return 1;
+    }
+    if (!valid) {
+        out.append(p, length);
+        return 1;
+    }
+    unsigned folded[3];
+    unsigned count = md_fold_codepoint(InputNormalizer::decode(p, length), folded);
+    for (unsigned i = 0; i < count; i++) {
+        InputNormalizer::appendUtf8(out, folded[i]);
+    }
+    return count;
+}
+
+} // namespace
+
+SearchIndex::SearchIndex(const MarkdownNode* root) {
+    std::vector<uint32_t> path;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t index) {
+            if (node == root || !node) {
+                return true;
+            }
+            path.push_back(static_cast<uint32_t>(index));
+            if (!isInline(node->type)) {
+                appendSeparator(kBlockSeparator);
+            }
+            if (node->type == "softbreak" || node->type == "hardbreak") {
+                appendSeparator(' ');
+            } else if ((node->type == "text" || node->type == "code_block") && node->content &&
+                       !node->content->empty()) {
+                // Parsed code is the text child of its code block; a code
+                // block holding its code itself is a segment of its own
+                auto begin = static_cast<uint32_t>(text.size());
+                bool ascii = appendText(*node->content);
+                nodes.push_back({path, begin, static_cast<uint32_t>(text.size()), ascii});
+            }
+            return true;
+        },
+        [&](const MarkdownNode* node) {
+            if (node == root || !node) {
+                return;
+            }
+            if (!isInline(node->type)) {
+                appendSeparator(kBlockSeparator);
+            }
+            path.pop_back();
+        });
+}
+
+void SearchIndex::appendFolded(std::string& out, std::string_view text) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        auto sequence = InputNormalizer::sequenceAt(p, end);
+        appendFoldedCharacter(out, p, sequence.length, sequence.valid);
+        p += sequence.length;
+    }
+}
+
+bool SearchIndex::appendText(const std::string& content) {
+    text += content;
+    const char* start = content.data();
+    const char* p = start;
+    const char* end = p + content.size();
+    auto textBegin = static_cast<uint32_t>(text.size() - content.size());
+    bool ascii = true;
+    while (p < end) {
+        if (static_cast<unsigned char>(*p) < 0x80) {
+            folded += *p >= 'A' && *p <= 'Z' ? static_cast<char>(*p + ('a' - 'A')) : *p;
+            p++;
+            continue;
+        }
+        ascii = false;
+        auto sequence = InputNormalizer::sequenceAt(p, end);
+        auto before = static_cast<uint32_t>(folded.size());
+        // A match may start or end inside a character that folds into more
+        // than one ("ß" into "ss")
+        unsigned count = appendFoldedCharacter(folded, p, sequence.length, sequence.valid);
+        if (count > 1 || folded.size() - before != sequence.length) {
+            auto offset = textBegin + static_cast<uint32_t>(p - start);
+            changes.push_back({before, static_cast<uint32_t>(folded.size()), offset,
+                               offset + static_cast<uint32_t>(sequence.length)});
+        }
+        p += sequence.length;
+    }
+    return ascii;
+}
+
+void SearchIndex::appendSeparator(char separator) {
+    if (separator == kBlockSeparator && (folded.empty() || folded.back() == kBlockSeparator)) {
+        return;
+    }
+    auto offset = static_cast<uint32_t>(folded.size());
+    auto at = static_cast<uint32_t>(text.size());
+    folded += separator;
+    changes.push_back({offset, offset + 1, at, at});
+}
+
+uint32_t SearchIndex::toText(uint32_t offset, bool end) const {
+    auto after = std::upper_bound(changes.begin(), changes.end(), offset,
+                                  [](uint32_t value, const Change& change) { return value < change.folded; });
+    if (after == changes.begin()) {
+        return offset;
+    }
+    const Change& change = *(after - 1);
+    if (offset >= change.foldedEnd) {
+        return offset - change.foldedEnd + change.textEnd;
+    }
+    return offset == change.folded || !end ? change.text : change.textEnd;
+}
+
+void SearchIndex::appendSegments(SearchMatch& match, uint32_t textStart, uint32_t textEnd) const {
+    auto node = std::upper_bound(nodes.begin(), nodes.end(), textStart,
+                                 [](uint32_t value, const TextNode& node) { return value < node.end; });
+    for (; node != nodes.end() && node->begin < textEnd; ++node) {
+        uint32_t from = std::max(textStart, node->begin);
+        uint32_t to = std::min(textEnd, node->end);
+        if (from >= to) {
+            continue;
+        }
+        if (node->ascii) {
+            match.segments.push_back({node->path, from - node->begin, to - node->begin});
+            continue;
+        }
+        const char* p = text.data() + node->begin;
+        const char* nodeEnd = text.data() + node->end;
+        auto segmentStart = static_cast<uint32_t>(InputNormalizer::utf16Units(p, text.data() + from, nodeEnd));
+        auto segmentEnd = segmentStart + static_cast<uint32_t>(InputNormalizer::utf16Units(p, text.data() + to, nodeEnd));
+        match.segments.push_back({node->path, segmentStart, segmentEnd});
+    }
+}
+
+std::vector<SearchMatch> SearchIndex::search(const std::vector<std::string>& patterns, size_t maxMatches) const {
+    // The automaton over the bytes of the folded patterns: a trie whose
+    // missing transitions are then filled in from the failure links, so
+    // the scan takes one lookup per byte of text
+    struct State {
+        int32_t pattern = -1;
+        uint32_t length = 0;
+        uint32_t fail = 0;
+        uint32_t output = 0;  // the next state on the failure chain ending a pattern, 0 for none
+    };
+    std::vector<State> states(1);
+    std::vector<uint32_t> next(256, 0);
+    for (size_t i = 0; i < patterns.size(); i++) {
+        std::string pattern;
+        appendFolded(pattern, patterns[i]);
+        pattern.erase(std::remove(pattern.begin(), pattern.end(), kBlockSeparator), pattern.end());
+        if (pattern.empty()) {
+            continue;
+        }
+        uint32_t state = 0;
+        for (unsigned char byte : pattern) {
+            if (!next[state * 256 + byte]) {
+                next[state * 256 + byte] = static_cast<uint32_t>(states.size());
+                states.push_back({-1, states[state].length + 1, 0, 0});
+                next.resize(states.size() * 256, 0);
+            }
+            state = next[state * 256 + byte];
+        }
+        // A pattern given twice matches as the first one
+        if (states[state].pattern < 0) {
+            states[state].pattern = static_cast<int32_t>(i);
+        }
+    }
+    if (states.size() == 1) {
+        return {};
+    }
+    std::vector<uint32_t> queue;
+    for (unsigned byte = 0; byte < 256; byte++) {
+        if (uint32_t child = next[byte]) {
+            queue.push_back(child);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint32_t state = queue[head];
+        uint32_t fail = states[state].fail;
+        for (unsigned byte = 0; byte < 256; byte++) {
+            uint32_t& transition = next[state * 256 + byte];
+            if (!transition) {
+                transition = next[fail * 256 + byte];
+                continue;
+            }
+            State& child = states[transition];
+            child.fail = next[fail * 256 + byte];
+            child.output = states[child.fail].pattern >= 0 ? child.fail : states[child.fail].output;
+            queue.push_back(transition);
+        }
+    }
+    
+    struct Found {
+        uint32_t start;
+        uint32_t end;
+        uint32_t pattern;
+    };
+    std::vector<Found> found;
+    std::vector<uint32_t> lastEnd(patterns.size(), 0);
+    uint32_t state = 0;
+    for (uint32_t i = 0; i < folded.size() && found.size() < maxMatches; i++) {
+        state = next[state * 256 + static_cast<unsigned char>(folded[i])];
+        uint32_t output = states[state].pattern >= 0 ? state : states[state].output;
+        for (; output != 0 && found.size() < maxMatches; output = states[output].output) {
+            const State& match = states[output];
+            uint32_t start = i + 1 - match.length;
+            if (start >= lastEnd[match.pattern]) {
+                lastEnd[match.pattern] = i + 1;
+                found.push_back({start, i + 1, static_cast<uint32_t>(match.pattern)});
+            }
+        }
+    }
+    
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+        return a.start != b.start ? a.start < b.start : a.pattern < b.pattern;
+    });
+    std::vector<SearchMatch> matches;
+    matches.reserve(found.size());
+    std::fill(lastEnd.begin(), lastEnd.end(), 0);
+    for (const auto& match : found) {
+        // Matches inside the folding of one character ("s" in "ß") are
+        // the whole character, once
+        uint32_t start = toText(match.start, false);
+        if (start < lastEnd[match.pattern]) {
+            continue;
+        }
+        lastEnd[match.pattern] = toText(match.end, true);
+        SearchMatch result;
+        result.pattern = match.pattern;
+        appendSegments(result, start, lastEnd[match.pattern]);
+        // A match of break spaces alone is in no text node
+        if (!result.segments.empty()) {
+            matches.push_back(std::move(result));
+        }
+    }
+    return matches;
+}
+
+} // namespace margelo::nitro::hypermarkdown
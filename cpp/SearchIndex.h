@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MarkdownParser.h"
+
+namespace margelo::nitro::hypermarkdown {
+
+// The part of a match in one text node, or in a code block that holds its
+// code as its own content: `path` holds the child indices from the document
+// node down to it, `start` and `end` count UTF-16 code units of its content,
+// like JS string indices
+struct SearchSegment {
+    std::vector<uint32_t> path;
+    uint32_t start = 0;
+    uint32_t end = 0;
+};
+
+// A match of the pattern `pattern`, in one segment per text node it covers
+struct SearchMatch {
+    uint32_t pattern = 0;
+    std::vector<SearchSegment> segments;
+};
+
+// Find-in-document over the rendered text of a parsed document: the content
+// of its text nodes, a space for each line break. The code of a code block
+// is searched too, as a block of its own: the parser puts it in a text child
+// of the code block. A match may span the inline nodes of a block
+// ("foo *bar*" matches "foo bar"), not two blocks.
+//
+// The text is case-folded once, with md4c's Unicode case folding; a search
+// folds its patterns the same way and finds all of them in one pass over
+// the text, with an Aho-Corasick automaton. Matches of the same pattern do
+// not overlap, and come in document order.
+class SearchIndex {
+public:
+    explicit SearchIndex(const MarkdownNode* root);
+    
+    // At most `maxMatches` matches of any of `patterns`; empty patterns
+    // match nothing
+    std::vector<SearchMatch> search(const std::vector<std::string>& patterns, size_t maxMatches = SIZE_MAX) const;
+    
+    // Bytes of folded text the index holds
+    size_t size() const { return folded.size(); }
+    
+    // Appends `text` case-folded
+    static void appendFolded(std::string& out, std::string_view text);
+    
+private:
+    struct TextNode {
+        std::vector<uint32_t> path;
+        uint32_t begin;   // offset of its content in `text`
+        uint32_t end;
+        bool ascii;       // bytes are UTF-16 units
+    };
+    
+    // Where `folded` and `text` do not advance in step: a character whose
+    // folding is longer or shorter or more than one character, a break or
+    // block separator that is only in `folded`
+    struct Change {
+        uint32_t folded;
+        uint32_t foldedEnd;
+        uint32_t text;
+        uint32_t textEnd;
+    };
+    
+    // Offset in `text` of an offset in `folded`; one inside a change goes
+    // to the start of the change, or with `end` to its end
+    uint32_t toText(uint32_t offset, bool end) const;
+    
+    // Appends the segments of the text nodes in [textStart, textEnd)
+    void appendSegments(SearchMatch& match, uint32_t textStart, uint32_t textEnd) const;
+    
+    // Returns whether the content is all ASCII
+    bool appendText(const std::string& content);
+    void appendSeparator(char separator);
+    
+    std::string text;       // content of all text nodes, back to back
+    std::string folded;     // the same, case-folded and with separators
+    std::vector<TextNode> nodes;
+    std::vector<Change> changes;
+};
+
+} // namespace margelo::nitro::hypermarkdown
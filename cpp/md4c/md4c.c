@@ -133,6 +133,33 @@
  * per-line, relying on us to "helpfully" fill all the missing "<td></td>". */
 #define TABLE_MAXCOLCOUNT       128
 
+/* We limit nesting of container blocks (block quotes and list items). Any
+ * further container mark is treated as an ordinary text. This bounds depth
+ * of the block tree the application has to deal with for inputs like
+ * thousands of '>' on a single line. */
+#define CONTAINER_MAXDEPTH      128
+
+/* We limit depth of each stack of unresolved openers (emphasis, brackets
+ * etc.). When the limit is reached, the older half of the stack is discarded
+ * so those marks can never be resolved and end up as an ordinary text. This
+ * bounds nesting of resolved spans (and the bracket nesting in particular)
+ * while keeping the amortized cost of the push operation constant. */
+#define OPENERS_MAXDEPTH        256
+
+/* We limit total size of link destinations and titles expanded from
+ * reference definitions. Otherwise a single long destination referenced many
+ * times could make the output quadratic to the input size. When the limit
+ * is reached, any further reference link is treated as an ordinary text. */
+#define REF_EXPANSION_MINLIMIT  (100 * 1024)
+#define REF_EXPANSION_FACTOR    16
+
+/* Inlines of a block longer than this are analyzed and processed in windows
+ * of whole lines, each at least this long, so the marks of a huge paragraph
+ * (e.g. a pasted log without blank lines) never have to be held all at once.
+ * A window is extended as long as any inline construct started in it may
+ * continue past its end. */
+#define INLINE_WINDOW_SIZE      (64 * 1024)
+
 
 /************************
  ***  Internal Types  ***
@@ -156,6 +183,7 @@ typedef struct MD_REF_DEF_tag MD_REF_DEF;
 typedef struct MD_MARKSTACK_tag MD_MARKSTACK;
 struct MD_MARKSTACK_tag {
     int top;        /* -1 if empty. */
+    int depth;      /* Count of marks in the stack. */
 };
 
 /* Context propagated through all the parsing. */
@@ -178,8 +206,13 @@ struct MD_CTX_tag {
     MD_REF_DEF* ref_defs;
     int n_ref_defs;
     int alloc_ref_defs;
-    void** ref_def_hashtable;
+    MD_REF_DEF** ref_def_hashtable;
     int ref_def_hashtable_size;
+    unsigned* norm_labels;  /* Normalized labels (see md_link_label_normalize()). */
+    SZ n_norm_labels;
+    SZ alloc_norm_labels;
+    SZ ref_expansion_size;
+    SZ max_ref_expansion_size;
 
     /* Stack of inline/span markers.
      * This is only used for parsing a single block contents but by storing it
@@ -228,6 +261,11 @@ struct MD_CTX_tag {
     int unresolved_link_head;
     int unresolved_link_tail;
 
+    /* Set by md_analyze_inlines() if some inline construct (an unclosed
+     * opener, code span, raw HTML, link destination...) may continue past
+     * the last analyzed line. */
+    int inline_window_open;
+
     /* For resolving raw HTML. */
     OFF html_comment_horizon;
     OFF html_proc_instr_horizon;
@@ -407,6 +445,30 @@ md_text_with_null_replacement(MD_CTX* ctx, MD_TEXTTYPE type, const CHAR* str, SZ
 }
 
 
+/* All working memory goes through these, so that the application can
+ * account for it or cap it (see MD_PARSER::mem_realloc). */
+static void*
+md_realloc(MD_CTX* ctx, void* ptr, size_t size)
+{
+    if(ctx->parser.mem_realloc != NULL)
+        return ctx->parser.mem_realloc(ptr, size, ctx->userdata);
+    return realloc(ptr, size);
+}
+
+#define md_malloc(ctx, size)    md_realloc((ctx), NULL, (size))
+
+static void
+md_free(MD_CTX* ctx, void* ptr)
+{
+    if(ptr == NULL)
+        return;
+    if(ctx->parser.mem_free != NULL)
+        ctx->parser.mem_free(ptr, ctx->userdata);
+    else
+        free(ptr);
+}
+
+
 #define MD_CHECK(func)                                                      \
     do {                                                                    \
         ret = (func);                                                       \
@@ -421,7 +483,7 @@ md_text_with_null_replacement(MD_CTX* ctx, MD_TEXTTYPE type, const CHAR* str, SZ
             CHAR* new_buffer;                                               \
             SZ new_size = ((sz) + (sz) / 2 + 128) & ~127;                   \
                                                                             \
-            new_buffer = realloc(ctx->buffer, new_size);                    \
+            new_buffer = md_realloc(ctx, ctx->buffer, new_size);            \
             if(new_buffer == NULL) {                                        \
                 MD_LOG("realloc() failed.");                                \
                 ret = -1;                                                   \
@@ -481,6 +543,12 @@ md_text_with_null_replacement(MD_CTX* ctx, MD_TEXTTYPE type, const CHAR* str, SZ
         }                                                                   \
     } while(0)
 
+#define MD_SOURCE_OFFSET(off)                                               \
+    do {                                                                    \
+        if(ctx->parser.source_offset != NULL)                               \
+            ctx->parser.source_offset((off), ctx->userdata);                \
+    } while(0)
+
 #define MD_TEXT_INSECURE(type, str, size)                                   \
     do {                                                                    \
         if(size > 0) {                                                      \
@@ -540,242 +608,50 @@ struct MD_UNICODE_FOLD_INFO_tag {
 
 
 #if defined MD4C_USE_UTF16 || defined MD4C_USE_UTF8
-    /* Binary search over sorted "map" of codepoints. Consecutive sequences
-     * of codepoints may be encoded in the map by just using the
-     * (MIN_CODEPOINT | 0x40000000) and (MAX_CODEPOINT | 0x80000000).
-     *
-     * Returns index of the found record in the map (in the case of ranges,
-     * the minimal value is used); or -1 on failure. */
-    static int
-    md_unicode_bsearch__(unsigned codepoint, const unsigned* map, size_t map_size)
+    /* Two-level lookup tables over all codepoints below MD_UNICODE_TABLE_LIMIT.
+     * (generated by scripts/build_unicode_tables.py) */
+    #include "md4c-unicode.h"
+
+    /* Returns the MD_UNICODE_INFO_xxx bits and the fold index of the
+     * codepoint in O(1), i.e. without any search. */
+    static inline unsigned
+    md_unicode_info__(unsigned codepoint)
     {
-        int beg, end;
-        int pivot_beg, pivot_end;
-
-        beg = 0;
-        end = (int) map_size-1;
-        while(beg <= end) {
-            /* Pivot may be a range, not just a single value. */
-            pivot_beg = pivot_end = (beg + end) / 2;
-            if(map[pivot_end] & 0x40000000)
-                pivot_end++;
-            if(map[pivot_beg] & 0x80000000)
-                pivot_beg--;
-
-            if(codepoint < (map[pivot_beg] & 0x00ffffff))
-                end = pivot_beg - 1;
-            else if(codepoint > (map[pivot_end] & 0x00ffffff))
-                beg = pivot_end + 1;
-            else
-                return pivot_beg;
-        }
+        if(codepoint >= MD_UNICODE_TABLE_LIMIT)
+            return 0;
 
-        return -1;
+        return MD_UNICODE_STAGE2[((unsigned) MD_UNICODE_STAGE1[codepoint >> MD_UNICODE_BLOCK_SHIFT]
+                                        << MD_UNICODE_BLOCK_SHIFT) | (codepoint & MD_UNICODE_BLOCK_MASK)];
     }
 
     static int
     md_is_unicode_whitespace__(unsigned codepoint)
     {
-#define R(cp_min, cp_max)   ((cp_min) | 0x40000000), ((cp_max) | 0x80000000)
-#define S(cp)               (cp)
-        /* Unicode "Zs" category.
-         * (generated by scripts/build_whitespace_map.py) */
-        static const unsigned WHITESPACE_MAP[] = {
-            S(0x0020), S(0x00a0), S(0x1680), R(0x2000,0x200a), S(0x202f), S(0x205f), S(0x3000)
-        };
-#undef R
-#undef S
-
         /* The ASCII ones are the most frequently used ones, also CommonMark
          * specification requests few more in this range. */
         if(codepoint <= 0x7f)
             return ISWHITESPACE_(codepoint);
 
-        return (md_unicode_bsearch__(codepoint, WHITESPACE_MAP, SIZEOF_ARRAY(WHITESPACE_MAP)) >= 0);
+        /* Unicode "Zs" category. */
+        return ((md_unicode_info__(codepoint) & MD_UNICODE_INFO_WHITESPACE) != 0);
     }
 
     static int
     md_is_unicode_punct__(unsigned codepoint)
     {
-#define R(cp_min, cp_max)   ((cp_min) | 0x40000000), ((cp_max) | 0x80000000)
-#define S(cp)               (cp)
-        /* Unicode general "P" and "S" categories.
-         * (generated by scripts/build_punct_map.py) */
-        static const unsigned PUNCT_MAP[] = {
-            R(0x0021,0x002f), R(0x003a,0x0040), R(0x005b,0x0060), R(0x007b,0x007e), R(0x00a1,0x00a9),
-            R(0x00ab,0x00ac), R(0x00ae,0x00b1), S(0x00b4), R(0x00b6,0x00b8), S(0x00bb), S(0x00bf), S(0x00d7),
-            S(0x00f7), R(0x02c2,0x02c5), R(0x02d2,0x02df), R(0x02e5,0x02eb), S(0x02ed), R(0x02ef,0x02ff), S(0x0375),
-            S(0x037e), R(0x0384,0x0385), S(0x0387), S(0x03f6), S(0x0482), R(0x055a,0x055f), R(0x0589,0x058a),
-            R(0x058d,0x058f), S(0x05be), S(0x05c0), S(0x05c3), S(0x05c6), R(0x05f3,0x05f4), R(0x0606,0x060f),
-            S(0x061b), R(0x061d,0x061f), R(0x066a,0x066d), S(0x06d4), S(0x06de), S(0x06e9), R(0x06fd,0x06fe),
-            R(0x0700,0x070d), R(0x07f6,0x07f9), R(0x07fe,0x07ff), R(0x0830,0x083e), S(0x085e), S(0x0888),
-            R(0x0964,0x0965), S(0x0970), R(0x09f2,0x09f3), R(0x09fa,0x09fb), S(0x09fd), S(0x0a76), R(0x0af0,0x0af1),
-            S(0x0b70), R(0x0bf3,0x0bfa), S(0x0c77), S(0x0c7f), S(0x0c84), S(0x0d4f), S(0x0d79), S(0x0df4), S(0x0e3f),
-            S(0x0e4f), R(0x0e5a,0x0e5b), R(0x0f01,0x0f17), R(0x0f1a,0x0f1f), S(0x0f34), S(0x0f36), S(0x0f38),
-            R(0x0f3a,0x0f3d), S(0x0f85), R(0x0fbe,0x0fc5), R(0x0fc7,0x0fcc), R(0x0fce,0x0fda), R(0x104a,0x104f),
-            R(0x109e,0x109f), S(0x10fb), R(0x1360,0x1368), R(0x1390,0x1399), S(0x1400), R(0x166d,0x166e),
-            R(0x169b,0x169c), R(0x16eb,0x16ed), R(0x1735,0x1736), R(0x17d4,0x17d6), R(0x17d8,0x17db),
-            R(0x1800,0x180a), S(0x1940), R(0x1944,0x1945), R(0x19de,0x19ff), R(0x1a1e,0x1a1f), R(0x1aa0,0x1aa6),
-            R(0x1aa8,0x1aad), R(0x1b5a,0x1b6a), R(0x1b74,0x1b7e), R(0x1bfc,0x1bff), R(0x1c3b,0x1c3f),
-            R(0x1c7e,0x1c7f), R(0x1cc0,0x1cc7), S(0x1cd3), S(0x1fbd), R(0x1fbf,0x1fc1), R(0x1fcd,0x1fcf),
-            R(0x1fdd,0x1fdf), R(0x1fed,0x1fef), R(0x1ffd,0x1ffe), R(0x2010,0x2027), R(0x2030,0x205e),
-            R(0x207a,0x207e), R(0x208a,0x208e), R(0x20a0,0x20c0), R(0x2100,0x2101), R(0x2103,0x2106),
-            R(0x2108,0x2109), S(0x2114), R(0x2116,0x2118), R(0x211e,0x2123), S(0x2125), S(0x2127), S(0x2129),
-            S(0x212e), R(0x213a,0x213b), R(0x2140,0x2144), R(0x214a,0x214d), S(0x214f), R(0x218a,0x218b),
-            R(0x2190,0x2426), R(0x2440,0x244a), R(0x249c,0x24e9), R(0x2500,0x2775), R(0x2794,0x2b73),
-            R(0x2b76,0x2b95), R(0x2b97,0x2bff), R(0x2ce5,0x2cea), R(0x2cf9,0x2cfc), R(0x2cfe,0x2cff), S(0x2d70),
-            R(0x2e00,0x2e2e), R(0x2e30,0x2e5d), R(0x2e80,0x2e99), R(0x2e9b,0x2ef3), R(0x2f00,0x2fd5),
-            R(0x2ff0,0x2fff), R(0x3001,0x3004), R(0x3008,0x3020), S(0x3030), R(0x3036,0x3037), R(0x303d,0x303f),
-            R(0x309b,0x309c), S(0x30a0), S(0x30fb), R(0x3190,0x3191), R(0x3196,0x319f), R(0x31c0,0x31e3), S(0x31ef),
-            R(0x3200,0x321e), R(0x322a,0x3247), S(0x3250), R(0x3260,0x327f), R(0x328a,0x32b0), R(0x32c0,0x33ff),
-            R(0x4dc0,0x4dff), R(0xa490,0xa4c6), R(0xa4fe,0xa4ff), R(0xa60d,0xa60f), S(0xa673), S(0xa67e),
-            R(0xa6f2,0xa6f7), R(0xa700,0xa716), R(0xa720,0xa721), R(0xa789,0xa78a), R(0xa828,0xa82b),
-            R(0xa836,0xa839), R(0xa874,0xa877), R(0xa8ce,0xa8cf), R(0xa8f8,0xa8fa), S(0xa8fc), R(0xa92e,0xa92f),
-            S(0xa95f), R(0xa9c1,0xa9cd), R(0xa9de,0xa9df), R(0xaa5c,0xaa5f), R(0xaa77,0xaa79), R(0xaade,0xaadf),
-            R(0xaaf0,0xaaf1), S(0xab5b), R(0xab6a,0xab6b), S(0xabeb), S(0xfb29), R(0xfbb2,0xfbc2), R(0xfd3e,0xfd4f),
-            S(0xfdcf), R(0xfdfc,0xfdff), R(0xfe10,0xfe19), R(0xfe30,0xfe52), R(0xfe54,0xfe66), R(0xfe68,0xfe6b),
-            R(0xff01,0xff0f), R(0xff1a,0xff20), R(0xff3b,0xff40), R(0xff5b,0xff65), R(0xffe0,0xffe6),
-            R(0xffe8,0xffee), R(0xfffc,0xfffd), R(0x10100,0x10102), R(0x10137,0x1013f), R(0x10179,0x10189),
-            R(0x1018c,0x1018e), R(0x10190,0x1019c), S(0x101a0), R(0x101d0,0x101fc), S(0x1039f), S(0x103d0),
-            S(0x1056f), S(0x10857), R(0x10877,0x10878), S(0x1091f), S(0x1093f), R(0x10a50,0x10a58), S(0x10a7f),
-            S(0x10ac8), R(0x10af0,0x10af6), R(0x10b39,0x10b3f), R(0x10b99,0x10b9c), S(0x10ead), R(0x10f55,0x10f59),
-            R(0x10f86,0x10f89), R(0x11047,0x1104d), R(0x110bb,0x110bc), R(0x110be,0x110c1), R(0x11140,0x11143),
-            R(0x11174,0x11175), R(0x111c5,0x111c8), S(0x111cd), S(0x111db), R(0x111dd,0x111df), R(0x11238,0x1123d),
-            S(0x112a9), R(0x1144b,0x1144f), R(0x1145a,0x1145b), S(0x1145d), S(0x114c6), R(0x115c1,0x115d7),
-            R(0x11641,0x11643), R(0x11660,0x1166c), S(0x116b9), R(0x1173c,0x1173f), S(0x1183b), R(0x11944,0x11946),
-            S(0x119e2), R(0x11a3f,0x11a46), R(0x11a9a,0x11a9c), R(0x11a9e,0x11aa2), R(0x11b00,0x11b09),
-            R(0x11c41,0x11c45), R(0x11c70,0x11c71), R(0x11ef7,0x11ef8), R(0x11f43,0x11f4f), R(0x11fd5,0x11ff1),
-            S(0x11fff), R(0x12470,0x12474), R(0x12ff1,0x12ff2), R(0x16a6e,0x16a6f), S(0x16af5), R(0x16b37,0x16b3f),
-            R(0x16b44,0x16b45), R(0x16e97,0x16e9a), S(0x16fe2), S(0x1bc9c), S(0x1bc9f), R(0x1cf50,0x1cfc3),
-            R(0x1d000,0x1d0f5), R(0x1d100,0x1d126), R(0x1d129,0x1d164), R(0x1d16a,0x1d16c), R(0x1d183,0x1d184),
-            R(0x1d18c,0x1d1a9), R(0x1d1ae,0x1d1ea), R(0x1d200,0x1d241), S(0x1d245), R(0x1d300,0x1d356), S(0x1d6c1),
-            S(0x1d6db), S(0x1d6fb), S(0x1d715), S(0x1d735), S(0x1d74f), S(0x1d76f), S(0x1d789), S(0x1d7a9),
-            S(0x1d7c3), R(0x1d800,0x1d9ff), R(0x1da37,0x1da3a), R(0x1da6d,0x1da74), R(0x1da76,0x1da83),
-            R(0x1da85,0x1da8b), S(0x1e14f), S(0x1e2ff), R(0x1e95e,0x1e95f), S(0x1ecac), S(0x1ecb0), S(0x1ed2e),
-            R(0x1eef0,0x1eef1), R(0x1f000,0x1f02b), R(0x1f030,0x1f093), R(0x1f0a0,0x1f0ae), R(0x1f0b1,0x1f0bf),
-            R(0x1f0c1,0x1f0cf), R(0x1f0d1,0x1f0f5), R(0x1f10d,0x1f1ad), R(0x1f1e6,0x1f202), R(0x1f210,0x1f23b),
-            R(0x1f240,0x1f248), R(0x1f250,0x1f251), R(0x1f260,0x1f265), R(0x1f300,0x1f6d7), R(0x1f6dc,0x1f6ec),
-            R(0x1f6f0,0x1f6fc), R(0x1f700,0x1f776), R(0x1f77b,0x1f7d9), R(0x1f7e0,0x1f7eb), S(0x1f7f0),
-            R(0x1f800,0x1f80b), R(0x1f810,0x1f847), R(0x1f850,0x1f859), R(0x1f860,0x1f887), R(0x1f890,0x1f8ad),
-            R(0x1f8b0,0x1f8b1), R(0x1f900,0x1fa53), R(0x1fa60,0x1fa6d), R(0x1fa70,0x1fa7c), R(0x1fa80,0x1fa88),
-            R(0x1fa90,0x1fabd), R(0x1fabf,0x1fac5), R(0x1face,0x1fadb), R(0x1fae0,0x1fae8), R(0x1faf0,0x1faf8),
-            R(0x1fb00,0x1fb92), R(0x1fb94,0x1fbca)
-        };
-#undef R
-#undef S
-
         /* The ASCII ones are the most frequently used ones, also CommonMark
          * specification requests few more in this range. */
         if(codepoint <= 0x7f)
             return ISPUNCT_(codepoint);
 
-        return (md_unicode_bsearch__(codepoint, PUNCT_MAP, SIZEOF_ARRAY(PUNCT_MAP)) >= 0);
+        /* Unicode general "P" and "S" categories. */
+        return ((md_unicode_info__(codepoint) & MD_UNICODE_INFO_PUNCT) != 0);
     }
 
     static void
     md_get_unicode_fold_info(unsigned codepoint, MD_UNICODE_FOLD_INFO* info)
     {
-#define R(cp_min, cp_max)   ((cp_min) | 0x40000000), ((cp_max) | 0x80000000)
-#define S(cp)               (cp)
-        /* Unicode "Pc", "Pd", "Pe", "Pf", "Pi", "Po", "Ps" categories.
-         * (generated by scripts/build_folding_map.py) */
-        static const unsigned FOLD_MAP_1[] = {
-            R(0x0041,0x005a), S(0x00b5), R(0x00c0,0x00d6), R(0x00d8,0x00de), R(0x0100,0x012e), R(0x0132,0x0136),
-            R(0x0139,0x0147), R(0x014a,0x0176), S(0x0178), R(0x0179,0x017d), S(0x017f), S(0x0181), S(0x0182),
-            S(0x0184), S(0x0186), S(0x0187), S(0x0189), S(0x018a), S(0x018b), S(0x018e), S(0x018f), S(0x0190),
-            S(0x0191), S(0x0193), S(0x0194), S(0x0196), S(0x0197), S(0x0198), S(0x019c), S(0x019d), S(0x019f),
-            R(0x01a0,0x01a4), S(0x01a6), S(0x01a7), S(0x01a9), S(0x01ac), S(0x01ae), S(0x01af), S(0x01b1), S(0x01b2),
-            S(0x01b3), S(0x01b5), S(0x01b7), S(0x01b8), S(0x01bc), S(0x01c4), S(0x01c5), S(0x01c7), S(0x01c8),
-            S(0x01ca), R(0x01cb,0x01db), R(0x01de,0x01ee), S(0x01f1), S(0x01f2), S(0x01f4), S(0x01f6), S(0x01f7),
-            R(0x01f8,0x021e), S(0x0220), R(0x0222,0x0232), S(0x023a), S(0x023b), S(0x023d), S(0x023e), S(0x0241),
-            S(0x0243), S(0x0244), S(0x0245), R(0x0246,0x024e), S(0x0345), S(0x0370), S(0x0372), S(0x0376), S(0x037f),
-            S(0x0386), R(0x0388,0x038a), S(0x038c), S(0x038e), S(0x038f), R(0x0391,0x03a1), R(0x03a3,0x03ab),
-            S(0x03c2), S(0x03cf), S(0x03d0), S(0x03d1), S(0x03d5), S(0x03d6), R(0x03d8,0x03ee), S(0x03f0), S(0x03f1),
-            S(0x03f4), S(0x03f5), S(0x03f7), S(0x03f9), S(0x03fa), R(0x03fd,0x03ff), R(0x0400,0x040f),
-            R(0x0410,0x042f), R(0x0460,0x0480), R(0x048a,0x04be), S(0x04c0), R(0x04c1,0x04cd), R(0x04d0,0x052e),
-            R(0x0531,0x0556), R(0x10a0,0x10c5), S(0x10c7), S(0x10cd), R(0x13f8,0x13fd), S(0x1c80), S(0x1c81),
-            S(0x1c82), S(0x1c83), S(0x1c84), S(0x1c85), S(0x1c86), S(0x1c87), S(0x1c88), R(0x1c90,0x1cba),
-            R(0x1cbd,0x1cbf), R(0x1e00,0x1e94), S(0x1e9b), R(0x1ea0,0x1efe), R(0x1f08,0x1f0f), R(0x1f18,0x1f1d),
-            R(0x1f28,0x1f2f), R(0x1f38,0x1f3f), R(0x1f48,0x1f4d), S(0x1f59), S(0x1f5b), S(0x1f5d), S(0x1f5f),
-            R(0x1f68,0x1f6f), S(0x1fb8), S(0x1fb9), S(0x1fba), S(0x1fbb), S(0x1fbe), R(0x1fc8,0x1fcb), S(0x1fd8),
-            S(0x1fd9), S(0x1fda), S(0x1fdb), S(0x1fe8), S(0x1fe9), S(0x1fea), S(0x1feb), S(0x1fec), S(0x1ff8),
-            S(0x1ff9), S(0x1ffa), S(0x1ffb), S(0x2126), S(0x212a), S(0x212b), S(0x2132), R(0x2160,0x216f), S(0x2183),
-            R(0x24b6,0x24cf), R(0x2c00,0x2c2f), S(0x2c60), S(0x2c62), S(0x2c63), S(0x2c64), R(0x2c67,0x2c6b),
-            S(0x2c6d), S(0x2c6e), S(0x2c6f), S(0x2c70), S(0x2c72), S(0x2c75), S(0x2c7e), S(0x2c7f), R(0x2c80,0x2ce2),
-            S(0x2ceb), S(0x2ced), S(0x2cf2), R(0xa640,0xa66c), R(0xa680,0xa69a), R(0xa722,0xa72e), R(0xa732,0xa76e),
-            S(0xa779), S(0xa77b), S(0xa77d), R(0xa77e,0xa786), S(0xa78b), S(0xa78d), S(0xa790), S(0xa792),
-            R(0xa796,0xa7a8), S(0xa7aa), S(0xa7ab), S(0xa7ac), S(0xa7ad), S(0xa7ae), S(0xa7b0), S(0xa7b1), S(0xa7b2),
-            S(0xa7b3), R(0xa7b4,0xa7c2), S(0xa7c4), S(0xa7c5), S(0xa7c6), S(0xa7c7), S(0xa7c9), S(0xa7d0), S(0xa7d6),
-            S(0xa7d8), S(0xa7f5), R(0xab70,0xabbf), R(0xff21,0xff3a), R(0x10400,0x10427), R(0x104b0,0x104d3),
-            R(0x10570,0x1057a), R(0x1057c,0x1058a), R(0x1058c,0x10592), S(0x10594), S(0x10595), R(0x10c80,0x10cb2),
-            R(0x118a0,0x118bf), R(0x16e40,0x16e5f), R(0x1e900,0x1e921)
-        };
-        static const unsigned FOLD_MAP_1_DATA[] = {
-            0x0061, 0x007a, 0x03bc, 0x00e0, 0x00f6, 0x00f8, 0x00fe, 0x0101, 0x012f, 0x0133, 0x0137, 0x013a, 0x0148,
-            0x014b, 0x0177, 0x00ff, 0x017a, 0x017e, 0x0073, 0x0253, 0x0183, 0x0185, 0x0254, 0x0188, 0x0256, 0x0257,
-            0x018c, 0x01dd, 0x0259, 0x025b, 0x0192, 0x0260, 0x0263, 0x0269, 0x0268, 0x0199, 0x026f, 0x0272, 0x0275,
-            0x01a1, 0x01a5, 0x0280, 0x01a8, 0x0283, 0x01ad, 0x0288, 0x01b0, 0x028a, 0x028b, 0x01b4, 0x01b6, 0x0292,
-            0x01b9, 0x01bd, 0x01c6, 0x01c6, 0x01c9, 0x01c9, 0x01cc, 0x01cc, 0x01dc, 0x01df, 0x01ef, 0x01f3, 0x01f3,
-            0x01f5, 0x0195, 0x01bf, 0x01f9, 0x021f, 0x019e, 0x0223, 0x0233, 0x2c65, 0x023c, 0x019a, 0x2c66, 0x0242,
-            0x0180, 0x0289, 0x028c, 0x0247, 0x024f, 0x03b9, 0x0371, 0x0373, 0x0377, 0x03f3, 0x03ac, 0x03ad, 0x03af,
-            0x03cc, 0x03cd, 0x03ce, 0x03b1, 0x03c1, 0x03c3, 0x03cb, 0x03c3, 0x03d7, 0x03b2, 0x03b8, 0x03c6, 0x03c0,
-            0x03d9, 0x03ef, 0x03ba, 0x03c1, 0x03b8, 0x03b5, 0x03f8, 0x03f2, 0x03fb, 0x037b, 0x037d, 0x0450, 0x045f,
-            0x0430, 0x044f, 0x0461, 0x0481, 0x048b, 0x04bf, 0x04cf, 0x04c2, 0x04ce, 0x04d1, 0x052f, 0x0561, 0x0586,
-            0x2d00, 0x2d25, 0x2d27, 0x2d2d, 0x13f0, 0x13f5, 0x0432, 0x0434, 0x043e, 0x0441, 0x0442, 0x0442, 0x044a,
-            0x0463, 0xa64b, 0x10d0, 0x10fa, 0x10fd, 0x10ff, 0x1e01, 0x1e95, 0x1e61, 0x1ea1, 0x1eff, 0x1f00, 0x1f07,
-            0x1f10, 0x1f15, 0x1f20, 0x1f27, 0x1f30, 0x1f37, 0x1f40, 0x1f45, 0x1f51, 0x1f53, 0x1f55, 0x1f57, 0x1f60,
-            0x1f67, 0x1fb0, 0x1fb1, 0x1f70, 0x1f71, 0x03b9, 0x1f72, 0x1f75, 0x1fd0, 0x1fd1, 0x1f76, 0x1f77, 0x1fe0,
-            0x1fe1, 0x1f7a, 0x1f7b, 0x1fe5, 0x1f78, 0x1f79, 0x1f7c, 0x1f7d, 0x03c9, 0x006b, 0x00e5, 0x214e, 0x2170,
-            0x217f, 0x2184, 0x24d0, 0x24e9, 0x2c30, 0x2c5f, 0x2c61, 0x026b, 0x1d7d, 0x027d, 0x2c68, 0x2c6c, 0x0251,
-            0x0271, 0x0250, 0x0252, 0x2c73, 0x2c76, 0x023f, 0x0240, 0x2c81, 0x2ce3, 0x2cec, 0x2cee, 0x2cf3, 0xa641,
-            0xa66d, 0xa681, 0xa69b, 0xa723, 0xa72f, 0xa733, 0xa76f, 0xa77a, 0xa77c, 0x1d79, 0xa77f, 0xa787, 0xa78c,
-            0x0265, 0xa791, 0xa793, 0xa797, 0xa7a9, 0x0266, 0x025c, 0x0261, 0x026c, 0x026a, 0x029e, 0x0287, 0x029d,
-            0xab53, 0xa7b5, 0xa7c3, 0xa794, 0x0282, 0x1d8e, 0xa7c8, 0xa7ca, 0xa7d1, 0xa7d7, 0xa7d9, 0xa7f6, 0x13a0,
-            0x13ef, 0xff41, 0xff5a, 0x10428, 0x1044f, 0x104d8, 0x104fb, 0x10597, 0x105a1, 0x105a3, 0x105b1, 0x105b3,
-            0x105b9, 0x105bb, 0x105bc, 0x10cc0, 0x10cf2, 0x118c0, 0x118df, 0x16e60, 0x16e7f, 0x1e922, 0x1e943
-        };
-        static const unsigned FOLD_MAP_2[] = {
-            S(0x00df), S(0x0130), S(0x0149), S(0x01f0), S(0x0587), S(0x1e96), S(0x1e97), S(0x1e98), S(0x1e99),
-            S(0x1e9a), S(0x1e9e), S(0x1f50), R(0x1f80,0x1f87), R(0x1f88,0x1f8f), R(0x1f90,0x1f97), R(0x1f98,0x1f9f),
-            R(0x1fa0,0x1fa7), R(0x1fa8,0x1faf), S(0x1fb2), S(0x1fb3), S(0x1fb4), S(0x1fb6), S(0x1fbc), S(0x1fc2),
-            S(0x1fc3), S(0x1fc4), S(0x1fc6), S(0x1fcc), S(0x1fd6), S(0x1fe4), S(0x1fe6), S(0x1ff2), S(0x1ff3),
-            S(0x1ff4), S(0x1ff6), S(0x1ffc), S(0xfb00), S(0xfb01), S(0xfb02), S(0xfb05), S(0xfb06), S(0xfb13),
-            S(0xfb14), S(0xfb15), S(0xfb16), S(0xfb17)
-        };
-        static const unsigned FOLD_MAP_2_DATA[] = {
-            0x0073,0x0073, 0x0069,0x0307, 0x02bc,0x006e, 0x006a,0x030c, 0x0565,0x0582, 0x0068,0x0331, 0x0074,0x0308,
-            0x0077,0x030a, 0x0079,0x030a, 0x0061,0x02be, 0x0073,0x0073, 0x03c5,0x0313, 0x1f00,0x03b9, 0x1f07,0x03b9,
-            0x1f00,0x03b9, 0x1f07,0x03b9, 0x1f20,0x03b9, 0x1f27,0x03b9, 0x1f20,0x03b9, 0x1f27,0x03b9, 0x1f60,0x03b9,
-            0x1f67,0x03b9, 0x1f60,0x03b9, 0x1f67,0x03b9, 0x1f70,0x03b9, 0x03b1,0x03b9, 0x03ac,0x03b9, 0x03b1,0x0342,
-            0x03b1,0x03b9, 0x1f74,0x03b9, 0x03b7,0x03b9, 0x03ae,0x03b9, 0x03b7,0x0342, 0x03b7,0x03b9, 0x03b9,0x0342,
-            0x03c1,0x0313, 0x03c5,0x0342, 0x1f7c,0x03b9, 0x03c9,0x03b9, 0x03ce,0x03b9, 0x03c9,0x0342, 0x03c9,0x03b9,
-            0x0066,0x0066, 0x0066,0x0069, 0x0066,0x006c, 0x0073,0x0074, 0x0073,0x0074, 0x0574,0x0576, 0x0574,0x0565,
-            0x0574,0x056b, 0x057e,0x0576, 0x0574,0x056d
-        };
-        static const unsigned FOLD_MAP_3[] = {
-            S(0x0390), S(0x03b0), S(0x1f52), S(0x1f54), S(0x1f56), S(0x1fb7), S(0x1fc7), S(0x1fd2), S(0x1fd3),
-            S(0x1fd7), S(0x1fe2), S(0x1fe3), S(0x1fe7), S(0x1ff7), S(0xfb03), S(0xfb04)
-        };
-        static const unsigned FOLD_MAP_3_DATA[] = {
-            0x03b9,0x0308,0x0301, 0x03c5,0x0308,0x0301, 0x03c5,0x0313,0x0300, 0x03c5,0x0313,0x0301,
-            0x03c5,0x0313,0x0342, 0x03b1,0x0342,0x03b9, 0x03b7,0x0342,0x03b9, 0x03b9,0x0308,0x0300,
-            0x03b9,0x0308,0x0301, 0x03b9,0x0308,0x0342, 0x03c5,0x0308,0x0300, 0x03c5,0x0308,0x0301,
-            0x03c5,0x0308,0x0342, 0x03c9,0x0342,0x03b9, 0x0066,0x0066,0x0069, 0x0066,0x0066,0x006c
-        };
-#undef R
-#undef S
-        static const struct {
-            const unsigned* map;
-            const unsigned* data;
-            size_t map_size;
-            unsigned n_codepoints;
-        } FOLD_MAP_LIST[] = {
-            { FOLD_MAP_1, FOLD_MAP_1_DATA, SIZEOF_ARRAY(FOLD_MAP_1), 1 },
-            { FOLD_MAP_2, FOLD_MAP_2_DATA, SIZEOF_ARRAY(FOLD_MAP_2), 2 },
-            { FOLD_MAP_3, FOLD_MAP_3_DATA, SIZEOF_ARRAY(FOLD_MAP_3), 3 }
-        };
-
-        int i;
+        const unsigned* fold;
 
         /* Fast path for ASCII characters. */
         if(codepoint <= 0x7f) {
@@ -786,39 +662,16 @@ struct MD_UNICODE_FOLD_INFO_tag {
             return;
         }
 
-        /* Try to locate the codepoint in any of the maps. */
-        for(i = 0; i < (int) SIZEOF_ARRAY(FOLD_MAP_LIST); i++) {
-            int index;
-
-            index = md_unicode_bsearch__(codepoint, FOLD_MAP_LIST[i].map, FOLD_MAP_LIST[i].map_size);
-            if(index >= 0) {
-                /* Found the mapping. */
-                unsigned n_codepoints = FOLD_MAP_LIST[i].n_codepoints;
-                const unsigned* map = FOLD_MAP_LIST[i].map;
-                const unsigned* codepoints = FOLD_MAP_LIST[i].data + (index * n_codepoints);
-
-                memcpy(info->codepoints, codepoints, sizeof(unsigned) * n_codepoints);
-                info->n_codepoints = n_codepoints;
-
-                if(FOLD_MAP_LIST[i].map[index] != codepoint) {
-                    /* The found mapping maps whole range of codepoints,
-                     * i.e. we have to offset info->codepoints[0] accordingly. */
-                    if((map[index] & 0x00ffffff)+1 == codepoints[0]) {
-                        /* Alternating type of the range. */
-                        info->codepoints[0] = codepoint + ((codepoint & 0x1) == (map[index] & 0x1) ? 1 : 0);
-                    } else {
-                        /* Range to range kind of mapping. */
-                        info->codepoints[0] += (codepoint - (map[index] & 0x00ffffff));
-                    }
-                }
-
-                return;
-            }
+        /* Index 0 of the fold data is the identity (delta 0). */
+        fold = MD_UNICODE_FOLD_DATA[md_unicode_info__(codepoint) >> MD_UNICODE_INFO_FOLD_SHIFT];
+        info->n_codepoints = fold[0];
+        if(fold[0] == 1) {
+            info->codepoints[0] = codepoint + fold[1];
+        } else {
+            info->codepoints[0] = fold[1];
+            info->codepoints[1] = fold[2];
+            info->codepoints[2] = fold[3];
         }
-
-        /* No mapping found. Map the codepoint to itself. */
-        info->codepoints[0] = codepoint;
-        info->n_codepoints = 1;
     }
 #endif
 
@@ -936,11 +789,16 @@ struct MD_UNICODE_FOLD_INFO_tag {
     }
 
     #define ISUNICODEWHITESPACE_(codepoint) md_is_unicode_whitespace__(codepoint)
-    #define ISUNICODEWHITESPACE(off)        md_is_unicode_whitespace__(md_decode_utf8__(STR(off), ctx->size - (off), NULL))
-    #define ISUNICODEWHITESPACEBEFORE(off)  md_is_unicode_whitespace__(md_decode_utf8_before__(ctx, off))
+    /* ASCII bytes are classified directly, without decoding anything. */
+    #define ISUNICODEWHITESPACE(off)        (IS_UTF8_LEAD1(CH(off)) ? ISWHITESPACE(off) :                         \
+                                             md_is_unicode_whitespace__(md_decode_utf8__(STR(off), ctx->size - (off), NULL)))
+    #define ISUNICODEWHITESPACEBEFORE(off)  (IS_UTF8_LEAD1(CH((off)-1)) ? ISWHITESPACE((off)-1) :                 \
+                                             md_is_unicode_whitespace__(md_decode_utf8_before__(ctx, off)))
 
-    #define ISUNICODEPUNCT(off)             md_is_unicode_punct__(md_decode_utf8__(STR(off), ctx->size - (off), NULL))
-    #define ISUNICODEPUNCTBEFORE(off)       md_is_unicode_punct__(md_decode_utf8_before__(ctx, off))
+    #define ISUNICODEPUNCT(off)             (IS_UTF8_LEAD1(CH(off)) ? ISPUNCT(off) :                              \
+                                             md_is_unicode_punct__(md_decode_utf8__(STR(off), ctx->size - (off), NULL)))
+    #define ISUNICODEPUNCTBEFORE(off)       (IS_UTF8_LEAD1(CH((off)-1)) ? ISPUNCT((off)-1) :                      \
+                                             md_is_unicode_punct__(md_decode_utf8_before__(ctx, off)))
 
     static inline unsigned
     md_decode_unicode(const CHAR* str, OFF off, SZ str_size, SZ* p_char_size)
@@ -1027,7 +885,7 @@ md_merge_lines_alloc(MD_CTX* ctx, OFF beg, OFF end, const MD_LINE* lines, MD_SIZ
 {
     CHAR* buffer;
 
-    buffer = (CHAR*) malloc(sizeof(CHAR) * (end - beg));
+    buffer = (CHAR*) md_malloc(ctx, sizeof(CHAR) * (end - beg));
     if(buffer == NULL) {
         MD_LOG("malloc() failed.");
         return -1;
@@ -1425,27 +1283,29 @@ md_build_attr_append_substr(MD_CTX* ctx, MD_ATTRIBUTE_BUILD* build,
     if(build->substr_count >= build->substr_alloc) {
         MD_TEXTTYPE* new_substr_types;
         OFF* new_substr_offsets;
-
-        build->substr_alloc = (build->substr_alloc > 0
+        unsigned new_alloc = (build->substr_alloc > 0
                 ? build->substr_alloc + build->substr_alloc / 2
                 : 8);
-        new_substr_types = (MD_TEXTTYPE*) realloc(build->substr_types,
-                                    build->substr_alloc * sizeof(MD_TEXTTYPE));
+
+        /* Each array is stored back as soon as it is reallocated, so that
+         * md_free_attribute() frees whatever the build holds when the other
+         * one fails. */
+        new_substr_types = (MD_TEXTTYPE*) md_realloc(ctx, build->substr_types,
+                                    new_alloc * sizeof(MD_TEXTTYPE));
         if(new_substr_types == NULL) {
             MD_LOG("realloc() failed.");
             return -1;
         }
+        build->substr_types = new_substr_types;
         /* Note +1 to reserve space for final offset (== raw_size). */
-        new_substr_offsets = (OFF*) realloc(build->substr_offsets,
-                                    (build->substr_alloc+1) * sizeof(OFF));
+        new_substr_offsets = (OFF*) md_realloc(ctx, build->substr_offsets,
+                                    (new_alloc+1) * sizeof(OFF));
         if(new_substr_offsets == NULL) {
             MD_LOG("realloc() failed.");
-            free(new_substr_types);
             return -1;
         }
-
-        build->substr_types = new_substr_types;
         build->substr_offsets = new_substr_offsets;
+        build->substr_alloc = new_alloc;
     }
 
     build->substr_types[build->substr_count] = type;
@@ -1459,10 +1319,11 @@ md_free_attribute(MD_CTX* ctx, MD_ATTRIBUTE_BUILD* build)
 {
     MD_UNUSED(ctx);
 
-    if(build->substr_alloc > 0) {
-        free(build->text);
-        free(build->substr_types);
-        free(build->substr_offsets);
+    /* A non-trivial build owns its buffers, however far it got. */
+    if(build->substr_types != build->trivial_types) {
+        md_free(ctx, build->text);
+        md_free(ctx, build->substr_types);
+        md_free(ctx, build->substr_offsets);
     }
 }
 
@@ -1497,7 +1358,7 @@ md_build_attribute(MD_CTX* ctx, const CHAR* raw_text, SZ raw_size,
         build->trivial_offsets[1] = raw_size;
         off = raw_size;
     } else {
-        build->text = (CHAR*) malloc(raw_size * sizeof(CHAR));
+        build->text = (CHAR*) md_malloc(ctx, raw_size * sizeof(CHAR));
         if(build->text == NULL) {
             MD_LOG("malloc() failed.");
             goto abort;
@@ -1548,6 +1409,8 @@ md_build_attribute(MD_CTX* ctx, const CHAR* raw_text, SZ raw_size,
 
 abort:
     md_free_attribute(ctx, build);
+    /* The caller frees the build on its own error path too. */
+    memset(build, 0, sizeof(MD_ATTRIBUTE_BUILD));
     return -1;
 }
 
@@ -1583,261 +1446,131 @@ struct MD_REF_DEF_tag {
     SZ title_size;
     OFF dest_beg;
     OFF dest_end;
+    SZ norm_label_off;      /* Normalized label in ctx->norm_labels[]. */
+    SZ norm_label_size;
     unsigned char label_needs_free : 1;
     unsigned char title_needs_free : 1;
 };
 
 /* Label equivalence is quite complicated with regards to whitespace and case
- * folding. This complicates computing a hash of it as well as direct comparison
- * of two labels. */
-
-static unsigned
-md_link_label_hash(const CHAR* label, SZ size)
+ * folding. To avoid repeating that work on every comparison, each label is
+ * normalized only once into a sequence of codepoints: Leading and trailing
+ * whitespace is stripped, any inner whitespace sequence is collapsed into a
+ * single space, and all other characters are case-folded. Two labels are
+ * equivalent if and only if their normalized forms are equal.
+ *
+ * The normalized form is appended to ctx->norm_labels[]. Its position, length
+ * and hash are stored into the given MD_REF_DEF. */
+static int
+md_link_label_normalize(MD_CTX* ctx, const CHAR* label, SZ size, MD_REF_DEF* def)
 {
-    unsigned hash = MD_FNV1A_BASE;
     OFF off;
-    unsigned codepoint;
-    int is_whitespace = FALSE;
+    unsigned* out;
+    int pending_space = FALSE;
+
+    /* Each character can fold into at most 3 codepoints. */
+    if(ctx->n_norm_labels + 3 * size > ctx->alloc_norm_labels) {
+        unsigned* new_norm_labels;
+        SZ alloc = ctx->alloc_norm_labels + ctx->alloc_norm_labels / 2;
+
+        if(alloc < ctx->n_norm_labels + 3 * size)
+            alloc = ctx->n_norm_labels + 3 * size;
+        if(alloc < 256)
+            alloc = 256;
+        new_norm_labels = (unsigned*) md_realloc(ctx, ctx->norm_labels, alloc * sizeof(unsigned));
+        if(new_norm_labels == NULL) {
+            MD_LOG("realloc() failed.");
+            return -1;
+        }
 
+        ctx->norm_labels = new_norm_labels;
+        ctx->alloc_norm_labels = alloc;
+    }
+
+    out = ctx->norm_labels + ctx->n_norm_labels;
     off = md_skip_unicode_whitespace(label, 0, size);
     while(off < size) {
         SZ char_size;
+        unsigned codepoint;
 
         codepoint = md_decode_unicode(label, off, size, &char_size);
-        is_whitespace = ISUNICODEWHITESPACE_(codepoint) || ISNEWLINE_(label[off]);
-
-        if(is_whitespace) {
-            codepoint = ' ';
-            hash = md_fnv1a(hash, &codepoint, sizeof(unsigned));
+        if(ISUNICODEWHITESPACE_(codepoint) || ISNEWLINE_(label[off])) {
+            pending_space = TRUE;
             off = md_skip_unicode_whitespace(label, off, size);
         } else {
             MD_UNICODE_FOLD_INFO fold_info;
+            unsigned i;
+
+            if(pending_space) {
+                *out++ = _T(' ');
+                pending_space = FALSE;
+            }
 
             md_get_unicode_fold_info(codepoint, &fold_info);
-            hash = md_fnv1a(hash, fold_info.codepoints, fold_info.n_codepoints * sizeof(unsigned));
+            for(i = 0; i < fold_info.n_codepoints; i++)
+                *out++ = fold_info.codepoints[i];
             off += char_size;
         }
     }
 
-    return hash;
-}
-
-static OFF
-md_link_label_cmp_load_fold_info(const CHAR* label, OFF off, SZ size,
-                                 MD_UNICODE_FOLD_INFO* fold_info)
-{
-    unsigned codepoint;
-    SZ char_size;
-
-    if(off >= size) {
-        /* Treat end of a link label as a whitespace. */
-        goto whitespace;
-    }
-
-    codepoint = md_decode_unicode(label, off, size, &char_size);
-    off += char_size;
-    if(ISUNICODEWHITESPACE_(codepoint)) {
-        /* Treat all whitespace as equivalent */
-        goto whitespace;
-    }
-
-    /* Get real folding info. */
-    md_get_unicode_fold_info(codepoint, fold_info);
-    return off;
-
-whitespace:
-    fold_info->codepoints[0] = _T(' ');
-    fold_info->n_codepoints = 1;
-    return md_skip_unicode_whitespace(label, off, size);
-}
-
-static int
-md_link_label_cmp(const CHAR* a_label, SZ a_size, const CHAR* b_label, SZ b_size)
-{
-    OFF a_off;
-    OFF b_off;
-    MD_UNICODE_FOLD_INFO a_fi = { { 0 }, 0 };
-    MD_UNICODE_FOLD_INFO b_fi = { { 0 }, 0 };
-    OFF a_fi_off = 0;
-    OFF b_fi_off = 0;
-    int cmp;
-
-    a_off = md_skip_unicode_whitespace(a_label, 0, a_size);
-    b_off = md_skip_unicode_whitespace(b_label, 0, b_size);
-    while(a_off < a_size || a_fi_off < a_fi.n_codepoints ||
-          b_off < b_size || b_fi_off < b_fi.n_codepoints)
-    {
-        /* If needed, load fold info for next char. */
-        if(a_fi_off >= a_fi.n_codepoints) {
-            a_fi_off = 0;
-            a_off = md_link_label_cmp_load_fold_info(a_label, a_off, a_size, &a_fi);
-        }
-        if(b_fi_off >= b_fi.n_codepoints) {
-            b_fi_off = 0;
-            b_off = md_link_label_cmp_load_fold_info(b_label, b_off, b_size, &b_fi);
-        }
-
-        cmp = b_fi.codepoints[b_fi_off] - a_fi.codepoints[a_fi_off];
-        if(cmp != 0)
-            return cmp;
-
-        a_fi_off++;
-        b_fi_off++;
-    }
-
+    def->norm_label_off = ctx->n_norm_labels;
+    def->norm_label_size = (SZ) (out - (ctx->norm_labels + ctx->n_norm_labels));
+    def->hash = md_fnv1a(MD_FNV1A_BASE, ctx->norm_labels + def->norm_label_off,
+                         def->norm_label_size * sizeof(unsigned));
+    ctx->n_norm_labels += def->norm_label_size;
     return 0;
 }
 
-typedef struct MD_REF_DEF_LIST_tag MD_REF_DEF_LIST;
-struct MD_REF_DEF_LIST_tag {
-    int n_ref_defs;
-    int alloc_ref_defs;
-    MD_REF_DEF* ref_defs[];  /* Valid items always  point into ctx->ref_defs[] */
-};
-
-static int
-md_ref_def_cmp(const void* a, const void* b)
-{
-    const MD_REF_DEF* a_ref = *(const MD_REF_DEF**)a;
-    const MD_REF_DEF* b_ref = *(const MD_REF_DEF**)b;
-
-    if(a_ref->hash < b_ref->hash)
-        return -1;
-    else if(a_ref->hash > b_ref->hash)
-        return +1;
-    else
-        return md_link_label_cmp(a_ref->label, a_ref->label_size, b_ref->label, b_ref->label_size);
-}
-
-static int
-md_ref_def_cmp_for_sort(const void* a, const void* b)
+static inline int
+md_ref_def_label_eq(MD_CTX* ctx, const MD_REF_DEF* a, const MD_REF_DEF* b)
 {
-    int cmp;
-
-    cmp = md_ref_def_cmp(a, b);
-
-    /* Ensure stability of the sorting. */
-    if(cmp == 0) {
-        const MD_REF_DEF* a_ref = *(const MD_REF_DEF**)a;
-        const MD_REF_DEF* b_ref = *(const MD_REF_DEF**)b;
-
-        if(a_ref < b_ref)
-            cmp = -1;
-        else if(a_ref > b_ref)
-            cmp = +1;
-        else
-            cmp = 0;
-    }
-
-    return cmp;
+    return (a->hash == b->hash  &&
+            a->norm_label_size == b->norm_label_size  &&
+            memcmp(ctx->norm_labels + a->norm_label_off, ctx->norm_labels + b->norm_label_off,
+                   a->norm_label_size * sizeof(unsigned)) == 0);
 }
 
+/* The hashtable uses open addressing with linear probing. Its size is a power
+ * of two and it is kept at most half full, so the probe sequences are short.
+ * Each slot is either NULL or points to a MD_REF_DEF in ctx->ref_defs[]. */
 static int
 md_build_ref_def_hashtable(MD_CTX* ctx)
 {
-    int i, j;
+    int i;
+    int size;
 
     if(ctx->n_ref_defs == 0)
         return 0;
 
-    ctx->ref_def_hashtable_size = (ctx->n_ref_defs * 5) / 4;
-    ctx->ref_def_hashtable = malloc(ctx->ref_def_hashtable_size * sizeof(void*));
+    size = 16;
+    while(size < 2 * ctx->n_ref_defs)
+        size *= 2;
+
+    ctx->ref_def_hashtable = (MD_REF_DEF**) md_malloc(ctx, size * sizeof(MD_REF_DEF*));
     if(ctx->ref_def_hashtable == NULL) {
         MD_LOG("malloc() failed.");
         goto abort;
     }
-    memset(ctx->ref_def_hashtable, 0, ctx->ref_def_hashtable_size * sizeof(void*));
+    memset(ctx->ref_def_hashtable, 0, size * sizeof(MD_REF_DEF*));
+    ctx->ref_def_hashtable_size = size;
 
-    /* Each member of ctx->ref_def_hashtable[] can be:
-     *  -- NULL,
-     *  -- pointer to the MD_REF_DEF in ctx->ref_defs[], or
-     *  -- pointer to a MD_REF_DEF_LIST, which holds multiple pointers to
-     *     such MD_REF_DEFs.
-     */
     for(i = 0; i < ctx->n_ref_defs; i++) {
         MD_REF_DEF* def = &ctx->ref_defs[i];
-        void* bucket;
-        MD_REF_DEF_LIST* list;
-
-        def->hash = md_link_label_hash(def->label, def->label_size);
-        bucket = ctx->ref_def_hashtable[def->hash % ctx->ref_def_hashtable_size];
-
-        if(bucket == NULL) {
-            /* The bucket is empty. Make it just point to the def. */
-            ctx->ref_def_hashtable[def->hash % ctx->ref_def_hashtable_size] = def;
-            continue;
-        }
-
-        if(ctx->ref_defs <= (MD_REF_DEF*) bucket  &&  (MD_REF_DEF*) bucket < ctx->ref_defs + ctx->n_ref_defs) {
-            /* The bucket already contains one ref. def. Lets see whether it
-             * is the same label (ref. def. duplicate) or different one
-             * (hash conflict). */
-            MD_REF_DEF* old_def = (MD_REF_DEF*) bucket;
+        unsigned slot;
 
-            if(md_link_label_cmp(def->label, def->label_size, old_def->label, old_def->label_size) == 0) {
-                /* Duplicate label: Ignore this ref. def. */
-                continue;
-            }
-
-            /* Make the bucket complex, i.e. able to hold more ref. defs. */
-            list = (MD_REF_DEF_LIST*) malloc(sizeof(MD_REF_DEF_LIST) + 2 * sizeof(MD_REF_DEF*));
-            if(list == NULL) {
-                MD_LOG("malloc() failed.");
-                goto abort;
-            }
-            list->ref_defs[0] = old_def;
-            list->ref_defs[1] = def;
-            list->n_ref_defs = 2;
-            list->alloc_ref_defs = 2;
-            ctx->ref_def_hashtable[def->hash % ctx->ref_def_hashtable_size] = list;
-            continue;
-        }
+        if(md_link_label_normalize(ctx, def->label, def->label_size, def) != 0)
+            goto abort;
 
-        /* Append the def to the complex bucket list.
-         *
-         * Note in this case we ignore potential duplicates to avoid expensive
-         * iterating over the complex bucket. Below, we revisit all the complex
-         * buckets and handle it more cheaply after the complex bucket contents
-         * is sorted. */
-        list = (MD_REF_DEF_LIST*) bucket;
-        if(list->n_ref_defs >= list->alloc_ref_defs) {
-            int alloc_ref_defs = list->alloc_ref_defs + list->alloc_ref_defs / 2;
-            MD_REF_DEF_LIST* list_tmp = (MD_REF_DEF_LIST*) realloc(list,
-                        sizeof(MD_REF_DEF_LIST) + alloc_ref_defs * sizeof(MD_REF_DEF*));
-            if(list_tmp == NULL) {
-                MD_LOG("realloc() failed.");
-                goto abort;
-            }
-            list = list_tmp;
-            list->alloc_ref_defs = alloc_ref_defs;
-            ctx->ref_def_hashtable[def->hash % ctx->ref_def_hashtable_size] = list;
+        slot = def->hash & (size - 1);
+        while(ctx->ref_def_hashtable[slot] != NULL) {
+            /* Duplicate label: The first ref. def. wins, ignore this one. */
+            if(md_ref_def_label_eq(ctx, ctx->ref_def_hashtable[slot], def))
+                break;
+            slot = (slot + 1) & (size - 1);
         }
 
-        list->ref_defs[list->n_ref_defs] = def;
-        list->n_ref_defs++;
-    }
-
-    /* Sort the complex buckets so we can use bsearch() with them. */
-    for(i = 0; i < ctx->ref_def_hashtable_size; i++) {
-        void* bucket = ctx->ref_def_hashtable[i];
-        MD_REF_DEF_LIST* list;
-
-        if(bucket == NULL)
-            continue;
-        if(ctx->ref_defs <= (MD_REF_DEF*) bucket  &&  (MD_REF_DEF*) bucket < ctx->ref_defs + ctx->n_ref_defs)
-            continue;
-
-        list = (MD_REF_DEF_LIST*) bucket;
-        qsort(list->ref_defs, list->n_ref_defs, sizeof(MD_REF_DEF*), md_ref_def_cmp_for_sort);
-
-        /* Disable all duplicates in the complex bucket by forcing all such
-         * records to point to the 1st such ref. def. I.e. no matter which
-         * record is found during the lookup, it will always point to the right
-         * ref. def. in ctx->ref_defs[]. */
-        for(j = 1; j < list->n_ref_defs; j++) {
-            if(md_ref_def_cmp(&list->ref_defs[j-1], &list->ref_defs[j]) == 0)
-                list->ref_defs[j] = list->ref_defs[j-1];
-        }
+        if(ctx->ref_def_hashtable[slot] == NULL)
+            ctx->ref_def_hashtable[slot] = def;
     }
 
     return 0;
@@ -1849,60 +1582,45 @@ abort:
 static void
 md_free_ref_def_hashtable(MD_CTX* ctx)
 {
-    if(ctx->ref_def_hashtable != NULL) {
-        int i;
-
-        for(i = 0; i < ctx->ref_def_hashtable_size; i++) {
-            void* bucket = ctx->ref_def_hashtable[i];
-            if(bucket == NULL)
-                continue;
-            if(ctx->ref_defs <= (MD_REF_DEF*) bucket  &&  (MD_REF_DEF*) bucket < ctx->ref_defs + ctx->n_ref_defs)
-                continue;
-            free(bucket);
-        }
-
-        free(ctx->ref_def_hashtable);
-    }
+    md_free(ctx, ctx->ref_def_hashtable);
+    md_free(ctx, ctx->norm_labels);
 }
 
-static const MD_REF_DEF*
-md_lookup_ref_def(MD_CTX* ctx, const CHAR* label, SZ label_size)
+/* Returns -1 in case of an error (out of memory), or 0 otherwise. If there
+ * is no matching ref. def., *p_def is set to NULL. */
+static int
+md_lookup_ref_def(MD_CTX* ctx, const CHAR* label, SZ label_size, const MD_REF_DEF** p_def)
 {
-    unsigned hash;
-    void* bucket;
+    MD_REF_DEF key;
+    unsigned mask;
+    unsigned slot;
 
+    *p_def = NULL;
     if(ctx->ref_def_hashtable_size == 0)
-        return NULL;
+        return 0;
 
-    hash = md_link_label_hash(label, label_size);
-    bucket = ctx->ref_def_hashtable[hash % ctx->ref_def_hashtable_size];
+    /* Link labels are limited to 999 characters (see md_is_link_label()),
+     * so anything longer cannot match and we do not waste time with it. */
+    if(label_size > 4 * 999)
+        return 0;
 
-    if(bucket == NULL) {
-        return NULL;
-    } else if(ctx->ref_defs <= (MD_REF_DEF*) bucket  &&  (MD_REF_DEF*) bucket < ctx->ref_defs + ctx->n_ref_defs) {
-        const MD_REF_DEF* def = (MD_REF_DEF*) bucket;
+    /* Normalize the label into the tail of ctx->norm_labels[] and roll it
+     * back when done. */
+    if(md_link_label_normalize(ctx, label, label_size, &key) != 0)
+        return -1;
+    ctx->n_norm_labels = key.norm_label_off;
 
-        if(md_link_label_cmp(def->label, def->label_size, label, label_size) == 0)
-            return def;
-        else
-            return NULL;
-    } else {
-        MD_REF_DEF_LIST* list = (MD_REF_DEF_LIST*) bucket;
-        MD_REF_DEF key_buf;
-        const MD_REF_DEF* key = &key_buf;
-        const MD_REF_DEF** ret;
-
-        key_buf.label = (CHAR*) label;
-        key_buf.label_size = label_size;
-        key_buf.hash = md_link_label_hash(key_buf.label, key_buf.label_size);
-
-        ret = (const MD_REF_DEF**) bsearch(&key, list->ref_defs,
-                    list->n_ref_defs, sizeof(MD_REF_DEF*), md_ref_def_cmp);
-        if(ret != NULL)
-            return *ret;
-        else
-            return NULL;
+    mask = (unsigned) ctx->ref_def_hashtable_size - 1;
+    slot = key.hash & mask;
+    while(ctx->ref_def_hashtable[slot] != NULL) {
+        if(md_ref_def_label_eq(ctx, ctx->ref_def_hashtable[slot], &key)) {
+            *p_def = ctx->ref_def_hashtable[slot];
+            break;
+        }
+        slot = (slot + 1) & mask;
     }
+
+    return 0;
 }
 
 
@@ -2221,17 +1939,19 @@ md_is_link_reference_definition(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lin
     /* So, it _is_ a reference definition. Remember it. */
     if(ctx->n_ref_defs >= ctx->alloc_ref_defs) {
         MD_REF_DEF* new_defs;
-
-        ctx->alloc_ref_defs = (ctx->alloc_ref_defs > 0
+        int new_alloc = (ctx->alloc_ref_defs > 0
                 ? ctx->alloc_ref_defs + ctx->alloc_ref_defs / 2
                 : 16);
-        new_defs = (MD_REF_DEF*) realloc(ctx->ref_defs, ctx->alloc_ref_defs * sizeof(MD_REF_DEF));
+
+        new_defs = (MD_REF_DEF*) md_realloc(ctx, ctx->ref_defs, new_alloc * sizeof(MD_REF_DEF));
         if(new_defs == NULL) {
             MD_LOG("realloc() failed.");
+            ret = -1;
             goto abort;
         }
 
         ctx->ref_defs = new_defs;
+        ctx->alloc_ref_defs = new_alloc;
     }
     def = &ctx->ref_defs[ctx->n_ref_defs];
     memset(def, 0, sizeof(MD_REF_DEF));
@@ -2266,9 +1986,9 @@ md_is_link_reference_definition(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lin
 abort:
     /* Failure. */
     if(def != NULL  &&  def->label_needs_free)
-        free(def->label);
+        md_free(ctx, def->label);
     if(def != NULL  &&  def->title_needs_free)
-        free(def->title);
+        md_free(ctx, def->title);
     return ret;
 }
 
@@ -2301,7 +2021,17 @@ md_is_link_reference(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
         label_size = end - beg;
     }
 
-    def = md_lookup_ref_def(ctx, label, label_size);
+    ret = md_lookup_ref_def(ctx, label, label_size, &def);
+    if(ret == 0  &&  def != NULL) {
+        SZ expansion_size = (def->dest_end - def->dest_beg) + def->title_size;
+
+        /* Refuse to expand the reference when we have already expanded too
+         * much (see REF_EXPANSION_MINLIMIT). */
+        if(expansion_size > ctx->max_ref_expansion_size - ctx->ref_expansion_size)
+            def = NULL;
+        else
+            ctx->ref_expansion_size += expansion_size;
+    }
     if(def != NULL) {
         attr->dest_beg = def->dest_beg;
         attr->dest_end = def->dest_end;
@@ -2311,7 +2041,9 @@ md_is_link_reference(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
     }
 
     if(is_multiline)
-        free(label);
+        md_free(ctx, label);
+    if(ret < 0)
+        goto abort;
 
     ret = (def != NULL);
 
@@ -2332,8 +2064,10 @@ md_is_inline_link_spec(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
     OFF off = beg;
     int ret = FALSE;
 
-    while(off >= lines[line_index].end)
-        line_index++;
+    /* Binary search: a linear walk from the paragraph's first line made
+     * every '(' after a ']' cost O(lines), i.e. O(n^2) for a paragraph full
+     * of them. */
+    md_lookup_line(off, lines, n_lines, &line_index);
 
     MD_ASSERT(CH(off) == _T('('));
     off++;
@@ -2425,12 +2159,12 @@ md_free_ref_defs(MD_CTX* ctx)
         MD_REF_DEF* def = &ctx->ref_defs[i];
 
         if(def->label_needs_free)
-            free(def->label);
+            md_free(ctx, def->label);
         if(def->title_needs_free)
-            free(def->title);
+            md_free(ctx, def->title);
     }
 
-    free(ctx->ref_defs);
+    md_free(ctx, ctx->ref_defs);
 }
 
 
@@ -2581,17 +2315,18 @@ md_add_mark(MD_CTX* ctx)
 {
     if(ctx->n_marks >= ctx->alloc_marks) {
         MD_MARK* new_marks;
-
-        ctx->alloc_marks = (ctx->alloc_marks > 0
+        int new_alloc = (ctx->alloc_marks > 0
                 ? ctx->alloc_marks + ctx->alloc_marks / 2
                 : 64);
-        new_marks = realloc(ctx->marks, ctx->alloc_marks * sizeof(MD_MARK));
+
+        new_marks = md_realloc(ctx, ctx->marks, new_alloc * sizeof(MD_MARK));
         if(new_marks == NULL) {
             MD_LOG("realloc() failed.");
             return NULL;
         }
 
         ctx->marks = new_marks;
+        ctx->alloc_marks = new_alloc;
     }
 
     return &ctx->marks[ctx->n_marks++];
@@ -2618,22 +2353,51 @@ md_add_mark(MD_CTX* ctx)
         } while(0)
 
 
+static inline void
+md_mark_stack_reset(MD_MARKSTACK* stack)
+{
+    stack->top = -1;
+    stack->depth = 0;
+}
+
 static inline void
 md_mark_stack_push(MD_CTX* ctx, MD_MARKSTACK* stack, int mark_index)
 {
     ctx->marks[mark_index].next = stack->top;
     stack->top = mark_index;
+    stack->depth++;
 }
 
 static inline int
 md_mark_stack_pop(MD_CTX* ctx, MD_MARKSTACK* stack)
 {
     int top = stack->top;
-    if(top >= 0)
+    if(top >= 0) {
         stack->top = ctx->marks[top].next;
+        stack->depth--;
+    }
     return top;
 }
 
+/* Push for the opener stacks. Unlike md_mark_stack_push(), this enforces
+ * OPENERS_MAXDEPTH by cutting off the bottom (i.e. the oldest) half of the
+ * stack when it is full. */
+static void
+md_opener_stack_push(MD_CTX* ctx, MD_MARKSTACK* stack, int mark_index)
+{
+    if(stack->depth >= OPENERS_MAXDEPTH) {
+        int i;
+        int index = stack->top;
+
+        for(i = 1; i < OPENERS_MAXDEPTH / 2; i++)
+            index = ctx->marks[index].next;
+        ctx->marks[index].next = -1;
+        stack->depth = OPENERS_MAXDEPTH / 2;
+    }
+
+    md_mark_stack_push(ctx, stack, mark_index);
+}
+
 /* Sometimes, we need to store a pointer into the mark. It is quite rare
  * so we do not bother to make MD_MARK use union, and it can only happen
  * for dummy marks. */
@@ -3182,6 +2946,12 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                     continue;
                 }
 
+                /* Raw HTML may span lines, so it might still be closed on
+                 * some line we do not see. */
+                if(!(ctx->parser.flags & MD_FLAG_NOHTMLSPANS)  &&  off+1 < line->end  &&
+                   (ISALPHA(off+1) || ISANYOF(off+1, _T("/!?"))))
+                    ctx->inline_window_open = TRUE;
+
                 off++;
                 continue;
             }
@@ -3347,6 +3117,10 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
         }
     }
 
+    /* A code span opener without any closer on the lines we have seen. */
+    if(codespan_scanned_till_paragraph_end)
+        ctx->inline_window_open = TRUE;
+
     /* Add a dummy mark at the end of the mark vector to simplify
      * process_inlines(). */
     ADD_MARK(127, ctx->size, ctx->size, MD_MARK_RESOLVED);
@@ -3377,7 +3151,7 @@ md_analyze_bracket(MD_CTX* ctx, int mark_index)
         if(BRACKET_OPENERS.top >= 0)
             ctx->marks[BRACKET_OPENERS.top].flags |= MD_MARK_HASNESTEDBRACKETS;
 
-        md_mark_stack_push(ctx, &BRACKET_OPENERS, mark_index);
+        md_opener_stack_push(ctx, &BRACKET_OPENERS, mark_index);
         return;
     }
 
@@ -3401,7 +3175,9 @@ md_analyze_bracket(MD_CTX* ctx, int mark_index)
     }
 }
 
-/* Forward declaration. */
+/* Forward declarations. */
+static void md_analyze_span_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
+                                  int mark_beg, int mark_end);
 static void md_analyze_link_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
                                      int mark_beg, int mark_end);
 
@@ -3581,7 +3357,7 @@ md_resolve_links(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                             if(ctx->marks[mark->next].beg >= inline_link_end) {
                                 /* Cancel the link status. */
                                 if(attr.title_needs_free)
-                                    free(attr.title);
+                                    md_free(ctx, attr.title);
                                 is_link = FALSE;
                                 break;
                             }
@@ -3801,7 +3577,7 @@ md_analyze_emph(MD_CTX* ctx, int mark_index)
 
     /* If we could not resolve as closer, we may be yet be an opener. */
     if(mark->flags & MD_MARK_POTENTIAL_OPENER)
-        md_mark_stack_push(ctx, md_emph_stack(ctx, mark->ch, mark->flags), mark_index);
+        md_opener_stack_push(ctx, md_emph_stack(ctx, mark->ch, mark->flags), mark_index);
 }
 
 static void
@@ -3824,7 +3600,7 @@ md_analyze_tilde(MD_CTX* ctx, int mark_index)
     }
 
     if(mark->flags & MD_MARK_POTENTIAL_OPENER)
-        md_mark_stack_push(ctx, stack, mark_index);
+        md_opener_stack_push(ctx, stack, mark_index);
 }
 
 static void
@@ -3847,13 +3623,13 @@ md_analyze_dollar(MD_CTX* ctx, int mark_index)
 
             /* Discard all pending openers: Latex math span do not allow
              * nesting. */
-            DOLLAR_OPENERS.top = -1;
+            md_mark_stack_reset(&DOLLAR_OPENERS);
             return;
         }
     }
 
     if(mark->flags & MD_MARK_POTENTIAL_OPENER)
-        md_mark_stack_push(ctx, &DOLLAR_OPENERS, mark_index);
+        md_opener_stack_push(ctx, &DOLLAR_OPENERS, mark_index);
 }
 
 static MD_MARK*
@@ -4111,19 +3887,35 @@ md_analyze_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table
 {
     int ret;
 
+    int i;
+
     /* Reset the previously collected stack of marks. */
     ctx->n_marks = 0;
+    ctx->inline_window_open = FALSE;
 
     /* Collect all marks. */
     MD_CHECK(md_collect_marks(ctx, lines, n_lines, table_mode));
 
     /* (1) Links. */
     md_analyze_marks(ctx, lines, n_lines, 0, ctx->n_marks, _T("[]!"), 0);
+    if(BRACKET_OPENERS.top >= 0)
+        ctx->inline_window_open = TRUE;
     MD_CHECK(md_resolve_links(ctx, lines, n_lines));
-    BRACKET_OPENERS.top = -1;
+    md_mark_stack_reset(&BRACKET_OPENERS);
     ctx->unresolved_link_head = -1;
     ctx->unresolved_link_tail = -1;
 
+    /* An inline link destination or title may continue on the next line. */
+    for(i = 0; i < ctx->n_marks; i++) {
+        MD_MARK* mark = &ctx->marks[i];
+        if(mark->ch == _T(']')  &&  !(mark->flags & MD_MARK_RESOLVED)  &&
+           mark->end < ctx->size  &&  CH(mark->end) == _T('('))
+        {
+            ctx->inline_window_open = TRUE;
+            break;
+        }
+    }
+
     if(table_mode) {
         /* (2) Analyze table cell boundaries. */
         MD_ASSERT(n_lines == 1);
@@ -4133,18 +3925,21 @@ md_analyze_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table
     }
 
     /* (3) Emphasis and strong emphasis; permissive autolinks. */
-    md_analyze_link_contents(ctx, lines, n_lines, 0, ctx->n_marks);
+    md_analyze_span_marks(ctx, lines, n_lines, 0, ctx->n_marks);
+    for(i = 0; i < (int) SIZEOF_ARRAY(ctx->opener_stacks); i++) {
+        if(ctx->opener_stacks[i].top >= 0)
+            ctx->inline_window_open = TRUE;
+        md_mark_stack_reset(&ctx->opener_stacks[i]);
+    }
 
 abort:
     return ret;
 }
 
 static void
-md_analyze_link_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
-                         int mark_beg, int mark_end)
+md_analyze_span_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
+                      int mark_beg, int mark_end)
 {
-    int i;
-
     md_analyze_marks(ctx, lines, n_lines, mark_beg, mark_end, _T("&"), 0);
     md_analyze_marks(ctx, lines, n_lines, mark_beg, mark_end, _T("*_~$"), 0);
 
@@ -4154,9 +3949,18 @@ md_analyze_link_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
          * not to cross any (previously) resolved marks when doing so. */
         md_analyze_marks(ctx, lines, n_lines, mark_beg, mark_end, _T("@:."), MD_ANALYZE_NOSKIP_EMPH);
     }
+}
+
+static void
+md_analyze_link_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
+                         int mark_beg, int mark_end)
+{
+    int i;
+
+    md_analyze_span_marks(ctx, lines, n_lines, mark_beg, mark_end);
 
     for(i = 0; i < (int) SIZEOF_ARRAY(ctx->opener_stacks); i++)
-        ctx->opener_stacks[i].top = -1;
+        md_mark_stack_reset(&ctx->opener_stacks[i]);
 }
 
 static int
@@ -4257,9 +4061,11 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
 
                 case '`':       /* Code span. */
                     if(mark->flags & MD_MARK_OPENER) {
+                        MD_SOURCE_OFFSET(mark->beg);
                         MD_ENTER_SPAN(MD_SPAN_CODE, NULL);
                         text_type = MD_TEXT_CODE;
                     } else {
+                        MD_SOURCE_OFFSET(mark->end);
                         MD_LEAVE_SPAN(MD_SPAN_CODE, NULL);
                         text_type = MD_TEXT_NORMAL;
                     }
@@ -4269,11 +4075,13 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     if(ctx->parser.flags & MD_FLAG_UNDERLINE) {
                         if(mark->flags & MD_MARK_OPENER) {
                             while(off < mark->end) {
+                                MD_SOURCE_OFFSET(off);
                                 MD_ENTER_SPAN(MD_SPAN_U, NULL);
                                 off++;
                             }
                         } else {
                             while(off < mark->end) {
+                                MD_SOURCE_OFFSET(off+1);
                                 MD_LEAVE_SPAN(MD_SPAN_U, NULL);
                                 off++;
                             }
@@ -4285,19 +4093,23 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                 case '*':       /* Emphasis, strong emphasis. */
                     if(mark->flags & MD_MARK_OPENER) {
                         if((mark->end - off) % 2) {
+                            MD_SOURCE_OFFSET(off);
                             MD_ENTER_SPAN(MD_SPAN_EM, NULL);
                             off++;
                         }
                         while(off + 1 < mark->end) {
+                            MD_SOURCE_OFFSET(off);
                             MD_ENTER_SPAN(MD_SPAN_STRONG, NULL);
                             off += 2;
                         }
                     } else {
                         while(off + 1 < mark->end) {
+                            MD_SOURCE_OFFSET(off+2);
                             MD_LEAVE_SPAN(MD_SPAN_STRONG, NULL);
                             off += 2;
                         }
                         if((mark->end - off) % 2) {
+                            MD_SOURCE_OFFSET(off+1);
                             MD_LEAVE_SPAN(MD_SPAN_EM, NULL);
                             off++;
                         }
@@ -4305,17 +4117,22 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     break;
 
                 case '~':
-                    if(mark->flags & MD_MARK_OPENER)
+                    if(mark->flags & MD_MARK_OPENER) {
+                        MD_SOURCE_OFFSET(mark->beg);
                         MD_ENTER_SPAN(MD_SPAN_DEL, NULL);
-                    else
+                    } else {
+                        MD_SOURCE_OFFSET(mark->end);
                         MD_LEAVE_SPAN(MD_SPAN_DEL, NULL);
+                    }
                     break;
 
                 case '$':
                     if(mark->flags & MD_MARK_OPENER) {
+                        MD_SOURCE_OFFSET(mark->beg);
                         MD_ENTER_SPAN((mark->end - off) % 2 ? MD_SPAN_LATEXMATH : MD_SPAN_LATEXMATH_DISPLAY, NULL);
                         text_type = MD_TEXT_LATEXMATH;
                     } else {
+                        MD_SOURCE_OFFSET(mark->end);
                         MD_LEAVE_SPAN((mark->end - off) % 2 ? MD_SPAN_LATEXMATH : MD_SPAN_LATEXMATH_DISPLAY, NULL);
                         text_type = MD_TEXT_NORMAL;
                     }
@@ -4342,6 +4159,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                         else
                             target_sz = closer->beg - opener->end;
 
+                        MD_SOURCE_OFFSET(mark->ch != ']' ? opener->beg : closer->end);
                         MD_CHECK(md_enter_leave_span_wikilink(ctx, (mark->ch != ']'),
                                  has_label ? STR(opener->beg+2) : STR(opener->end),
                                  target_sz));
@@ -4354,6 +4172,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     title_mark = opener+2;
                     MD_ASSERT(title_mark->ch == 'D');
 
+                    MD_SOURCE_OFFSET(mark->ch != ']' ? opener->beg : closer->end);
                     MD_CHECK(md_enter_leave_span_a(ctx, (mark->ch != ']'),
                                 (opener->ch == '!' ? MD_SPAN_IMG : MD_SPAN_A),
                                 STR(dest_mark->beg), dest_mark->end - dest_mark->beg, FALSE,
@@ -4412,9 +4231,11 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                         dest = ctx->buffer;
                     }
 
-                    if(closer->flags & MD_MARK_VALIDPERMISSIVEAUTOLINK)
+                    if(closer->flags & MD_MARK_VALIDPERMISSIVEAUTOLINK) {
+                        MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? opener->beg : closer->end);
                         MD_CHECK(md_enter_leave_span_a(ctx, (mark->flags & MD_MARK_OPENER),
                                     MD_SPAN_A, dest, dest_size, TRUE, NULL, 0));
+                    }
                     break;
                 }
 
@@ -4547,8 +4368,13 @@ md_process_table_cell(MD_CTX* ctx, MD_BLOCKTYPE cell_type, MD_ALIGN align, OFF b
     line.beg = beg;
     line.end = end;
 
+    /* Cells made up for a short row come with beg == end == 0. */
+    if(end > 0)
+        MD_SOURCE_OFFSET(beg);
     MD_ENTER_BLOCK(cell_type, &det);
     MD_CHECK(md_process_normal_block_contents(ctx, &line, 1));
+    if(end > 0)
+        MD_SOURCE_OFFSET(end);
     MD_LEAVE_BLOCK(cell_type, &det);
 
 abort:
@@ -4574,7 +4400,7 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
     /* We have to remember the cell boundaries in local buffer because
      * ctx->marks[] shall be reused during cell contents processing. */
     n = ctx->n_table_cell_boundaries + 2;
-    pipe_offs = (OFF*) malloc(n * sizeof(OFF));
+    pipe_offs = (OFF*) md_malloc(ctx, n * sizeof(OFF));
     if(pipe_offs == NULL) {
         MD_LOG("malloc() failed.");
         ret = -1;
@@ -4589,6 +4415,7 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
     pipe_offs[j++] = end+1;
 
     /* Process cells. */
+    MD_SOURCE_OFFSET(beg);
     MD_ENTER_BLOCK(MD_BLOCK_TR, NULL);
     k = 0;
     for(i = 0; i < j-1  &&  k < col_count; i++) {
@@ -4599,10 +4426,11 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
      * too few of them. */
     while(k < col_count)
         MD_CHECK(md_process_table_cell(ctx, cell_type, align[k++], 0, 0));
+    MD_SOURCE_OFFSET(end);
     MD_LEAVE_BLOCK(MD_BLOCK_TR, NULL);
 
 abort:
-    free(pipe_offs);
+    md_free(ctx, pipe_offs);
 
     ctx->table_cell_boundaries_head = -1;
     ctx->table_cell_boundaries_tail = -1;
@@ -4621,7 +4449,7 @@ md_process_table_block_contents(MD_CTX* ctx, int col_count, const MD_LINE* lines
      * with the underlines. */
     MD_ASSERT(n_lines >= 2);
 
-    align = malloc(col_count * sizeof(MD_ALIGN));
+    align = md_malloc(ctx, col_count * sizeof(MD_ALIGN));
     if(align == NULL) {
         MD_LOG("malloc() failed.");
         ret = -1;
@@ -4645,7 +4473,7 @@ md_process_table_block_contents(MD_CTX* ctx, int col_count, const MD_LINE* lines
     }
 
 abort:
-    free(align);
+    md_free(ctx, align);
     return ret;
 }
 
@@ -4690,52 +4518,153 @@ struct MD_CONTAINER_tag {
 };
 
 
-static int
-md_process_normal_block_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
+static void
+md_free_ptr_stack(MD_CTX* ctx)
 {
     int i;
-    int ret;
-
-    MD_CHECK(md_analyze_inlines(ctx, lines, n_lines, FALSE));
-    MD_CHECK(md_process_inlines(ctx, lines, n_lines));
 
-abort:
     /* Free any temporary memory blocks stored within some dummy marks. */
     for(i = ctx->ptr_stack.top; i >= 0; i = ctx->marks[i].next)
-        free(md_mark_get_ptr(ctx, i));
-    ctx->ptr_stack.top = -1;
+        md_free(ctx, md_mark_get_ptr(ctx, i));
+    md_mark_stack_reset(&ctx->ptr_stack);
+}
+
+/* Returns index of the line after the last line of an inline window starting
+ * at lines[beg], which spans at least window_size bytes (if the block is that
+ * long). The window never ends with a line ending with a backslash, which
+ * could be a hard break. */
+static MD_SIZE
+md_inline_window_end(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, MD_SIZE beg, SZ window_size)
+{
+    MD_SIZE end = beg + 1;
+
+    while(end < n_lines  &&  lines[end-1].end - lines[beg].beg < window_size)
+        end++;
+    while(end < n_lines  &&  lines[end-1].end > lines[end-1].beg  &&  CH(lines[end-1].end-1) == _T('\\'))
+        end++;
+
+    return end;
+}
+
+static int
+md_process_normal_block_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
+{
+    MD_SIZE beg = 0;
+    MD_SIZE end;
+    SZ window_size;
+    int ret = 0;
+
+    /* Usually, the whole block is a single window. Huge blocks are split
+     * into windows on line boundaries no inline construct crosses, so the
+     * outcome is the same as if we processed the block at once. */
+    while(beg < n_lines) {
+        window_size = INLINE_WINDOW_SIZE;
+        while(TRUE) {
+            end = md_inline_window_end(ctx, lines, n_lines, beg, window_size);
+            MD_CHECK(md_analyze_inlines(ctx, lines + beg, end - beg, FALSE));
+            if(end >= n_lines  ||  !ctx->inline_window_open)
+                break;
+
+            /* Retry with a window twice as big. Doubling keeps the total
+             * work linear even if we eventually need the whole block. */
+            md_free_ptr_stack(ctx);
+            window_size *= 2;
+        }
+
+        MD_CHECK(md_process_inlines(ctx, lines + beg, end - beg));
 
+        if(end < n_lines) {
+            /* Output the line break md_process_inlines() would output if
+             * the lines were in the same window. */
+            const MD_LINE* line = &lines[end-1];
+            MD_TEXTTYPE break_type = MD_TEXT_SOFTBR;
+
+            if(ctx->parser.flags & MD_FLAG_HARD_SOFT_BREAKS)
+                break_type = MD_TEXT_BR;
+            else if(CH(line->end) == _T(' ')  &&  CH(line->end+1) == _T(' '))
+                break_type = MD_TEXT_BR;
+            MD_TEXT(break_type, _T("\n"), 1);
+        }
+
+        md_free_ptr_stack(ctx);
+        beg = end;
+    }
+
+abort:
+    md_free_ptr_stack(ctx);
     return ret;
 }
 
+/* Checks the source between beg and end consists of spaces only. */
+static int
+md_is_spaces_only(MD_CTX* ctx, OFF beg, OFF end)
+{
+    while(beg < end) {
+        if(CH(beg) != _T(' '))
+            return FALSE;
+        beg++;
+    }
+    return TRUE;
+}
+
 static int
 md_process_verbatim_block_contents(MD_CTX* ctx, MD_TEXTTYPE text_type, const MD_VERBATIMLINE* lines, MD_SIZE n_lines)
 {
     static const CHAR indent_chunk_str[] = _T("                ");
     static const SZ indent_chunk_size = SIZEOF_ARRAY(indent_chunk_str) - 1;
 
-    MD_SIZE line_index;
+    MD_SIZE line_index = 0;
     int ret = 0;
 
-    for(line_index = 0; line_index < n_lines; line_index++) {
+    /* Usually, the output is just the source text of the lines, so we output
+     * it in runs spanning as many lines as possible, instead of outputting
+     * each line, its indentation and end-of-line separately. */
+    while(line_index < n_lines) {
         const MD_VERBATIMLINE* line = &lines[line_index];
         int indent = line->indent;
+        OFF run_beg = line->beg;
+        OFF run_end;
 
         MD_ASSERT(indent >= 0);
 
-        /* Output code indentation. */
-        while(indent > (int) indent_chunk_size) {
-            MD_TEXT(text_type, indent_chunk_str, indent_chunk_size);
-            indent -= indent_chunk_size;
+        if(indent > 0  &&  (OFF) indent <= line->beg  &&  md_is_spaces_only(ctx, line->beg - indent, line->beg)) {
+            /* The indentation is there in the source as it is. */
+            run_beg = line->beg - indent;
+        } else {
+            /* Output code indentation. */
+            while(indent > (int) indent_chunk_size) {
+                MD_TEXT(text_type, indent_chunk_str, indent_chunk_size);
+                indent -= indent_chunk_size;
+            }
+            if(indent > 0)
+                MD_TEXT(text_type, indent_chunk_str, indent);
         }
-        if(indent > 0)
-            MD_TEXT(text_type, indent_chunk_str, indent);
 
-        /* Output the code line itself. */
-        MD_TEXT_INSECURE(text_type, STR(line->beg), line->end - line->beg);
+        /* Extend the run over the following lines as long as the source
+         * between them is exactly the new line and indentation we would
+         * output anyway (i.e. no container marks, tabs or CRLF). */
+        run_end = line->end;
+        line_index++;
+        while(line_index < n_lines  &&  run_end < ctx->size  &&  CH(run_end) == _T('\n')) {
+            const MD_VERBATIMLINE* next = &lines[line_index];
+
+            if(next->beg - (run_end + 1) != next->indent  ||  !md_is_spaces_only(ctx, run_end + 1, next->beg))
+                break;
 
-        /* Enforce end-of-line. */
-        MD_TEXT(text_type, _T("\n"), 1);
+            run_end = next->end;
+            line_index++;
+        }
+
+        /* Output the code lines themselves, with the end-of-line of the last
+         * one if it is there in the source. */
+        if(run_end < ctx->size  &&  CH(run_end) == _T('\n')) {
+            MD_TEXT_INSECURE(text_type, STR(run_beg), run_end + 1 - run_beg);
+        } else {
+            MD_TEXT_INSECURE(text_type, STR(run_beg), run_end - run_beg);
+
+            /* Enforce end-of-line. */
+            MD_TEXT(text_type, _T("\n"), 1);
+        }
     }
 
 abort:
@@ -4804,6 +4733,21 @@ abort:
     return ret;
 }
 
+/* Offsets where the contents of a (non-empty) leaf block begin and end. */
+static void
+md_leaf_block_range(const MD_BLOCK* block, OFF* p_beg, OFF* p_end)
+{
+    if(block->type == MD_BLOCK_CODE  ||  block->type == MD_BLOCK_HTML) {
+        const MD_VERBATIMLINE* lines = (const MD_VERBATIMLINE*)(block + 1);
+        *p_beg = lines[0].beg;
+        *p_end = lines[block->n_lines-1].end;
+    } else {
+        const MD_LINE* lines = (const MD_LINE*)(block + 1);
+        *p_beg = lines[0].beg;
+        *p_end = lines[block->n_lines-1].end;
+    }
+}
+
 static int
 md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
 {
@@ -4812,14 +4756,19 @@ md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
         MD_BLOCK_CODE_DETAIL code;
         MD_BLOCK_TABLE_DETAIL table;
     } det;
-    MD_ATTRIBUTE_BUILD info_build;
-    MD_ATTRIBUTE_BUILD lang_build;
+    MD_ATTRIBUTE_BUILD info_build = { 0 };
+    MD_ATTRIBUTE_BUILD lang_build = { 0 };
     int is_in_tight_list;
     int clean_fence_code_detail = FALSE;
+    OFF block_beg = 0;
+    OFF block_end = 0;
     int ret = 0;
 
     memset(&det, 0, sizeof(det));
 
+    if(block->n_lines > 0)
+        md_leaf_block_range(block, &block_beg, &block_end);
+
     if(ctx->n_containers == 0)
         is_in_tight_list = FALSE;
     else
@@ -4850,10 +4799,18 @@ md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
             break;
     }
 
-    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P)
+    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P) {
+        if(block->n_lines > 0)
+            MD_SOURCE_OFFSET(block_beg);
         MD_ENTER_BLOCK(block->type, (void*) &det);
+    }
+
+    /* Process the block contents accordingly to is type, unless the caller
+     * asked to skip them. */
+    if(ctx->parser.skip_contents != NULL  &&
+       ctx->parser.skip_contents(block->type, block_beg, block_end, ctx->userdata))
+        goto leave;
 
-    /* Process the block contents accordingly to is type. */
     switch(block->type) {
         case MD_BLOCK_HR:
             /* noop */
@@ -4880,8 +4837,12 @@ md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
             break;
     }
 
-    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P)
+leave:
+    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P) {
+        if(block->n_lines > 0)
+            MD_SOURCE_OFFSET(block_end);
         MD_LEAVE_BLOCK(block->type, (void*) &det);
+    }
 
 abort:
     if(clean_fence_code_detail) {
@@ -4891,19 +4852,16 @@ abort:
     return ret;
 }
 
+/* Processes the blocks from '*p_byte_off' on, until all are processed or
+ * '*p_budget' runs out: a leaf block costs one plus the size of its lines in
+ * the input. A negative budget is unlimited. */
 static int
-md_process_all_blocks(MD_CTX* ctx)
+md_process_blocks(MD_CTX* ctx, int* p_byte_off, int* p_budget)
 {
-    int byte_off = 0;
+    int byte_off = *p_byte_off;
     int ret = 0;
 
-    /* ctx->containers now is not needed for detection of lists and list items
-     * so we reuse it for tracking what lists are loose or tight. We rely
-     * on the fact the vector is large enough to hold the deepest nesting
-     * level of lists. */
-    ctx->n_containers = 0;
-
-    while(byte_off < ctx->n_block_bytes) {
+    while(byte_off < ctx->n_block_bytes  &&  *p_budget != 0) {
         MD_BLOCK* block = (MD_BLOCK*)((char*)ctx->block_bytes + byte_off);
         union {
             MD_BLOCK_UL_DETAIL ul;
@@ -4957,20 +4915,31 @@ md_process_all_blocks(MD_CTX* ctx)
                 }
             }
         } else {
+            SZ cost = 1;
+
             MD_CHECK(md_process_leaf_block(ctx, block));
 
-            if(block->type == MD_BLOCK_CODE || block->type == MD_BLOCK_HTML)
+            if(block->type == MD_BLOCK_CODE || block->type == MD_BLOCK_HTML) {
+                const MD_VERBATIMLINE* lines = (const MD_VERBATIMLINE*) (block + 1);
+                if(block->n_lines > 0)
+                    cost += lines[block->n_lines - 1].end - lines[0].beg;
                 byte_off += block->n_lines * sizeof(MD_VERBATIMLINE);
-            else
+            } else {
+                const MD_LINE* lines = (const MD_LINE*) (block + 1);
+                if(block->n_lines > 0)
+                    cost += lines[block->n_lines - 1].end - lines[0].beg;
                 byte_off += block->n_lines * sizeof(MD_LINE);
+            }
+
+            if(*p_budget > 0)
+                *p_budget -= (int) MIN((SZ) *p_budget, cost);
         }
 
         byte_off += sizeof(MD_BLOCK);
     }
 
-    ctx->n_block_bytes = 0;
-
 abort:
+    *p_byte_off = byte_off;
     return ret;
 }
 
@@ -4986,11 +4955,11 @@ md_push_block_bytes(MD_CTX* ctx, int n_bytes)
 
     if(ctx->n_block_bytes + n_bytes > ctx->alloc_block_bytes) {
         void* new_block_bytes;
-
-        ctx->alloc_block_bytes = (ctx->alloc_block_bytes > 0
+        int new_alloc = (ctx->alloc_block_bytes > 0
                 ? ctx->alloc_block_bytes + ctx->alloc_block_bytes / 2
                 : 512);
-        new_block_bytes = realloc(ctx->block_bytes, ctx->alloc_block_bytes);
+
+        new_block_bytes = md_realloc(ctx, ctx->block_bytes, new_alloc);
         if(new_block_bytes == NULL) {
             MD_LOG("realloc() failed.");
             return NULL;
@@ -5003,6 +4972,7 @@ md_push_block_bytes(MD_CTX* ctx, int n_bytes)
         }
 
         ctx->block_bytes = new_block_bytes;
+        ctx->alloc_block_bytes = new_alloc;
     }
 
     ptr = (char*)ctx->block_bytes + ctx->n_block_bytes;
@@ -5634,17 +5604,18 @@ md_push_container(MD_CTX* ctx, const MD_CONTAINER* container)
 {
     if(ctx->n_containers >= ctx->alloc_containers) {
         MD_CONTAINER* new_containers;
-
-        ctx->alloc_containers = (ctx->alloc_containers > 0
+        int new_alloc = (ctx->alloc_containers > 0
                 ? ctx->alloc_containers + ctx->alloc_containers / 2
                 : 16);
-        new_containers = realloc(ctx->containers, ctx->alloc_containers * sizeof(MD_CONTAINER));
+
+        new_containers = md_realloc(ctx, ctx->containers, new_alloc * sizeof(MD_CONTAINER));
         if(new_containers == NULL) {
             MD_LOG("realloc() failed.");
             return -1;
         }
 
         ctx->containers = new_containers;
+        ctx->alloc_containers = new_alloc;
     }
 
     memcpy(&ctx->containers[ctx->n_containers++], container, sizeof(MD_CONTAINER));
@@ -6074,6 +6045,7 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
 
         /* Check for start of a new container block. */
         if(line->indent < ctx->code_indent_offset  &&
+           n_parents + n_brothers + n_children < CONTAINER_MAXDEPTH  &&
            md_is_container_mark(ctx, line->indent, off, &off, &container))
         {
             if(pivot_line->type == MD_LINE_TEXT  &&  n_parents == ctx->n_containers  &&
@@ -6386,36 +6358,105 @@ abort:
     return ret;
 }
 
+/* Progress of md_process_doc(), so that it can be done in steps
+ * (md_parse_step()). The pivot line may point into 'line_buf', so the
+ * structure must not move once in use. */
+typedef struct MD_DOC_PROGRESS_tag MD_DOC_PROGRESS;
+struct MD_DOC_PROGRESS_tag {
+    enum { MD_PHASE_START, MD_PHASE_LINES, MD_PHASE_BLOCKS, MD_PHASE_DONE } phase;
+    OFF off;                                /* Next line to analyze. */
+    const MD_LINE_ANALYSIS* pivot_line;
+    MD_LINE_ANALYSIS line_buf[2];
+    MD_LINE_ANALYSIS* line;
+    int byte_off;                           /* Next block to process. */
+};
+
+static void
+md_init_doc_progress(MD_DOC_PROGRESS* progress)
+{
+    progress->phase = MD_PHASE_START;
+    progress->off = 0;
+    progress->pivot_line = &md_dummy_blank_line;
+    progress->line = &progress->line_buf[0];
+    progress->byte_off = 0;
+}
+
+/* Advances the processing of the document by about 'budget' bytes of the
+ * input: the lines analyzed, see md_process_blocks() for the blocks. A
+ * negative budget is unlimited. '*p_done' is set once the document is left. */
 static int
-md_process_doc(MD_CTX *ctx)
+md_process_doc_step(MD_CTX* ctx, MD_DOC_PROGRESS* progress, int budget, int* p_done)
 {
-    const MD_LINE_ANALYSIS* pivot_line = &md_dummy_blank_line;
-    MD_LINE_ANALYSIS line_buf[2];
-    MD_LINE_ANALYSIS* line = &line_buf[0];
-    OFF off = 0;
+    OFF line_beg;
     int ret = 0;
 
-    MD_ENTER_BLOCK(MD_BLOCK_DOC, NULL);
+    *p_done = FALSE;
 
-    while(off < ctx->size) {
-        if(line == pivot_line)
-            line = (line == &line_buf[0] ? &line_buf[1] : &line_buf[0]);
-
-        MD_CHECK(md_analyze_line(ctx, off, &off, pivot_line, line));
-        MD_CHECK(md_process_line(ctx, &pivot_line, line));
+    if(progress->phase == MD_PHASE_START) {
+        MD_SOURCE_OFFSET(0);
+        MD_ENTER_BLOCK(MD_BLOCK_DOC, NULL);
+        progress->phase = MD_PHASE_LINES;
     }
 
-    md_end_current_block(ctx);
+    if(progress->phase == MD_PHASE_LINES) {
+        while(progress->off < ctx->size) {
+            if(budget == 0)
+                goto abort;
 
-    MD_CHECK(md_build_ref_def_hashtable(ctx));
+            if(progress->line == progress->pivot_line) {
+                progress->line = (progress->line == &progress->line_buf[0]
+                        ? &progress->line_buf[1] : &progress->line_buf[0]);
+            }
 
-    /* Process all blocks. */
-    MD_CHECK(md_leave_child_containers(ctx, 0));
-    MD_CHECK(md_process_all_blocks(ctx));
+            line_beg = progress->off;
+            MD_CHECK(md_analyze_line(ctx, progress->off, &progress->off, progress->pivot_line, progress->line));
+            MD_CHECK(md_process_line(ctx, &progress->pivot_line, progress->line));
 
-    MD_LEAVE_BLOCK(MD_BLOCK_DOC, NULL);
+            if(budget > 0)
+                budget -= (int) MIN((SZ) budget, progress->off - line_beg);
+        }
+
+        md_end_current_block(ctx);
+
+        MD_CHECK(md_build_ref_def_hashtable(ctx));
+
+        /* Process all blocks. */
+        MD_CHECK(md_leave_child_containers(ctx, 0));
+
+        /* ctx->containers now is not needed for detection of lists and list
+         * items so we reuse it for tracking what lists are loose or tight. We
+         * rely on the fact the vector is large enough to hold the deepest
+         * nesting level of lists. */
+        ctx->n_containers = 0;
+        progress->phase = MD_PHASE_BLOCKS;
+    }
+
+    if(progress->phase == MD_PHASE_BLOCKS) {
+        MD_CHECK(md_process_blocks(ctx, &progress->byte_off, &budget));
+        if(progress->byte_off < ctx->n_block_bytes)
+            goto abort;
+        ctx->n_block_bytes = 0;
+
+        MD_SOURCE_OFFSET(ctx->size);
+        MD_LEAVE_BLOCK(MD_BLOCK_DOC, NULL);
+        progress->phase = MD_PHASE_DONE;
+    }
+
+    *p_done = TRUE;
 
 abort:
+    return ret;
+}
+
+static int
+md_process_doc(MD_CTX *ctx)
+{
+    MD_DOC_PROGRESS progress;
+    int done;
+    int ret;
+
+    md_init_doc_progress(&progress);
+    ret = md_process_doc_step(ctx, &progress, -1, &done);
 
 #if 0
     /* Output some memory consumption statistics. */
@@ -6447,12 +6488,10 @@ abort:
  ***  Public API  ***
  ********************/
 
-int
-md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata)
+static int
+md_setup_ctx(MD_CTX* ctx, const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata)
 {
-    MD_CTX ctx;
     int i;
-    int ret;
 
     if(parser->abi_version != 0) {
         if(parser->debug_log != NULL)
@@ -6461,34 +6500,113 @@ md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userd
     }
 
     /* Setup context structure. */
-    memset(&ctx, 0, sizeof(MD_CTX));
-    ctx.text = text;
-    ctx.size = size;
-    memcpy(&ctx.parser, parser, sizeof(MD_PARSER));
-    ctx.userdata = userdata;
-    ctx.code_indent_offset = (ctx.parser.flags & MD_FLAG_NOINDENTEDCODEBLOCKS) ? (OFF)(-1) : 4;
-    md_build_mark_char_map(&ctx);
-    ctx.doc_ends_with_newline = (size > 0  &&  ISNEWLINE_(text[size-1]));
+    memset(ctx, 0, sizeof(MD_CTX));
+    ctx->text = text;
+    ctx->size = size;
+    memcpy(&ctx->parser, parser, sizeof(MD_PARSER));
+    ctx->userdata = userdata;
+    ctx->code_indent_offset = (ctx->parser.flags & MD_FLAG_NOINDENTEDCODEBLOCKS) ? (OFF)(-1) : 4;
+    md_build_mark_char_map(ctx);
+    ctx->doc_ends_with_newline = (size > 0  &&  ISNEWLINE_(text[size-1]));
+    if(size < (SZ)(-1) / REF_EXPANSION_FACTOR)
+        ctx->max_ref_expansion_size = MAX(REF_EXPANSION_MINLIMIT, REF_EXPANSION_FACTOR * size);
+    else
+        ctx->max_ref_expansion_size = (SZ)(-1);
 
     /* Reset all mark stacks and lists. */
-    for(i = 0; i < (int) SIZEOF_ARRAY(ctx.opener_stacks); i++)
-        ctx.opener_stacks[i].top = -1;
-    ctx.ptr_stack.top = -1;
-    ctx.unresolved_link_head = -1;
-    ctx.unresolved_link_tail = -1;
-    ctx.table_cell_boundaries_head = -1;
-    ctx.table_cell_boundaries_tail = -1;
+    for(i = 0; i < (int) SIZEOF_ARRAY(ctx->opener_stacks); i++)
+        md_mark_stack_reset(&ctx->opener_stacks[i]);
+    md_mark_stack_reset(&ctx->ptr_stack);
+    ctx->unresolved_link_head = -1;
+    ctx->unresolved_link_tail = -1;
+    ctx->table_cell_boundaries_head = -1;
+    ctx->table_cell_boundaries_tail = -1;
+
+    return 0;
+}
+
+static void
+md_cleanup_ctx(MD_CTX* ctx)
+{
+    md_free_ref_defs(ctx);
+    md_free_ref_def_hashtable(ctx);
+    md_free(ctx, ctx->buffer);
+    md_free(ctx, ctx->marks);
+    md_free(ctx, ctx->block_bytes);
+    md_free(ctx, ctx->containers);
+}
+
+int
+md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata)
+{
+    MD_CTX ctx;
+    int ret;
+
+    if(md_setup_ctx(&ctx, text, size, parser, userdata) != 0)
+        return -1;
 
     /* All the work. */
     ret = md_process_doc(&ctx);
 
     /* Clean-up. */
-    md_free_ref_defs(&ctx);
-    md_free_ref_def_hashtable(&ctx);
-    free(ctx.buffer);
-    free(ctx.marks);
-    free(ctx.block_bytes);
-    free(ctx.containers);
+    md_cleanup_ctx(&ctx);
 
     return ret;
 }
+
+struct MD_PARSE_STATE_tag {
+    MD_CTX ctx;
+    MD_DOC_PROGRESS progress;
+};
+
+MD_PARSE_STATE*
+md_parse_begin(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata)
+{
+    MD_PARSE_STATE* state;
+
+    if(parser->mem_realloc != NULL)
+        state = (MD_PARSE_STATE*) parser->mem_realloc(NULL, sizeof(MD_PARSE_STATE), userdata);
+    else
+        state = (MD_PARSE_STATE*) malloc(sizeof(MD_PARSE_STATE));
+    if(state == NULL)
+        return NULL;
+
+    if(md_setup_ctx(&state->ctx, text, size, parser, userdata) != 0) {
+        if(parser->mem_free != NULL)
+            parser->mem_free(state, userdata);
+        else
+            free(state);
+        return NULL;
+    }
+
+    md_init_doc_progress(&state->progress);
+    return state;
+}
+
+int
+md_parse_step(MD_PARSE_STATE* state, int budget, int* p_done)
+{
+    return md_process_doc_step(&state->ctx, &state->progress, budget, p_done);
+}
+
+void
+md_parse_end(MD_PARSE_STATE* state)
+{
+    md_cleanup_ctx(&state->ctx);
+    if(state->ctx.parser.mem_free != NULL)
+        state->ctx.parser.mem_free(state, state->ctx.userdata);
+    else
+        free(state);
+}
+
+unsigned
+md_fold_codepoint(unsigned codepoint, unsigned folded[3])
+{
+    MD_UNICODE_FOLD_INFO info;
+    unsigned i;
+
+    md_get_unicode_fold_info(codepoint, &info);
+    for(i = 0; i < info.n_codepoints; i++)
+        folded[i] = info.codepoints[i];
+    return info.n_codepoints;
+}
@@ -26,6 +26,8 @@
 #ifndef MD4C_H
 #define MD4C_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -380,6 +382,53 @@ typedef struct MD_PARSER {
     /* Reserved. Set to NULL.
      */
     void (*syntax)(void);
+
+    /* Memory allocator. Optional (may be NULL, then realloc() and free() are
+     * used).
+     *
+     * If provided, md4c allocates all its working memory through these, so
+     * the application can account for it or put a cap on it. mem_realloc()
+     * follows the contract of realloc(); returning NULL is handled as an
+     * allocation failure and aborts the parsing. mem_free() is never called
+     * with NULL.
+     */
+    void* (*mem_realloc)(void* /*ptr*/, size_t /*size*/, void* /*userdata*/);
+    void (*mem_free)(void* /*ptr*/, void* /*userdata*/);
+
+    /* Source offsets. Optional (may be NULL).
+     *
+     * If provided, it is called right before enter_block() and enter_span()
+     * with the offset in the input where the block or span begins, and right
+     * before leave_block() and leave_span() with the offset where it ends
+     * (exclusive). Spans cover their delimiters, e.g. both '*' of an
+     * emphasis or the whole "[text](url)" of a link. Leaf blocks span from
+     * the first to the last line of their contents (line prefixes, ATX
+     * heading marks and a closing code fence are not part of it), the
+     * document spans the whole input.
+     *
+     * It is not called for container blocks (block quotes, lists, list
+     * items, table head and body) nor for table cells made up to fill a
+     * short row: their extent is not known when they are entered.
+     */
+    void (*source_offset)(MD_OFFSET /*offset*/, void* /*userdata*/);
+
+    /* Skipping of leaf block contents. Optional (may be NULL).
+     *
+     * If provided, it is called for every leaf block right after its
+     * enter_block() (or where that would be, for paragraphs of tight list
+     * items, which are not entered), with the type of the block and the
+     * range of its lines: from the beginning of the first to the end of the
+     * last, or 0 and 0 for a block without lines. The lines of a fenced code
+     * block start with the opening fence but do not include the closing
+     * one, those of a Setext heading do not include the underline, those of
+     * an indented code block may end with blank lines. If it returns
+     * non-zero, the contents of the block are not processed: no inline
+     * analysis happens and no span, text or table row callbacks are made
+     * for it, but the block is still entered and left, with its source
+     * offsets. This lets a caller that only needs the block structure, or
+     * only some of the blocks, skip the inline phase for the rest.
+     */
+    int (*skip_contents)(MD_BLOCKTYPE /*type*/, MD_OFFSET /*beg*/, MD_OFFSET /*end*/, void* /*userdata*/);
 } MD_PARSER;
 
 
@@ -400,6 +449,41 @@ typedef MD_PARSER MD_RENDERER;
 int md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata);
 
 
+/* The same parse as md_parse(), done in steps, so that a caller which must
+ * not block for the whole document (e.g. a UI thread) can interleave it with
+ * other work. The callbacks are the same and are called in the same order.
+ *
+ * md_parse_begin() sets the parse up; 'text' has to stay valid until
+ * md_parse_end(), 'parser' is copied. NULL is returned for an unsupported
+ * abi_version or if a memory allocation fails.
+ *
+ * md_parse_step() advances the parse by about 'budget' bytes of the input,
+ * first by analyzing its lines, then by processing leaf blocks (i.e. by
+ * calling most of the callbacks); a line or a leaf block is not split, so a
+ * step may go over the budget by one. Note the whole block analysis comes
+ * before the first block is entered, as link reference definitions may come
+ * after their use. A negative budget means
+ * no limit. '*p_done' is set when the document has been left. The return
+ * value is as for md_parse(); after a non-zero one, only md_parse_end() may
+ * be called.
+ *
+ * md_parse_end() releases the parse, done or not.
+ */
+typedef struct MD_PARSE_STATE_tag MD_PARSE_STATE;
+
+MD_PARSE_STATE* md_parse_begin(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userdata);
+int md_parse_step(MD_PARSE_STATE* state, int budget, int* p_done);
+void md_parse_end(MD_PARSE_STATE* state);
+
+
+/* Unicode case folding, the same md4c does to match link reference labels:
+ * writes the 1 to 3 codepoints 'codepoint' folds into to 'folded' and
+ * returns how many. Without MD4C_USE_UTF8 or MD4C_USE_UTF16, only ASCII
+ * letters fold.
+ */
+unsigned md_fold_codepoint(unsigned codepoint, unsigned folded[3]);
+
+
 #ifdef __cplusplus
     }  /* extern "C" { */
 #endif
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * Shared code of the fuzz targets
+ *
+ * The first byte of every fuzz input selects the parser options, one bit
+ * per option, so the fuzzer explores all option combinations; the rest is
+ * the Markdown. Each input runs with a time and a memory budget that grow
+ * linearly with its size: an input that goes over a budget is reported
+ * like a crash, so libFuzzer keeps it as an artifact to minimize.
+ *
+ * A share of the inputs, picked by a hash of the Markdown, parse a second
+ * time with a maxMemory limit below the peak of their first parse, so that
+ * md4c or the tree build runs out of memory part-way and has to unwind.
+ */
+
+#include "MarkdownParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace hypermarkdown_fuzz {
+
+using margelo::nitro::hypermarkdown::InternalParserOptions;
+using margelo::nitro::hypermarkdown::MarkdownParser;
+
+// Per-input budgets. They are generous enough for sanitizer and coverage
+// instrumentation; only super-linear time or memory gets near them on the
+// input sizes libFuzzer generates.
+constexpr double kTimeBudgetBaseMs = 50;
+constexpr double kTimeBudgetNsPerByte = 2000;
+constexpr size_t kMemoryBudgetBaseBytes = 1024 * 1024;
+constexpr size_t kMemoryBudgetBytesPerByte = 1024;
+
+// One input in this many parses again under a memory limit
+constexpr uint32_t kMemoryLimitedShare = 4;
+
+struct FuzzInput {
+    InternalParserOptions options;
+    std::string content;
+    uint32_t hash = 0;  // FNV-1a of the content, picks the memory limit
+};
+
+inline FuzzInput decode(const uint8_t* data, size_t size) {
+    FuzzInput input;
+    uint8_t bits = size > 0 ? data[0] : 0;
+    input.options.gfm = bits & 0x01;
+    input.options.enableTables = bits & 0x02;
+    input.options.enableTaskLists = bits & 0x04;
+    input.options.enableStrikethrough = bits & 0x08;
+    input.options.enableAutolink = bits & 0x10;
+    input.options.math = bits & 0x20;
+    input.options.wiki = bits & 0x40;
+    input.options.collectTimings = bits & 0x80;
+    input.options.collectMemory = true;
+    if (size > 0) {
+        input.content.assign(reinterpret_cast<const char*>(data) + 1, size - 1);
+    }
+    input.hash = 2166136261u;
+    for (char c : input.content) {
+        input.hash = (input.hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return input;
+}
+
+inline double timeBudgetMs(const FuzzInput& input) {
+    return kTimeBudgetBaseMs + input.content.size() * kTimeBudgetNsPerByte / 1e6;
+}
+
+inline size_t memoryBudgetBytes(const FuzzInput& input) {
+    return kMemoryBudgetBaseBytes + input.content.size() * kMemoryBudgetBytesPerByte;
+}
+
+// Runs `fn` and returns its duration. Slow runs are repeated once, and the
+// faster of the two counts, so a preempted process is not taken for a
+// performance cliff.
+template <typename Fn>
+double timedMs(const FuzzInput& input, Fn&& fn) {
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double ms = Ms(std::chrono::steady_clock::now() - start).count();
+    if (ms > timeBudgetMs(input)) {
+        start = std::chrono::steady_clock::now();
+        fn();
+        ms = std::min(ms, Ms(std::chrono::steady_clock::now() - start).count());
+    }
+    return ms;
+}
+
+[[noreturn]] inline void reportFinding(const char* what, double value, double budget, const FuzzInput& input) {
+    std::fprintf(stderr, "==hypermarkdown-fuzz== %s: %.1f over a budget of %.1f for %zu bytes of input\n", what,
+                 value, budget, input.content.size());
+    std::abort();
+}
+
+inline void checkBudgets(const FuzzInput& input, double ms, size_t peakBytes) {
+    if (ms > timeBudgetMs(input)) {
+        reportFinding("slow input (ms)", ms, timeBudgetMs(input), input);
+    }
+    if (peakBytes > memoryBudgetBytes(input)) {
+        reportFinding("memory-hungry input (bytes)", static_cast<double>(peakBytes),
+                      static_cast<double>(memoryBudgetBytes(input)), input);
+    }
+}
+
+// Parses the input of the share picked by its hash again, with a maxMemory
+// limit somewhere below `peakBytes` (the peak of its unlimited parse with
+// the same options): the parse has to fail on the limit, and cleanly
+inline void checkMemoryLimit(const FuzzInput& input, size_t peakBytes) {
+    if (peakBytes == 0 || input.hash % kMemoryLimitedShare != 0) {
+        return;
+    }
+    InternalParserOptions options = input.options;
+    options.maxMemory = 1 + input.hash / kMemoryLimitedShare % peakBytes;
+    auto limited = MarkdownParser::parse(input.content, options);
+    if (limited.success || !limited.error || limited.error->message != "Parse exceeds maximum memory limit") {
+        std::abort();
+    }
+}
+
+} // namespace hypermarkdown_fuzz
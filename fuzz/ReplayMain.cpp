@@ -0,0 +1,51 @@
+/**
+ * Replay driver for the fuzz targets
+ *
+ * Runs LLVMFuzzerTestOneInput on every file given on the command line, or
+ * found in a directory given on the command line, without libFuzzer. It
+ * lets compilers without -fsanitize=fuzzer build the targets, and CTest
+ * replay the seed corpus and the regression inputs on every build: any
+ * crash or budget overrun aborts the run.
+ *
+ * Usage: <target>_replay FILE_OR_DIR...
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int main(int argc, char** argv) {
+    std::vector<std::filesystem::path> files;
+    for (int i = 1; i < argc; i++) {
+        std::filesystem::path path = argv[i];
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                if (entry.is_regular_file()) {
+                    files.push_back(entry.path());
+                }
+            }
+        } else if (std::filesystem::exists(path)) {
+            files.push_back(path);
+        } else {
+            std::fprintf(stderr, "%s: no such file or directory\n", argv[i]);
+            return 1;
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::fprintf(stderr, "%s\n", file.string().c_str());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    std::printf("replayed %zu input(s)\n", files.size());
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * Fuzz target: MarkdownParser::parse
+ *
+ * Parses every input with the options selected by its first byte, once as
+ * it is and once with the input normalization pre-pass, and reports inputs
+ * that crash the parser or go over the time or memory budget of
+ * FuzzInput.h, or do not fail cleanly under its memory limit. The
+ * normalized input has to come out clean: normalizing it again changes
+ * nothing. The block manifest of the input has to cover it in order, and
+ * parsing one of its blocks has to succeed. Parsing the inline content of a
+ * skeleton (deferInlines) has to give a node for each deferred leaf.
+ * Parsing in steps has to give the AST of the one-shot parse. The heading
+ * index has to lead to the headings of the tree, and come out the same
+ * without the tree (headingsOnly). The matches of a search have to lie in
+ * the text nodes of the tree. The images and links extracted without a tree
+ * have to come in document order, within the input. Plain text cut at some
+ * length has to be a prefix of the whole text, no longer than that.
+ */
+#include "BlockManifest.h"
+#include "DocumentResources.h"
+#include "FuzzInput.h"
+#include "IncrementalParser.h"
+#include "InputNormalizer.h"
+#include "MarkdownSerializer.h"
+#include "PlainText.h"
+#include "SearchIndex.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_fuzz;
+using hypermarkdown_test::nodeAt;
+
+namespace {
+
+void check(const FuzzInput& input) {
+    ParseResult result = ParseResult::Failure("");
+    double ms = timedMs(input, [&] { result = MarkdownParser::parse(input.content, input.options); });
+
+    if (result.success) {
+        if (result.nodes.size() != 1 || !result.nodes[0] || result.nodes[0]->type != "document") {
+            std::abort();
+        }
+        std::string again;
+        if (result.normalizedInput && InputNormalizer::normalize(*result.normalizedInput, again)) {
+            std::abort();
+        }
+        checkBudgets(input, ms, result.memory ? result.memory->peakBytes : 0);
+        checkMemoryLimit(input, result.memory ? result.memory->peakBytes : 0);
+
+        size_t parsedSize = result.normalizedInput ? result.normalizedInput->size() : input.content.size();
+        auto manifest = BlockManifest::build(input.content, InternalLayoutMetrics(), input.options);
+        uint32_t previousEnd = 0;
+        for (const auto& block : manifest.blocks) {
+            if (block.start < previousEnd || block.end < block.start || block.end > parsedSize) {
+                std::abort();
+            }
+            previousEnd = block.end;
+        }
+        if (!manifest.blocks.empty()) {
+            InternalParserOptions options = input.options;
+            options.firstBlock = manifest.blocks.size() / 2;
+            options.endBlock = options.firstBlock + 1;
+            if (!MarkdownParser::parse(input.content, options).success) {
+                std::abort();
+            }
+        }
+
+        // Two-phase parsing: the content of the skeleton's deferred nodes
+        // comes back one node each
+        InternalParserOptions options = input.options;
+        options.deferInlines = true;
+        auto skeleton = MarkdownParser::parse(input.content, options);
+        size_t deferred = 0;
+        if (skeleton.success) {
+            walkTree(
+                skeleton.nodes[0].get(),
+                [&](const MarkdownNode* node, size_t) {
+                    deferred += node->type == "deferred";
+                    return true;
+                },
+                [](const MarkdownNode*) {});
+            options.deferInlines = false;
+            options.inlinesOnly = true;
+            auto inlines = MarkdownParser::parse(input.content, options);
+            if (inlines.success && inlines.nodes[0]->children.size() != deferred) {
+                std::abort();
+            }
+        }
+
+        // Incremental parsing: the blocks of all steps, in the document of
+        // the last one, are the one-shot AST
+        IncrementalParser incremental(input.content, input.options);
+        std::string children;
+        for (;;) {
+            auto step = incremental.step(0);
+            if (!step.success) {
+                break;
+            }
+            if (step.blocks.size() > 2) {
+                children += children.empty() ? "" : ",";
+                children.append(step.blocks, 1, step.blocks.size() - 2);
+            }
+            if (step.done) {
+                std::string document = *step.document;
+                if (!children.empty()) {
+                    document.pop_back();
+                    document += ",\"children\":[" + children + "]}";
+                }
+                std::optional<LineIndex> lines;
+                if (input.options.sourcePositions) {
+                    lines.emplace(result.normalizedInput ? *result.normalizedInput : input.content);
+                }
+                if (document != MarkdownSerializer::nodeToJson(result.nodes[0], lines ? &*lines : nullptr)) {
+                    std::abort();
+                }
+                break;
+            }
+        }
+
+        // Heading index: each path leads to a heading, and headingsOnly
+        // finds the headings of the full parse
+        options = input.options;
+        options.collectHeadings = true;
+        auto indexed = MarkdownParser::parse(input.content, options);
+        options.headingsOnly = true;
+        auto headingsOnly = MarkdownParser::parse(input.content, options);
+        if (indexed.success && headingsOnly.success) {
+            // Spans md4c leaves open in malformed input can put inline nodes
+            // among the blocks of the full tree, which a parse without
+            // inlines does not see
+            bool balanced =
+                skeleton.success && skeleton.nodes[0]->children.size() == indexed.nodes[0]->children.size();
+            const auto& headings = *indexed.headings;
+            if (headingsOnly.headings->size() != headings.size()) {
+                std::abort();
+            }
+            for (size_t i = 0; i < headings.size(); i++) {
+                const auto& other = (*headingsOnly.headings)[i];
+                if (other.text != headings[i].text || other.slug != headings[i].slug ||
+                    other.offset != headings[i].offset || (other.path != headings[i].path && balanced)) {
+                    std::abort();
+                }
+                const MarkdownNode* node = nodeAt(indexed.nodes[0].get(), headings[i].path);
+                if (!node || node->type != "heading" || node->level != headings[i].level) {
+                    std::abort();
+                }
+            }
+        }
+
+        // Search: each segment of a match lies in a text node
+        SearchIndex index(result.nodes[0].get());
+        std::vector<std::string> patterns = {input.content.substr(0, 2), input.content.substr(input.content.size() / 2, 3), "a"};
+        for (const auto& match : index.search(patterns)) {
+            if (match.pattern >= patterns.size() || match.segments.empty()) {
+                std::abort();
+            }
+            for (const auto& segment : match.segments) {
+                const MarkdownNode* node = nodeAt(result.nodes[0].get(), segment.path);
+                if (!node || node->type != "text" || !node->content || segment.start > segment.end ||
+                    segment.end > InputNormalizer::utf16Length(node->content->data(), node->content->size())) {
+                    std::abort();
+                }
+            }
+        }
+
+        // Resources: in order, each within the parsed input
+        auto extracted = DocumentResources::extract(input.content, input.options);
+        uint32_t previousStart = 0;
+        for (const auto& resource : extracted.resources) {
+            if (resource.start < previousStart || resource.start > resource.end || resource.end > parsedSize) {
+                std::abort();
+            }
+            previousStart = resource.start;
+        }
+
+        // Plain text: a preview is the start of the whole text
+        auto text = PlainText::extract(input.content, SIZE_MAX, input.options);
+        size_t maxChars = input.content.size() % 64;
+        auto preview = PlainText::extract(input.content, maxChars, input.options);
+        if (!text.success || !preview.success || text.truncated ||
+            text.text.compare(0, preview.text.size(), preview.text) != 0 ||
+            InputNormalizer::utf16Length(preview.text.data(), preview.text.size()) > maxChars) {
+            std::abort();
+        }
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzInput input = decode(data, size);
+
+    // Once as it comes, NULs, CRs and invalid UTF-8 included, once through
+    // the normalization pre-pass
+    for (bool normalizeInput : {false, true}) {
+        input.options.normalizeInput = normalizeInput;
+        check(input);
+    }
+    return 0;
+}
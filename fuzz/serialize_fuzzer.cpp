@@ -0,0 +1,211 @@
+/**
+ * Fuzz target: MarkdownParser::parse plus MarkdownSerializer::toJson
+ *
+ * Like parse_fuzzer, with source positions and code highlighting on and
+ * the JSON serialization inside the budgets, and a structural check of the
+ * JSON: brackets balance outside of strings, no raw control character ends
+ * up in a string, and the JSON is valid UTF-8 whatever the input. Node
+ * positions have to lie within the input and within their parent's, code
+ * tokens in order within the code text. Every input runs twice, the second
+ * time with text runs, which have to cover their text exactly. The display
+ * list of each tree has to read back as one record per node, each nested
+ * under an open record.
+ */
+#include "DisplayList.h"
+#include "FuzzInput.h"
+#include "InputNormalizer.h"
+#include "LineIndex.h"
+#include "MarkdownSerializer.h"
+
+using namespace margelo::nitro::hypermarkdown;
+using namespace hypermarkdown_fuzz;
+
+namespace {
+
+bool wellFormed(const std::string& json) {
+    std::string open;
+    bool inString = false;
+    for (size_t i = 0; i < json.size(); i++) {
+        char c = json[i];
+        if (inString) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                inString = false;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '[' || c == '{') {
+            open += c;
+        } else if (c == ']' || c == '}') {
+            if (open.empty() || open.back() != (c == ']' ? '[' : '{')) {
+                return false;
+            }
+            open.pop_back();
+        }
+    }
+    return !inString && open.empty();
+}
+
+bool nestedPositions(const MarkdownNode* root, size_t inputSize) {
+    std::vector<const MarkdownNode*> parents;
+    bool nested = true;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t) {
+            nested = node && node->position && node->position->start <= node->position->end &&
+                     node->position->end <= inputSize;
+            if (nested && !parents.empty()) {
+                nested = parents.back()->position->start <= node->position->start &&
+                         node->position->end <= parents.back()->position->end;
+            }
+            parents.push_back(node);
+            return nested;
+        },
+        [&](const MarkdownNode*) { parents.pop_back(); });
+    return nested;
+}
+
+bool orderedTokens(const MarkdownNode* root) {
+    bool ordered = true;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t) {
+            if (node->tokens.empty()) {
+                return true;
+            }
+            const std::string& code = *node->children.front()->content;
+            size_t units = InputNormalizer::utf16Length(code.data(), code.size());
+            size_t end = 0;
+            for (const auto& token : node->tokens) {
+                ordered = ordered && token.offset >= end && token.length > 0 && token.offset + token.length <= units;
+                end = token.offset + token.length;
+            }
+            return ordered;
+        },
+        [](const MarkdownNode*) {});
+    return ordered;
+}
+
+// Text runs have to cover their text node's content and link to its links
+bool coveringRuns(const MarkdownNode* root) {
+    bool covering = true;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t) {
+            if (node->runs.empty()) {
+                return true;
+            }
+            size_t units = 0;
+            for (const auto& run : node->runs) {
+                units += run.length;
+                covering = covering && run.link < static_cast<int32_t>(node->links.size());
+            }
+            const std::string& text = *node->content;
+            covering = covering && units == InputNormalizer::utf16Length(text.data(), text.size());
+            return covering;
+        },
+        [](const MarkdownNode*) {});
+    return covering;
+}
+
+// Reads the records back: every value and string index in bounds, each
+// record at most one level below the previous one, one record per node
+bool readableList(const DisplayList& list, const MarkdownNode* root) {
+    size_t nodes = 0;
+    walkTree(root, [&](const MarkdownNode*, size_t) { nodes++; return true; }, [](const MarkdownNode*) {});
+    size_t records = 0;
+    size_t i = 0;
+    int64_t previousDepth = -1;
+    auto has = [&](size_t count) { return list.ops.size() - i >= count; };
+    auto next = [&] { return list.ops[i++]; };
+    auto string = [&] { return static_cast<uint32_t>(next()) < list.strings.size(); };
+    while (i < list.ops.size()) {
+        if (!has(3)) {
+            return false;
+        }
+        int32_t depth = next();
+        int32_t type = next();
+        auto fields = static_cast<uint32_t>(next());
+        if (depth < 0 || depth > previousDepth + 1 || (records == 0) != (depth == 0) ||
+            (type >= 0 && static_cast<size_t>(type) >= list.strings.size())) {
+            return false;
+        }
+        previousDepth = depth;
+        records++;
+        for (uint32_t field = 1; field <= kFieldLocation; field <<= 1) {
+            if (!(fields & field)) {
+                continue;
+            }
+            bool readable = true;
+            if (field & (kFieldContent | kFieldHref | kFieldSrc | kFieldAlt | kFieldTitle | kFieldLanguage)) {
+                readable = has(1) && string();
+            } else if (field & (kFieldTokens | kFieldRuns)) {
+                int32_t count = has(1) ? next() : -1;
+                readable = count >= 0 && count % 3 == 0 && has(count);
+                i += readable ? count : 0;
+            } else if (field == kFieldLinks) {
+                readable = has(1);
+                for (int32_t count = readable ? next() : 0; readable && count > 0; count--) {
+                    int32_t mask = has(1) ? next() : 8;
+                    readable = mask < 8;
+                    for (int bit = 1; readable && bit < 8; bit <<= 1) {
+                        readable = !(mask & bit) || (has(1) && string());
+                    }
+                }
+            } else {
+                size_t count = field == kFieldPosition ? 2 : field == kFieldLocation ? 4 : 1;
+                readable = has(count);
+                i += readable ? count : 0;
+            }
+            if (!readable) {
+                return false;
+            }
+        }
+    }
+    return records == nodes && records == list.nodeCount;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzInput input = decode(data, size);
+    input.options.sourcePositions = true;
+    input.options.highlightCode = true;
+
+    // Once with a node per span, once with text runs
+    for (bool textRuns : {false, true}) {
+        input.options.textRuns = textRuns;
+        ParseResult result = ParseResult::Failure("");
+        std::string json;
+        DisplayList list;
+        std::string listJson;
+        size_t parsePeakBytes = 0;  // without the JSON, which toJson accounts too
+        double ms = timedMs(input, [&] {
+            result = MarkdownParser::parse(input.content, input.options);
+            parsePeakBytes = result.memory ? result.memory->peakBytes : 0;
+            if (result.success) {
+                LineIndex lines(input.content);
+                json = MarkdownSerializer::toJson(result.nodes, result.memory ? &*result.memory : nullptr, &lines);
+                list = DisplayList::build(result.nodes, &lines);
+                listJson = MarkdownSerializer::displayListToJson(list);
+            }
+        });
+
+        if (result.success) {
+            std::string normalized;
+            const MarkdownNode* root = result.nodes[0].get();
+            if (!wellFormed(json) || InputNormalizer::normalize(json, normalized) ||
+                !nestedPositions(root, input.content.size()) || !orderedTokens(root) || !coveringRuns(root) ||
+                !wellFormed(listJson) || InputNormalizer::normalize(listJson, normalized) ||
+                !readableList(list, root)) {
+                std::abort();
+            }
+            checkBudgets(input, ms, result.memory ? result.memory->peakBytes : 0);
+            checkMemoryLimit(input, parsePeakBytes);
+        }
+    }
+    return 0;
+}
@@ -34,6 +34,8 @@ target_sources(
   ../nitrogen/generated/android/HyperMarkdownOnLoad.cpp
   # Shared Nitrogen C++ sources
   ../nitrogen/generated/shared/c++/HybridHyperMarkdownSpec.cpp
+  ../nitrogen/generated/shared/c++/HybridIncrementalParserSpec.cpp
+  ../nitrogen/generated/shared/c++/HybridSearchIndexSpec.cpp
   # Android-specific Nitrogen C++ sources
   
 )
@@ -0,0 +1,92 @@
+///
+/// BlockManifestNative.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/PropNameIDCache.hpp>)
+#include <NitroModules/PropNameIDCache.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <string>
+#include <optional>
+
+namespace margelo::nitro::hypermarkdown {
+
+  /**
+   * A struct which can be represented as a JavaScript object (BlockManifestNative).
+   */
+  struct BlockManifestNative final {
+  public:
+    bool success     SWIFT_PRIVATE;
+    std::string manifest     SWIFT_PRIVATE;
+    std::optional<std::string> errorMessage     SWIFT_PRIVATE;
+
+  public:
+    BlockManifestNative() = default;
+    explicit BlockManifestNative(bool success, std::string manifest, std::optional<std::string> errorMessage): success(success), manifest(manifest), errorMessage(errorMessage) {}
+
+  public:
+    friend bool operator==(const BlockManifestNative& lhs, const BlockManifestNative& rhs) = default;
+  };
+
+} // namespace margelo::nitro::hypermarkdown
+
+namespace margelo::nitro {
+
+  // C++ BlockManifestNative <> JS BlockManifestNative (object)
+  template <>
+  struct JSIConverter<margelo::nitro::hypermarkdown::BlockManifestNative> final {
+    static inline margelo::nitro::hypermarkdown::BlockManifestNative fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::hypermarkdown::BlockManifestNative(
+        JSIConverter<bool>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "success"))),
+        JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "manifest"))),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorMessage")))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::BlockManifestNative& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "success"), JSIConverter<bool>::toJSI(runtime, arg.success));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "manifest"), JSIConverter<std::string>::toJSI(runtime, arg.manifest));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "errorMessage"), JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.errorMessage));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<bool>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "success")))) return false;
+      if (!JSIConverter<std::string>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "manifest")))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorMessage")))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -15,6 +15,13 @@ namespace margelo::nitro::hypermarkdown {
     // load custom methods/properties
     registerHybrids(this, [](Prototype& prototype) {
       prototype.registerHybridMethod("parse", &HybridHyperMarkdownSpec::parse);
+      prototype.registerHybridMethod("getBlockManifest", &HybridHyperMarkdownSpec::getBlockManifest);
+      prototype.registerHybridMethod("getBlocks", &HybridHyperMarkdownSpec::getBlocks);
+      prototype.registerHybridMethod("parseInlines", &HybridHyperMarkdownSpec::parseInlines);
+      prototype.registerHybridMethod("createIncrementalParser", &HybridHyperMarkdownSpec::createIncrementalParser);
+      prototype.registerHybridMethod("createSearchIndex", &HybridHyperMarkdownSpec::createSearchIndex);
+      prototype.registerHybridMethod("extractResources", &HybridHyperMarkdownSpec::extractResources);
+      prototype.registerHybridMethod("toPlainText", &HybridHyperMarkdownSpec::toPlainText);
     });
   }
 
@@ -17,11 +17,25 @@
 namespace margelo::nitro::hypermarkdown { struct ParseResultNative; }
 // Forward declaration of `ParserOptions` to properly resolve imports.
 namespace margelo::nitro::hypermarkdown { struct ParserOptions; }
+// Forward declaration of `BlockManifestNative` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct BlockManifestNative; }
+// Forward declaration of `LayoutMetrics` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct LayoutMetrics; }
+// Forward declaration of `HybridIncrementalParserSpec` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { class HybridIncrementalParserSpec; }
+// Forward declaration of `HybridSearchIndexSpec` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { class HybridSearchIndexSpec; }
 
 #include "ParseResultNative.hpp"
 #include <string>
 #include "ParserOptions.hpp"
 #include <optional>
+#include "BlockManifestNative.hpp"
+#include "LayoutMetrics.hpp"
+#include <memory>
+#include "HybridIncrementalParserSpec.hpp"
+#include "HybridSearchIndexSpec.hpp"
+#include <vector>
 
 namespace margelo::nitro::hypermarkdown {
 
@@ -55,6 +69,13 @@ namespace margelo::nitro::hypermarkdown {
     public:
       // Methods
       virtual ParseResultNative parse(const std::string& content, const std::optional<ParserOptions>& options) = 0;
+      virtual BlockManifestNative getBlockManifest(const std::string& content, const LayoutMetrics& metrics, const std::optional<ParserOptions>& options) = 0;
+      virtual ParseResultNative getBlocks(const std::string& content, double start, double end, const std::optional<ParserOptions>& options) = 0;
+      virtual ParseResultNative parseInlines(const std::string& content, double start, double end, const std::optional<ParserOptions>& options) = 0;
+      virtual std::shared_ptr<HybridIncrementalParserSpec> createIncrementalParser(const std::string& content, const std::optional<ParserOptions>& options) = 0;
+      virtual std::shared_ptr<HybridSearchIndexSpec> createSearchIndex(const std::string& content, const std::optional<ParserOptions>& options) = 0;
+      virtual std::string extractResources(const std::vector<std::string>& contents, const std::optional<ParserOptions>& options) = 0;
+      virtual std::string toPlainText(const std::string& content, std::optional<double> maxChars, const std::optional<ParserOptions>& options) = 0;
 
     protected:
       // Hybrid Setup
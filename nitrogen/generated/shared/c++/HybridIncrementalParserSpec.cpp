@@ -0,0 +1,21 @@
+///
+/// HybridIncrementalParserSpec.cpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#include "HybridIncrementalParserSpec.hpp"
+
+namespace margelo::nitro::hypermarkdown {
+
+  void HybridIncrementalParserSpec::loadHybridMethods() {
+    // load base methods/properties
+    HybridObject::loadHybridMethods();
+    // load custom methods/properties
+    registerHybrids(this, [](Prototype& prototype) {
+      prototype.registerHybridMethod("step", &HybridIncrementalParserSpec::step);
+    });
+  }
+
+} // namespace margelo::nitro::hypermarkdown
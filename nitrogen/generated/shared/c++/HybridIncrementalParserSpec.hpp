@@ -0,0 +1,63 @@
+///
+/// HybridIncrementalParserSpec.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/HybridObject.hpp>)
+#include <NitroModules/HybridObject.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+// Forward declaration of `ParseStepNative` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct ParseStepNative; }
+
+#include "ParseStepNative.hpp"
+
+namespace margelo::nitro::hypermarkdown {
+
+  using namespace margelo::nitro;
+
+  /**
+   * An abstract base class for `IncrementalParser`
+   * Inherit this class to create instances of `HybridIncrementalParserSpec` in C++.
+   * You must explicitly call `HybridObject`'s constructor yourself, because it is virtual.
+   * @example
+   * ```cpp
+   * class HybridIncrementalParser: public HybridIncrementalParserSpec {
+   * public:
+   *   HybridIncrementalParser(...): HybridObject(TAG) { ... }
+   *   // ...
+   * };
+   * ```
+   */
+  class HybridIncrementalParserSpec: public virtual HybridObject {
+    public:
+      // Constructor
+      explicit HybridIncrementalParserSpec(): HybridObject(TAG) { }
+
+      // Destructor
+      ~HybridIncrementalParserSpec() override = default;
+
+    public:
+      // Properties
+      
+
+    public:
+      // Methods
+      virtual ParseStepNative step(double budgetMs) = 0;
+
+    protected:
+      // Hybrid Setup
+      void loadHybridMethods() override;
+
+    protected:
+      // Tag for logging
+      static constexpr auto TAG = "IncrementalParser";
+  };
+
+} // namespace margelo::nitro::hypermarkdown
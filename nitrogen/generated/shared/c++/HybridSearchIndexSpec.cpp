@@ -0,0 +1,21 @@
+///
+/// HybridSearchIndexSpec.cpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#include "HybridSearchIndexSpec.hpp"
+
+namespace margelo::nitro::hypermarkdown {
+
+  void HybridSearchIndexSpec::loadHybridMethods() {
+    // load base methods/properties
+    HybridObject::loadHybridMethods();
+    // load custom methods/properties
+    registerHybrids(this, [](Prototype& prototype) {
+      prototype.registerHybridMethod("search", &HybridSearchIndexSpec::search);
+    });
+  }
+
+} // namespace margelo::nitro::hypermarkdown
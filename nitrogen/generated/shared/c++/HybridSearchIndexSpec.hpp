@@ -0,0 +1,62 @@
+///
+/// HybridSearchIndexSpec.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/HybridObject.hpp>)
+#include <NitroModules/HybridObject.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace margelo::nitro::hypermarkdown {
+
+  using namespace margelo::nitro;
+
+  /**
+   * An abstract base class for `SearchIndex`
+   * Inherit this class to create instances of `HybridSearchIndexSpec` in C++.
+   * You must explicitly call `HybridObject`'s constructor yourself, because it is virtual.
+   * @example
+   * ```cpp
+   * class HybridSearchIndex: public HybridSearchIndexSpec {
+   * public:
+   *   HybridSearchIndex(...): HybridObject(TAG) { ... }
+   *   // ...
+   * };
+   * ```
+   */
+  class HybridSearchIndexSpec: public virtual HybridObject {
+    public:
+      // Constructor
+      explicit HybridSearchIndexSpec(): HybridObject(TAG) { }
+
+      // Destructor
+      ~HybridSearchIndexSpec() override = default;
+
+    public:
+      // Properties
+      
+
+    public:
+      // Methods
+      virtual std::string search(const std::vector<std::string>& patterns, std::optional<double> maxMatches) = 0;
+
+    protected:
+      // Hybrid Setup
+      void loadHybridMethods() override;
+
+    protected:
+      // Tag for logging
+      static constexpr auto TAG = "SearchIndex";
+  };
+
+} // namespace margelo::nitro::hypermarkdown
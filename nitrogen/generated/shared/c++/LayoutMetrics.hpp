@@ -0,0 +1,120 @@
+///
+/// LayoutMetrics.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/PropNameIDCache.hpp>)
+#include <NitroModules/PropNameIDCache.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <optional>
+#include <vector>
+
+namespace margelo::nitro::hypermarkdown {
+
+  /**
+   * A struct which can be represented as a JavaScript object (LayoutMetrics).
+   */
+  struct LayoutMetrics final {
+  public:
+    double width     SWIFT_PRIVATE;
+    double fontSize     SWIFT_PRIVATE;
+    double lineHeight     SWIFT_PRIVATE;
+    std::optional<std::vector<double>> headingFontSizes     SWIFT_PRIVATE;
+    std::optional<std::vector<double>> headingLineHeights     SWIFT_PRIVATE;
+    std::optional<double> codeLineHeight     SWIFT_PRIVATE;
+    std::optional<double> codeBlockPadding     SWIFT_PRIVATE;
+    std::optional<double> blockSpacing     SWIFT_PRIVATE;
+    std::optional<double> imageHeight     SWIFT_PRIVATE;
+    std::optional<double> charWidth     SWIFT_PRIVATE;
+
+  public:
+    LayoutMetrics() = default;
+    explicit LayoutMetrics(double width, double fontSize, double lineHeight, std::optional<std::vector<double>> headingFontSizes, std::optional<std::vector<double>> headingLineHeights, std::optional<double> codeLineHeight, std::optional<double> codeBlockPadding, std::optional<double> blockSpacing, std::optional<double> imageHeight, std::optional<double> charWidth): width(width), fontSize(fontSize), lineHeight(lineHeight), headingFontSizes(headingFontSizes), headingLineHeights(headingLineHeights), codeLineHeight(codeLineHeight), codeBlockPadding(codeBlockPadding), blockSpacing(blockSpacing), imageHeight(imageHeight), charWidth(charWidth) {}
+
+  public:
+    friend bool operator==(const LayoutMetrics& lhs, const LayoutMetrics& rhs) = default;
+  };
+
+} // namespace margelo::nitro::hypermarkdown
+
+namespace margelo::nitro {
+
+  // C++ LayoutMetrics <> JS LayoutMetrics (object)
+  template <>
+  struct JSIConverter<margelo::nitro::hypermarkdown::LayoutMetrics> final {
+    static inline margelo::nitro::hypermarkdown::LayoutMetrics fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::hypermarkdown::LayoutMetrics(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "width"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "fontSize"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "lineHeight"))),
+        JSIConverter<std::optional<std::vector<double>>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingFontSizes"))),
+        JSIConverter<std::optional<std::vector<double>>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingLineHeights"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "codeLineHeight"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "codeBlockPadding"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "blockSpacing"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "imageHeight"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "charWidth")))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::LayoutMetrics& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "width"), JSIConverter<double>::toJSI(runtime, arg.width));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "fontSize"), JSIConverter<double>::toJSI(runtime, arg.fontSize));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "lineHeight"), JSIConverter<double>::toJSI(runtime, arg.lineHeight));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "headingFontSizes"), JSIConverter<std::optional<std::vector<double>>>::toJSI(runtime, arg.headingFontSizes));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "headingLineHeights"), JSIConverter<std::optional<std::vector<double>>>::toJSI(runtime, arg.headingLineHeights));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "codeLineHeight"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.codeLineHeight));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "codeBlockPadding"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.codeBlockPadding));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "blockSpacing"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.blockSpacing));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "imageHeight"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.imageHeight));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "charWidth"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.charWidth));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "width")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "fontSize")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "lineHeight")))) return false;
+      if (!JSIConverter<std::optional<std::vector<double>>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingFontSizes")))) return false;
+      if (!JSIConverter<std::optional<std::vector<double>>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingLineHeights")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "codeLineHeight")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "codeBlockPadding")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "blockSpacing")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "imageHeight")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "charWidth")))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
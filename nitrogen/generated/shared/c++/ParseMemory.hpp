@@ -0,0 +1,96 @@
+///
+/// ParseMemory.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/PropNameIDCache.hpp>)
+#include <NitroModules/PropNameIDCache.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+// Forward declaration of `ParseMemoryUsage` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct ParseMemoryUsage; }
+
+#include "ParseMemoryUsage.hpp"
+
+namespace margelo::nitro::hypermarkdown {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ParseMemory).
+   */
+  struct ParseMemory final {
+  public:
+    ParseMemoryUsage md4c     SWIFT_PRIVATE;
+    ParseMemoryUsage ast     SWIFT_PRIVATE;
+    ParseMemoryUsage output     SWIFT_PRIVATE;
+    double peakBytes     SWIFT_PRIVATE;
+
+  public:
+    ParseMemory() = default;
+    explicit ParseMemory(ParseMemoryUsage md4c, ParseMemoryUsage ast, ParseMemoryUsage output, double peakBytes): md4c(md4c), ast(ast), output(output), peakBytes(peakBytes) {}
+
+  public:
+    friend bool operator==(const ParseMemory& lhs, const ParseMemory& rhs) = default;
+  };
+
+} // namespace margelo::nitro::hypermarkdown
+
+namespace margelo::nitro {
+
+  // C++ ParseMemory <> JS ParseMemory (object)
+  template <>
+  struct JSIConverter<margelo::nitro::hypermarkdown::ParseMemory> final {
+    static inline margelo::nitro::hypermarkdown::ParseMemory fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::hypermarkdown::ParseMemory(
+        JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "md4c"))),
+        JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "ast"))),
+        JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "output"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "peakBytes")))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::ParseMemory& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "md4c"), JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::toJSI(runtime, arg.md4c));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "ast"), JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::toJSI(runtime, arg.ast));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "output"), JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::toJSI(runtime, arg.output));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "peakBytes"), JSIConverter<double>::toJSI(runtime, arg.peakBytes));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "md4c")))) return false;
+      if (!JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "ast")))) return false;
+      if (!JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "output")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "peakBytes")))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,89 @@
+///
+/// ParseMemoryUsage.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/PropNameIDCache.hpp>)
+#include <NitroModules/PropNameIDCache.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+namespace margelo::nitro::hypermarkdown {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ParseMemoryUsage).
+   */
+  struct ParseMemoryUsage final {
+  public:
+    double allocations     SWIFT_PRIVATE;
+    double bytesAllocated     SWIFT_PRIVATE;
+    double peakBytes     SWIFT_PRIVATE;
+
+  public:
+    ParseMemoryUsage() = default;
+    explicit ParseMemoryUsage(double allocations, double bytesAllocated, double peakBytes): allocations(allocations), bytesAllocated(bytesAllocated), peakBytes(peakBytes) {}
+
+  public:
+    friend bool operator==(const ParseMemoryUsage& lhs, const ParseMemoryUsage& rhs) = default;
+  };
+
+} // namespace margelo::nitro::hypermarkdown
+
+namespace margelo::nitro {
+
+  // C++ ParseMemoryUsage <> JS ParseMemoryUsage (object)
+  template <>
+  struct JSIConverter<margelo::nitro::hypermarkdown::ParseMemoryUsage> final {
+    static inline margelo::nitro::hypermarkdown::ParseMemoryUsage fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::hypermarkdown::ParseMemoryUsage(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "allocations"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "bytesAllocated"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "peakBytes")))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::ParseMemoryUsage& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "allocations"), JSIConverter<double>::toJSI(runtime, arg.allocations));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "bytesAllocated"), JSIConverter<double>::toJSI(runtime, arg.bytesAllocated));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "peakBytes"), JSIConverter<double>::toJSI(runtime, arg.peakBytes));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "allocations")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "bytesAllocated")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "peakBytes")))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -28,10 +28,16 @@
 #error NitroModules cannot be found! Are you sure you installed NitroModules properly?
 #endif
 
+// Forward declaration of `ParseTimings` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct ParseTimings; }
 
+// Forward declaration of `ParseMemory` to properly resolve imports.
+namespace margelo::nitro::hypermarkdown { struct ParseMemory; }
 
 #include <string>
 #include <optional>
+#include "ParseTimings.hpp"
+#include "ParseMemory.hpp"
 
 namespace margelo::nitro::hypermarkdown {
 
@@ -45,10 +51,13 @@ namespace margelo::nitro::hypermarkdown {
     std::optional<std::string> errorMessage     SWIFT_PRIVATE;
     std::optional<double> errorLine     SWIFT_PRIVATE;
     std::optional<double> errorColumn     SWIFT_PRIVATE;
+    std::optional<ParseTimings> timings     SWIFT_PRIVATE;
+    std::optional<ParseMemory> memory     SWIFT_PRIVATE;
+    std::optional<std::string> headings     SWIFT_PRIVATE;
 
   public:
     ParseResultNative() = default;
-    explicit ParseResultNative(bool success, std::string ast, std::optional<std::string> errorMessage, std::optional<double> errorLine, std::optional<double> errorColumn): success(success), ast(ast), errorMessage(errorMessage), errorLine(errorLine), errorColumn(errorColumn) {}
+    explicit ParseResultNative(bool success, std::string ast, std::optional<std::string> errorMessage, std::optional<double> errorLine, std::optional<double> errorColumn, std::optional<ParseTimings> timings, std::optional<ParseMemory> memory, std::optional<std::string> headings): success(success), ast(ast), errorMessage(errorMessage), errorLine(errorLine), errorColumn(errorColumn), timings(timings), memory(memory), headings(headings) {}
 
   public:
     friend bool operator==(const ParseResultNative& lhs, const ParseResultNative& rhs) = default;
@@ -68,7 +77,10 @@ namespace margelo::nitro {
         JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "ast"))),
         JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorMessage"))),
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorLine"))),
-        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorColumn")))
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorColumn"))),
+        JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseTimings>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "timings"))),
+        JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseMemory>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "memory"))),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headings")))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::ParseResultNative& arg) {
@@ -78,6 +90,9 @@ namespace margelo::nitro {
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "errorMessage"), JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.errorMessage));
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "errorLine"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.errorLine));
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "errorColumn"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.errorColumn));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "timings"), JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseTimings>>::toJSI(runtime, arg.timings));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "memory"), JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseMemory>>::toJSI(runtime, arg.memory));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "headings"), JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.headings));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -93,6 +108,9 @@ namespace margelo::nitro {
       if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorMessage")))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorLine")))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "errorColumn")))) return false;
+      if (!JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseTimings>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "timings")))) return false;
+      if (!JSIConverter<std::optional<margelo::nitro::hypermarkdown::ParseMemory>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "memory")))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headings")))) return false;
       return true;
     }
   };
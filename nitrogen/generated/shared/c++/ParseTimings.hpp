@@ -0,0 +1,109 @@
+///
+/// ParseTimings.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/PropNameIDCache.hpp>)
+#include <NitroModules/PropNameIDCache.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+namespace margelo::nitro::hypermarkdown {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ParseTimings).
+   */
+  struct ParseTimings final {
+  public:
+    double blockMs     SWIFT_PRIVATE;
+    double inlineMs     SWIFT_PRIVATE;
+    double treeMs     SWIFT_PRIVATE;
+    double serializeMs     SWIFT_PRIVATE;
+    double totalMs     SWIFT_PRIVATE;
+    double inputBytes     SWIFT_PRIVATE;
+    double nodeCount     SWIFT_PRIVATE;
+    double outputBytes     SWIFT_PRIVATE;
+
+  public:
+    ParseTimings() = default;
+    explicit ParseTimings(double blockMs, double inlineMs, double treeMs, double serializeMs, double totalMs, double inputBytes, double nodeCount, double outputBytes): blockMs(blockMs), inlineMs(inlineMs), treeMs(treeMs), serializeMs(serializeMs), totalMs(totalMs), inputBytes(inputBytes), nodeCount(nodeCount), outputBytes(outputBytes) {}
+
+  public:
+    friend bool operator==(const ParseTimings& lhs, const ParseTimings& rhs) = default;
+  };
+
+} // namespace margelo::nitro::hypermarkdown
+
+namespace margelo::nitro {
+
+  // C++ ParseTimings <> JS ParseTimings (object)
+  template <>
+  struct JSIConverter<margelo::nitro::hypermarkdown::ParseTimings> final {
+    static inline margelo::nitro::hypermarkdown::ParseTimings fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::hypermarkdown::ParseTimings(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "blockMs"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "inlineMs"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "treeMs"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "serializeMs"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "totalMs"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "inputBytes"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "nodeCount"))),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "outputBytes")))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::ParseTimings& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "blockMs"), JSIConverter<double>::toJSI(runtime, arg.blockMs));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "inlineMs"), JSIConverter<double>::toJSI(runtime, arg.inlineMs));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "treeMs"), JSIConverter<double>::toJSI(runtime, arg.treeMs));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "serializeMs"), JSIConverter<double>::toJSI(runtime, arg.serializeMs));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "totalMs"), JSIConverter<double>::toJSI(runtime, arg.totalMs));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "inputBytes"), JSIConverter<double>::toJSI(runtime, arg.inputBytes));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "nodeCount"), JSIConverter<double>::toJSI(runtime, arg.nodeCount));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "outputBytes"), JSIConverter<double>::toJSI(runtime, arg.outputBytes));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "blockMs")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "inlineMs")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "treeMs")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "serializeMs")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "totalMs")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "inputBytes")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "nodeCount")))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "outputBytes")))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -48,10 +48,21 @@ namespace margelo::nitro::hypermarkdown {
     std::optional<bool> wiki     SWIFT_PRIVATE;
     std::optional<double> maxInputSize     SWIFT_PRIVATE;
     std::optional<double> timeout     SWIFT_PRIVATE;
+    std::optional<bool> collectTimings     SWIFT_PRIVATE;
+    std::optional<bool> collectMemory     SWIFT_PRIVATE;
+    std::optional<double> maxMemory     SWIFT_PRIVATE;
+    std::optional<bool> sourcePositions     SWIFT_PRIVATE;
+    std::optional<bool> normalizeInput     SWIFT_PRIVATE;
+    std::optional<bool> highlightCode     SWIFT_PRIVATE;
+    std::optional<bool> textRuns     SWIFT_PRIVATE;
+    std::optional<bool> displayList     SWIFT_PRIVATE;
+    std::optional<bool> deferInlines     SWIFT_PRIVATE;
+    std::optional<bool> collectHeadings     SWIFT_PRIVATE;
+    std::optional<bool> headingsOnly     SWIFT_PRIVATE;
 
   public:
     ParserOptions() = default;
-    explicit ParserOptions(std::optional<bool> gfm, std::optional<bool> enableTables, std::optional<bool> enableTaskLists, std::optional<bool> enableStrikethrough, std::optional<bool> enableAutolink, std::optional<bool> math, std::optional<bool> wiki, std::optional<double> maxInputSize, std::optional<double> timeout): gfm(gfm), enableTables(enableTables), enableTaskLists(enableTaskLists), enableStrikethrough(enableStrikethrough), enableAutolink(enableAutolink), math(math), wiki(wiki), maxInputSize(maxInputSize), timeout(timeout) {}
+    explicit ParserOptions(std::optional<bool> gfm, std::optional<bool> enableTables, std::optional<bool> enableTaskLists, std::optional<bool> enableStrikethrough, std::optional<bool> enableAutolink, std::optional<bool> math, std::optional<bool> wiki, std::optional<double> maxInputSize, std::optional<double> timeout, std::optional<bool> collectTimings, std::optional<bool> collectMemory, std::optional<double> maxMemory, std::optional<bool> sourcePositions, std::optional<bool> normalizeInput, std::optional<bool> highlightCode, std::optional<bool> textRuns, std::optional<bool> displayList, std::optional<bool> deferInlines, std::optional<bool> collectHeadings, std::optional<bool> headingsOnly): gfm(gfm), enableTables(enableTables), enableTaskLists(enableTaskLists), enableStrikethrough(enableStrikethrough), enableAutolink(enableAutolink), math(math), wiki(wiki), maxInputSize(maxInputSize), timeout(timeout), collectTimings(collectTimings), collectMemory(collectMemory), maxMemory(maxMemory), sourcePositions(sourcePositions), normalizeInput(normalizeInput), highlightCode(highlightCode), textRuns(textRuns), displayList(displayList), deferInlines(deferInlines), collectHeadings(collectHeadings), headingsOnly(headingsOnly) {}
 
   public:
     friend bool operator==(const ParserOptions& lhs, const ParserOptions& rhs) = default;
@@ -75,7 +86,18 @@ namespace margelo::nitro {
         JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "math"))),
         JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "wiki"))),
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "maxInputSize"))),
-        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "timeout")))
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "timeout"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectTimings"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectMemory"))),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "maxMemory"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "sourcePositions"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "normalizeInput"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "highlightCode"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "textRuns"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "displayList"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "deferInlines"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectHeadings"))),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingsOnly")))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::hypermarkdown::ParserOptions& arg) {
@@ -89,6 +111,17 @@ namespace margelo::nitro {
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "wiki"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.wiki));
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "maxInputSize"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.maxInputSize));
       obj.setProperty(runtime, PropNameIDCache::get(runtime, "timeout"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.timeout));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "collectTimings"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.collectTimings));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "collectMemory"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.collectMemory));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "maxMemory"), JSIConverter<std::optional<double>>::toJSI(runtime, arg.maxMemory));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "sourcePositions"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.sourcePositions));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "normalizeInput"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.normalizeInput));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "highlightCode"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.highlightCode));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "textRuns"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.textRuns));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "displayList"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.displayList));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "deferInlines"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.deferInlines));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "collectHeadings"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.collectHeadings));
+      obj.setProperty(runtime, PropNameIDCache::get(runtime, "headingsOnly"), JSIConverter<std::optional<bool>>::toJSI(runtime, arg.headingsOnly));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -108,6 +141,17 @@ namespace margelo::nitro {
       if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "wiki")))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "maxInputSize")))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "timeout")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectTimings")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectMemory")))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "maxMemory")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "sourcePositions")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "normalizeInput")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "highlightCode")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "textRuns")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "displayList")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "deferInlines")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "collectHeadings")))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, PropNameIDCache::get(runtime, "headingsOnly")))) return false;
       return true;
     }
   };
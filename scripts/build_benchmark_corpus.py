@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+#
+# Generates the synthetic documents of benchmarks/corpus/: LLM chat
+# transcripts, table-heavy docs, code-heavy docs and CJK text. They are built
+# from hand-written fragments shuffled with a fixed seed, so the output is
+# stable and only changes when this script does. The other corpus files are
+# real documents, see benchmarks/corpus/README.md.
+#
+# Usage: scripts/build_benchmark_corpus.py [output-dir]
+
+import os
+import random
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_OUTPUT = os.path.join(ROOT, "benchmarks", "corpus")
+
+TARGET_BYTES = 192 * 1024
+
+TOPICS = [
+    "React Native", "the Nitro module", "a FlatList", "Hermes", "the JSI bridge", "a Turbo module",
+    "the Metro bundler", "Android Gradle", "CocoaPods", "the Yoga layout engine", "a Reanimated worklet",
+]
+
+PROSE = [
+    "The short answer is that {topic} does most of the work for you, but there are a few caveats.",
+    "Here is what is happening: the render is triggered twice because the key changes on every update.",
+    "You can fix this by moving the expensive computation out of the render path and memoizing it.",
+    "In practice this matters mostly for long lists, where every extra allocation shows up in the profiler.",
+    "Keep in mind that {topic} runs on a separate thread, so you cannot touch the UI from there directly.",
+    "If you only need the first few items, there is no reason to parse the whole document up front.",
+    "This is a common source of confusion, and the documentation for {topic} is not very explicit about it.",
+    "Let me know if the error persists after the change; the stack trace will tell us which module fails.",
+    "The difference is small for short messages, but it adds up when a chat has hundreds of them.",
+    "Note that the example below assumes TypeScript, but the same approach works in plain JavaScript.",
+]
+
+INLINE = [
+    "`useMemo`", "**important**", "*not*", "`npm install`", "[the docs](https://reactnative.dev/docs/performance)",
+    "`keyExtractor`", "~~deprecated~~", "`onLayout`", "**before** rendering", "<https://github.com/mrousavy/nitro>",
+]
+
+QUESTIONS = [
+    "Why does my list re-render every time I type in the search box?",
+    "How do I render markdown with syntax highlighting in {topic}?",
+    "What is the fastest way to parse a large document on a low-end Android phone?",
+    "Can you explain the difference between useMemo and useCallback with an example?",
+    "My app crashes with an out of memory error when opening long messages. Any ideas?",
+    "How should I structure a chat screen so that streaming responses stay smooth?",
+]
+
+CODE_TS = [
+    """import { useMemo } from 'react';
+import { parseMarkdown } from 'react-native-hyper-markdown';
+
+export function useParsed(content: string) {
+  return useMemo(() => parseMarkdown(content), [content]);
+}""",
+    """const renderItem = useCallback(
+  ({ item }: { item: Message }) => <MessageBubble message={item} />,
+  []
+);
+
+<FlatList
+  data={messages}
+  renderItem={renderItem}
+  keyExtractor={(m) => m.id}
+  initialNumToRender={12}
+  windowSize={7}
+/>""",
+    """type Message = {
+  id: string;
+  role: 'user' | 'assistant';
+  content: string;
+  createdAt: number;
+};
+
+function append(messages: Message[], chunk: string): Message[] {
+  const last = messages[messages.length - 1];
+  return [...messages.slice(0, -1), { ...last, content: last.content + chunk }];
+}""",
+]
+
+CODE_OTHER = [
+    ("bash", "cd ios && pod install && cd ..\nnpx react-native run-ios --configuration Release"),
+    ("json", '{\n  "name": "example",\n  "dependencies": {\n    "react-native-hyper-markdown": "^0.1.1",\n    "react-native-nitro-modules": "^0.31.0"\n  }\n}'),
+    ("kotlin", "override fun onCreate(savedInstanceState: Bundle?) {\n    super.onCreate(null)\n    WindowCompat.setDecorFitsSystemWindows(window, false)\n}"),
+    ("swift", "func application(_ application: UIApplication,\n                 didFinishLaunchingWithOptions launchOptions: [UIApplication.LaunchOptionsKey: Any]?) -> Bool {\n    return true\n}"),
+    ("cpp", "std::string escape(const std::string& s) {\n    std::string out;\n    out.reserve(s.size());\n    for (char c : s) {\n        if (c == '\"' || c == '\\\\') out += '\\\\';\n        out += c;\n    }\n    return out;\n}"),
+    ("python", "def chunks(items, size):\n    for i in range(0, len(items), size):\n        yield items[i:i + size]\n\nfor batch in chunks(list(range(100)), 16):\n    print(sum(batch))"),
+    ("sql", "SELECT m.id, m.role, m.content\nFROM messages m\nWHERE m.chat_id = ?\nORDER BY m.created_at DESC\nLIMIT 50;"),
+    ("rust", "fn main() {\n    let words: Vec<&str> = \"a b c\".split(' ').collect();\n    for (i, w) in words.iter().enumerate() {\n        println!(\"{i}: {w}\");\n    }\n}"),
+    ("go", "func handler(w http.ResponseWriter, r *http.Request) {\n\tif r.Method != http.MethodPost {\n\t\thttp.Error(w, \"method not allowed\", http.StatusMethodNotAllowed)\n\t\treturn\n\t}\n\tw.WriteHeader(http.StatusNoContent)\n}"),
+]
+
+CJK_JA = [
+    "マークダウンは軽量マークアップ言語の一つで、読みやすく書きやすいプレーンテキスト形式です。",
+    "この章では、**見出し**や*強調*、`インラインコード`の書き方を説明します。",
+    "大きな文書を表示する場合は、仮想化されたリストを使うとメモリ使用量を抑えられます。",
+    "詳しくは[公式ドキュメント](https://example.jp/docs)を参照してください。",
+    "日本語の文章では、句読点の直後に強調記号を置くと意図しない結果になることがあります。",
+]
+
+CJK_ZH = [
+    "本文档介绍如何在移动应用中高效地渲染**长篇内容**，包括表格、代码块和图片。",
+    "解析器在原生线程上运行，因此不会阻塞界面的*交互与动画*。",
+    "如果遇到性能问题，请先使用`collectTimings`选项确认耗时集中在哪个阶段。",
+    "更多示例请参见[示例应用](https://example.cn/demo)中的「性能」页面。",
+    "繁體中文與簡體中文可以混合出現在同一段落中，解析結果不受影響。",
+]
+
+CJK_KO = [
+    "마크다운은 **간단한 문법**으로 서식 있는 문서를 작성할 수 있게 해 줍니다.",
+    "긴 문서를 렌더링할 때는 화면에 보이는 블록만 먼저 그리는 것이 좋습니다.",
+    "자세한 내용은 [가이드](https://example.kr/guide)를 참고하세요.",
+]
+
+
+def sentence(rng, pool):
+    s = rng.choice(pool).replace("{topic}", rng.choice(TOPICS))
+    if rng.random() < 0.5:
+        words = s.split(" ")
+        pos = rng.randrange(1, len(words))
+        words.insert(pos, rng.choice(INLINE))
+        s = " ".join(words)
+    return s
+
+
+def paragraph(rng, pool, count):
+    return " ".join(sentence(rng, pool) for _ in range(count))
+
+
+def fenced(lang, code):
+    return "```%s\n%s\n```" % (lang, code)
+
+
+def chat_transcript(rng):
+    out = ["# Conversation export\n"]
+    turn = 0
+    while sum(len(p) for p in out) < TARGET_BYTES:
+        turn += 1
+        out.append("## User\n\n" + rng.choice(QUESTIONS).replace("{topic}", rng.choice(TOPICS)) + "\n")
+        out.append("## Assistant\n")
+        for _ in range(rng.randint(2, 5)):
+            kind = rng.random()
+            if kind < 0.45:
+                out.append(paragraph(rng, PROSE, rng.randint(2, 4)) + "\n")
+            elif kind < 0.6:
+                items = ["%d. %s" % (i + 1, sentence(rng, PROSE)) for i in range(rng.randint(3, 6))]
+                out.append("\n".join(items) + "\n")
+            elif kind < 0.7:
+                items = ["- %s" % sentence(rng, PROSE) for _ in range(rng.randint(2, 5))]
+                out.append("\n".join(items) + "\n")
+            elif kind < 0.85:
+                out.append(fenced("tsx", rng.choice(CODE_TS)) + "\n")
+            elif kind < 0.93:
+                out.append("> **Note:** " + sentence(rng, PROSE) + "\n> " + sentence(rng, PROSE) + "\n")
+            else:
+                rows = ["| Option | Default | Effect |", "|--------|:-------:|--------|"]
+                for opt in rng.sample(["gfm", "math", "wiki", "timeout", "maxInputSize", "enableTables"], 3):
+                    rows.append("| `%s` | `%s` | %s |" % (opt, rng.choice(["true", "false", "5000"]), sentence(rng, PROSE)))
+                out.append("\n".join(rows) + "\n")
+        if turn % 7 == 0:
+            out.append("---\n")
+    return "\n".join(out)
+
+
+NOTES = [
+    "", "see [#12](https://github.com/example/issues/12)", "see [#311](https://github.com/example/issues/311)",
+    "cold start", "*debug build*", "`--release`", "pipe \\| escaped",
+]
+
+
+def tables(rng):
+    out = ["# Device compatibility matrix\n"]
+    devices = ["Pixel 8", "Galaxy A14", "iPhone 15", "iPhone SE", "Moto G32", "Redmi 12C", "iPad Air", "Xperia 10"]
+    columns = ["Parse (ms)", "Render (ms)", "Memory (MB)", "FPS", "Status", "Notes"]
+    section = 0
+    while sum(len(p) for p in out) < TARGET_BYTES:
+        section += 1
+        out.append("## Release %d.%d\n" % (section // 10, section % 10))
+        out.append(paragraph(rng, PROSE, 2) + "\n")
+        header = "| Device | " + " | ".join(columns) + " |"
+        align = "|:-------|" + "|".join(rng.choice(["-------:", ":------:", "-------"]) for _ in columns) + "|"
+        rows = [header, align]
+        for device in rng.sample(devices, rng.randint(4, len(devices))):
+            cells = [
+                "%.1f" % rng.uniform(0.5, 80),
+                "%.1f" % rng.uniform(2, 40),
+                "%d" % rng.randint(40, 400),
+                "%d" % rng.choice([30, 60, 90, 120]),
+                rng.choice(["✅ pass", "⚠️ slow", "❌ **fail**", "`n/a`"]),
+                rng.choice(NOTES),
+            ]
+            rows.append("| **%s** | %s |" % (device, " | ".join(cells)))
+        out.append("\n".join(rows) + "\n")
+    return "\n".join(out)
+
+
+def code_heavy(rng):
+    out = ["# Snippets\n"]
+    n = 0
+    while sum(len(p) for p in out) < TARGET_BYTES:
+        n += 1
+        lang, code = rng.choice(CODE_OTHER + [("tsx", c) for c in CODE_TS])
+        out.append("### Snippet %d: %s\n" % (n, lang))
+        out.append(sentence(rng, PROSE) + "\n")
+        repeat = rng.randint(1, 4)
+        out.append(fenced(lang, "\n\n".join([code] * repeat)) + "\n")
+        if n % 5 == 0:
+            out.append("Indented example:\n\n" + "\n".join("    " + line for line in code.split("\n")) + "\n")
+        if n % 9 == 0:
+            out.append("- In a list:\n\n  " + fenced(lang, code).replace("\n", "\n  ") + "\n")
+    return "\n".join(out)
+
+
+def cjk(rng):
+    out = ["# 多言語ドキュメント\n"]
+    pools = [CJK_JA, CJK_ZH, CJK_KO]
+    n = 0
+    while sum(len(p.encode("utf-8")) for p in out) < TARGET_BYTES:
+        n += 1
+        pool = pools[n % len(pools)]
+        out.append("## %s %d\n" % (["第%d章" % n, "第%d节" % n, "제%d장" % n][n % 3], n))
+        out.append("".join(rng.choice(pool) for _ in range(rng.randint(2, 5))) + "\n")
+        if n % 3 == 0:
+            out.append("\n".join("- " + rng.choice(pool) for _ in range(3)) + "\n")
+        if n % 4 == 0:
+            out.append("> " + rng.choice(pool) + "\n")
+        if n % 5 == 0:
+            out.append("| 項目 | 説明 |\n|------|------|\n| `parse` | %s |\n| `render` | %s |\n" % (
+                rng.choice(pool), rng.choice(pool)))
+    return "\n".join(out)
+
+
+GENERATORS = {
+    "chat_transcript.md": chat_transcript,
+    "tables.md": tables,
+    "code_heavy.md": code_heavy,
+    "cjk.md": cjk,
+}
+
+
+def main():
+    output_dir = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_OUTPUT
+    os.makedirs(output_dir, exist_ok=True)
+    for name, generate in GENERATORS.items():
+        text = generate(random.Random(name))
+        path = os.path.join(output_dir, name)
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(text)
+        print("%s: %d bytes" % (path, len(text.encode("utf-8"))))
+
+
+if __name__ == "__main__":
+    main()
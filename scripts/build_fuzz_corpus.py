@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+#
+# Generates the seed corpus of the fuzz targets, fuzz/corpus/: every example
+# of the CommonMark spec (taken from benchmarks/corpus/commonmark_spec.md)
+# and a few snippets for the extensions the spec does not cover. The first
+# byte of a fuzz input selects the parser options (see fuzz/FuzzInput.h);
+# the spec examples cycle through all 128 combinations of the option bits,
+# the extension snippets enable everything.
+#
+# Usage: scripts/build_fuzz_corpus.py [output-dir]
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SPEC = os.path.join(ROOT, "benchmarks", "corpus", "commonmark_spec.md")
+DEFAULT_OUTPUT = os.path.join(ROOT, "fuzz", "corpus")
+
+ALL_OPTIONS = 0x7F
+
+EXTENSIONS = [
+    "| a | b |\n|:--|--:|\n| *c* | `d` |\n| e |\n",
+    "- [ ] todo\n- [x] done\n  - [X] nested\n",
+    "~~strike~~ and ~single~ and ~~~three~~~\n",
+    "www.example.com, https://example.com/a?b=c. and user@example.com\n",
+    "$inline$ and $$display$$ math, $ not math $\n",
+    "[[Wiki Link]] and [[target|label]] and [[unclosed\n",
+    "> quote\n> - list\n>   ```js\n>   code\n>   ```\n",
+    "1. one\n2. two\n\n   | x |\n   |---|\n   | y |\n",
+]
+
+
+def spec_examples():
+    with open(SPEC, encoding="utf-8") as f:
+        text = f.read()
+    pattern = re.compile(r"^`{32} example\n(.*?)^\.\n.*?^`{32}$", re.S | re.M)
+    return [m.group(1) for m in pattern.finditer(text)]
+
+
+def write(path, options, markdown):
+    with open(path, "wb") as f:
+        f.write(bytes([options]) + markdown.encode("utf-8"))
+
+
+def main():
+    output_dir = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_OUTPUT
+    os.makedirs(output_dir, exist_ok=True)
+    examples = spec_examples()
+    for i, markdown in enumerate(examples):
+        write(os.path.join(output_dir, "spec-%03d" % (i + 1)), i % 128, markdown)
+    for i, markdown in enumerate(EXTENSIONS):
+        write(os.path.join(output_dir, "ext-%02d" % (i + 1)), ALL_OPTIONS, markdown)
+    print("wrote %d seeds to %s" % (len(examples) + len(EXTENSIONS), output_dir))
+
+
+if __name__ == "__main__":
+    main()
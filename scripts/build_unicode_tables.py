@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+#
+# Generates cpp/md4c/md4c-unicode.h, the two-level lookup tables md4c uses to
+# classify codepoints (whitespace, punctuation) and to case-fold them.
+#
+# Input is scripts/unicode_maps.txt, which holds md4c's range maps in their
+# R(min,max)/S(cp) notation. Every codepoint below TABLE_LIMIT gets a 16-bit
+# info word:
+#
+#   bit 0      Unicode whitespace ("Zs")
+#   bit 1      Unicode punctuation ("P" and "S")
+#   bits 2-15  index into MD_UNICODE_FOLD_DATA, 0 meaning "folds to itself"
+#
+# The words are stored in blocks of 2^shift codepoints; identical blocks are
+# shared, so the first level maps (codepoint >> shift) to a block and the
+# second level holds the deduplicated blocks. The shift is picked to make the
+# tables as small as possible.
+#
+# Usage: scripts/build_unicode_tables.py [maps.txt] [output.h]
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_INPUT = os.path.join(ROOT, "scripts", "unicode_maps.txt")
+DEFAULT_OUTPUT = os.path.join(ROOT, "cpp", "md4c", "md4c-unicode.h")
+
+INFO_WHITESPACE = 0x1
+INFO_PUNCT = 0x2
+INFO_FOLD_SHIFT = 2
+MAX_FOLD_ENTRIES = 1 << (16 - INFO_FOLD_SHIFT)
+
+
+def read_maps(path):
+    """Returns {name: [(min, max), ...]} for maps and {name: [cp, ...]} for _DATA."""
+    sections = {}
+    name = None
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            m = re.match(r"^\[(\w+)\]$", line)
+            if m:
+                name = m.group(1)
+                sections[name] = []
+                continue
+            for tok in re.finditer(r"R\((0x[0-9a-fA-F]+),\s*(0x[0-9a-fA-F]+)\)|S\((0x[0-9a-fA-F]+)\)|(0x[0-9a-fA-F]+)", line):
+                if tok.group(1):
+                    sections[name].append(("R", int(tok.group(1), 16), int(tok.group(2), 16)))
+                elif tok.group(3):
+                    sections[name].append(("S", int(tok.group(3), 16)))
+                else:
+                    sections[name].append(("V", int(tok.group(4), 16)))
+    return sections
+
+
+def map_slots(entries):
+    """Flattens a map the way the C array lays it out: a range takes two slots.
+    Returns [(slot_index, min, max), ...]."""
+    slots = []
+    index = 0
+    for e in entries:
+        if e[0] == "R":
+            slots.append((index, e[1], e[2]))
+            index += 2
+        else:
+            slots.append((index, e[1], e[1]))
+            index += 1
+    return slots
+
+
+def build_info(maps, limit):
+    info = [0] * limit
+
+    for _, lo, hi in map_slots(maps["WHITESPACE_MAP"]):
+        for cp in range(lo, hi + 1):
+            info[cp] |= INFO_WHITESPACE
+    for _, lo, hi in map_slots(maps["PUNCT_MAP"]):
+        for cp in range(lo, hi + 1):
+            info[cp] |= INFO_PUNCT
+
+    # Fold entries: (n_codepoints, cp0, cp1, cp2). Single codepoint mappings
+    # are stored as a delta so that whole ranges share one entry.
+    fold_entries = [(1, 0, 0, 0)]
+    fold_index = {fold_entries[0]: 0}
+    folded = set()
+
+    for n in (1, 2, 3):
+        data = [v[1] for v in maps["FOLD_MAP_%d_DATA" % n]]
+        for index, lo, hi in map_slots(maps["FOLD_MAP_%d" % n]):
+            target = data[index * n:index * n + n]
+            for cp in range(lo, hi + 1):
+                if cp in folded:
+                    continue
+                folded.add(cp)
+                mapped = list(target)
+                if cp != lo:
+                    if lo + 1 == target[0]:
+                        # Alternating range: every other codepoint maps to the next one
+                        mapped[0] = cp + (1 if (cp & 1) == (lo & 1) else 0)
+                    else:
+                        # Range to range
+                        mapped[0] = target[0] + (cp - lo)
+                if n == 1:
+                    entry = (1, (mapped[0] - cp) & 0xffffffff, 0, 0)
+                else:
+                    entry = tuple([n] + mapped + [0] * (3 - n))
+                if entry not in fold_index:
+                    fold_index[entry] = len(fold_entries)
+                    fold_entries.append(entry)
+                info[cp] |= fold_index[entry] << INFO_FOLD_SHIFT
+
+    if len(fold_entries) > MAX_FOLD_ENTRIES:
+        sys.exit("too many fold entries: %d" % len(fold_entries))
+    return info, fold_entries
+
+
+def build_trie(info, shift):
+    block_size = 1 << shift
+    blocks = []
+    block_index = {}
+    stage1 = []
+    for start in range(0, len(info), block_size):
+        block = tuple(info[start:start + block_size])
+        if block not in block_index:
+            block_index[block] = len(blocks)
+            blocks.append(block)
+        stage1.append(block_index[block])
+    stage1_type = "unsigned char" if len(blocks) <= 256 else "unsigned short"
+    stage1_bytes = len(stage1) * (1 if len(blocks) <= 256 else 2)
+    size = stage1_bytes + len(blocks) * block_size * 2
+    return stage1, stage1_type, blocks, size
+
+
+def format_array(values, fmt, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt % v for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    input_path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_INPUT
+    output_path = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT
+    maps = read_maps(input_path)
+
+    # Nothing past the last mapped codepoint needs a table entry
+    last = 0
+    for name, entries in maps.items():
+        if not name.endswith("_DATA"):
+            last = max(last, max(hi for _, _, hi in map_slots(entries)))
+    limit = (last | 0xfff) + 1
+
+    info, fold_entries = build_info(maps, limit)
+
+    best = None
+    for shift in range(4, 10):
+        trie = build_trie(info, shift)
+        if best is None or trie[3] < best[1][3]:
+            best = (shift, trie)
+    shift, (stage1, stage1_type, blocks, size) = best
+    stage2 = [v for block in blocks for v in block]
+
+    out = []
+    out.append("/*")
+    out.append(" * Unicode lookup tables for md4c.")
+    out.append(" *")
+    out.append(" * Generated by scripts/build_unicode_tables.py from scripts/unicode_maps.txt,")
+    out.append(" * do not edit. %d bytes of tables, %d shared blocks of %d codepoints." % (size, len(blocks), 1 << shift))
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef MD4C_UNICODE_H")
+    out.append("#define MD4C_UNICODE_H")
+    out.append("")
+    out.append("#define MD_UNICODE_TABLE_LIMIT      0x%x" % limit)
+    out.append("#define MD_UNICODE_BLOCK_SHIFT      %d" % shift)
+    out.append("#define MD_UNICODE_BLOCK_MASK       0x%x" % ((1 << shift) - 1))
+    out.append("")
+    out.append("#define MD_UNICODE_INFO_WHITESPACE  0x%x" % INFO_WHITESPACE)
+    out.append("#define MD_UNICODE_INFO_PUNCT       0x%x" % INFO_PUNCT)
+    out.append("#define MD_UNICODE_INFO_FOLD_SHIFT  %d" % INFO_FOLD_SHIFT)
+    out.append("")
+    out.append("static const %s MD_UNICODE_STAGE1[%d] = {" % (stage1_type, len(stage1)))
+    out.append(format_array(stage1, "%d", 24))
+    out.append("};")
+    out.append("")
+    out.append("static const unsigned short MD_UNICODE_STAGE2[%d] = {" % len(stage2))
+    out.append(format_array(stage2, "0x%04x", 12))
+    out.append("};")
+    out.append("")
+    out.append("/* { n_codepoints, codepoints... }; for n_codepoints == 1 the value is the")
+    out.append(" * (wrapping) delta to add to the codepoint instead. */")
+    out.append("static const unsigned MD_UNICODE_FOLD_DATA[%d][4] = {" % len(fold_entries))
+    out.append(format_array(["{ %d, 0x%x, 0x%x, 0x%x }" % e for e in fold_entries], "%s", 4))
+    out.append("};")
+    out.append("")
+    out.append("#endif  /* MD4C_UNICODE_H */")
+    out.append("")
+
+    with open(output_path, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+    print("%s: %d bytes, shift %d" % (output_path, size, shift))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,80 @@
+// Block manifests for virtualized rendering: decoding of the native
+// manifest, and layout metrics from a theme
+import type { LayoutMetrics, ManifestBlock, NodeType } from './types/ast'
+import type { MarkdownTheme } from './types/theme'
+
+/**
+ * Decode the manifest JSON of `getBlockManifest`
+ * @param json - `{types, blocks}` with six numbers per block
+ * @returns The blocks, with the cumulative `offset` of each
+ */
+export function decodeBlockManifest(json: string): ManifestBlock[] {
+  const { types, blocks } = JSON.parse(json) as {
+    types: string[]
+    blocks: number[]
+  }
+  const result: ManifestBlock[] = []
+  let offset = 0
+  for (let i = 0; i + 5 < blocks.length; i += 6) {
+    const height = blocks[i + 5] ?? 0
+    result.push({
+      type: (types[blocks[i] ?? 0] ?? '') as NodeType,
+      start: blocks[i + 1] ?? 0,
+      end: blocks[i + 2] ?? 0,
+      characters: blocks[i + 3] ?? 0,
+      lines: blocks[i + 4] ?? 0,
+      height,
+      offset,
+    })
+    offset += height
+  }
+  return result
+}
+
+const HEADINGS = [
+  'heading1',
+  'heading2',
+  'heading3',
+  'heading4',
+  'heading5',
+  'heading6',
+] as const
+
+/**
+ * Layout metrics for block heights from the text styles and spacing of a
+ * theme
+ * @param theme - Theme the document is rendered with
+ * @param width - Width of the rendered text
+ */
+export function layoutMetricsFromTheme(
+  theme: MarkdownTheme,
+  width: number
+): LayoutMetrics {
+  const { textStyles, spacing, imageStyles } = theme
+  const fontSize = textStyles.text?.fontSize ?? 16
+  const lineHeight = textStyles.text?.lineHeight ?? fontSize * 1.5
+  const headingFontSizes = HEADINGS.map(
+    (key) => textStyles[key]?.fontSize ?? fontSize
+  )
+  const metrics: LayoutMetrics = {
+    width,
+    fontSize,
+    lineHeight,
+    headingFontSizes,
+    headingLineHeights: HEADINGS.map(
+      (key, i) =>
+        textStyles[key]?.lineHeight ?? (headingFontSizes[i] ?? fontSize) * 1.25
+    ),
+    codeBlockPadding: spacing.codeBlockPadding,
+    blockSpacing: spacing.paragraph,
+  }
+  const codeLineHeight = textStyles.codeBlock?.lineHeight
+  if (codeLineHeight !== undefined) {
+    metrics.codeLineHeight = codeLineHeight
+  }
+  const imageHeight = imageStyles.image?.height
+  if (typeof imageHeight === 'number') {
+    metrics.imageHeight = imageHeight
+  }
+  return metrics
+}
@@ -4,7 +4,15 @@
  * Requires react-syntax-highlighter as a peer dependency
  */
 import React, { useMemo } from 'react'
-import { Text, ScrollView, Platform, View, type TextStyle } from 'react-native'
+import {
+  Text,
+  ScrollView,
+  Platform,
+  View,
+  type TextStyle,
+  type ViewStyle,
+} from 'react-native'
+import { CODE_TOKEN_CLASSES } from '../types/ast'
 
 // Style transformation cache for performance
 const styleCache = new Map<object, TransformedStyleResult>()
@@ -61,6 +69,12 @@ export interface SyntaxHighlighterProps {
   fontSize?: number
   /** Font family for code text */
   fontFamily?: string
+  /**
+   * Syntax tokens from the native parser (`MarkdownNode.tokens`). With
+   * them, the code is styled from the tokens and react-syntax-highlighter
+   * is not run.
+   */
+  tokens?: number[]
 }
 
 /**
@@ -256,6 +270,51 @@ function createNativeElement(
   return null
 }
 
+/**
+ * Create React Native Text elements from native syntax tokens: one Text
+ * per token, styled by the theme's class for it, the text in between
+ * takes the default color
+ */
+function createTokenElements(
+  code: string,
+  tokens: number[],
+  stylesheet: Record<string, Record<string, unknown>>,
+  defaultColor: string,
+  fontFamily: string,
+  fontSize: number
+): React.ReactNode {
+  const baseStyle: TextStyle = {
+    color: defaultColor,
+    fontFamily,
+    fontSize,
+    lineHeight: fontSize + 5,
+  }
+  const classStyles = CODE_TOKEN_CLASSES.map(
+    (name) => createStyleObject([`hljs-${name}`], {}, stylesheet) as TextStyle
+  )
+
+  const segments: React.ReactNode[] = []
+  let last = 0
+  for (let i = 0; i + 2 < tokens.length; i += 3) {
+    const offset = tokens[i] ?? 0
+    const end = offset + (tokens[i + 1] ?? 0)
+    if (offset > last) {
+      segments.push(code.slice(last, offset))
+    }
+    segments.push(
+      <Text key={`code-token-${i}`} style={classStyles[tokens[i + 2] ?? 0]}>
+        {code.slice(offset, end)}
+      </Text>
+    )
+    last = end
+  }
+  if (last < code.length) {
+    segments.push(code.slice(last))
+  }
+
+  return <Text style={baseStyle}>{segments}</Text>
+}
+
 /**
  * Native renderer function for react-syntax-highlighter
  */
@@ -315,6 +374,7 @@ export function SyntaxHighlighter({
   highlighter = 'hljs',
   fontSize = 14,
   fontFamily = Platform.OS === 'ios' ? 'Menlo-Regular' : 'monospace',
+  tokens,
 }: SyntaxHighlighterProps): React.ReactElement | null {
   // Get the highlighter module
   const highlighterModule = getHighlighterModule()
@@ -362,6 +422,26 @@ export function SyntaxHighlighter({
     return generateNewStylesheet(style, highlighter)
   }, [style, highlighter])
 
+  // Natively tokenized code needs no highlighter
+  if (tokens) {
+    const topLevel =
+      highlighter === 'prism'
+        ? transformedStyle['pre[class*="language-"]']
+        : transformedStyle.hljs
+    return (
+      <ScrollView horizontal style={topLevel as ViewStyle | undefined}>
+        {createTokenElements(
+          children,
+          tokens,
+          transformedStyle,
+          defaultColor,
+          fontFamily,
+          fontSize
+        )}
+      </ScrollView>
+    )
+  }
+
   // If react-syntax-highlighter is not available, return fallback
   if (!Highlighter) {
     return (
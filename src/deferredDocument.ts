@@ -0,0 +1,108 @@
+// Two-phase parsing: the block skeleton of a document first, the inline
+// content of its blocks once they are shown
+import { parseInlines, parseMarkdown } from './parser'
+import type { MarkdownNode, ParseResult, ParserOptions } from './types/ast'
+
+/**
+ * A document parsed as a block skeleton, whose `deferred` nodes are parsed
+ * on demand
+ */
+export interface DeferredDocument {
+  /**
+   * Result of the skeleton parse. Resolved content replaces the `deferred`
+   * nodes of `result.nodes` in place, so it is parsed only once.
+   */
+  result: ParseResult
+  /** Number of `deferred` nodes left */
+  pending(): number
+  /**
+   * Parse the content of the `deferred` nodes in a subtree of the skeleton,
+   * in one native call
+   * @param node - Node of the skeleton, e.g. a top-level block about to be
+   * rendered
+   * @returns The same node, without `deferred` nodes
+   */
+  resolve(node: MarkdownNode): MarkdownNode
+}
+
+// Calls `visit` for the nodes of a subtree in preorder, with their parents
+function walk(
+  root: MarkdownNode,
+  visit: (node: MarkdownNode, parent: MarkdownNode | undefined) => void
+): void {
+  const stack: [MarkdownNode, MarkdownNode | undefined][] = [[root, undefined]]
+  while (stack.length > 0) {
+    const [node, parent] = stack.pop()!
+    visit(node, parent)
+    const children = node.children ?? []
+    for (let i = children.length - 1; i >= 0; i--) {
+      stack.push([children[i]!, node])
+    }
+  }
+}
+
+/**
+ * Parse the block structure of a document (`deferInlines`), to render it
+ * before its inline content is parsed
+ * @param content - Markdown string to parse
+ * @param options - Parser options, for the skeleton and the inline content
+ * @returns The skeleton, with `resolve` for the blocks to render
+ */
+export function createDeferredDocument(
+  content: string,
+  options?: ParserOptions
+): DeferredDocument {
+  const result = parseMarkdown(content, { ...options, deferInlines: true })
+  const inlineOptions: ParserOptions = { ...options, deferInlines: false }
+
+  // Index of each deferred node, in document order as parseInlines counts
+  // them, and its parent
+  const placeholders = new Map<
+    MarkdownNode,
+    { index: number; parent: MarkdownNode }
+  >()
+  for (const root of result.nodes) {
+    walk(root, (node, parent) => {
+      if (node.type === 'deferred' && parent) {
+        placeholders.set(node, { index: placeholders.size, parent })
+      }
+    })
+  }
+
+  function resolve(node: MarkdownNode): MarkdownNode {
+    const found: MarkdownNode[] = []
+    walk(node, (child) => {
+      if (placeholders.has(child)) {
+        found.push(child)
+      }
+    })
+    if (found.length === 0) {
+      return node
+    }
+    // The deferred nodes of a subtree are consecutive
+    const first = placeholders.get(found[0]!)!.index
+    const last = placeholders.get(found[found.length - 1]!)!.index
+    const inlines = parseInlines(content, first, last + 1, inlineOptions)
+    if (!inlines.success) {
+      return node
+    }
+    const fetched = inlines.nodes[0]?.children ?? []
+    for (const placeholder of found) {
+      const { index, parent } = placeholders.get(placeholder)!
+      const siblings = parent.children ?? []
+      const position = siblings.indexOf(placeholder)
+      if (position >= 0) {
+        const resolved = fetched[index - first]?.children ?? []
+        siblings.splice(position, 1, ...resolved)
+      }
+      placeholders.delete(placeholder)
+    }
+    return node
+  }
+
+  return {
+    result,
+    pending: () => placeholders.size,
+    resolve,
+  }
+}
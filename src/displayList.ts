@@ -0,0 +1,97 @@
+// Decoding of the flat display list the native parser returns with
+// `displayList`
+import { DISPLAY_LIST_FIELDS as F } from './types/ast'
+import type {
+  DisplayList,
+  MarkdownNode,
+  NodeType,
+  SourcePoint,
+  TableCellAlign,
+  TextRunLink,
+} from './types/ast'
+
+const ALIGNMENTS: TableCellAlign[] = ['default', 'left', 'center', 'right']
+
+/**
+ * Rebuild the node tree of a display list, in one pass over its records
+ * @param list - Display list from a parse with `displayList`
+ * @returns The top-level nodes
+ */
+export function decodeDisplayList(list: DisplayList): MarkdownNode[] {
+  const { ops, strings } = list
+  const roots: MarkdownNode[] = []
+  // The last node at each depth, i.e. the open ancestors of the next record
+  const open: Array<MarkdownNode | null> = []
+  let i = 0
+  const next = (): number => ops[i++] ?? 0
+  const string = (): string => strings[next()] ?? ''
+  const numbers = (): number[] => {
+    const count = next()
+    i += count
+    return ops.slice(i - count, i)
+  }
+
+  while (i < ops.length) {
+    const depth = next()
+    const type = next()
+    const fields = next()
+    open.length = depth
+    if (type < 0) {
+      // A null node: nothing to render, but it keeps its depth
+      open.push(null)
+      continue
+    }
+
+    const node: MarkdownNode = { type: (strings[type] ?? '') as NodeType }
+    if (fields & F.content) node.content = string()
+    if (fields & F.level) node.level = next()
+    if (fields & F.href) node.href = string()
+    if (fields & F.src) node.src = string()
+    if (fields & F.alt) node.alt = string()
+    if (fields & F.title) node.title = string()
+    if (fields & F.language) node.language = string()
+    if (fields & F.tokens) node.tokens = numbers()
+    if (fields & F.runs) node.runs = numbers()
+    if (fields & F.links) {
+      const links: TextRunLink[] = []
+      for (let count = next(); count > 0; count--) {
+        const mask = next()
+        const link: TextRunLink = {}
+        if (mask & 1) link.href = string()
+        if (mask & 2) link.src = string()
+        if (mask & 4) link.title = string()
+        links.push(link)
+      }
+      node.links = links
+    }
+    if (fields & F.ordered) node.ordered = next() !== 0
+    if (fields & F.start) node.start = next()
+    if (fields & F.checked) node.checked = next() !== 0
+    if (fields & F.align) node.align = ALIGNMENTS[next()] ?? 'default'
+    if (fields & F.isHeader) node.isHeader = next() !== 0
+    if (fields & F.position) {
+      const start: SourcePoint = { line: 0, column: 0, offset: next() }
+      const end: SourcePoint = { line: 0, column: 0, offset: next() }
+      if (fields & F.location) {
+        start.line = next()
+        start.column = next()
+        end.line = next()
+        end.column = next()
+      }
+      node.position = { start, end }
+    }
+
+    const parent = depth > 0 ? open[depth - 1] : undefined
+    if (parent === undefined) {
+      roots.push(node)
+    } else if (parent) {
+      if (parent.children) {
+        parent.children.push(node)
+      } else {
+        parent.children = [node]
+      }
+    }
+    open.push(node)
+  }
+  return roots
+}
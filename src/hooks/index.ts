@@ -1,7 +1,14 @@
 // Hooks for react-native-hyper-markdown
 import { useMemo, useState, useEffect, useRef } from 'react'
+import { createIncrementalParser } from '../incrementalParser'
 import { parseMarkdown } from '../parser'
-import type { MarkdownNode, ParseResult, ParserOptions } from '../types/ast'
+import { createSearchIndex } from '../searchIndex'
+import type {
+  MarkdownNode,
+  ParseResult,
+  ParserOptions,
+  SearchMatch,
+} from '../types/ast'
 
 /**
  * Hook to parse markdown and memoize the result
@@ -58,6 +65,85 @@ export function useDebouncedParsing(
   return result
 }
 
+/**
+ * Hook for parsing a long document in steps, one per frame, so that it
+ * does not block the JS thread for the whole parse. Until the parse is
+ * done, the result is a document node with the top-level blocks parsed so
+ * far; rendering can start with the first of them.
+ * @param content - Markdown content to parse
+ * @param options - Parser options
+ * @param budgetMs - Parse time per frame in milliseconds (default: 8)
+ * @returns Parse result, and whether the parse is done
+ */
+export function useIncrementalParsing(
+  content: string,
+  options?: ParserOptions,
+  budgetMs: number = 8
+): { result: ParseResult; done: boolean } {
+  const [state, setState] = useState<{ result: ParseResult; done: boolean }>(
+    () => ({
+      result: { success: true, nodes: [{ type: 'document', children: [] }] },
+      done: false,
+    })
+  )
+
+  useEffect(() => {
+    const parser = createIncrementalParser(content, options)
+    let frame: ReturnType<typeof requestAnimationFrame> | null = null
+    let shown = -1
+
+    const step = () => {
+      const result = parser.step(budgetMs)
+      if (result) {
+        setState({ result, done: true })
+        return
+      }
+      // Render again only when the step added blocks
+      if (parser.blocks.length !== shown) {
+        shown = parser.blocks.length
+        setState({
+          result: {
+            success: true,
+            nodes: [{ type: 'document', children: parser.blocks.slice() }],
+          },
+          done: false,
+        })
+      }
+      frame = requestAnimationFrame(step)
+    }
+    frame = requestAnimationFrame(step)
+
+    // Stop stepping on unmount or content change
+    return () => {
+      if (frame !== null) {
+        cancelAnimationFrame(frame)
+      }
+    }
+  }, [content, options, budgetMs])
+
+  return state
+}
+
+/**
+ * Hook for find-in-document: the content is indexed natively once, and
+ * each new query is a single native search, without walking the tree
+ * @param content - Markdown content to search
+ * @param query - Text to find, or several texts; nothing when empty
+ * @param options - Parser options, the same as for rendering the content
+ * @returns The matches in document order, mapped to their text nodes
+ */
+export function useDocumentSearch(
+  content: string,
+  query: string | string[],
+  options?: ParserOptions
+): SearchMatch[] {
+  const index = useMemo(
+    () => createSearchIndex(content, options),
+    [content, options]
+  )
+  return useMemo(() => index.search(query), [index, query])
+}
+
 /**
  * Hook to get just the parsed AST nodes
  * Convenience wrapper around useMarkdown
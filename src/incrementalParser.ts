@@ -0,0 +1,102 @@
+// Incremental parsing: a document parsed in steps of a time budget, its
+// top-level blocks available as they complete
+import { getNativeModule } from './parser'
+import type {
+  IncrementalParser as IncrementalParserSpec,
+} from './specs/hyper-markdown.nitro'
+import type { MarkdownNode, ParseResult, ParserOptions } from './types/ast'
+
+/**
+ * A parse of a document in steps, for documents that take longer to parse
+ * than a frame
+ */
+export interface IncrementalParse {
+  /** Top-level blocks parsed so far, in document order */
+  readonly blocks: MarkdownNode[]
+  /** Whether the parse is over, done or failed */
+  readonly done: boolean
+  /**
+   * Parse for about `budgetMs` milliseconds, at least a chunk of the
+   * document. The first steps of a document analyze its block structure
+   * and add no blocks.
+   * @param budgetMs - Time budget of the step
+   * @returns The result once the parse is over, the same as
+   * `parseMarkdown`'s; undefined while the document is not fully parsed
+   */
+  step(budgetMs: number): ParseResult | undefined
+}
+
+/**
+ * Start parsing a document in steps, e.g. one per frame, so that a long
+ * document does not block the JS thread for the whole parse
+ * @param content - Markdown string to parse
+ * @param options - Parser options; `collectTimings` and `displayList` do
+ * not apply
+ * @returns The parse, advanced by `step`
+ */
+export function createIncrementalParser(
+  content: string,
+  options?: ParserOptions
+): IncrementalParse {
+  const blocks: MarkdownNode[] = []
+  let result: ParseResult | undefined
+  let parser: IncrementalParserSpec | undefined
+
+  const fail = (error: unknown): ParseResult => ({
+    success: false,
+    nodes: [],
+    error: {
+      message:
+        error instanceof Error ? error.message : 'Failed to parse markdown',
+    },
+  })
+
+  try {
+    parser = getNativeModule().createIncrementalParser(content, options)
+  } catch (error) {
+    result = fail(error)
+  }
+
+  function step(budgetMs: number): ParseResult | undefined {
+    if (result || !parser) {
+      return result
+    }
+    try {
+      const next = parser.step(budgetMs)
+      if (!next.success) {
+        result = {
+          success: false,
+          nodes: [],
+          error: {
+            message: next.errorMessage ?? 'Unknown parse error',
+            line: next.errorLine,
+            column: next.errorColumn,
+          },
+        }
+        return result
+      }
+      const parsed: MarkdownNode[] = JSON.parse(next.blocks)
+      for (const block of parsed) {
+        blocks.push(block)
+      }
+      if (next.done && next.document) {
+        const document: MarkdownNode = JSON.parse(next.document)
+        if (blocks.length > 0) {
+          document.children = blocks
+        }
+        result = { success: true, nodes: [document] }
+      }
+    } catch (error) {
+      result = fail(error)
+    }
+    return result
+  }
+
+  return {
+    blocks,
+    get done() {
+      return result !== undefined
+    },
+    step,
+  }
+}
@@ -5,12 +5,33 @@
 export { MarkdownView, type MarkdownViewProps } from './MarkdownView'
 
 // Parser
-export { parseMarkdown, getNativeModule } from './parser'
+export {
+  parseMarkdown,
+  getBlockManifest,
+  getBlocks,
+  parseInlines,
+  extractResources,
+  toPlainText,
+  getNativeModule,
+} from './parser'
+export { decodeDisplayList } from './displayList'
+export { decodeBlockManifest, layoutMetricsFromTheme } from './blockManifest'
+export {
+  createDeferredDocument,
+  type DeferredDocument,
+} from './deferredDocument'
+export {
+  createIncrementalParser,
+  type IncrementalParse,
+} from './incrementalParser'
+export { createSearchIndex, type DocumentSearch } from './searchIndex'
 
 // Hooks
 export {
   useMarkdown,
   useDebouncedParsing,
+  useIncrementalParsing,
+  useDocumentSearch,
   useMarkdownAST,
   useMarkdownTheme,
 } from './hooks'
@@ -20,13 +41,34 @@ export { ThemeProvider, type ThemeProviderProps } from './context/ThemeContext'
 export { lightTheme, darkTheme } from './themes'
 
 // Types
+export {
+  CODE_TOKEN_CLASSES,
+  TEXT_RUN_STYLES,
+  DISPLAY_LIST_FIELDS,
+} from './types/ast'
 export type {
   MarkdownNode,
+  CodeTokenClass,
+  TextRunLink,
+  DisplayList,
+  LayoutMetrics,
+  ManifestBlock,
+  BlockManifest,
+  DocumentResource,
+  DocumentResources,
   NodeType,
   TableCellAlign,
+  HeadingEntry,
   ParseResult,
   ParseError,
+  SearchMatch,
+  SearchSegment,
   ParserOptions,
+  ParseTimings,
+  ParseMemory,
+  ParseMemoryUsage,
+  SourcePoint,
+  SourcePosition,
 } from './types/ast'
 
 export type {
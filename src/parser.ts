@@ -1,12 +1,67 @@
 // parseMarkdown wrapper function
 import { NitroModules } from 'react-native-nitro-modules'
-import type { HyperMarkdown as HyperMarkdownSpec } from './specs/hyper-markdown.nitro'
-import type { MarkdownNode, ParseResult, ParserOptions } from './types/ast'
+import type {
+  HyperMarkdown as HyperMarkdownSpec,
+  ParseResultNative,
+} from './specs/hyper-markdown.nitro'
+import { decodeBlockManifest } from './blockManifest'
+import { decodeDisplayList } from './displayList'
+import type {
+  BlockManifest,
+  DocumentResources,
+  LayoutMetrics,
+  MarkdownNode,
+  ParseResult,
+  ParserOptions,
+} from './types/ast'
 
 // Create the native HyperMarkdown module
 const HyperMarkdown =
   NitroModules.createHybridObject<HyperMarkdownSpec>('HyperMarkdown')
 
+// The error of a failed call
+function failure(error: unknown, fallback: string): { message: string } {
+  return { message: error instanceof Error ? error.message : fallback }
+}
+
+// Converts a native parse result, decoding its AST
+function toParseResult(
+  result: ParseResultNative,
+  options?: ParserOptions
+): ParseResult {
+  if (!result.success) {
+    return {
+      success: false,
+      nodes: [],
+      error: {
+        message: result.errorMessage ?? 'Unknown parse error',
+        line: result.errorLine,
+        column: result.errorColumn,
+      },
+    }
+  }
+
+  // Parse the JSON AST string, or rebuild the tree from the display list
+  const nodes: MarkdownNode[] = options?.displayList
+    ? decodeDisplayList(JSON.parse(result.ast))
+    : JSON.parse(result.ast)
+
+  const parsed: ParseResult = {
+    success: true,
+    nodes,
+  }
+  if (result.timings) {
+    parsed.timings = result.timings
+  }
+  if (result.memory) {
+    parsed.memory = result.memory
+  }
+  if (result.headings) {
+    parsed.headings = JSON.parse(result.headings)
+  }
+  return parsed
+}
+
 /**
  * Parse markdown content into an AST
  * @param content - Markdown string to parse
@@ -18,39 +73,173 @@ export function parseMarkdown(
   options?: ParserOptions
 ): ParseResult {
   try {
-    const result = HyperMarkdown.parse(content, options)
+    return toParseResult(HyperMarkdown.parse(content, options), options)
+  } catch (error) {
+    return {
+      success: false,
+      nodes: [],
+      error: failure(error, 'Failed to parse markdown'),
+    }
+  }
+}
 
+/**
+ * List the top-level blocks of a document with estimated heights, from
+ * the native block analysis alone: no inline parsing and no AST. Meant for
+ * virtualized lists over long documents, with `getBlocks` for the AST of
+ * the visible blocks.
+ * @param content - Markdown string
+ * @param metrics - Theme metrics for the heights, see `layoutMetricsFromTheme`
+ * @param options - Parser options; only the syntax flags, `maxInputSize`
+ * and `normalizeInput` apply
+ * @returns The blocks in document order
+ */
+export function getBlockManifest(
+  content: string,
+  metrics: LayoutMetrics,
+  options?: ParserOptions
+): BlockManifest {
+  try {
+    const result = HyperMarkdown.getBlockManifest(content, metrics, options)
     if (!result.success) {
       return {
         success: false,
-        nodes: [],
-        error: {
-          message: result.errorMessage ?? 'Unknown parse error',
-          line: result.errorLine,
-          column: result.errorColumn,
-        },
+        blocks: [],
+        error: { message: result.errorMessage ?? 'Unknown parse error' },
       }
     }
+    return { success: true, blocks: decodeBlockManifest(result.manifest) }
+  } catch (error) {
+    return {
+      success: false,
+      blocks: [],
+      error: failure(error, 'Failed to analyze markdown'),
+    }
+  }
+}
 
-    // Parse the JSON AST string
-    const nodes: MarkdownNode[] = JSON.parse(result.ast)
-
+/**
+ * Parse markdown content, building the AST of some top-level blocks only:
+ * the document node gets the blocks [start, end) of the block manifest as
+ * its children. Source positions stay offsets into the whole content.
+ * @param content - Markdown string, the same as for the manifest
+ * @param start - Index of the first block
+ * @param end - Index after the last block
+ * @param options - Parser options, the same syntax flags as for the manifest
+ * @returns ParseResult with AST nodes or error
+ */
+export function getBlocks(
+  content: string,
+  start: number,
+  end: number,
+  options?: ParserOptions
+): ParseResult {
+  try {
+    return toParseResult(
+      HyperMarkdown.getBlocks(content, start, end, options),
+      options
+    )
+  } catch (error) {
     return {
-      success: true,
-      nodes,
+      success: false,
+      nodes: [],
+      error: failure(error, 'Failed to parse markdown'),
     }
+  }
+}
+
+/**
+ * Parse the inline content of some leaves of a skeleton parsed with
+ * `deferInlines`: the document node gets one `deferred` node for each of
+ * the skeleton's `deferred` nodes [start, end), in document order, holding
+ * the nodes it stands for. See `createDeferredDocument` for a cache over it.
+ * @param content - Markdown string, the same as for the skeleton
+ * @param start - Index of the first deferred node
+ * @param end - Index after the last deferred node
+ * @param options - Parser options, the same syntax flags as for the skeleton
+ * @returns ParseResult with AST nodes or error
+ */
+export function parseInlines(
+  content: string,
+  start: number,
+  end: number,
+  options?: ParserOptions
+): ParseResult {
+  try {
+    return toParseResult(
+      HyperMarkdown.parseInlines(content, start, end, options),
+      options
+    )
   } catch (error) {
     return {
       success: false,
       nodes: [],
-      error: {
-        message:
-          error instanceof Error ? error.message : 'Failed to parse markdown',
-      },
+      error: failure(error, 'Failed to parse markdown'),
     }
   }
 }
 
+/**
+ * List the images and links of each of a batch of documents, with their
+ * source offsets, without building or transferring an AST: for prefetching
+ * images ahead of rendering. Code and HTML blocks, and the paragraphs
+ * without a link, are not analyzed.
+ * @param contents - Markdown strings
+ * @param options - Parser options; only the syntax flags, `maxInputSize`
+ * and `normalizeInput` apply
+ * @returns One entry per document, in the order of `contents`
+ */
+export function extractResources(
+  contents: string[],
+  options?: ParserOptions
+): DocumentResources[] {
+  let documents: Array<{
+    success: boolean
+    resources: DocumentResources['resources']
+    error?: string
+  }>
+  try {
+    documents = JSON.parse(HyperMarkdown.extractResources(contents, options))
+  } catch (error) {
+    const message = failure(error, 'Failed to extract resources')
+    return contents.map(() => ({
+      success: false,
+      resources: [],
+      error: message,
+    }))
+  }
+  return documents.map(({ success, resources, error }) =>
+    error === undefined
+      ? { success, resources }
+      : { success, resources, error: { message: error } }
+  )
+}
+
+/**
+ * Get the rendered text of markdown content, for previews and accessibility
+ * labels, without building or transferring an AST: soft breaks as spaces,
+ * a newline between blocks, images as their alt text, no raw HTML. Parsing
+ * stops as soon as the text is `maxChars` long.
+ * @param content - Markdown string
+ * @param maxChars - Maximum length of the text, in UTF-16 code units as
+ * for `string.length` (default: all of it)
+ * @param options - Parser options; only the syntax flags, `maxInputSize`
+ * and `normalizeInput` apply
+ * @returns The text, cut at a character boundary; empty if the content
+ * could not be parsed
+ */
+export function toPlainText(
+  content: string,
+  maxChars?: number,
+  options?: ParserOptions
+): string {
+  try {
+    return HyperMarkdown.toPlainText(content, maxChars, options)
+  } catch {
+    return ''
+  }
+}
+
 /**
  * Get the native HyperMarkdown module for direct access
  */
@@ -1,15 +1,132 @@
 // Default renderers for react-native-hyper-markdown
 import React from 'react'
 import { Text, View, Image as RNImage, Pressable } from 'react-native'
-import type { MarkdownNode } from '../types/ast'
+import type { TextStyle } from 'react-native'
+import { TEXT_RUN_STYLES } from '../types/ast'
+import type { MarkdownNode, TextRunLink } from '../types/ast'
 import type { RenderContext, RendererFn } from '../types/renderers'
 
+// Theme styles of the style bits of a text run
+function runStyle(styles: number, ctx: RenderContext): TextStyle[] {
+  const { textStyles } = ctx.theme
+  const bits: [number, TextStyle | undefined][] = [
+    [TEXT_RUN_STYLES.strong, textStyles.strong],
+    [TEXT_RUN_STYLES.emphasis, textStyles.emphasis],
+    [TEXT_RUN_STYLES.strikethrough, textStyles.strikethrough],
+    [TEXT_RUN_STYLES.code, textStyles.codeInline],
+    [TEXT_RUN_STYLES.link, textStyles.link],
+    [TEXT_RUN_STYLES.underline, { textDecorationLine: 'underline' }],
+  ]
+  return bits.flatMap(([bit, style]) => (styles & bit && style ? [style] : []))
+}
+
+// The image node of an image run, whose text is the alt text
+function runImage(link: TextRunLink | undefined, alt: string): MarkdownNode {
+  return {
+    type: 'image',
+    src: link?.src,
+    alt: alt || undefined,
+    title: link?.title,
+  }
+}
+
+function hasImageRun(runs: number[]): boolean {
+  for (let i = 1; i < runs.length; i += 3) {
+    if ((runs[i] ?? 0) & TEXT_RUN_STYLES.image) {
+      return true
+    }
+  }
+  return false
+}
+
+// Text runs (textRuns): one Text per styled run, siblings inside the
+// parent's Text, instead of a Text per span nested as deep as the spans
+function renderRuns(
+  node: MarkdownNode,
+  key: string | number,
+  ctx: RenderContext
+): React.ReactNode[] {
+  const content = node.content ?? ''
+  const runs = node.runs ?? []
+  const elements: React.ReactNode[] = []
+  let offset = 0
+  for (let i = 0; i + 2 < runs.length; i += 3) {
+    const length = runs[i] ?? 0
+    const styles = runs[i + 1] ?? 0
+    const link = node.links?.[runs[i + 2] ?? -1]
+    const text = content.slice(offset, offset + length)
+    const runKey = `${key}-${i / 3}`
+    offset += length
+
+    if (styles & TEXT_RUN_STYLES.image) {
+      elements.push(ctx.renderNode(runImage(link, text), runKey))
+    } else if (styles === 0) {
+      elements.push(text)
+    } else if (styles & TEXT_RUN_STYLES.link && link?.href) {
+      const href = link.href
+      elements.push(
+        <Text
+          key={runKey}
+          style={runStyle(styles, ctx)}
+          accessibilityRole="link"
+          onPress={() => ctx.onLinkPress?.(href, link.title)}
+        >
+          {text}
+        </Text>
+      )
+    } else {
+      elements.push(
+        <Text key={runKey} style={runStyle(styles, ctx)}>
+          {text}
+        </Text>
+      )
+    }
+  }
+  return elements
+}
+
+// Splits a text node with image runs into text and image nodes, for
+// layouts that keep images out of Text
+function splitImageRuns(node: MarkdownNode): MarkdownNode[] {
+  const runs = node.runs
+  if (!runs || !hasImageRun(runs)) {
+    return [node]
+  }
+  const parts: MarkdownNode[] = []
+  const content = node.content ?? ''
+  let text: MarkdownNode | undefined
+  let offset = 0
+  for (let i = 0; i + 2 < runs.length; i += 3) {
+    const length = runs[i] ?? 0
+    const styles = runs[i + 1] ?? 0
+    const linkIndex = runs[i + 2] ?? -1
+    const slice = content.slice(offset, offset + length)
+    offset += length
+
+    if (styles & TEXT_RUN_STYLES.image) {
+      parts.push(runImage(node.links?.[linkIndex], slice))
+      text = undefined
+      continue
+    }
+    if (!text) {
+      text = { type: 'text', content: '', runs: [], links: node.links }
+      parts.push(text)
+    }
+    text.content = (text.content ?? '') + slice
+    text.runs?.push(length, styles, linkIndex)
+  }
+  return parts
+}
+
 // Text node renderer
 export function renderText(
   node: MarkdownNode,
-  _key: string | number,
-  _ctx: RenderContext
+  key: string | number,
+  ctx: RenderContext
 ): React.ReactNode {
+  if (node.runs) {
+    return renderRuns(node, key, ctx)
+  }
   return node.content ?? ''
 }
 
@@ -81,16 +198,15 @@ export function renderParagraph(
   ctx: RenderContext
 ): React.ReactNode {
   // Check if paragraph contains block-level elements (like images)
-  // that can't be nested inside Text
-  const hasBlockChildren = node.children?.some(
-    (child) => child.type === 'image'
-  )
+  // that can't be nested inside Text; with text runs, images are runs
+  const children = node.children?.flatMap(splitImageRuns)
+  const hasBlockChildren = children?.some((child) => child.type === 'image')
 
   if (hasBlockChildren) {
     // For paragraphs with images, render as View with Text wrapper for inline content
     return (
       <View key={key} style={ctx.theme.containerStyles.paragraph}>
-        {node.children?.map((child, i) => {
+        {children?.map((child, i) => {
           if (child.type === 'image') {
             return ctx.renderNode(child, `${key}-${i}`)
           }
@@ -235,7 +351,9 @@ export function renderCodeBlock(
         isSyntaxHighlightingAvailable,
       } = require('../components/SyntaxHighlighter')
 
-      if (isSyntaxHighlightingAvailable()) {
+      // Tokens from the native parser (highlightCode) render without
+      // react-syntax-highlighter
+      if (node.tokens || isSyntaxHighlightingAvailable()) {
         return (
           <View
             key={key}
@@ -248,6 +366,7 @@ export function renderCodeBlock(
               highlighter={syntaxOptions?.highlighter}
               fontSize={syntaxOptions?.fontSize}
               fontFamily={syntaxOptions?.fontFamily}
+              tokens={node.tokens}
             >
               {code}
             </SyntaxHighlighter>
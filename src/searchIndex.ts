@@ -0,0 +1,57 @@
+// Find-in-document: the rendered text of a document indexed natively once,
+// searched on every keystroke
+import { getNativeModule } from './parser'
+import type {
+  SearchIndex as SearchIndexSpec,
+} from './specs/hyper-markdown.nitro'
+import type { ParserOptions, SearchMatch } from './types/ast'
+
+/**
+ * The rendered text of a document, to find text in: the content of its
+ * text nodes, with a space for each line break
+ */
+export interface DocumentSearch {
+  /**
+   * Find all of the patterns at once, ignoring case (with Unicode case
+   * folding). A match may span the inline nodes of a block, not two
+   * blocks; matches of the same pattern do not overlap.
+   * @param patterns - Text to find, or several texts
+   * @param maxMatches - Stop after this many matches (default: all)
+   * @returns The matches in document order, each mapped to the text nodes
+   * it covers, empty if the document could not be parsed
+   */
+  search(patterns: string | string[], maxMatches?: number): SearchMatch[]
+}
+
+/**
+ * Index a document for find-in-document. The paths of the matches are
+ * those of the nodes `parseMarkdown` returns with the same options.
+ * @param content - Markdown string
+ * @param options - Parser options; `deferInlines` and `headingsOnly` do
+ * not apply
+ */
+export function createSearchIndex(
+  content: string,
+  options?: ParserOptions
+): DocumentSearch {
+  let index: SearchIndexSpec | undefined
+  try {
+    index = getNativeModule().createSearchIndex(content, options)
+  } catch {
+    index = undefined
+  }
+
+  return {
+    search(patterns, maxMatches) {
+      if (!index) {
+        return []
+      }
+      const list = typeof patterns === 'string' ? [patterns] : patterns
+      try {
+        return JSON.parse(index.search(list, maxMatches))
+      } catch {
+        return []
+      }
+    },
+  }
+}
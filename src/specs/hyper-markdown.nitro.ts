@@ -20,22 +20,162 @@ export interface ParserOptions {
   maxInputSize?: number
   // Parse timeout in milliseconds (default: 5000)
   timeout?: number
+  // Return a per-phase timing breakdown with the result (default: false)
+  collectTimings?: boolean
+  // Return memory usage statistics with the result (default: false)
+  collectMemory?: boolean
+  // Abort the parse once it would need more memory, in bytes (default: unlimited)
+  maxMemory?: number
+  // Add the source range of every node to the AST (default: false)
+  sourcePositions?: boolean
+  // Replace invalid UTF-8 and NULs with U+FFFD, CRLF and CR with LF (default: false)
+  normalizeInput?: boolean
+  // Add syntax tokens to code blocks of supported languages (default: false)
+  highlightCode?: boolean
+  // Flatten the inline content of a block into one text node with styled runs (default: false)
+  textRuns?: boolean
+  // Return the AST as a flat display list instead of a nested tree (default: false)
+  displayList?: boolean
+  // Parse the block structure only, with a "deferred" node in place of inline content (default: false)
+  deferInlines?: boolean
+  // Return the headings of the document with their text, slug and path (default: false)
+  collectHeadings?: boolean
+  // Return the headings only, without building the AST (default: false)
+  headingsOnly?: boolean
+}
+
+// Per-phase timing breakdown of a parse, in milliseconds
+export interface ParseTimings {
+  // md4c block analysis, including link reference definitions
+  blockMs: number
+  // md4c inline analysis and callback dispatch
+  inlineMs: number
+  // Building the native node tree
+  treeMs: number
+  // Serializing the tree to JSON
+  serializeMs: number
+  // Total native time of the parse call
+  totalMs: number
+  // Size of the input in bytes
+  inputBytes: number
+  // Number of nodes in the tree
+  nodeCount: number
+  // Size of the JSON AST in bytes
+  outputBytes: number
+}
+
+// Allocations of one kind of memory used by a parse
+export interface ParseMemoryUsage {
+  // Number of allocations
+  allocations: number
+  // Total bytes allocated
+  bytesAllocated: number
+  // Peak of the live bytes
+  peakBytes: number
+}
+
+// Memory used by a parse
+export interface ParseMemory {
+  // md4c's scratch memory, and the normalized input with normalizeInput
+  md4c: ParseMemoryUsage
+  // The native node tree
+  ast: ParseMemoryUsage
+  // The serialized JSON AST
+  output: ParseMemoryUsage
+  // Peak of all live bytes together
+  peakBytes: number
 }
 
 // Parse result returned from native
 export interface ParseResultNative {
   // Whether parsing succeeded
   success: boolean
-  // JSON-encoded AST (parsed on JS side to avoid recursive type issues)
+  // JSON-encoded AST (parsed on JS side to avoid recursive type issues), or
+  // the JSON-encoded display list with displayList
   ast: string
   // Error message if parsing failed
   errorMessage?: string
   // Error line number
   errorLine?: number
-  // Error column number
+  // Error column number, in UTF-16 code units
+  errorColumn?: number
+  // Timing breakdown, present when collectTimings was set
+  timings?: ParseTimings
+  // Memory usage, present when collectMemory was set
+  memory?: ParseMemory
+  // JSON-encoded heading index, present with collectHeadings or headingsOnly
+  headings?: string
+}
+
+// Theme metrics block heights are estimated from, in points
+export interface LayoutMetrics {
+  // Width of the rendered text
+  width: number
+  // Body font size and line height
+  fontSize: number
+  lineHeight: number
+  // Font sizes and line heights of heading levels 1 to 6
+  headingFontSizes?: number[]
+  headingLineHeights?: number[]
+  // Line height of code blocks, whose lines do not wrap (default: 20)
+  codeLineHeight?: number
+  // Padding above and below the code of a code block (default: 16)
+  codeBlockPadding?: number
+  // Space below every top-level block (default: 16)
+  blockSpacing?: number
+  // Height of an image (default: 200)
+  imageHeight?: number
+  // Average advance of a character, in ems (default: 0.55)
+  charWidth?: number
+}
+
+// Block manifest returned from native
+export interface BlockManifestNative {
+  // Whether the block analysis succeeded
+  success: boolean
+  // JSON-encoded {types, blocks}: the block types, then per block the
+  // index of its type, start, end, characters, lines and height
+  manifest: string
+  // Error message if the analysis failed
+  errorMessage?: string
+}
+
+// One step of an incremental parse
+export interface ParseStepNative {
+  // Whether the step succeeded
+  success: boolean
+  // Whether the whole document is parsed
+  done: boolean
+  // JSON-encoded array of the top-level blocks completed in the step
+  blocks: string
+  // JSON-encoded document node without children, once done
+  document?: string
+  // Error message if parsing failed
+  errorMessage?: string
+  // Error line number
+  errorLine?: number
+  // Error column number, in UTF-16 code units
   errorColumn?: number
 }
 
+// A parse of a document in steps
+export interface IncrementalParser extends HybridObject<{
+  ios: 'c++'
+  android: 'c++'
+}> {
+  // Parse for about budgetMs, returning the top-level blocks completed
+  step(budgetMs: number): ParseStepNative
+}
+
+// Find-in-document over the rendered text of a parsed document
+export interface SearchIndex extends HybridObject<{
+  ios: 'c++'
+  android: 'c++'
+}> {
+  // JSON-encoded matches of any of the patterns, case-insensitive
+  search(patterns: string[], maxMatches?: number): string
+}
+
 // HyperMarkdown native module interface
 export interface HyperMarkdown extends HybridObject<{
   ios: 'c++'
@@ -43,4 +183,39 @@ export interface HyperMarkdown extends HybridObject<{
 }> {
   // Parse markdown content into AST (returns JSON string for recursive structure)
   parse(content: string, options?: ParserOptions): ParseResultNative
+  // Top-level blocks with estimated heights, from the block analysis only
+  getBlockManifest(
+    content: string,
+    metrics: LayoutMetrics,
+    options?: ParserOptions
+  ): BlockManifestNative
+  // Parse, building the AST of the top-level blocks [start, end) only
+  getBlocks(
+    content: string,
+    start: number,
+    end: number,
+    options?: ParserOptions
+  ): ParseResultNative
+  // Parse the inline content of the deferred nodes [start, end) of a skeleton
+  parseInlines(
+    content: string,
+    start: number,
+    end: number,
+    options?: ParserOptions
+  ): ParseResultNative
+  // Start parsing the content in steps of a time budget
+  createIncrementalParser(
+    content: string,
+    options?: ParserOptions
+  ): IncrementalParser
+  // Index the rendered text of the content for find-in-document
+  createSearchIndex(content: string, options?: ParserOptions): SearchIndex
+  // Images and links of each of the contents, without an AST, as JSON
+  extractResources(contents: string[], options?: ParserOptions): string
+  // Rendered text of the content, up to maxChars UTF-16 code units
+  toPlainText(
+    content: string,
+    maxChars?: number,
+    options?: ParserOptions
+  ): string
 }
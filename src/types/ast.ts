@@ -34,12 +34,124 @@ export type NodeType =
   | 'html_block'
   | 'html_inline'
   | 'underline'
+  | 'deferred'
 
 /**
  * Table cell alignment
  */
 export type TableCellAlign = 'left' | 'center' | 'right' | 'default'
 
+/**
+ * A point in the parsed input. Lines and columns are 1-based; columns count
+ * UTF-16 code units like JS strings do, offsets count UTF-8 bytes.
+ */
+export interface SourcePoint {
+  line: number
+  column: number
+  offset: number
+}
+
+/**
+ * Range of a node in the parsed input, the end is exclusive
+ */
+export interface SourcePosition {
+  start: SourcePoint
+  end: SourcePoint
+}
+
+/**
+ * Classes of native code tokens, indexed by the class number in
+ * `MarkdownNode.tokens`. The names are highlight.js classes, so the
+ * `hljs-*` styles of a syntax theme apply to them.
+ */
+export const CODE_TOKEN_CLASSES = [
+  'keyword',
+  'string',
+  'comment',
+  'number',
+  'literal',
+  'built_in',
+  'type',
+  'title',
+  'attr',
+  'meta',
+  'variable',
+  'addition',
+  'deletion',
+] as const
+
+export type CodeTokenClass = (typeof CODE_TOKEN_CLASSES)[number]
+
+/**
+ * Style bits of a text run in `MarkdownNode.runs`, one per kind of span
+ * the run is in
+ */
+export const TEXT_RUN_STYLES = {
+  emphasis: 1,
+  strong: 2,
+  strikethrough: 4,
+  code: 8,
+  link: 16,
+  /** The run is the alt text of an image */
+  image: 32,
+  math: 64,
+  displayMath: 128,
+  underline: 256,
+  wikiLink: 512,
+} as const
+
+/**
+ * Target of a link, wiki link or image in a text node's runs. An image in
+ * a link has both `src` and the link's `href`.
+ */
+export interface TextRunLink {
+  href?: string
+  src?: string
+  title?: string
+}
+
+/**
+ * Field bits of a display list record (`displayList`), in the order their
+ * values follow the record's field mask
+ */
+export const DISPLAY_LIST_FIELDS = {
+  content: 1 << 0,
+  level: 1 << 1,
+  href: 1 << 2,
+  src: 1 << 3,
+  alt: 1 << 4,
+  title: 1 << 5,
+  language: 1 << 6,
+  /** Count, then that many numbers of `tokens` */
+  tokens: 1 << 7,
+  /** Count, then that many numbers of `runs` */
+  runs: 1 << 8,
+  /** Count, then per link a mask (href 1, src 2, title 4) and its strings */
+  links: 1 << 9,
+  ordered: 1 << 10,
+  start: 1 << 11,
+  checked: 1 << 12,
+  /** Index into `default`, `left`, `center`, `right` */
+  align: 1 << 13,
+  isHeader: 1 << 14,
+  /** Start and end offset */
+  position: 1 << 15,
+  /** Start line and column, end line and column */
+  location: 1 << 16,
+} as const
+
+/**
+ * A node tree flattened into preorder records (`displayList`). Each node is
+ * `depth, type, fields` followed by the values of its fields: `depth` is 0
+ * for top-level nodes and the parent's plus one for children, `type` and
+ * string values index `strings`, `fields` is a mask of
+ * `DISPLAY_LIST_FIELDS`, booleans are 0 or 1.
+ */
+export interface DisplayList {
+  ops: number[]
+  strings: string[]
+}
+
 /**
  * Markdown AST node structure
  */
@@ -62,6 +174,22 @@ export interface MarkdownNode {
   title?: string
   /** Code block language */
   language?: string
+  /**
+   * Syntax tokens of a code block, present when parsed with `highlightCode`
+   * and the language is supported: flat `offset, length, class` triples,
+   * offsets and lengths in UTF-16 code units of the code text, classes
+   * indexing `CODE_TOKEN_CLASSES`
+   */
+  tokens?: number[]
+  /**
+   * Styled runs of a text node's content, present when parsed with
+   * `textRuns` and some of the text is styled: flat `length, styles, link`
+   * triples covering the content in order, lengths in UTF-16 code units,
+   * styles a mask of `TEXT_RUN_STYLES`, link an index into `links` or -1
+   */
+  runs?: number[]
+  /** Targets of the links and images among the runs */
+  links?: TextRunLink[]
   /** Is ordered list */
   ordered?: boolean
   /** Ordered list start number */
@@ -72,6 +200,8 @@ export interface MarkdownNode {
   align?: TableCellAlign
   /** Is table header cell */
   isHeader?: boolean
+  /** Source range, present when parsed with `sourcePositions` */
+  position?: SourcePosition
 }
 
 /**
@@ -83,6 +213,94 @@ export interface ParseError {
   column?: number
 }
 
+/**
+ * Per-phase timing breakdown of a native parse (times in milliseconds)
+ */
+export interface ParseTimings {
+  /** md4c block analysis, including link reference definitions */
+  blockMs: number
+  /** md4c inline analysis and callback dispatch */
+  inlineMs: number
+  /** Building the native node tree */
+  treeMs: number
+  /** Serializing the tree to JSON */
+  serializeMs: number
+  /** Total native time of the parse call */
+  totalMs: number
+  /** Size of the input in bytes */
+  inputBytes: number
+  /** Number of nodes in the tree */
+  nodeCount: number
+  /** Size of the JSON AST in bytes */
+  outputBytes: number
+}
+
+/**
+ * Allocations of one kind of memory used by a native parse
+ */
+export interface ParseMemoryUsage {
+  /** Number of allocations */
+  allocations: number
+  /** Total bytes allocated */
+  bytesAllocated: number
+  /** Peak of the live bytes */
+  peakBytes: number
+}
+
+/**
+ * Memory used by a native parse
+ */
+export interface ParseMemory {
+  /** md4c's scratch memory, and the normalized input with `normalizeInput` */
+  md4c: ParseMemoryUsage
+  /** The native node tree */
+  ast: ParseMemoryUsage
+  /** The serialized JSON AST */
+  output: ParseMemoryUsage
+  /** Peak of all live bytes together */
+  peakBytes: number
+}
+
+/**
+ * A heading of the document, for a table of contents or anchor links
+ */
+export interface HeadingEntry {
+  /** Heading level, 1 to 6 */
+  level: number
+  /** Plain text of the heading's content */
+  text: string
+  /** GitHub-style anchor, unique in the document ("intro", "intro-1"...) */
+  slug: string
+  /** UTF-8 byte offset of the heading's content in the input */
+  offset: number
+  /** 1-based line of the heading's content */
+  line: number
+  /** Child indices from the document node down to the heading node */
+  path: number[]
+}
+
+/**
+ * The part of a search match in one text node
+ */
+export interface SearchSegment {
+  /** Child indices from the document node down to the text node */
+  path: number[]
+  /** Start of the match in the node's `content`, in UTF-16 code units */
+  start: number
+  /** End of the match in the node's `content`, in UTF-16 code units */
+  end: number
+}
+
+/**
+ * A match of a search, in one segment per text node it covers
+ */
+export interface SearchMatch {
+  /** Index of the pattern that matched */
+  pattern: number
+  /** The text nodes it covers, in document order */
+  segments: SearchSegment[]
+}
+
 /**
  * Parse result from the parser
  */
@@ -90,6 +308,99 @@ export interface ParseResult {
   success: boolean
   nodes: MarkdownNode[]
   error?: ParseError
+  /** Timing breakdown, present when `collectTimings` was set */
+  timings?: ParseTimings
+  /** Memory usage, present when `collectMemory` was set */
+  memory?: ParseMemory
+  /** The headings in document order, with `collectHeadings` or `headingsOnly` */
+  headings?: HeadingEntry[]
+}
+
+/**
+ * Theme metrics the heights of a block manifest are estimated from, in
+ * points; `layoutMetricsFromTheme()` derives them from a theme
+ */
+export interface LayoutMetrics {
+  /** Width of the rendered text */
+  width: number
+  /** Body font size */
+  fontSize: number
+  /** Body line height */
+  lineHeight: number
+  /** Font sizes of heading levels 1 to 6 */
+  headingFontSizes?: number[]
+  /** Line heights of heading levels 1 to 6 */
+  headingLineHeights?: number[]
+  /** Line height of code blocks, whose lines do not wrap (default: 20) */
+  codeLineHeight?: number
+  /** Padding above and below the code of a code block (default: 16) */
+  codeBlockPadding?: number
+  /** Space below every top-level block (default: 16) */
+  blockSpacing?: number
+  /** Height of an image (default: 200) */
+  imageHeight?: number
+  /** Average advance of a character, in ems (default: 0.55) */
+  charWidth?: number
+}
+
+/**
+ * A top-level block of a document, as listed by `getBlockManifest()`
+ */
+export interface ManifestBlock {
+  type: NodeType
+  /** Byte offset where the block starts, from its first non-blank line */
+  start: number
+  /** Byte offset after the newline ending its last line */
+  end: number
+  /** Length of the block's source in UTF-16 code units */
+  characters: number
+  /** Number of source lines */
+  lines: number
+  /** Estimated rendered height, including the block spacing */
+  height: number
+  /** Sum of the heights of the blocks before it, for `getItemLayout` */
+  offset: number
+}
+
+/**
+ * Top-level blocks of a document with estimated heights
+ */
+export interface BlockManifest {
+  success: boolean
+  blocks: ManifestBlock[]
+  error?: ParseError
+}
+
+/**
+ * An image or a link of a document, as listed by `extractResources()`;
+ * `start` and `end` are the UTF-8 byte offsets of its whole source, from
+ * the `!` or `[` to after the `)` or `]`
+ */
+export type DocumentResource =
+  | {
+      type: 'image'
+      src: string
+      /** Plain text of the image's description */
+      alt?: string
+      title?: string
+      start: number
+      end: number
+    }
+  | {
+      type: 'link'
+      href: string
+      title?: string
+      start: number
+      end: number
+    }
+
+/**
+ * The images and links of a document in document order
+ */
+export interface DocumentResources {
+  success: boolean
+  resources: DocumentResource[]
+  error?: ParseError
 }
 
 /**
@@ -114,4 +425,50 @@ export interface ParserOptions {
   maxInputSize?: number
   /** Parse timeout in milliseconds (default: 5000) */
   timeout?: number
+  /** Return a per-phase timing breakdown with the result (default: false) */
+  collectTimings?: boolean
+  /** Return memory usage statistics with the result (default: false) */
+  collectMemory?: boolean
+  /** Abort the parse once it would need more memory, in bytes (default: unlimited) */
+  maxMemory?: number
+  /** Give every node its source range in `position` (default: false) */
+  sourcePositions?: boolean
+  /**
+   * Replace invalid UTF-8 and NUL bytes with U+FFFD and CRLF or CR line
+   * endings with LF before parsing (default: false)
+   */
+  normalizeInput?: boolean
+  /**
+   * Tokenize fenced code blocks of supported languages natively, so the
+   * renderer does not run react-syntax-highlighter on them (default: false)
+   */
+  highlightCode?: boolean
+  /**
+   * Emit the inline content of each paragraph, heading, table cell or tight
+   * list item as one text node with styled `runs` instead of a node per
+   * span, so it renders as a single Text (default: false)
+   */
+  textRuns?: boolean
+  /**
+   * Transfer the AST from native as a flat display list instead of nested
+   * JSON objects; `nodes` are rebuilt from it in a single loop (default:
+   * false)
+   */
+  displayList?: boolean
+  /**
+   * Parse the block structure only: paragraphs, headings and tables get a
+   * `deferred` node in place of their content, which `parseInlines` or a
+   * `DeferredDocument` fills in later (default: false)
+   */
+  deferInlines?: boolean
+  /**
+   * Return the headings of the document in `headings`, collected during the
+   * same native pass (default: false)
+   */
+  collectHeadings?: boolean
+  /**
+   * Return the headings only: the inline content of other blocks is not
+   * analyzed and `nodes` is empty (default: false)
+   */
+  headingsOnly?: boolean
 }
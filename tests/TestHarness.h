@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * Minimal test harness for the native tests
+ *
+ * TEST(name) registers a test case; CHECK and CHECK_EQ record a failure and
+ * keep going, so one run reports every broken expectation. Each test source
+ * ends with HYPERMARKDOWN_TEST_MAIN() and runs as its own CTest executable.
+ * nodeAt() follows the child-index paths of the heading and search indexes;
+ * the fuzz targets use it too.
+ */
+
+#include "MarkdownParser.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hypermarkdown_test {
+
+struct TestCase {
+    const char* name;
+    std::function<void()> fn;
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> fn) {
+        registry().push_back({name, std::move(fn)});
+    }
+};
+
+template <typename A, typename B>
+void checkEqual(const A& actual, const B& expected, const char* expr, const char* file, int line) {
+    if (actual == expected) {
+        return;
+    }
+    std::ostringstream oss;
+    oss << "  expected: " << expected << "\n  actual:   " << actual;
+    std::fprintf(stderr, "%s:%d: CHECK_EQ(%s) failed\n%s\n", file, line, expr, oss.str().c_str());
+    failures()++;
+}
+
+// The node at `path`, child indices from `node` down, or nullptr if an
+// index is out of range
+inline const margelo::nitro::hypermarkdown::MarkdownNode* nodeAt(
+    const margelo::nitro::hypermarkdown::MarkdownNode* node, const std::vector<uint32_t>& path) {
+    for (uint32_t index : path) {
+        if (index >= node->children.size()) {
+            return nullptr;
+        }
+        node = node->children[index].get();
+    }
+    return node;
+}
+
+inline int runAll() {
+    for (const auto& test : registry()) {
+        int before = failures();
+        test.fn();
+        std::printf("[%s] %s\n", failures() == before ? "PASS" : "FAIL", test.name);
+    }
+    std::printf("%zu tests, %d failed checks\n", registry().size(), failures());
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace hypermarkdown_test
+
+#define TEST(name)                                                                  \
+    static void name();                                                             \
+    static ::hypermarkdown_test::Registrar name##_registrar(#name, name);           \
+    static void name()
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ::hypermarkdown_test::failures()++;                                     \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    ::hypermarkdown_test::checkEqual((actual), (expected), #actual ", " #expected, __FILE__, __LINE__)
+
+#define HYPERMARKDOWN_TEST_MAIN() \
+    int main() { return ::hypermarkdown_test::runAll(); }
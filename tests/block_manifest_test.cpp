@@ -0,0 +1,150 @@
+/**
+ * BlockManifest tests
+ *
+ * Checks the block ranges of the manifest pass against the document's
+ * top-level nodes, the height estimates, and that parsing a range of
+ * blocks builds the same nodes as a full parse.
+ */
+#include "BlockManifest.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+const std::string kDocument =
+    "# Title\n\n"
+    "Some *text*\nover two lines\n\n"
+    "```js\nconst a = 1\n```\n\n"
+    "- one\n- two\n\n"
+    "---\n\n"
+    "Setext\n======\n\n"
+    "> quote\n> ```\n> code\n> ```\n\n"
+    "| a | b |\n|---|---|\n| 1 | 2 |\n\n"
+    "[ref]: http://example.com\n"
+    "![image](x.png) and [ref]\n\n"
+    "~~~\n~~~\n";
+
+std::string source(const std::string& content, const ManifestBlock& block) {
+    return content.substr(block.start, block.end - block.start);
+}
+
+} // namespace
+
+TEST(ranges) {
+    auto manifest = BlockManifest::build(kDocument, InternalLayoutMetrics());
+    CHECK(manifest.success);
+    CHECK_EQ(manifest.blocks.size(), 10u);
+    if (manifest.blocks.size() != 10) {
+        return;
+    }
+    const auto& blocks = manifest.blocks;
+    CHECK_EQ(blocks[0].type, "heading");
+    CHECK_EQ(source(kDocument, blocks[0]), "# Title\n");
+    CHECK_EQ(source(kDocument, blocks[1]), "Some *text*\nover two lines\n");
+    CHECK_EQ(blocks[1].lines, 2u);
+    // Fences and Setext underlines are part of their blocks
+    CHECK_EQ(source(kDocument, blocks[2]), "```js\nconst a = 1\n```\n");
+    CHECK_EQ(blocks[3].type, "list");
+    CHECK_EQ(source(kDocument, blocks[3]), "- one\n- two\n");
+    CHECK_EQ(source(kDocument, blocks[4]), "---\n");
+    CHECK_EQ(source(kDocument, blocks[5]), "Setext\n======\n");
+    CHECK_EQ(source(kDocument, blocks[6]), "> quote\n> ```\n> code\n> ```\n");
+    CHECK_EQ(blocks[7].type, "table");
+    // A link reference definition goes with the block after it
+    CHECK_EQ(source(kDocument, blocks[8]), "[ref]: http://example.com\n![image](x.png) and [ref]\n");
+    CHECK_EQ(source(kDocument, blocks[9]), "~~~\n~~~\n");
+    CHECK_EQ(blocks[9].end, static_cast<uint32_t>(kDocument.size()));
+}
+
+TEST(matchesDocument) {
+    auto manifest = BlockManifest::build(kDocument, InternalLayoutMetrics());
+    auto result = MarkdownParser::parse(kDocument);
+    CHECK(result.success);
+    const auto& children = result.nodes.front()->children;
+    CHECK_EQ(manifest.blocks.size(), children.size());
+    for (size_t i = 0; i < children.size() && i < manifest.blocks.size(); i++) {
+        CHECK_EQ(manifest.blocks[i].type, children[i]->type);
+    }
+}
+
+TEST(characters) {
+    std::string content = "é😀\n\n- a\n-\n";
+    auto manifest = BlockManifest::build(content, InternalLayoutMetrics());
+    CHECK_EQ(manifest.blocks.size(), 2u);
+    if (manifest.blocks.size() != 2) {
+        return;
+    }
+    // UTF-16 code units, the newline included
+    CHECK_EQ(manifest.blocks[0].characters, 4u);
+    CHECK_EQ(manifest.blocks[1].start, 8u);
+}
+
+TEST(heights) {
+    InternalLayoutMetrics metrics;
+    metrics.width = 100;
+    metrics.fontSize = 10;
+    metrics.lineHeight = 20;
+    metrics.charWidth = 0.5;
+    metrics.blockSpacing = 8;
+    metrics.codeLineHeight = 15;
+    metrics.codeBlockPadding = 5;
+    metrics.imageHeight = 50;
+    metrics.headingFontSizes[0] = 20;
+    metrics.headingLineHeights[0] = 30;
+    // 20 characters a line: 45 characters wrap to 3 lines
+    std::string paragraph(45, 'x');
+    auto manifest = BlockManifest::build("# Heading\n\n" + paragraph + "\n\n```\na\nb\n```\n\n![i](x.png)\n", metrics);
+    CHECK_EQ(manifest.blocks.size(), 4u);
+    if (manifest.blocks.size() != 4) {
+        return;
+    }
+    CHECK_EQ(manifest.blocks[0].height, 30u + 8u);
+    CHECK_EQ(manifest.blocks[1].height, 3 * 20u + 8u);
+    CHECK_EQ(manifest.blocks[2].height, 2 * 15u + 2 * 5u + 8u);
+    CHECK_EQ(manifest.blocks[3].height, 20u + 50u + 8u);
+}
+
+TEST(json) {
+    auto manifest = BlockManifest::build("# A\n\nb\n", InternalLayoutMetrics());
+    CHECK_EQ(MarkdownSerializer::blockManifestToJson(manifest),
+             "{\"types\":[\"heading\",\"paragraph\"],\"blocks\":[0,0,4,4,1,56,1,5,7,2,1,40]}");
+    CHECK_EQ(MarkdownSerializer::blockManifestToJson(BlockManifest::build("", InternalLayoutMetrics())),
+             "{\"types\":[],\"blocks\":[]}");
+}
+
+TEST(sizeLimit) {
+    InternalParserOptions options;
+    options.maxInputSize = 4;
+    auto manifest = BlockManifest::build("# Too long\n", InternalLayoutMetrics(), options);
+    CHECK(!manifest.success);
+    CHECK(manifest.error && manifest.error->message == "Input exceeds maximum size limit");
+}
+
+TEST(blockRange) {
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    auto full = MarkdownParser::parse(kDocument, options);
+    CHECK(full.success);
+    const auto& children = full.nodes.front()->children;
+    for (size_t first = 0; first < children.size(); first += 3) {
+        options.firstBlock = first;
+        options.endBlock = first + 3;
+        auto range = MarkdownParser::parse(kDocument, options);
+        CHECK(range.success);
+        const auto& blocks = range.nodes.front()->children;
+        CHECK_EQ(blocks.size(), std::min<size_t>(3, children.size() - first));
+        // The same nodes, with the same absolute positions
+        for (size_t i = 0; i < blocks.size(); i++) {
+            CHECK_EQ(MarkdownSerializer::nodeToJson(blocks[i]), MarkdownSerializer::nodeToJson(children[first + i]));
+        }
+    }
+    options.firstBlock = 20;
+    options.endBlock = SIZE_MAX;
+    auto past = MarkdownParser::parse(kDocument, options);
+    CHECK(past.success && past.nodes.front()->children.empty());
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,175 @@
+/**
+ * CodeTokenizer tests
+ *
+ * Every language is looked up by its common fence names and tokenizes the
+ * constructs themes color; tokens are ordered and never overlap, and their
+ * offsets convert to UTF-16 units.
+ */
+#include "CodeTokenizer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+// The tokens of `code` as "class:text" strings, one per line
+std::string tokens(const char* language, const std::string& code) {
+    static const char* kClasses[] = {"keyword", "string", "comment", "number", "literal", "built_in", "type",
+                                     "title", "attr", "meta", "variable", "addition", "deletion"};
+    const CodeLanguage* lang = CodeTokenizer::findLanguage(language);
+    if (!lang) {
+        return "<unsupported>";
+    }
+    std::vector<CodeToken> list;
+    CodeTokenizer::tokenize(*lang, code.data(), code.size(), list);
+    std::string out;
+    for (const auto& token : list) {
+        out += kClasses[static_cast<int>(token.cls)];
+        out += ':';
+        out.append(code, token.offset, token.length);
+        out += '\n';
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(findLanguage) {
+    CHECK_EQ(CodeTokenizer::languageName(*CodeTokenizer::findLanguage("ts")), "typescript");
+    CHECK(CodeTokenizer::findLanguage("JavaScript") == CodeTokenizer::findLanguage("tsx"));
+    CHECK(CodeTokenizer::findLanguage("c++") == CodeTokenizer::findLanguage("cpp"));
+    CHECK(CodeTokenizer::findLanguage("yml") != nullptr);
+    CHECK(CodeTokenizer::findLanguage("brainfuck") == nullptr);
+    CHECK(CodeTokenizer::findLanguage("") == nullptr);
+}
+
+TEST(typescript) {
+    CHECK_EQ(tokens("ts", "export function f(a: string) { return `x${a}` ?? null } // c"),
+             "keyword:export\nkeyword:function\ntitle:f\ntype:string\nkeyword:return\nstring:`x${a}`\n"
+             "literal:null\ncomment:// c\n");
+    CHECK_EQ(tokens("js", "const n = 0x1F + 1.5e3 /* a\nb */ + new Foo()"),
+             "keyword:const\nnumber:0x1F\nnumber:1.5e3\ncomment:/* a\nb */\nkeyword:new\ntitle:Foo\n");
+    // An unterminated string ends with its line
+    CHECK_EQ(tokens("js", "'abc\nlet"), "string:'abc\nkeyword:let\n");
+}
+
+TEST(python) {
+    CHECK_EQ(tokens("python", "@cache\ndef f(x=None):\n    return rb'\\x' + \"\"\"a\n\"\"\"  # c"),
+             "meta:@cache\nkeyword:def\ntitle:f\nliteral:None\nkeyword:return\nstring:rb'\\x'\n"
+             "string:\"\"\"a\n\"\"\"\ncomment:# c\n");
+}
+
+TEST(json) {
+    CHECK_EQ(tokens("json", "{\"a\": [1, -2.5e3, true, null], \"b\" : \"c\"}"),
+             "attr:\"a\"\nnumber:1\nnumber:-2.5e3\nliteral:true\nliteral:null\nattr:\"b\"\nstring:\"c\"\n");
+}
+
+TEST(shell) {
+    CHECK_EQ(tokens("bash", "#!/bin/sh\nif [ -f \"$x\" ]; then echo ${y} 'a#b' # c\nfi"),
+             "meta:#!/bin/sh\nkeyword:if\nstring:\"$x\"\nkeyword:then\nbuilt_in:echo\nvariable:${y}\n"
+             "string:'a#b'\ncomment:# c\nkeyword:fi\n");
+    // `#` inside a word does not start a comment
+    CHECK_EQ(tokens("sh", "echo a#b $1"), "built_in:echo\nvariable:$1\n");
+}
+
+TEST(cpp) {
+    CHECK_EQ(tokens("cpp", "#include <a>\n#define M \\\n  1\nint main() { return nullptr != 'c'; }"),
+             "meta:#include <a>\nmeta:#define M \\\n  1\ntype:int\ntitle:main\nkeyword:return\n"
+             "literal:nullptr\nstring:'c'\n");
+    // Raw strings end at )delim", prefixes belong to the string
+    CHECK_EQ(tokens("cpp", "auto s = R\"(say \"hi\" now)\"; f(u8R\"x(a)\"\nb)x\", L'c', u8\"d\\\"\", R(1));"),
+             "type:auto\nstring:R\"(say \"hi\" now)\"\ntitle:f\nstring:u8R\"x(a)\"\nb)x\"\nstring:L'c'\n"
+             "string:u8\"d\\\"\"\ntitle:R\nnumber:1\n");
+    CHECK_EQ(tokens("cpp", "R\"(a\nb"), "string:R\"(a\nb\n");
+}
+
+TEST(javaAndKotlin) {
+    CHECK_EQ(tokens("java", "@Override public void run() { String s = null; }"),
+             "meta:@Override\nkeyword:public\ntype:void\ntitle:run\nbuilt_in:String\nliteral:null\n");
+    CHECK_EQ(tokens("kotlin", "data class P(val x: Int) { fun f() = \"\"\"a\"\"\" }"),
+             "keyword:data\nkeyword:class\ntype:P\nkeyword:val\ntype:Int\nkeyword:fun\ntitle:f\n"
+             "string:\"\"\"a\"\"\"\n");
+}
+
+TEST(swift) {
+    CHECK_EQ(tokens("swift", "#if DEBUG\n@State var x: Int? = nil"),
+             "meta:#if\ntype:DEBUG\nmeta:@State\nkeyword:var\ntype:Int\nliteral:nil\n");
+}
+
+TEST(go) {
+    CHECK_EQ(tokens("go", "func (r *T) Run() error { s := `raw\\` ; return nil }"),
+             "keyword:func\ntitle:Run\ntype:error\nstring:`raw\\`\nkeyword:return\nliteral:nil\n");
+}
+
+TEST(rust) {
+    CHECK_EQ(tokens("rust", "#[derive(Debug)]\nfn f<'a>(x: &'a str) { let c = 'x'; println!(r#\"\"q\"\"#); }"),
+             "meta:#[derive(Debug)]\nkeyword:fn\ntitle:f\ntype:str\nkeyword:let\nstring:'x'\n"
+             "built_in:println!\nstring:r#\"\"q\"\"#\n");
+}
+
+TEST(sql) {
+    CHECK_EQ(tokens("sql", "SELECT COUNT(*) FROM \"from\" WHERE a = 'it''s' -- c"),
+             "keyword:SELECT\nbuilt_in:COUNT\nkeyword:FROM\nkeyword:WHERE\nstring:'it''s'\ncomment:-- c\n");
+}
+
+TEST(yaml) {
+    CHECK_EQ(tokens("yaml", "---\nname: app # c\nlist:\n  - 1.5\n  - \"x\"\non: [true, a: ~]\ntext: |\n  a\n  b\nk: &x v"),
+             "meta:---\nattr:name\nstring:app\ncomment:# c\nattr:list\nnumber:1.5\nstring:\"x\"\nattr:on\n"
+             "literal:true\nattr:a\nliteral:~\nattr:text\nmeta:|\nstring:a\nstring:b\nattr:k\ntype:&x\nstring:v\n");
+}
+
+TEST(diff) {
+    CHECK_EQ(tokens("diff", "diff --git a b\n--- a\n+++ b\n@@ -1 +1 @@\n ctx\n-old\n+new"),
+             "comment:diff --git a b\ncomment:--- a\ncomment:+++ b\nmeta:@@ -1 +1 @@\ndeletion:-old\n"
+             "addition:+new\n");
+}
+
+TEST(orderedWithoutOverlaps) {
+    // Every language over inputs mixing all of their constructs, cut at
+    // every position so unterminated constructs are covered too
+    const std::string code = "#!x\n#[a] @b /* c */ // d\n\"e\\\"\" 'f' `g` \"\"\"h\"\"\" r#\"i\"# $j ${k}\n"
+                             "- l: 1e5 |\n  m\n+n\n-o\n@@ p\nfn q() { 'r 0x2 .5 s! }\n"
+                             "t: \"u\\\n v\" [\"w\\\n\", x]\n";
+    for (const char* language : {"ts", "py", "json", "sh", "cpp", "java", "kotlin", "swift", "go", "rust", "sql",
+                                 "yaml", "diff"}) {
+        const CodeLanguage* lang = CodeTokenizer::findLanguage(language);
+        CHECK(lang != nullptr);
+        for (size_t size = 0; lang && size <= code.size(); size++) {
+            std::vector<CodeToken> list;
+            CodeTokenizer::tokenize(*lang, code.data(), size, list);
+            size_t end = 0;
+            for (const auto& token : list) {
+                CHECK(token.offset >= end && token.length > 0 && token.offset + token.length <= size);
+                end = token.offset + token.length;
+            }
+        }
+    }
+}
+
+TEST(utf16Offsets) {
+    const std::string code = "// é\n'🚀' x";
+    std::vector<CodeToken> list;
+    CodeTokenizer::tokenize(*CodeTokenizer::findLanguage("js"), code.data(), code.size(), list);
+    CodeTokenizer::toUtf16(code.data(), code.size(), list);
+    CHECK_EQ(list.size(), 2u);
+    if (list.size() == 2) {
+        // "// é" is 4 units, the newline one, "'🚀'" 4 (a surrogate pair)
+        CHECK_EQ(list[0].offset, 0u);
+        CHECK_EQ(list[0].length, 4u);
+        CHECK_EQ(list[1].offset, 5u);
+        CHECK_EQ(list[1].length, 4u);
+    }
+
+    // Invalid UTF-8 counts as one U+FFFD per maximal subpart
+    const std::string invalid = "'\xC3' \xE2\x82 'x'";
+    list.clear();
+    CodeTokenizer::tokenize(*CodeTokenizer::findLanguage("js"), invalid.data(), invalid.size(), list);
+    CodeTokenizer::toUtf16(invalid.data(), invalid.size(), list);
+    CHECK_EQ(list.size(), 2u);
+    if (list.size() == 2) {
+        CHECK_EQ(list[0].length, 3u);
+        CHECK_EQ(list[1].offset, 6u);
+    }
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,172 @@
+/**
+ * Two-phase parsing tests
+ *
+ * Parses documents as a skeleton (deferInlines), fetches the content of
+ * its "deferred" nodes (inlinesOnly) and checks that splicing it in gives
+ * the tree of a full parse.
+ */
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+const std::string kDocument =
+    "# Title *one*\n\n"
+    "Some *text*\nover two lines\n\n"
+    "```js\nconst a = 1\n```\n\n"
+    "- one **1**\n- two\n  ***\n  after\n- three\n  - nested `x`\n\n"
+    "1. loose\n\n   second\n\n"
+    "Setext [link](u)\n======\n\n"
+    "> quote\n> > deeper\n\n"
+    "| a | *b* |\n|---|---|\n| 1 | 2 |\n\n"
+    "#\n\n"
+    "<div>\nhtml\n</div>\n\n"
+    "[ref]: http://example.com\n"
+    "![image](x.png) and [ref]\n";
+
+struct Placeholder {
+    std::vector<size_t> parentPath;     // child indices from the root down to its parent
+    size_t index;
+};
+
+std::vector<Placeholder> placeholders(const std::shared_ptr<MarkdownNode>& root) {
+    std::vector<Placeholder> found;
+    std::vector<size_t> path;
+    walkTree(
+        root.get(),
+        [&](const MarkdownNode* node, size_t index) {
+            if (node == root.get()) {
+                return true;
+            }
+            if (node->type == "deferred") {
+                found.push_back({path, index});
+            }
+            path.push_back(index);
+            return true;
+        },
+        [&](const MarkdownNode* node) {
+            if (node != root.get()) {
+                path.pop_back();
+            }
+        });
+    return found;
+}
+
+// Replaces the placeholders of `skeleton` by the content fetched for them,
+// from the last one, so the indices of the others stay valid
+void resolve(const std::shared_ptr<MarkdownNode>& skeleton, const std::vector<std::shared_ptr<MarkdownNode>>& fetched) {
+    auto found = placeholders(skeleton);
+    for (size_t i = found.size(); i-- > 0;) {
+        MarkdownNode* parent = skeleton.get();
+        for (size_t index : found[i].parentPath) {
+            parent = parent->children[index].get();
+        }
+        auto& children = parent->children;
+        children.erase(children.begin() + static_cast<std::ptrdiff_t>(found[i].index));
+        const auto& content = fetched[i]->children;
+        children.insert(children.begin() + static_cast<std::ptrdiff_t>(found[i].index), content.begin(), content.end());
+    }
+}
+
+// Parses `content` in two phases, fetching `step` leaves at a time, and
+// compares the result with a full parse
+void checkTwoPhase(const std::string& content, InternalParserOptions options, size_t step) {
+    auto full = MarkdownParser::parse(content, options);
+    options.deferInlines = true;
+    auto skeleton = MarkdownParser::parse(content, options);
+    CHECK(full.success && skeleton.success);
+    size_t leaves = placeholders(skeleton.nodes.front()).size();
+
+    options.deferInlines = false;
+    options.inlinesOnly = true;
+    std::vector<std::shared_ptr<MarkdownNode>> fetched;
+    for (size_t first = 0; first < leaves; first += step) {
+        options.firstInline = first;
+        options.endInline = first + step;
+        auto inlines = MarkdownParser::parse(content, options);
+        CHECK(inlines.success);
+        const auto& children = inlines.nodes.front()->children;
+        CHECK_EQ(children.size(), std::min(step, leaves - first));
+        fetched.insert(fetched.end(), children.begin(), children.end());
+    }
+    if (fetched.size() != leaves) {
+        return;
+    }
+    resolve(skeleton.nodes.front(), fetched);
+    CHECK_EQ(MarkdownSerializer::nodeToJson(skeleton.nodes.front()), MarkdownSerializer::nodeToJson(full.nodes.front()));
+}
+
+} // namespace
+
+TEST(skeleton) {
+    InternalParserOptions options;
+    options.deferInlines = true;
+    auto result = MarkdownParser::parse("# A *b*\n\n- c\n- d\n\n```\ne\n```\n", options);
+    CHECK(result.success);
+    const auto& blocks = result.nodes.front()->children;
+    CHECK_EQ(blocks.size(), 3u);
+    if (blocks.size() != 3) {
+        return;
+    }
+    // Leaves with inline content hold a placeholder, the block structure
+    // and verbatim content are complete
+    CHECK_EQ(blocks[0]->children.size(), 1u);
+    CHECK_EQ(blocks[0]->children.front()->type, "deferred");
+    CHECK_EQ(blocks[0]->level.value_or(0), 1);
+    const auto& item = blocks[1]->children.front();
+    CHECK_EQ(item->type, "list_item");
+    CHECK_EQ(item->children.front()->type, "deferred");
+    CHECK_EQ(blocks[2]->children.front()->content.value_or(""), "e\n");
+    CHECK_EQ(placeholders(result.nodes.front()).size(), 3u);
+}
+
+TEST(fetch) {
+    InternalParserOptions options;
+    options.inlinesOnly = true;
+    options.firstInline = 1;
+    options.endInline = 3;
+    auto result = MarkdownParser::parse("# A\n\nb *c*\n\n- d\n- e\n", options);
+    CHECK(result.success);
+    const auto& deferred = result.nodes.front()->children;
+    CHECK_EQ(deferred.size(), 2u);
+    if (deferred.size() != 2) {
+        return;
+    }
+    CHECK_EQ(deferred[0]->type, "deferred");
+    CHECK_EQ(deferred[0]->children.size(), 2u);
+    CHECK_EQ(deferred[0]->children.back()->type, "emphasis");
+    // The paragraph of a tight list item
+    CHECK_EQ(deferred[1]->children.size(), 1u);
+    CHECK_EQ(deferred[1]->children.front()->content.value_or(""), "d");
+}
+
+TEST(matchesFullParse) {
+    checkTwoPhase(kDocument, InternalParserOptions(), 1);
+    checkTwoPhase(kDocument, InternalParserOptions(), 4);
+    InternalParserOptions options;
+    options.textRuns = true;
+    checkTwoPhase(kDocument, options, 3);
+    options.textRuns = false;
+    options.gfm = false;
+    options.enableTables = false;
+    checkTwoPhase(kDocument, options, 2);
+}
+
+TEST(positions) {
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    checkTwoPhase("Some *text*\nover two lines\n\n- a\n- b *c*\n\n| a |\n|---|\n| `1` |\n", options, 1);
+}
+
+TEST(pastTheEnd) {
+    InternalParserOptions options;
+    options.inlinesOnly = true;
+    options.firstInline = 10;
+    auto result = MarkdownParser::parse("a\n\nb\n", options);
+    CHECK(result.success && result.nodes.front()->children.empty());
+}
+
+HYPERMARKDOWN_TEST_MAIN()
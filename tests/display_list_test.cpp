@@ -0,0 +1,186 @@
+/**
+ * DisplayList tests
+ *
+ * Pins the record layout and its JSON, and checks that a tree rebuilt from
+ * the records, the way src/displayList.ts does it, serializes to the same
+ * JSON as the original tree for every kind of node and field.
+ */
+#include "DisplayList.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+std::string ops(const DisplayList& list) {
+    std::string out;
+    for (auto op : list.ops) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += std::to_string(op);
+    }
+    return out;
+}
+
+// Rebuilds the top-level nodes of a display list
+std::vector<std::shared_ptr<MarkdownNode>> decode(const DisplayList& list) {
+    std::vector<std::shared_ptr<MarkdownNode>> roots;
+    std::vector<MarkdownNode*> open;
+    size_t i = 0;
+    auto next = [&] { return list.ops[i++]; };
+    auto string = [&] { return std::string(list.strings[next()]); };
+    while (i < list.ops.size()) {
+        auto depth = static_cast<size_t>(next());
+        int32_t type = next();
+        uint32_t fields = static_cast<uint32_t>(next());
+        open.resize(depth);
+        auto node = type < 0 ? nullptr : std::make_shared<MarkdownNode>(std::string(list.strings[type]));
+        if (node) {
+            if (fields & kFieldContent) node->content = string();
+            if (fields & kFieldLevel) node->level = next();
+            if (fields & kFieldHref) node->href = string();
+            if (fields & kFieldSrc) node->src = string();
+            if (fields & kFieldAlt) node->alt = string();
+            if (fields & kFieldTitle) node->title = string();
+            if (fields & kFieldLanguage) node->language = string();
+            if (fields & kFieldTokens) {
+                for (int32_t count = next(); count > 0; count -= 3) {
+                    uint32_t offset = next();
+                    uint32_t length = next();
+                    node->tokens.push_back({offset, length, static_cast<CodeTokenClass>(next())});
+                }
+            }
+            if (fields & kFieldRuns) {
+                for (int32_t count = next(); count > 0; count -= 3) {
+                    uint32_t length = next();
+                    auto styles = static_cast<uint16_t>(next());
+                    node->runs.push_back({length, styles, next()});
+                }
+            }
+            if (fields & kFieldLinks) {
+                for (int32_t count = next(); count > 0; count--) {
+                    int32_t mask = next();
+                    TextRunLink link;
+                    if (mask & 1) link.href = string();
+                    if (mask & 2) link.src = string();
+                    if (mask & 4) link.title = string();
+                    node->links.push_back(link);
+                }
+            }
+            if (fields & kFieldOrdered) node->ordered = next() != 0;
+            if (fields & kFieldStart) node->start = next();
+            if (fields & kFieldChecked) node->checked = next() != 0;
+            if (fields & kFieldAlign) node->align = static_cast<TableCellAlign>(next());
+            if (fields & kFieldIsHeader) node->isHeader = next() != 0;
+            if (fields & kFieldPosition) {
+                uint32_t start = next();
+                node->position = SourceSpan{start, static_cast<uint32_t>(next())};
+            }
+            if (fields & kFieldLocation) {
+                i += 4;
+            }
+        }
+        if (depth == 0) {
+            roots.push_back(node);
+        } else {
+            open.back()->children.push_back(node);
+        }
+        open.push_back(node.get());
+    }
+    return roots;
+}
+
+} // namespace
+
+TEST(records) {
+    auto result = MarkdownParser::parse("# T\n\nHello *world*\n");
+    CHECK(result.success);
+    auto list = DisplayList::build(result.nodes);
+    CHECK_EQ(ops(list), "0,0,0," "1,1,2,1," "2,2,1,3," "1,4,0," "2,2,1,5," "2,6,0," "3,2,1,7");
+    CHECK_EQ(list.strings.size(), 8u);
+    CHECK_EQ(list.nodeCount, 7u);
+    // Type names are interned
+    CHECK(list.strings[2] == "text" && list.strings[7] == "world");
+}
+
+TEST(json) {
+    auto result = MarkdownParser::parse("a\"\n");
+    CHECK(result.success);
+    CHECK_EQ(MarkdownSerializer::displayListToJson(DisplayList::build(result.nodes)),
+             "{\"ops\":[0,0,0,1,1,0,2,2,1,3],\"strings\":[\"document\",\"paragraph\",\"text\",\"a\\\"\"]}");
+    CHECK_EQ(MarkdownSerializer::displayListToJson(DisplayList()), "{\"ops\":[],\"strings\":[]}");
+}
+
+TEST(positions) {
+    std::string content = "a\n*b*\n";
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success);
+    LineIndex lines(content);
+    auto list = DisplayList::build(result.nodes, &lines);
+    // The emphasis: offsets, then lines and columns
+    std::string emphasis = std::to_string(kFieldPosition | kFieldLocation) + ",2,5,2,1,2,4";
+    CHECK(ops(list).find(emphasis) != std::string::npos);
+    CHECK(ops(DisplayList::build(result.nodes)).find(std::to_string(kFieldPosition) + ",2,5,") != std::string::npos);
+}
+
+TEST(nullNode) {
+    auto root = std::make_shared<MarkdownNode>("document");
+    root->children.push_back(nullptr);
+    root->children.push_back(std::make_shared<MarkdownNode>("thematic_break"));
+    CHECK_EQ(ops(DisplayList::build({root})), "0,0,0,1,-1,0,1,1,0");
+}
+
+TEST(roundTrip) {
+    const std::string content =
+        "# Title *em*\n\n"
+        "Text with **strong**, `code`, ~~gone~~, [link](http://x \"t\") and ![img](i.png \"it\").  \n"
+        "Line two $x^2$ [[Wiki|label]] _u_\n\n"
+        "> quote\n\n"
+        "3. three\n4. four\n\n"
+        "- [x] done\n- [ ] todo\n\n"
+        "| l | c | r |\n|:--|:-:|--:|\n| 1 | 2 | 3 |\n\n"
+        "```js\nconst a = 1 // x\n```\n\n"
+        "<div>html</div>\n\n"
+        "$$\ny\n$$\n\n---\n\n"
+        "é \"quoted\" \\ tab\tend\n";
+    for (bool textRuns : {false, true}) {
+        InternalParserOptions options;
+        options.math = true;
+        options.wiki = true;
+        options.highlightCode = true;
+        options.sourcePositions = true;
+        options.textRuns = textRuns;
+        auto result = MarkdownParser::parse(content, options);
+        CHECK(result.success);
+        auto list = DisplayList::build(result.nodes);
+        CHECK_EQ(MarkdownSerializer::toJson(decode(list)), MarkdownSerializer::toJson(result.nodes));
+    }
+}
+
+TEST(outputMemory) {
+    InternalParserOptions options;
+    options.collectMemory = true;
+    auto result = MarkdownParser::parse("Hello *world*\n", options);
+    CHECK(result.success && result.memory);
+    if (!result.memory) {
+        return;
+    }
+
+    auto list = DisplayList::build(result.nodes);
+    std::string json = MarkdownSerializer::displayListToJson(list, &*result.memory);
+    CHECK_EQ(json, MarkdownSerializer::displayListToJson(list));
+    CHECK(result.memory->output.bytesAllocated >= json.size() + list.byteSize());
+
+    InternalParseMemory tight;
+    tight.limit = 16;
+    CHECK_EQ(MarkdownSerializer::displayListToJson(list, &tight), "");
+    CHECK(tight.exceeded);
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,146 @@
+/**
+ * Document resources tests
+ *
+ * Extracts the images and links of documents without an AST and checks
+ * them against the image and link nodes of the full parse: URLs, titles,
+ * alt text, offsets and document order.
+ */
+#include "DocumentResources.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+const std::string kDocument =
+    "# Logo ![logo](logo.png \"The logo\")\n\n"
+    "Some prose without links\nover two lines.\n\n"
+    "- [Docs](https://example.com/docs 'Docs title') and <https://auto.link>\n"
+    "- [![badge](badge.svg)](https://ci.example.com)\n\n"
+    "```\n![not an image](code.png)\n```\n\n"
+    "<div>\n[not a link](html)\n</div>\n\n"
+    "| a | b |\n|---|---|\n| ![cell](cell.png) | [ref] |\n\n"
+    "> ![quoted](q.png)\n\n"
+    "[ref]: https://example.com/ref\n";
+
+// The image and link nodes of the full parse, in document order
+std::vector<const MarkdownNode*> resourceNodes(const MarkdownNode* root) {
+    std::vector<const MarkdownNode*> nodes;
+    walkTree(
+        root,
+        [&](const MarkdownNode* node, size_t) {
+            if (node->type == "image" || node->type == "link") {
+                nodes.push_back(node);
+            }
+            return true;
+        },
+        [](const MarkdownNode*) {});
+    return nodes;
+}
+
+// Extracts the resources of `content` and checks them against its AST
+void checkAgainstAst(const std::string& content, InternalParserOptions options = InternalParserOptions()) {
+    auto extracted = DocumentResources::extract(content, options);
+    CHECK(extracted.success);
+    options.sourcePositions = true;
+    auto parsed = MarkdownParser::parse(content, options);
+    CHECK(parsed.success);
+    auto nodes = resourceNodes(parsed.nodes[0].get());
+    CHECK_EQ(extracted.resources.size(), nodes.size());
+    for (size_t i = 0; i < nodes.size() && i < extracted.resources.size(); i++) {
+        const auto& resource = extracted.resources[i];
+        const auto* node = nodes[i];
+        CHECK_EQ(resource.image, node->type == "image");
+        CHECK_EQ(resource.url, (resource.image ? node->src : node->href).value_or(""));
+        CHECK(resource.title == node->title);
+        CHECK_EQ(resource.start, node->position->start);
+        CHECK_EQ(resource.end, node->position->end);
+    }
+}
+
+} // namespace
+
+TEST(imagesAndLinks) {
+    auto extracted = DocumentResources::extract(kDocument);
+    CHECK(extracted.success);
+    const auto& resources = extracted.resources;
+    CHECK_EQ(resources.size(), size_t{8});
+    if (resources.size() != 8) {
+        return;
+    }
+    CHECK(resources[0].image);
+    CHECK_EQ(resources[0].url, "logo.png");
+    CHECK(resources[0].alt == std::optional<std::string>("logo"));
+    CHECK(resources[0].title == std::optional<std::string>("The logo"));
+    CHECK_EQ(kDocument.substr(resources[0].start, resources[0].end - resources[0].start),
+             "![logo](logo.png \"The logo\")");
+
+    CHECK(!resources[1].image);
+    CHECK_EQ(resources[1].url, "https://example.com/docs");
+    CHECK(resources[1].title == std::optional<std::string>("Docs title"));
+    CHECK(!resources[1].alt);
+    CHECK_EQ(resources[2].url, "https://auto.link");
+
+    // A linked image: the link, then the image inside it
+    CHECK(!resources[3].image);
+    CHECK_EQ(resources[3].url, "https://ci.example.com");
+    CHECK(resources[4].image);
+    CHECK_EQ(resources[4].url, "badge.svg");
+    CHECK(resources[3].start < resources[4].start && resources[4].end < resources[3].end);
+
+    // Nothing from the code and HTML blocks
+    CHECK_EQ(resources[5].url, "cell.png");
+    CHECK_EQ(resources[6].url, "https://example.com/ref");
+    CHECK_EQ(kDocument.substr(resources[6].start, resources[6].end - resources[6].start), "[ref]");
+    CHECK_EQ(resources[7].url, "q.png");
+}
+
+TEST(matchesTheAst) {
+    checkAgainstAst(kDocument);
+    checkAgainstAst("Visit www.example.com, https://example.org/a?b or mail me@example.net.\n");
+    checkAgainstAst("[empty]() ![](no-alt.png) [*emphasis* `code`](x \"t\")\n\n"
+                    "Line one [link\nacross lines](y)\n");
+    checkAgainstAst("  # [A](a)\n1. > [B](b)\n   > ![C](c)\n");
+}
+
+TEST(altText) {
+    // The images and links in the description of an image are not
+    // rendered: only their text goes into the alt
+    auto extracted = DocumentResources::extract("![a *b*\n![c](in.png) [d](l)](out.png)");
+    CHECK(extracted.success);
+    CHECK_EQ(extracted.resources.size(), size_t{1});
+    if (!extracted.resources.empty()) {
+        CHECK_EQ(extracted.resources[0].url, "out.png");
+        CHECK(extracted.resources[0].alt == std::optional<std::string>("a b c d"));
+    }
+}
+
+TEST(flags) {
+    const std::string content = "See www.example.com and https://example.org or [a link](z).\n";
+    CHECK_EQ(DocumentResources::extract(content).resources.size(), size_t{3});
+    InternalParserOptions options;
+    options.gfm = false;
+    options.enableAutolink = false;
+    auto extracted = DocumentResources::extract(content, options);
+    CHECK_EQ(extracted.resources.size(), size_t{1});
+}
+
+TEST(json) {
+    InternalParserOptions limited;
+    limited.maxInputSize = 4;
+    std::vector<DocumentResources> documents = {
+        DocumentResources::extract("![a \"b\"](x.png 't') <https://y>"),
+        DocumentResources::extract("no resources"),
+        DocumentResources::extract("too long", limited),
+    };
+    CHECK_EQ(MarkdownSerializer::resourcesToJson(documents),
+             "[{\"success\":true,\"resources\":["
+             "{\"type\":\"image\",\"src\":\"x.png\",\"alt\":\"a \\\"b\\\"\",\"title\":\"t\",\"start\":0,\"end\":19},"
+             "{\"type\":\"link\",\"href\":\"https://y\",\"start\":20,\"end\":31}]},"
+             "{\"success\":true,\"resources\":[]},"
+             "{\"success\":false,\"resources\":[],\"error\":\"Input exceeds maximum size limit\"}]");
+}
+
+HYPERMARKDOWN_TEST_MAIN()
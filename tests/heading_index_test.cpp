@@ -0,0 +1,161 @@
+/**
+ * Heading index tests
+ *
+ * Collects the headings of documents (collectHeadings, headingsOnly) and
+ * checks their text, GitHub-style slugs, offsets and paths into the tree.
+ */
+#include "HeadingSlugger.h"
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+using hypermarkdown_test::nodeAt;
+
+namespace {
+
+const std::string kDocument =
+    "# Title *one*\n\n"
+    "Some text\n\n"
+    "- item\n- ## In a `list`\n  more\n\n"
+    "> quote\n>\n> ### Quoted &amp; [linked](u)\n\n"
+    "Setext ![alt](x.png)\nover two lines\n------\n\n"
+    "#\n\n"
+    "# Title one\n\n"
+    "<div>\n\n## <b>Bold</b>\n\n</div>\n";
+
+std::vector<HeadingEntry> headingsOf(const std::string& content, InternalParserOptions options) {
+    options.collectHeadings = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success && result.headings);
+    return result.headings.value_or(std::vector<HeadingEntry>());
+}
+
+} // namespace
+
+TEST(githubSlugs) {
+    CHECK_EQ(HeadingSlugger::githubSlug("Hello World"), "hello-world");
+    CHECK_EQ(HeadingSlugger::githubSlug("Hello, World!"), "hello-world");
+    CHECK_EQ(HeadingSlugger::githubSlug("C++ & C#"), "c--c");
+    CHECK_EQ(HeadingSlugger::githubSlug("snake_case and kebab-case"), "snake_case-and-kebab-case");
+    CHECK_EQ(HeadingSlugger::githubSlug("  Spaces  "), "--spaces--");
+    CHECK_EQ(HeadingSlugger::githubSlug("Über Café ÀÉ"), "über-café-àé");
+    CHECK_EQ(HeadingSlugger::githubSlug("Ελληνικά Русский"), "ελληνικά-русский");
+    CHECK_EQ(HeadingSlugger::githubSlug("日本語「テスト」"), "日本語テスト");
+    CHECK_EQ(HeadingSlugger::githubSlug("\xF0\x9F\x8E\x89 Release \xE2\x80\x94 v2.0"), "-release--v20");
+    CHECK_EQ(HeadingSlugger::githubSlug("x² ½ µ"), "x--µ");
+}
+
+TEST(duplicates) {
+    HeadingSlugger slugger;
+    CHECK_EQ(slugger.slug("Intro"), "intro");
+    CHECK_EQ(slugger.slug("intro"), "intro-1");
+    CHECK_EQ(slugger.slug("Intro-1"), "intro-1-1");
+    CHECK_EQ(slugger.slug("Intro"), "intro-2");
+    CHECK_EQ(slugger.slug(""), "");
+    CHECK_EQ(slugger.slug("!"), "-1");
+}
+
+TEST(entities) {
+    std::string out;
+    HeadingSlugger::appendEntity(out, "&amp;");
+    HeadingSlugger::appendEntity(out, "&#65;");
+    HeadingSlugger::appendEntity(out, "&#x1F600;");
+    HeadingSlugger::appendEntity(out, "&#0;");
+    HeadingSlugger::appendEntity(out, "&copy;");
+    CHECK_EQ(out, "&A\xF0\x9F\x98\x80\xEF\xBF\xBD&copy;");
+}
+
+TEST(index) {
+    auto headings = headingsOf(kDocument, InternalParserOptions());
+    CHECK_EQ(headings.size(), 7u);
+    if (headings.size() != 7) {
+        return;
+    }
+    CHECK_EQ(headings[0].text, "Title one");
+    CHECK_EQ(headings[0].slug, "title-one");
+    CHECK_EQ(headings[0].level, 1);
+    CHECK_EQ(headings[1].text, "In a list");
+    CHECK_EQ(headings[1].level, 2);
+    CHECK(headings[1].path == std::vector<uint32_t>({2, 1, 0}));
+    CHECK_EQ(headings[2].text, "Quoted & linked");
+    CHECK_EQ(headings[2].slug, "quoted--linked");
+    CHECK(headings[2].path == std::vector<uint32_t>({3, 1}));
+    // Soft breaks are spaces, images give their alt text
+    CHECK_EQ(headings[3].text, "Setext alt over two lines");
+    CHECK_EQ(headings[3].level, 2);
+    CHECK_EQ(headings[4].text, "");
+    CHECK_EQ(headings[5].slug, "title-one-1");
+    // Inline HTML is not text
+    CHECK_EQ(headings[6].text, "Bold");
+}
+
+TEST(offsetsAndPaths) {
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    options.collectHeadings = true;
+    auto result = MarkdownParser::parse(kDocument, options);
+    CHECK(result.success && result.headings);
+    if (!result.success || !result.headings) {
+        return;
+    }
+    // The same offsets without positions
+    auto plain = headingsOf(kDocument, InternalParserOptions());
+    CHECK_EQ(plain.size(), result.headings->size());
+    for (size_t i = 0; i < result.headings->size() && i < plain.size(); i++) {
+        const auto& heading = (*result.headings)[i];
+        const auto* node = nodeAt(result.nodes.front().get(), heading.path);
+        CHECK(node && node->type == "heading");
+        CHECK(node && node->position && node->position->start == heading.offset);
+        CHECK_EQ(plain[i].offset, heading.offset);
+    }
+    CHECK_EQ(result.headings->front().offset, 2u);
+    CHECK_EQ(LineIndex(kDocument).locate(result.headings->at(1).offset).line, 6u);
+}
+
+TEST(headingsOnly) {
+    InternalParserOptions options;
+    auto full = headingsOf(kDocument, options);
+    options.headingsOnly = true;
+    auto result = MarkdownParser::parse(kDocument, options);
+    CHECK(result.success && result.headings && result.nodes.empty());
+    if (!result.headings) {
+        return;
+    }
+    CHECK_EQ(result.headings->size(), full.size());
+    for (size_t i = 0; i < full.size() && i < result.headings->size(); i++) {
+        const auto& heading = (*result.headings)[i];
+        CHECK_EQ(heading.text, full[i].text);
+        CHECK_EQ(heading.slug, full[i].slug);
+        CHECK_EQ(heading.offset, full[i].offset);
+        CHECK(heading.path == full[i].path);
+    }
+}
+
+TEST(deferredHeadings) {
+    InternalParserOptions options;
+    options.deferInlines = true;
+    auto headings = headingsOf("# A *b*\n\nc\n\n## D &amp; e\n", options);
+    CHECK_EQ(headings.size(), 2u);
+    if (headings.size() == 2) {
+        // The source of the heading's contents stands for its text
+        CHECK_EQ(headings[0].text, "A *b*");
+        CHECK_EQ(headings[0].slug, "a-b");
+        CHECK_EQ(headings[1].slug, "d-amp-e");
+    }
+}
+
+TEST(json) {
+    std::string content = "Text\n\n## Two \"quoted\"\n";
+    auto headings = headingsOf(content, InternalParserOptions());
+    CHECK_EQ(MarkdownSerializer::headingsToJson(headings, LineIndex(content)),
+             "[{\"level\":2,\"text\":\"Two \\\"quoted\\\"\",\"slug\":\"two-quoted\",\"offset\":9,\"line\":3,"
+             "\"path\":[1]}]");
+    InternalParserOptions options;
+    options.headingsOnly = true;
+    auto empty = MarkdownParser::parse("", options);
+    CHECK(empty.success && empty.headings && empty.headings->empty());
+}
+
+HYPERMARKDOWN_TEST_MAIN()
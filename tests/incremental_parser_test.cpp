@@ -0,0 +1,151 @@
+/**
+ * Incremental parsing tests
+ *
+ * Parses documents in steps and checks that the blocks of all steps, put
+ * back into the document of the last one, give the JSON of a one-shot
+ * parse.
+ */
+#include "IncrementalParser.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+const std::string kDocument =
+    "# Title *one*\n\n"
+    "Some *text*\nover two lines\n\n"
+    "```js\nconst a = 1\n```\n\n"
+    "- one **1**\n- two\n  ***\n  after\n- three\n  - nested `x`\n\n"
+    "1. loose\n\n   second\n\n"
+    "Setext [link][ref]\n======\n\n"
+    "> quote\n> > deeper\n\n"
+    "| a | *b* |\n|---|---|\n| 1 | 2 |\n\n"
+    "<div>\nhtml\n</div>\n\n"
+    "![image](x.png) and [ref]\n\n"
+    "[ref]: http://example.com\n";
+
+// A document of many blocks, so that parsing takes many steps
+std::string longDocument() {
+    std::string content;
+    for (int i = 0; i < 300; i++) {
+        content += kDocument;
+    }
+    return content;
+}
+
+// Parses `content` in steps of `budgetMs` and reassembles the document
+std::string parseInSteps(const std::string& content, const InternalParserOptions& options, double budgetMs,
+                         size_t* steps = nullptr) {
+    IncrementalParser parser(content, options);
+    std::string children;
+    for (size_t i = 0;; i++) {
+        auto step = parser.step(budgetMs);
+        CHECK(step.success);
+        if (!step.success) {
+            return std::string();
+        }
+        if (step.blocks.size() > 2) {
+            children += children.empty() ? "" : ",";
+            children.append(step.blocks, 1, step.blocks.size() - 2);
+        }
+        if (step.done) {
+            if (steps) {
+                *steps = i + 1;
+            }
+            CHECK(step.document.has_value());
+            std::string document = step.document.value_or("");
+            if (children.empty() || document.empty()) {
+                return document;
+            }
+            document.pop_back();
+            return document + ",\"children\":[" + children + "]}";
+        }
+    }
+}
+
+void checkSteps(const std::string& content, const InternalParserOptions& options, double budgetMs) {
+    auto full = MarkdownParser::parse(content, options);
+    CHECK(full.success);
+    std::optional<LineIndex> lines;
+    if (options.sourcePositions) {
+        lines.emplace(full.normalizedInput ? *full.normalizedInput : content);
+    }
+    CHECK_EQ(parseInSteps(content, options, budgetMs),
+             MarkdownSerializer::nodeToJson(full.nodes.front(), lines ? &*lines : nullptr));
+}
+
+} // namespace
+
+TEST(matchesOneShotParse) {
+    checkSteps(kDocument, InternalParserOptions(), 0);
+    checkSteps(longDocument(), InternalParserOptions(), 0);
+    checkSteps(longDocument(), InternalParserOptions(), 1000);
+    checkSteps("", InternalParserOptions(), 0);
+    checkSteps("plain", InternalParserOptions(), 0);
+}
+
+TEST(matchesWithOptions) {
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    checkSteps(longDocument(), options, 0);
+    options.textRuns = true;
+    options.highlightCode = true;
+    checkSteps(longDocument(), options, 0);
+    InternalParserOptions plain;
+    plain.gfm = false;
+    plain.enableTables = false;
+    plain.normalizeInput = true;
+    checkSteps("a\r\nb\r\n\n| a |\r\n|---|\n", plain, 0);
+}
+
+TEST(stepsAreBounded) {
+    // A zero budget runs one chunk per step, so a long document takes many
+    // steps, and every step but the ones of the block analysis has blocks
+    size_t steps = 0;
+    parseInSteps(longDocument(), InternalParserOptions(), 0, &steps);
+    CHECK(steps > 10);
+    
+    IncrementalParser parser(longDocument(), InternalParserOptions());
+    bool sawBlocks = false;
+    while (true) {
+        auto step = parser.step(0);
+        CHECK(step.success);
+        if (!step.success || step.done) {
+            break;
+        }
+        CHECK(!sawBlocks || step.blocks != "[]");
+        sawBlocks |= step.blocks != "[]";
+    }
+    CHECK(sawBlocks);
+    // Steps after the last one are done, without blocks
+    auto after = parser.step(0);
+    CHECK(after.success && after.done && after.blocks == "[]");
+}
+
+TEST(errors) {
+    InternalParserOptions options;
+    options.maxInputSize = 4;
+    IncrementalParser tooLarge("too large", options);
+    auto step = tooLarge.step(10);
+    CHECK(!step.success && step.error && step.error->message == "Input exceeds maximum size limit");
+    
+    InternalParserOptions limited;
+    limited.maxMemory = 4096;
+    IncrementalParser outOfMemory(longDocument(), limited);
+    bool failed = false;
+    for (int i = 0; i < 10000 && !failed; i++) {
+        auto result = outOfMemory.step(0);
+        failed = !result.success;
+        CHECK(failed || !result.done);
+        if (failed) {
+            CHECK(result.error && result.error->message == "Parse exceeds maximum memory limit");
+        }
+    }
+    CHECK(failed);
+    CHECK(!outOfMemory.step(0).success);
+}
+
+HYPERMARKDOWN_TEST_MAIN()
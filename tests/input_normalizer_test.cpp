@@ -0,0 +1,69 @@
+/**
+ * InputNormalizer tests
+ *
+ * Clean input is left alone; invalid UTF-8 (overlong forms, surrogates,
+ * truncated and stray bytes), NULs and CR line endings are replaced, at
+ * every position relative to the 16-byte chunks of the vectorized scan.
+ */
+#include "InputNormalizer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+const std::string kFffd = "\xEF\xBF\xBD";
+
+// The input normalized, or "<clean>" if it needs no changes
+std::string normalized(const std::string& input) {
+    std::string out;
+    return InputNormalizer::normalize(input, out) ? out : "<clean>";
+}
+
+} // namespace
+
+TEST(cleanInput) {
+    CHECK_EQ(normalized(""), "<clean>");
+    CHECK_EQ(normalized("# Title\n\nSome *text*\n"), "<clean>");
+    CHECK_EQ(normalized("héllo 中文 🚀 \xF4\x8F\xBF\xBF"), "<clean>");
+}
+
+TEST(lineEndings) {
+    CHECK_EQ(normalized("a\r\nb\rc\n"), "a\nb\nc\n");
+    CHECK_EQ(normalized("\r\r\n\r"), "\n\n\n");
+}
+
+TEST(nul) {
+    CHECK_EQ(normalized(std::string("a\0b", 3)), "a" + kFffd + "b");
+}
+
+TEST(invalidUtf8) {
+    // Stray continuation byte and invalid lead bytes
+    CHECK_EQ(normalized("a\x80z"), "a" + kFffd + "z");
+    CHECK_EQ(normalized("\xC0\xAF"), kFffd + kFffd);
+    CHECK_EQ(normalized("\xF5\x80"), kFffd + kFffd);
+    // Overlong forms and surrogates
+    CHECK_EQ(normalized("\xE0\x80\xAF"), kFffd + kFffd + kFffd);
+    CHECK_EQ(normalized("\xED\xA0\x80"), kFffd + kFffd + kFffd);
+    CHECK_EQ(normalized("\xF4\x90\x80\x80"), kFffd + kFffd + kFffd + kFffd);
+    // A truncated sequence is one maximal subpart
+    CHECK_EQ(normalized("\xE4\xB8z"), kFffd + "z");
+    CHECK_EQ(normalized("\xF0\x9F\x9A"), kFffd);
+    CHECK_EQ(normalized("中\xE4"), "中" + kFffd);
+}
+
+TEST(everyChunkPosition) {
+    bool replaced = true;
+    for (size_t at = 0; at < 40; at++) {
+        for (const std::string& bad : {std::string("\r"), std::string(1, '\0'), std::string("\xFF")}) {
+            std::string input(40, 'x');
+            input.insert(at, bad);
+            std::string expected(40, 'x');
+            expected.insert(at, bad == "\r" ? "\n" : kFffd);
+            replaced &= normalized(input) == expected;
+        }
+    }
+    CHECK(replaced);
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,111 @@
+/**
+ * LineIndex tests
+ *
+ * Line and column lookups for every kind of line ending, UTF-16 columns,
+ * lookups in and out of document order, agreement of the vectorized scan
+ * with a byte-by-byte one, and that line starts are only found as far as
+ * needed.
+ */
+#include "LineIndex.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+std::string locate(const LineIndex& lines, size_t offset) {
+    auto location = lines.locate(offset);
+    return std::to_string(location.line) + ":" + std::to_string(location.column);
+}
+
+} // namespace
+
+TEST(lineEndings) {
+    std::string text = "ab\ncd\r\nef\rgh";
+    LineIndex lines(text);
+    CHECK_EQ(locate(lines, 0), "1:1");
+    CHECK_EQ(locate(lines, 2), "1:3");
+    CHECK_EQ(locate(lines, 3), "2:1");
+    CHECK_EQ(locate(lines, 6), "2:4");
+    CHECK_EQ(locate(lines, 7), "3:1");
+    CHECK_EQ(locate(lines, 10), "4:1");
+    CHECK_EQ(locate(lines, 12), "4:3");
+}
+
+TEST(endOfInput) {
+    std::string text = "a\n";
+    LineIndex lines(text);
+    CHECK_EQ(locate(lines, 2), "2:1");
+    CHECK_EQ(locate(lines, 100), "2:1");
+    CHECK_EQ(locate(LineIndex(std::string()), 0), "1:1");
+}
+
+TEST(anyOrder) {
+    std::string text;
+    for (int i = 0; i < 100; i++) {
+        text += "line\n";
+    }
+    LineIndex lines(text);
+    CHECK_EQ(locate(lines, 5 * 70 + 2), "71:3");
+    CHECK_EQ(locate(lines, 5 * 3), "4:1");
+    CHECK_EQ(locate(lines, 5 * 4 + 1), "5:2");
+    CHECK_EQ(locate(lines, 5 * 99 + 4), "100:5");
+    CHECK_EQ(locate(lines, 1), "1:2");
+}
+
+TEST(utf16Columns) {
+    // é takes two bytes and one unit, 中 three bytes and one unit, 🚀 four
+    // bytes and a surrogate pair
+    std::string text = "é中🚀x\n🚀";
+    LineIndex lines(text);
+    CHECK_EQ(locate(lines, 2), "1:2");
+    CHECK_EQ(locate(lines, 5), "1:3");
+    CHECK_EQ(locate(lines, 9), "1:5");
+    CHECK_EQ(locate(lines, 10), "1:6");
+    CHECK_EQ(locate(lines, 15), "2:3");
+    CHECK_EQ(locate(lines, 9), "1:5");
+}
+
+TEST(matchesBytewiseScan) {
+    std::mt19937 random(39);
+    const char alphabet[] = {'a', 'b', ' ', '\n', '\r', '\xc3', '\xa9', '\xf0'};
+    std::string text;
+    for (int i = 0; i < 5000; i++) {
+        text += alphabet[random() % sizeof(alphabet)];
+    }
+    LineIndex lines(text);
+    uint32_t line = 1;
+    size_t lineStart = 0;
+    bool same = true;
+    for (size_t offset = 0; offset <= text.size() && same; offset++) {
+        if (offset > 0 && (text[offset - 1] == '\n' || (text[offset - 1] == '\r' && text[offset] != '\n'))) {
+            line++;
+            lineStart = offset;
+        }
+        uint32_t column = 1;
+        for (size_t i = lineStart; i < offset; i++) {
+            auto byte = static_cast<unsigned char>(text[i]);
+            column += ((byte & 0xC0) != 0x80) + (byte >= 0xF0);
+        }
+        auto location = lines.locate(offset);
+        same = location.line == line && location.column == column;
+    }
+    CHECK(same);
+}
+
+TEST(lazy) {
+    std::string text;
+    for (int i = 0; i < 100000; i++) {
+        text += "line\n";
+    }
+    LineIndex lines(text);
+    CHECK_EQ(lines.scannedLines(), 1u);
+    CHECK_EQ(locate(lines, 12), "3:3");
+    CHECK(lines.scannedBytes() < text.size() / 4);
+    CHECK_EQ(locate(lines, text.size()), "100001:1");
+    CHECK_EQ(lines.scannedLines(), 100001u);
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,108 @@
+/**
+ * Deep nesting tests
+ *
+ * Parses, serializes and destroys trees 100k levels deep on a thread with
+ * a 256 KB stack, the size of a small background thread. Any of them
+ * recursing once per level would overflow it.
+ */
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+#include <functional>
+#include <pthread.h>
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+constexpr size_t kDepth = 100000;
+constexpr size_t kStackSize = 256 * 1024;
+
+std::string repeat(const std::string& s, size_t n) {
+    std::string out;
+    out.reserve(s.size() * n);
+    for (size_t i = 0; i < n; i++) {
+        out += s;
+    }
+    return out;
+}
+
+// Runs `fn` to completion on a thread with a kStackSize stack
+void onSmallStack(const std::function<void()>& fn) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, kStackSize);
+    pthread_t thread;
+    auto run = [](void* arg) -> void* {
+        (*static_cast<const std::function<void()>*>(arg))();
+        return nullptr;
+    };
+    bool started = pthread_create(&thread, &attr, run, const_cast<std::function<void()>*>(&fn)) == 0;
+    CHECK(started);
+    if (started) {
+        pthread_join(thread, nullptr);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// Parses, serializes and frees `content` on the small stack
+void parseDeep(const std::string& content) {
+    onSmallStack([&] {
+        InternalParserOptions options;
+        auto result = MarkdownParser::parse(content, options);
+        CHECK(result.success);
+        std::string json = MarkdownSerializer::toJson(result.nodes);
+        CHECK(json.size() > 2 && json.front() == '[' && json.back() == ']');
+    });
+}
+
+} // namespace
+
+TEST(deepBlockquotes) {
+    parseDeep(repeat("> ", kDepth) + "a\n");
+}
+
+TEST(deepLists) {
+    parseDeep(repeat("- ", kDepth) + "a\n");
+}
+
+TEST(deepEmphasis) {
+    parseDeep(repeat("*a ", kDepth) + "b" + repeat(" a*", kDepth) + "\n");
+}
+
+TEST(deepBrackets) {
+    parseDeep(repeat("![", kDepth) + "a" + repeat("](b)", kDepth) + "\n");
+}
+
+TEST(deepTree) {
+    // md4c bounds the nesting it produces, so build the tree by hand
+    auto root = std::make_shared<MarkdownNode>("document");
+    MarkdownNode* leaf = root.get();
+    for (size_t i = 0; i < kDepth; i++) {
+        auto child = std::make_shared<MarkdownNode>(i % 2 ? "list" : "blockquote");
+        MarkdownNode* next = child.get();
+        leaf->children.push_back(std::move(child));
+        leaf = next;
+    }
+    leaf->children.push_back(std::make_shared<MarkdownNode>("text"));
+
+    onSmallStack([&] {
+        std::string json = MarkdownSerializer::toJson({root});
+        size_t nodes = 0;
+        walkTree(root.get(), [&](const MarkdownNode*, size_t) { return ++nodes > 0; }, [](const MarkdownNode*) {});
+        CHECK_EQ(nodes, kDepth + 2);
+        std::string expected = "[{\"type\":\"document\",\"children\":[";
+        for (size_t i = 0; i < kDepth; i++) {
+            expected += i % 2 ? "{\"type\":\"list\",\"children\":[" : "{\"type\":\"blockquote\",\"children\":[";
+        }
+        expected += "{\"type\":\"text\"}" + repeat("]}", kDepth + 1) + "]";
+        CHECK(json == expected);
+
+        // Drop the only reference on the small stack
+        root.reset();
+    });
+    CHECK(!root);
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,358 @@
+/**
+ * MarkdownParser tests
+ *
+ * Checks the tree shape the JS renderers rely on: node types, the
+ * properties carried by headings, lists, code blocks, links, images and
+ * tables, and the failure paths.
+ */
+#include "MarkdownParser.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+std::shared_ptr<MarkdownNode> parseDocument(const std::string& content) {
+    auto result = MarkdownParser::parse(content);
+    CHECK(result.success);
+    CHECK_EQ(result.nodes.size(), 1u);
+    return result.success && !result.nodes.empty() ? result.nodes[0] : std::make_shared<MarkdownNode>("document");
+}
+
+// First node of the given type in document order
+std::shared_ptr<MarkdownNode> find(const std::shared_ptr<MarkdownNode>& node, const std::string& type) {
+    if (node->type == type) {
+        return node;
+    }
+    for (const auto& child : node->children) {
+        if (auto found = find(child, type)) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+std::string textOf(const std::shared_ptr<MarkdownNode>& node) {
+    std::string text = node->content.value_or("");
+    for (const auto& child : node->children) {
+        text += textOf(child);
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(paragraphWithEmphasis) {
+    auto doc = parseDocument("Hello *world* and **bold**\n");
+    CHECK_EQ(doc->type, "document");
+    auto paragraph = find(doc, "paragraph");
+    CHECK(paragraph != nullptr);
+    CHECK(find(doc, "emphasis") != nullptr);
+    CHECK(find(doc, "strong") != nullptr);
+    CHECK_EQ(textOf(paragraph), "Hello world and bold");
+}
+
+TEST(headingLevel) {
+    auto heading = find(parseDocument("### Title\n"), "heading");
+    CHECK(heading != nullptr);
+    CHECK(heading && heading->level == 3);
+    CHECK(heading && textOf(heading) == "Title");
+}
+
+TEST(fencedCodeBlock) {
+    auto code = find(parseDocument("```ts\nconst a = 1;\n  indented();\n```\n"), "code_block");
+    CHECK(code != nullptr);
+    CHECK(code && code->language == std::string("ts"));
+    CHECK(code && textOf(code) == "const a = 1;\n  indented();\n");
+}
+
+TEST(codeBlockInsideList) {
+    auto code = find(parseDocument("- item\n\n  ```\n  a\n    b\n  ```\n"), "code_block");
+    CHECK(code != nullptr);
+    CHECK(code && textOf(code) == "a\n  b\n");
+}
+
+TEST(orderedListStart) {
+    auto list = find(parseDocument("3. three\n4. four\n"), "list");
+    CHECK(list != nullptr);
+    CHECK(list && list->ordered == true);
+    CHECK(list && list->start == 3);
+    CHECK(list && list->children.size() == 2);
+}
+
+TEST(taskList) {
+    auto doc = parseDocument("- [x] done\n- [ ] todo\n");
+    auto list = find(doc, "list");
+    CHECK(list && list->children.size() == 2);
+    if (list && list->children.size() == 2) {
+        CHECK(list->children[0]->checked == true);
+        CHECK(list->children[1]->checked == false);
+    }
+}
+
+TEST(linkAndImage) {
+    auto doc = parseDocument("[site](https://example.com \"Home\") ![logo](logo.png)\n");
+    auto link = find(doc, "link");
+    CHECK(link && link->href == std::string("https://example.com"));
+    CHECK(link && link->title == std::string("Home"));
+    auto image = find(doc, "image");
+    CHECK(image && image->src == std::string("logo.png"));
+    CHECK(image && image->alt == std::string("logo"));
+}
+
+TEST(tableAlignment) {
+    auto doc = parseDocument("| a | b |\n|:--|--:|\n| 1 | 2 |\n");
+    auto table = find(doc, "table");
+    CHECK(table != nullptr);
+    auto cell = find(doc, "table_cell");
+    CHECK(cell && cell->isHeader == true);
+    CHECK(cell && cell->align == TableCellAlign::Left);
+}
+
+TEST(inputSizeLimit) {
+    InternalParserOptions options;
+    options.maxInputSize = 4;
+    auto result = MarkdownParser::parse("too long", options);
+    CHECK(!result.success);
+    CHECK(result.error && result.error->message == "Input exceeds maximum size limit");
+}
+
+TEST(timingsOnlyWhenRequested) {
+    auto plain = MarkdownParser::parse("# a\n\nb *c*\n");
+    CHECK(plain.success && !plain.timings);
+
+    InternalParserOptions options;
+    options.collectTimings = true;
+    std::string content = "# a\n\nb *c*\n";
+    auto timed = MarkdownParser::parse(content, options);
+    CHECK(timed.success && timed.timings);
+    if (timed.timings) {
+        // document, heading, text, paragraph, text, emphasis, text
+        CHECK_EQ(timed.timings->nodeCount, 7u);
+        CHECK_EQ(timed.timings->inputBytes, content.size());
+        CHECK(timed.timings->blockMs >= 0 && timed.timings->inlineMs >= 0 && timed.timings->treeMs >= 0);
+        CHECK(timed.timings->totalMs >= timed.timings->blockMs);
+    }
+}
+
+TEST(memoryOnlyWhenRequested) {
+    auto plain = MarkdownParser::parse("# a\n\nb *c*\n");
+    CHECK(plain.success && !plain.memory);
+
+    InternalParserOptions options;
+    options.collectMemory = true;
+    auto counted = MarkdownParser::parse("# a\n\nb *c*\n\n- d\n- e\n", options);
+    CHECK(counted.success && counted.memory);
+    if (counted.memory) {
+        CHECK(counted.memory->md4c.allocations > 0);
+        CHECK(counted.memory->ast.allocations > 0);
+        // md4c frees everything before md_parse() returns, the tree stays
+        CHECK_EQ(counted.memory->md4c.liveBytes, 0u);
+        CHECK_EQ(counted.memory->liveBytes, counted.memory->ast.liveBytes);
+        CHECK(counted.memory->peakBytes >= counted.memory->ast.peakBytes);
+    }
+}
+
+TEST(maxMemory) {
+    std::string content;
+    for (int i = 0; i < 200; i++) {
+        content += "- item *" + std::to_string(i) + "*\n";
+    }
+
+    InternalParserOptions options;
+    options.maxMemory = 4096;
+    auto capped = MarkdownParser::parse(content, options);
+    CHECK(!capped.success);
+    CHECK_EQ(capped.error ? capped.error->message : "", "Parse exceeds maximum memory limit");
+
+    options.maxMemory = 64 * 1024 * 1024;
+    auto roomy = MarkdownParser::parse(content, options);
+    CHECK(roomy.success && roomy.memory && !roomy.memory->exceeded);
+}
+
+TEST(maxMemorySweep) {
+    // Every allocation md4c and the tree build make fails in turn, as the
+    // limit grows until the parse fits: each failure has to come out clean
+    // (the sanitizer build checks for leaks and double frees)
+    const std::vector<std::string> documents = {
+        "[x](/u \"a&amp;\\*b\") ![y](/v&amp;w 't&lt;')",
+        "~~~ lang&amp;x info\\*\ncode\n~~~\n",
+        "[ref\nlabel]: /url\n  \"multi\nline title\"\n\n[ref label] and [Ref   LABEL][]\n",
+        "> - a *b* **c**\n>   - [[wiki&amp;link]]\n\n| a | b |\n|---|---|\n| `c` | <http://d> |\n",
+        "* [ ] task\n\n      indented\n\n<div>\nhtml\n</div>\n\n$x^2$ ~~s~~ www.example.com\n",
+    };
+    for (const auto& content : documents) {
+        InternalParserOptions options;
+        options.wiki = true;
+        options.math = true;
+        bool parsed = false;
+        for (size_t limit = 8; !parsed && limit < 1024 * 1024; limit += 8) {
+            options.maxMemory = limit;
+            auto result = MarkdownParser::parse(content, options);
+            parsed = result.success;
+            if (!parsed) {
+                CHECK_EQ(result.error ? result.error->message : "", "Parse exceeds maximum memory limit");
+            }
+        }
+        CHECK(parsed);
+    }
+}
+
+TEST(positionsOnlyWhenRequested) {
+    auto doc = parseDocument("# Title\n\nSome *text*\n");
+    bool anyPosition = false;
+    walkTree(doc.get(), [&](const MarkdownNode* node, size_t) { anyPosition |= node->position.has_value(); return true; },
+             [](const MarkdownNode*) {});
+    CHECK(!anyPosition);
+}
+
+TEST(sourcePositions) {
+    std::string content = "# Title\n\n> Some *text* and [a link](url)\n\n- one\n- two\n";
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success);
+    if (!result.success) {
+        return;
+    }
+    auto doc = result.nodes[0];
+    auto source = [&](const std::shared_ptr<MarkdownNode>& node) {
+        if (!node || !node->position) {
+            return std::string("<none>");
+        }
+        return content.substr(node->position->start, node->position->end - node->position->start);
+    };
+
+    CHECK_EQ(source(doc), content);
+    CHECK_EQ(source(find(doc, "heading")), "Title");
+    CHECK_EQ(source(find(doc, "emphasis")), "*text*");
+    CHECK_EQ(source(find(doc, "link")), "[a link](url)");
+    CHECK_EQ(source(find(find(doc, "link"), "text")), "a link");
+    // Containers take the range of their children
+    CHECK_EQ(source(find(doc, "blockquote")), "Some *text* and [a link](url)");
+    CHECK_EQ(source(find(doc, "list")), "one\n- two");
+
+    // Every node has a range within its parent's
+    bool nested = true;
+    std::vector<const MarkdownNode*> parents;
+    walkTree(
+        doc.get(),
+        [&](const MarkdownNode* node, size_t) {
+            nested &= node->position.has_value() && node->position->start <= node->position->end;
+            if (!parents.empty() && node->position) {
+                nested &= parents.back()->position->start <= node->position->start &&
+                          node->position->end <= parents.back()->position->end;
+            }
+            parents.push_back(node);
+            return nested;
+        },
+        [&](const MarkdownNode*) { parents.pop_back(); });
+    CHECK(nested);
+}
+
+TEST(memoryLimitLocation) {
+    std::string content;
+    for (int i = 0; i < 200; i++) {
+        content += "- item *" + std::to_string(i) + "*\n";
+    }
+
+    InternalParserOptions options;
+    options.maxMemory = 16 * 1024;
+    auto unplaced = MarkdownParser::parse(content, options);
+    CHECK(!unplaced.success && unplaced.error && !unplaced.error->line);
+
+    options.sourcePositions = true;
+    auto placed = MarkdownParser::parse(content, options);
+    CHECK(!placed.success && placed.error && placed.error->line && placed.error->column);
+    CHECK(placed.error && placed.error->line.value_or(0) > 1);
+}
+
+TEST(normalizeInput) {
+    const char raw[] = "# T\xFFitle\r\n\r\na\0b\r\n";
+    std::string content(raw, sizeof(raw) - 1);
+    InternalParserOptions options;
+    options.normalizeInput = true;
+    options.sourcePositions = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success && result.normalizedInput);
+    if (!result.success || !result.normalizedInput) {
+        return;
+    }
+    CHECK_EQ(*result.normalizedInput, "# T\xEF\xBF\xBDitle\n\na\xEF\xBF\xBD" "b\n");
+    CHECK_EQ(textOf(find(result.nodes[0], "heading")), "T\xEF\xBF\xBDitle");
+    CHECK_EQ(textOf(find(result.nodes[0], "paragraph")), "a\xEF\xBF\xBD" "b");
+    // Positions refer to the normalized input
+    CHECK(result.nodes[0]->position && result.nodes[0]->position->end == result.normalizedInput->size());
+
+    // Clean input is parsed in place
+    auto clean = MarkdownParser::parse("# Title\n", options);
+    CHECK(clean.success && !clean.normalizedInput);
+}
+
+TEST(embeddedNul) {
+    auto code = find(parseDocument(std::string("```\na\0b\n```\n", 12)), "code_block");
+    CHECK(code != nullptr);
+    CHECK(code && textOf(code).size() == 4 && textOf(code).back() == '\n');
+}
+
+TEST(highlightCode) {
+    const std::string content = "```py\nx = 1 # \xC3\xA9\n```\n\n```unknown\nx = 1\n```\n";
+    CHECK(find(parseDocument(content), "code_block")->tokens.empty());
+
+    InternalParserOptions options;
+    options.highlightCode = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success && result.nodes[0]->children.size() == 2);
+    if (!result.success || result.nodes[0]->children.size() != 2) {
+        return;
+    }
+    // Offsets in UTF-16 units of the code text
+    const auto& tokens = result.nodes[0]->children[0]->tokens;
+    CHECK_EQ(tokens.size(), 2u);
+    if (tokens.size() == 2) {
+        CHECK(tokens[0].offset == 4 && tokens[0].length == 1 && tokens[0].cls == CodeTokenClass::Number);
+        CHECK(tokens[1].offset == 6 && tokens[1].length == 3 && tokens[1].cls == CodeTokenClass::Comment);
+    }
+    // Languages without a lexer get no tokens
+    CHECK(result.nodes[0]->children[1]->tokens.empty());
+}
+
+TEST(textRuns) {
+    InternalParserOptions options;
+    options.textRuns = true;
+    auto result = MarkdownParser::parse("Hi *a **b***\n[\xC3\xA9 `c`](u \"t\") ![](i)\n\n- plain\n", options);
+    CHECK(result.success);
+    if (!result.success) {
+        return;
+    }
+    // One text node per paragraph, the spans are runs of it
+    auto paragraph = find(result.nodes[0], "paragraph");
+    CHECK_EQ(paragraph->children.size(), 1u);
+    auto text = paragraph->children.front();
+    CHECK_EQ(text->type, std::string("text"));
+    CHECK_EQ(*text->content, std::string("Hi a b \xC3\xA9 c "));
+    const auto& runs = text->runs;
+    CHECK_EQ(runs.size(), 8u);
+    if (runs.size() == 8) {
+        CHECK(runs[0].length == 3 && runs[0].styles == 0 && runs[0].link == -1);
+        CHECK(runs[1].length == 2 && runs[1].styles == kStyleEmphasis);
+        CHECK(runs[2].length == 1 && runs[2].styles == (kStyleEmphasis | kStyleStrong));
+        // The soft break is a space; lengths are in UTF-16 units
+        CHECK(runs[3].length == 1 && runs[3].styles == 0);
+        CHECK(runs[4].length == 2 && runs[4].styles == kStyleLink && runs[4].link == 0);
+        CHECK(runs[5].length == 1 && runs[5].styles == (kStyleLink | kStyleCode) && runs[5].link == 0);
+        // An image without alt text keeps an empty run
+        CHECK(runs[6].length == 1 && runs[6].styles == 0 && runs[6].link == -1);
+        CHECK(runs[7].length == 0 && runs[7].styles == kStyleImage && runs[7].link == 1);
+    }
+    CHECK_EQ(text->links.size(), 2u);
+    if (text->links.size() == 2) {
+        CHECK(text->links[0].href == "u" && text->links[0].title == "t" && !text->links[0].src);
+        CHECK(text->links[1].src == "i" && !text->links[1].href);
+    }
+    // Plain text has no runs
+    auto item = find(result.nodes[0], "list_item");
+    CHECK(item->children.size() == 1 && item->children[0]->content == "plain" && item->children[0]->runs.empty());
+}
+
+HYPERMARKDOWN_TEST_MAIN()
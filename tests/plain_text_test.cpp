@@ -0,0 +1,83 @@
+/**
+ * Plain text tests
+ *
+ * Extracts the rendered text of documents without an AST and checks its
+ * separators, alt texts and entities, and where it stops at maxChars.
+ */
+#include "PlainText.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+std::string plainText(const std::string& content, size_t maxChars = SIZE_MAX) {
+    auto plain = PlainText::extract(content, maxChars);
+    CHECK(plain.success);
+    return plain.text;
+}
+
+} // namespace
+
+TEST(blocks) {
+    CHECK_EQ(plainText("# Title\n\nFirst *line*\nsecond  \nthird\n\n> Quoted\n\n- one\n- two\n\n---\n\nEnd"),
+             "Title\nFirst line second\nthird\nQuoted\none\ntwo\nEnd");
+    CHECK_EQ(plainText("```js\nlet a = 1\nlet b = 2\n```\n\nAfter\n\n    indented\n"),
+             "let a = 1\nlet b = 2\nAfter\nindented");
+    CHECK_EQ(plainText("| a | b |\n|---|---|\n| 1 | **2** |\n"), "a b\n1 2");
+    CHECK_EQ(plainText(""), "");
+    CHECK_EQ(plainText("\n\n   \n"), "");
+}
+
+TEST(inlines) {
+    CHECK_EQ(plainText("See ![a *cat*](cat.png) and [the docs](https://x) or <https://y>"),
+             "See a cat and the docs or https://y");
+    CHECK_EQ(plainText("Fish &amp; chips &lt;3 &#x41;&#66; `&amp;`"), "Fish & chips <3 AB &amp;");
+    CHECK_EQ(plainText("Some <b>bold</b> text\n\n<div>\nraw block\n</div>\n\nafter"), "Some bold text\nafter");
+    CHECK_EQ(plainText(std::string("nul\0byte", 8)), "nul\xEF\xBF\xBD" "byte");
+    CHECK_EQ(plainText("bad \xC3 byte"), "bad \xEF\xBF\xBD byte");
+}
+
+TEST(maxChars) {
+    const std::string content = "# Hello\n\nWorld of *markdown*, and a lot more text after it.\n";
+    auto plain = PlainText::extract(content, 12);
+    CHECK(plain.success && plain.truncated);
+    CHECK_EQ(plain.text, "Hello\nWorld ");
+
+    plain = PlainText::extract("Hello", 5);
+    CHECK(plain.success && !plain.truncated);
+    CHECK_EQ(plain.text, "Hello");
+
+    plain = PlainText::extract("# Hello\n\nWorld", 5);
+    CHECK(plain.truncated);
+    CHECK_EQ(plain.text, "Hello");
+    CHECK_EQ(plainText("Hello", 0), "");
+
+    // UTF-16 code units, and never half a character
+    CHECK_EQ(plainText("日本語テキスト", 3), "日本語");
+    CHECK_EQ(plainText("a\xF0\x9F\x8E\x89" "b", 2), "a");
+    CHECK_EQ(plainText("a\xF0\x9F\x8E\x89" "b", 3), "a\xF0\x9F\x8E\x89");
+}
+
+TEST(stopsEarly) {
+    // A document whose inline content would take long to parse: the text
+    // is full after the first paragraph
+    std::string content = "Preview of the message.\n\n";
+    for (int i = 0; i < 20000; i++) {
+        content += "[link](url) *emphasis* `code` ";
+    }
+    auto plain = PlainText::extract(content, 23);
+    CHECK(plain.success && plain.truncated);
+    CHECK_EQ(plain.text, "Preview of the message.");
+}
+
+TEST(limits) {
+    InternalParserOptions options;
+    options.maxInputSize = 4;
+    auto plain = PlainText::extract("too long", SIZE_MAX, options);
+    CHECK(!plain.success);
+    CHECK(plain.error.has_value());
+    CHECK_EQ(plain.text, "");
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,52 @@
+/**
+ * NodeReclaimer tests
+ *
+ * Released trees must be freed by the reclaimer, and nodes the caller
+ * still references must survive the release.
+ */
+#include "MarkdownParser.h"
+#include "NodeReclaimer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+TEST(releaseFreesTree) {
+    auto result = MarkdownParser::parse("# a\n\n- b\n- *c*\n");
+    CHECK(result.success);
+    std::weak_ptr<MarkdownNode> document = result.nodes[0];
+    std::weak_ptr<MarkdownNode> heading = result.nodes[0]->children[0];
+
+    NodeReclaimer::shared().release(std::move(result.nodes));
+    CHECK(result.nodes.empty());
+    NodeReclaimer::shared().drain();
+    CHECK(document.expired());
+    CHECK(heading.expired());
+}
+
+TEST(sharedNodesSurvive) {
+    auto result = MarkdownParser::parse("# a\n\nb\n");
+    CHECK(result.success);
+    std::shared_ptr<MarkdownNode> heading = result.nodes[0]->children[0];
+    std::weak_ptr<MarkdownNode> document = result.nodes[0];
+
+    NodeReclaimer::shared().release(std::move(result.nodes));
+    NodeReclaimer::shared().drain();
+    CHECK(document.expired());
+    CHECK_EQ(heading->type, "heading");
+    CHECK_EQ(heading->children.size(), 1u);
+}
+
+TEST(manyReleases) {
+    std::vector<std::weak_ptr<MarkdownNode>> documents;
+    for (int i = 0; i < 200; i++) {
+        auto result = MarkdownParser::parse("para " + std::to_string(i) + "\n");
+        documents.push_back(result.nodes[0]);
+        NodeReclaimer::shared().release(std::move(result.nodes));
+    }
+    NodeReclaimer::shared().drain();
+    for (const auto& document : documents) {
+        CHECK(document.expired());
+    }
+}
+
+HYPERMARKDOWN_TEST_MAIN()
@@ -0,0 +1,171 @@
+/**
+ * Search index tests
+ *
+ * Builds the search index of parsed documents and checks that matches are
+ * case-insensitive, map to the text nodes they cover with UTF-16 offsets,
+ * and do not cross blocks.
+ */
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "SearchIndex.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+using hypermarkdown_test::nodeAt;
+
+namespace {
+
+std::shared_ptr<MarkdownNode> parse(const std::string& content) {
+    auto result = MarkdownParser::parse(content);
+    CHECK(result.success);
+    return result.success ? result.nodes.front() : std::make_shared<MarkdownNode>("document");
+}
+
+} // namespace
+
+TEST(caseInsensitive) {
+    auto root = parse("Hello WORLD, hello world.\n");
+    SearchIndex index(root.get());
+    auto matches = index.search({"hello world"});
+    CHECK_EQ(matches.size(), 2u);
+    if (matches.size() == 2) {
+        CHECK_EQ(matches[0].segments.size(), 1u);
+        CHECK(matches[0].segments[0].path == std::vector<uint32_t>({0, 0}));
+        CHECK_EQ(matches[0].segments[0].start, 0u);
+        CHECK_EQ(matches[0].segments[0].end, 11u);
+        CHECK_EQ(matches[1].segments[0].start, 13u);
+    }
+}
+
+TEST(unicode) {
+    // Greek and Cyrillic capitals, ß folding to "ss", and a character past
+    // the BMP, two UTF-16 units, before the match
+    auto root = parse("\xF0\x9F\x98\x80 ΣΟΦΙΑ and Москва, Straße\n");
+    SearchIndex index(root.get());
+    auto matches = index.search({"σοφια", "МОСКВА", "strasse"});
+    CHECK_EQ(matches.size(), 3u);
+    if (matches.size() == 3) {
+        CHECK_EQ(matches[0].pattern, 0u);
+        CHECK_EQ(matches[0].segments[0].start, 3u);
+        CHECK_EQ(matches[0].segments[0].end, 8u);
+        CHECK_EQ(matches[1].pattern, 1u);
+        CHECK_EQ(matches[2].pattern, 2u);
+        CHECK_EQ(matches[2].segments[0].start, 21u);
+        CHECK_EQ(matches[2].segments[0].end, 27u);
+    }
+    // A part of ß's folding covers all of it
+    auto partial = index.search({"se"});
+    CHECK_EQ(partial.size(), 1u);
+    if (partial.size() == 1) {
+        CHECK_EQ(partial[0].segments[0].start, 25u);
+        CHECK_EQ(partial[0].segments[0].end, 27u);
+    }
+    // Both "s" of its folding are ß, one match
+    CHECK_EQ(index.search({"s"}).size(), 2u);
+}
+
+TEST(acrossInlines) {
+    auto root = parse("Some *emphasized\ntext* here\n\nSome\n");
+    SearchIndex index(root.get());
+    auto matches = index.search({"some emphasized text here"});
+    CHECK_EQ(matches.size(), 1u);
+    if (matches.size() == 1) {
+        const auto& segments = matches[0].segments;
+        CHECK_EQ(segments.size(), 4u);
+        for (const auto& segment : segments) {
+            const auto* node = nodeAt(root.get(), segment.path);
+            CHECK(node && node->type == "text");
+        }
+        if (segments.size() == 4) {
+            CHECK(segments[1].path == std::vector<uint32_t>({0, 1, 0}));
+            CHECK_EQ(segments[3].start, 0u);
+            CHECK_EQ(segments[3].end, 5u);
+        }
+    }
+    // Blocks do not run on
+    CHECK(index.search({"here some"}).empty());
+}
+
+TEST(codeBlocks) {
+    auto root = parse("Intro\n\n```js\nconst Answer = 42\n```\n\n- item `Answer`\n");
+    SearchIndex index(root.get());
+    auto matches = index.search({"answer"});
+    CHECK_EQ(matches.size(), 2u);
+    if (matches.size() == 2) {
+        // The code of a code block is its text child
+        CHECK(matches[0].segments[0].path == std::vector<uint32_t>({1, 0}));
+        CHECK_EQ(matches[0].segments[0].start, 6u);
+        const auto* code = nodeAt(root.get(), matches[1].segments[0].path);
+        CHECK(code && code->type == "text" && code->content.value_or("") == "Answer");
+    }
+}
+
+TEST(insideCodeFences) {
+    auto root = parse("- item\n\n  ```\n  let x = 1\n  return Total\n  ```\n");
+    SearchIndex index(root.get());
+    auto matches = index.search({"total"});
+    CHECK_EQ(matches.size(), 1u);
+    if (matches.size() == 1) {
+        // The fence of a list item is parsed with its prefix stripped
+        const auto& segment = matches[0].segments[0];
+        CHECK(segment.path == std::vector<uint32_t>({0, 0, 1, 0}));
+        CHECK_EQ(segment.start, 17u);
+        CHECK_EQ(segment.end, 22u);
+        std::vector<uint32_t> parentPath(segment.path.begin(), segment.path.end() - 1);
+        const auto* block = nodeAt(root.get(), parentPath);
+        CHECK(block && block->type == "code_block");
+    }
+    // Code is a block of its own: no match runs on from the paragraph
+    CHECK(index.search({"item let"}).empty());
+}
+
+TEST(codeBlockContent) {
+    // A code block may hold its code itself rather than in a text child
+    auto root = std::make_shared<MarkdownNode>("document");
+    auto paragraph = std::make_shared<MarkdownNode>("paragraph");
+    auto text = std::make_shared<MarkdownNode>("text");
+    text->content = "Before";
+    paragraph->children.push_back(text);
+    auto code = std::make_shared<MarkdownNode>("code_block");
+    code->content = "fn main() {\n    println!(\"Ünïcode\");\n}\n";
+    root->children.push_back(paragraph);
+    root->children.push_back(code);
+    SearchIndex index(root.get());
+    auto matches = index.search({"ÜNÏCODE"});
+    CHECK_EQ(matches.size(), 1u);
+    if (matches.size() == 1) {
+        CHECK(matches[0].segments[0].path == std::vector<uint32_t>({1}));
+        CHECK_EQ(matches[0].segments[0].start, 26u);
+        CHECK_EQ(matches[0].segments[0].end, 33u);
+    }
+    CHECK(index.search({"before fn"}).empty());
+}
+
+TEST(multiplePatterns) {
+    auto root = parse("aaaa abab\n");
+    SearchIndex index(root.get());
+    // Matches of one pattern do not overlap, those of different ones may
+    auto matches = index.search({"aa", "ab", "bab", "", "aa"});
+    CHECK_EQ(matches.size(), 5u);
+    if (matches.size() == 5) {
+        CHECK_EQ(matches[0].segments[0].start, 0u);
+        CHECK_EQ(matches[1].segments[0].start, 2u);
+        CHECK_EQ(matches[2].pattern, 1u);
+        CHECK_EQ(matches[2].segments[0].start, 5u);
+        CHECK_EQ(matches[3].pattern, 2u);
+        CHECK_EQ(matches[4].segments[0].start, 7u);
+    }
+    CHECK_EQ(index.search({"a"}, 3).size(), 3u);
+    CHECK(index.search({}).empty());
+    CHECK(index.search({"missing"}).empty());
+}
+
+TEST(json) {
+    auto root = parse("# Find *me*\n");
+    SearchIndex index(root.get());
+    CHECK_EQ(MarkdownSerializer::searchMatchesToJson(index.search({"d me"})),
+             "[{\"pattern\":0,\"segments\":[{\"path\":[0,0],\"start\":3,\"end\":5},"
+             "{\"path\":[0,1,0],\"start\":0,\"end\":2}]}]");
+}
+
+HYPERMARKDOWN_TEST_MAIN()
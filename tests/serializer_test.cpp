@@ -0,0 +1,118 @@
+/**
+ * MarkdownSerializer tests
+ *
+ * Pins the JSON produced for the JS side: property names and order,
+ * omitted optional properties and string escaping.
+ */
+#include "LineIndex.h"
+#include "MarkdownParser.h"
+#include "MarkdownSerializer.h"
+#include "TestHarness.h"
+
+using namespace margelo::nitro::hypermarkdown;
+
+namespace {
+
+std::string parseToJson(const std::string& content) {
+    auto result = MarkdownParser::parse(content);
+    CHECK(result.success);
+    return MarkdownSerializer::toJson(result.nodes);
+}
+
+} // namespace
+
+TEST(paragraph) {
+    CHECK_EQ(parseToJson("Hello *world*\n"),
+             "[{\"type\":\"document\",\"children\":[{\"type\":\"paragraph\",\"children\":["
+             "{\"type\":\"text\",\"content\":\"Hello \"},"
+             "{\"type\":\"emphasis\",\"children\":[{\"type\":\"text\",\"content\":\"world\"}]}]}]}]");
+}
+
+TEST(headingAndCode) {
+    CHECK_EQ(parseToJson("# T\n\n```js\nx\n```\n"),
+             "[{\"type\":\"document\",\"children\":["
+             "{\"type\":\"heading\",\"level\":1,\"children\":[{\"type\":\"text\",\"content\":\"T\"}]},"
+             "{\"type\":\"code_block\",\"language\":\"js\",\"children\":[{\"type\":\"text\",\"content\":\"x\\n\"}]}]}]");
+}
+
+TEST(listProperties) {
+    std::string json = parseToJson("2. [x] a\n");
+    CHECK(json.find("\"ordered\":true,\"start\":2") != std::string::npos);
+    CHECK(json.find("\"checked\":true") != std::string::npos);
+}
+
+TEST(tableCell) {
+    std::string json = parseToJson("| a |\n|:-:|\n| 1 |\n");
+    CHECK(json.find("\"type\":\"table_cell\",\"align\":\"center\",\"isHeader\":true") != std::string::npos);
+    CHECK(json.find("\"align\":\"center\",\"isHeader\":false") != std::string::npos);
+}
+
+TEST(escaping) {
+    CHECK_EQ(MarkdownSerializer::escapeJson("a\"b\\c\n\t\r\b\f"), "a\\\"b\\\\c\\n\\t\\r\\b\\f");
+    CHECK_EQ(MarkdownSerializer::escapeJson(std::string("\x01\x1f", 2)), "\\u0001\\u001f");
+    CHECK_EQ(MarkdownSerializer::escapeJson("héllo 🚀"), "héllo 🚀");
+    // The JSON stays valid UTF-8
+    CHECK_EQ(MarkdownSerializer::escapeJson("a\xFF\xE4\xB8z"), "a\xEF\xBF\xBD\xEF\xBF\xBDz");
+}
+
+TEST(nullNode) {
+    CHECK_EQ(MarkdownSerializer::nodeToJson(nullptr), "null");
+    CHECK_EQ(MarkdownSerializer::toJson({}), "[]");
+}
+
+TEST(positions) {
+    std::string content = "a\n*b*\n";
+    InternalParserOptions options;
+    options.sourcePositions = true;
+    auto result = MarkdownParser::parse(content, options);
+    CHECK(result.success);
+    LineIndex lines(content);
+    std::string json = MarkdownSerializer::toJson(result.nodes, nullptr, &lines);
+    CHECK(json.find("{\"type\":\"emphasis\",\"position\":{\"start\":{\"line\":2,\"column\":1,\"offset\":2},"
+                    "\"end\":{\"line\":2,\"column\":4,\"offset\":5}}") != std::string::npos);
+    // Without the index only offsets are known
+    CHECK(MarkdownSerializer::toJson(result.nodes).find(
+              "\"position\":{\"start\":{\"offset\":2},\"end\":{\"offset\":5}}") != std::string::npos);
+}
+
+TEST(codeTokens) {
+    InternalParserOptions options;
+    options.highlightCode = true;
+    auto result = MarkdownParser::parse("```json\n{\"a\": 1}\n```\n", options);
+    CHECK(result.success);
+    CHECK(MarkdownSerializer::toJson(result.nodes).find("\"language\":\"json\",\"tokens\":[1,3,8,6,1,3]") !=
+          std::string::npos);
+}
+
+TEST(textRuns) {
+    InternalParserOptions options;
+    options.textRuns = true;
+    auto result = MarkdownParser::parse("a *b* [c](u \"t\")\n", options);
+    CHECK(result.success);
+    CHECK(MarkdownSerializer::toJson(result.nodes).find(
+              "{\"type\":\"text\",\"content\":\"a b c\",\"runs\":[2,0,-1,1,1,-1,1,0,-1,1,16,0],"
+              "\"links\":[{\"href\":\"u\",\"title\":\"t\"}]}") != std::string::npos);
+}
+
+TEST(outputMemory) {
+    InternalParserOptions options;
+    options.collectMemory = true;
+    auto result = MarkdownParser::parse("Hello *world*\n", options);
+    CHECK(result.success && result.memory);
+    if (!result.memory) {
+        return;
+    }
+
+    std::string json = MarkdownSerializer::toJson(result.nodes, &*result.memory);
+    CHECK_EQ(json, MarkdownSerializer::toJson(result.nodes));
+    CHECK(result.memory->output.allocations > 0);
+    CHECK(result.memory->output.bytesAllocated >= json.size());
+
+    // Output that does not fit in the limit gives an empty string
+    InternalParseMemory tight;
+    tight.limit = 16;
+    CHECK_EQ(MarkdownSerializer::toJson(result.nodes, &tight), "");
+    CHECK(tight.exceeded);
+}
+
+HYPERMARKDOWN_TEST_MAIN()